@@ -13,6 +13,8 @@ add_library(onnxruntime_session ${onnxruntime_session_srcs})
 install(DIRECTORY ${PROJECT_SOURCE_DIR}/../include/onnxruntime/core/session  DESTINATION ${CMAKE_INSTALL_INCLUDEDIR}/onnxruntime/core)
 onnxruntime_add_include_to_target(onnxruntime_session onnx protobuf::libprotobuf)
 target_include_directories(onnxruntime_session PRIVATE ${ONNXRUNTIME_ROOT})
+# part of the key of the optimized model cache
+target_compile_definitions(onnxruntime_session PRIVATE ORT_VERSION_NUMBER="${VERSION_NUMBER}")
 add_dependencies(onnxruntime_session ${onnxruntime_EXTERNAL_DEPENDENCIES})
 set_target_properties(onnxruntime_session PROPERTIES FOLDER "ONNXRuntime")
 
@@ -63,6 +63,31 @@ namespace Microsoft.ML.OnnxRuntime
                                                 IntPtr[] outputValues /* An array of output value pointers. Array must be allocated by the caller */
                                                 );
 
+        [DllImport(nativeLib, CharSet = charSet)]
+        public static extern IntPtr /*(OrtStatus*)*/ OrtCreatePreparedRun(
+                                                IntPtr /*(const OrtSession*)*/ session,
+                                                string[] inputNames,
+                                                ulong inputCount,  /* TODO: size_t, make it portable for x86 arm */
+                                                string[] outputNames,
+                                                ulong outputCount,  /* TODO: size_t, make it portable for x86 and arm */
+                                                out IntPtr /*(OrtPreparedRun**)*/ preparedRun);
+
+        [DllImport(nativeLib, CharSet = charSet)]
+        public static extern IntPtr /*(OrtStatus*)*/ OrtRunPrepared(
+                                                IntPtr /*(OrtSession*)*/ session,
+                                                IntPtr /*(OrtSessionRunOptions*)*/ runOptions,  // can be null to use the default options
+                                                IntPtr /*(const OrtPreparedRun*)*/ preparedRun,
+                                                IntPtr[] /* (OrtValue*[])*/ inputValues,
+                                                ulong inputCount,  /* TODO: size_t, make it portable for x86 arm */
+
+                                                [MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 6 /*index of outputCount*/)][In, Out]
+                                                IntPtr[] outputValues, /* An array of output value pointers. Array must be allocated by the caller */
+                                                ulong outputCount  /* TODO: size_t, make it portable for x86 and arm */
+                                                );
+
+        [DllImport(nativeLib, CharSet = charSet)]
+        public static extern void OrtReleasePreparedRun(IntPtr /*(OrtPreparedRun*)*/preparedRun);
+
 
         [DllImport(nativeLib, CharSet = charSet)]
         public static extern IntPtr /*(OrtStatus*)*/ OrtInferenceSessionGetInputCount(
@@ -131,12 +156,24 @@ namespace Microsoft.ML.OnnxRuntime
         [DllImport(nativeLib, CharSet = charSet)]
         public static extern void OrtDisableProfiling(IntPtr /* OrtSessionOptions* */ options);
 
+        [DllImport(nativeLib, CharSet = charSet)]
+        public static extern void OrtSetProfileSamplingInterval(IntPtr /* OrtSessionOptions* */ options, uint samplingInterval);
+
+        [DllImport(nativeLib, CharSet = charSet)]
+        public static extern void OrtSetProfileFileRotation(IntPtr /* OrtSessionOptions* */ options, ulong /* TODO: size_t */ maxFileBytes, uint maxFileSeconds);
+
         [DllImport(nativeLib, CharSet = charSet)]
         public static extern void OrtEnableMemPattern(IntPtr /* OrtSessionOptions* */ options);
 
         [DllImport(nativeLib, CharSet = charSet)]
         public static extern void OrtDisableMemPattern(IntPtr /* OrtSessionOptions* */ options);
 
+        [DllImport(nativeLib, CharSet = charSet)]
+        public static extern void OrtSetMemPatternCacheLimits(IntPtr /* OrtSessionOptions* */ options, ulong /* TODO: size_t */ maxEntries, ulong /* TODO: size_t */ maxBytes);
+
+        [DllImport(nativeLib, CharSet = charSet)]
+        public static extern int OrtSetMemPatternDimBuckets(IntPtr /* OrtSessionOptions* */ options, long[] dimBuckets, ulong /* TODO: size_t */ dimBucketsLength);
+
         [DllImport(nativeLib, CharSet = charSet)]
         public static extern void OrtEnableCpuMemArena(IntPtr /* OrtSessionOptions* */ options);
 
@@ -152,6 +189,15 @@ namespace Microsoft.ML.OnnxRuntime
         [DllImport(nativeLib, CharSet = charSet)]
         public static extern int OrtSetSessionThreadPoolSize(IntPtr /* OrtSessionOptions* */ options, int sessionThreadPoolSize);
 
+        [DllImport(nativeLib, CharSet = charSet)]
+        public static extern int OrtSetIntraOpNumThreads(IntPtr /* OrtSessionOptions* */ options, int intraOpNumThreads);
+
+        [DllImport(nativeLib, CharSet = charSet)]
+        public static extern int OrtSetSessionGraphOptimizationLevel(IntPtr /* OrtSessionOptions* */ options, uint graphOptimizationLevel);
+
+        [DllImport(nativeLib, CharSet = charSet)]
+        public static extern void OrtSetOptimizedModelCachePath(IntPtr /* OrtSessionOptions* */ options, string cachePath);
+
         ///**
         //  * The order of invocation indicates the preference order as well. In other words call this method
         //  * on your most preferred execution provider first followed by the less preferred ones.
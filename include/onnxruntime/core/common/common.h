@@ -196,6 +196,11 @@ inline long long TimeDiffMicroSeconds(TimePoint start_time, TimePoint end_time)
   return std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
 }
 
+inline long long TimeDiffNanoSeconds(TimePoint start_time) {
+  auto end_time = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count();
+}
+
 inline std::string GetCurrentTimeString() {
   auto now = std::chrono::system_clock::now();
   auto in_time_t = std::chrono::system_clock::to_time_t(now);
@@ -69,6 +69,7 @@ static constexpr const char* event_categor_names_[EVENT_CATEGORY_MAX] = {
 Timing record for all events.
 */
 struct EventRecord {
+  EventRecord() = default;
   EventRecord(EventCategory category,
               int process_id,
               int thread_id,
@@ -23,6 +23,9 @@ namespace onnxruntime {
 class ExecutionFrame;
 class OpKernelContext;
 class OpKernelWrapper;
+namespace concurrency {
+class ThreadPool;
+}
 
 class OpKernel {
  public:
@@ -145,6 +148,12 @@ class OpKernelContext {
   */
   Fence_t OutputFence(int index) const;
 
+  /**
+  Returns the intra-op thread pool of the session, shared by all kernels that parallelize their work.
+  Kernels should use it instead of creating threads so that the session never oversubscribes the machine.
+  */
+  concurrency::ThreadPool* GetOperatorThreadPool() const;
+
  protected:
   onnxruntime::NodeIndex GetNodeIndex() const;
   const SessionState& GetSessionState() const;
@@ -474,6 +474,12 @@ class Graph {
   /** Removes all initializer tensors from this Graph and releases the memory they were using. */
   void CleanAllInitializedTensors() noexcept;
 
+  /** Releases the NodeProto and ValueInfoProto instances of the GraphProto this Graph was created from, in this
+  Graph and in all subgraphs. The Nodes and NodeArgs hold copies of everything they need, so this only drops
+  the protobuf representation, which for a Node with a subgraph includes a copy of the whole subgraph.
+  ToGraphProto recreates the released content from the Nodes if it is called later. */
+  void ReleaseGraphProtoNodes() noexcept;
+
   /** Gets the Graph inputs excluding initializers. 
   These are the required inputs to the Graph as the initializers can be optionally overridden via graph inputs.
   @remarks Contains no nullptr values. */
@@ -109,6 +109,7 @@ ORT_RUNTIME_CLASS(AllocatorInfo);
 ORT_RUNTIME_CLASS(Session);
 ORT_RUNTIME_CLASS(Value);
 ORT_RUNTIME_CLASS(ValueList);
+ORT_RUNTIME_CLASS(PreparedRun);
 
 struct OrtTypeInfo;
 typedef struct OrtTypeInfo OrtTypeInfo;
@@ -289,6 +290,18 @@ ORT_API(void, OrtDisableSequentialExecution, _In_ OrtSessionOptions* options);
 ORT_API(void, OrtEnableProfiling, _In_ OrtSessionOptions* options, _In_ const char* profile_file_prefix);
 ORT_API(void, OrtDisableProfiling, _In_ OrtSessionOptions* options);
 
+/**
+ * Record the profile events of one in every sampling_interval runs. 1, the default, records every run.
+ */
+ORT_API(void, OrtSetProfileSamplingInterval, _In_ OrtSessionOptions* options, uint32_t sampling_interval);
+
+/**
+ * Start a new profile file once the current one holds max_file_bytes, or was started max_file_seconds ago.
+ * Every file is a complete trace. 0 disables the limit.
+ */
+ORT_API(void, OrtSetProfileFileRotation, _In_ OrtSessionOptions* options, size_t max_file_bytes,
+        uint32_t max_file_seconds);
+
 // enable the memory pattern optimization.
 // The idea is if the input shapes are the same, we could trace the internal memory allocation
 // and generate a memory pattern for future request. So next time we could just do one allocation
@@ -296,6 +309,22 @@ ORT_API(void, OrtDisableProfiling, _In_ OrtSessionOptions* options);
 ORT_API(void, OrtEnableMemPattern, _In_ OrtSessionOptions* options);
 ORT_API(void, OrtDisableMemPattern, _In_ OrtSessionOptions* options);
 
+/**
+ * Limit the memory pattern cache of a session to max_entries patterns and about max_bytes of memory, which counts the
+ * buffer each pattern allocates as well as its bookkeeping. The least recently used patterns are dropped when either
+ * is exceeded. 0 disables a limit. The defaults are 64 patterns and no byte limit.
+ */
+ORT_API(void, OrtSetMemPatternCacheLimits, _In_ OrtSessionOptions* options, size_t max_entries, size_t max_bytes);
+
+/**
+ * Round every input dimension up to the next of the ascending dim_buckets before looking up a memory pattern, so that
+ * inputs with a variable dimension such as the sequence length share patterns. An empty list, the default, requires
+ * the shapes to match exactly.
+ * \return 0 on success, -1 if dim_buckets is not in ascending order.
+ */
+ORT_API(int, OrtSetMemPatternDimBuckets, _In_ OrtSessionOptions* options, _In_ const int64_t* dim_buckets,
+        size_t dim_buckets_len);
+
 // enable the memory arena on CPU
 // Arena may pre-allocate memory for future usage.
 // set this option to false if you don't want it.
@@ -311,6 +340,38 @@ ORT_API(void, OrtSetSessionLogVerbosityLevel, _In_ OrtSessionOptions* options, u
 ///How many threads in the session thread pool.
 ORT_API(int, OrtSetSessionThreadPoolSize, _In_ OrtSessionOptions* options, int session_thread_pool_size);
 
+/**
+ * How many threads the CPU kernels use to parallelize a single operator, including the calling thread.
+ * The threads are shared by all the kernels of the session. 0 (the default) lets onnxruntime choose.
+ * \return 0 on success, -1 if intra_op_num_threads is negative.
+ */
+ORT_API(int, OrtSetIntraOpNumThreads, _In_ OrtSessionOptions* options, int intra_op_num_threads);
+
+/**
+ * Levels of the built-in graph optimizations applied when a session is initialized.
+ * Each level also applies the optimizations of the levels below it.
+ */
+typedef enum GraphOptimizationLevel {
+  ORT_DISABLE_ALL = 0,
+  ORT_ENABLE_BASIC = 1,     // rewrites that keep to ONNX operators, e.g. folding BatchNormalization into Conv
+  ORT_ENABLE_EXTENDED = 2,  // fusions into com.microsoft operators with CPU kernels, e.g. Conv+Relu
+} GraphOptimizationLevel;
+
+/**
+ * Set the level of the built-in graph optimizations. The default is ORT_ENABLE_BASIC.
+ * \return 0 on success, -1 if graph_optimization_level is not a GraphOptimizationLevel.
+ */
+ORT_API(int, OrtSetSessionGraphOptimizationLevel, _In_ OrtSessionOptions* options, uint32_t graph_optimization_level);
+
+/**
+ * Set the path of a file caching the model after the graph optimizations were applied, and the execution provider
+ * assigned to each node, so that sessions created later for the same model file and options skip the optimizations,
+ * and the assignment if they append the same execution providers. The cache is written by the first session
+ * initialized. Only models loaded from a file are cached. The execution plan, kernels, memory patterns and
+ * initializers are created by every session.
+ */
+ORT_API(void, OrtSetOptimizedModelCachePath, _In_ OrtSessionOptions* options, _In_ const char* cache_path);
+
 /**
   * The order of invocation indicates the preference order as well. In other words call this method
   * on your most preferred execution provider first followed by the less preferred ones.
@@ -463,9 +524,43 @@ ORT_API_STATUS(OrtRunInference, _Inout_ OrtSession* sess,
                _In_ const char* const* input_names, _In_ const OrtValue* const* input, size_t input_len,
                _In_ const char* const* output_names, size_t output_names_len, _Out_ OrtValue** output);
 
+/**
+ * Resolve the input and output names of repeated OrtRunPrepared calls once.
+ * \param input_names names of the inputs that will be passed to OrtRunPrepared, in that order.
+ * \param output_names names of the outputs that OrtRunPrepared will return, in that order.
+ * \param out should be freed by OrtReleasePreparedRun after use. It must not outlive sess.
+ */
+ORT_API_STATUS(OrtCreatePreparedRun, _In_ const OrtSession* sess,
+               _In_ const char* const* input_names, size_t input_len,
+               _In_ const char* const* output_names, size_t output_names_len, _Out_ OrtPreparedRun** out);
+
+/**
+ * Same as OrtRunInference, but the inputs and outputs are matched by position with the names given to
+ * OrtCreatePreparedRun, so no names are looked up per call.
+ * \param prepared created by OrtCreatePreparedRun for sess. May be used by several threads at once.
+ */
+ORT_API_STATUS(OrtRunPrepared, _Inout_ OrtSession* sess,
+               _In_ OrtRunOptions* run_options, _In_ const OrtPreparedRun* prepared,
+               _In_ const OrtValue* const* input, size_t input_len,
+               _Out_ OrtValue** output, size_t output_len);
+
 ORT_API_STATUS(OrtInferenceSessionGetInputCount, _In_ const OrtSession* sess, _Out_ size_t* out);
 ORT_API_STATUS(OrtInferenceSessionGetOutputCount, _In_ const OrtSession* sess, _Out_ size_t* out);
 
+/**
+ * Counters of the memory pattern cache of a session, see OrtSetMemPatternCacheLimits.
+ */
+typedef struct OrtMemPatternCacheStats {
+  uint64_t hits;       // runs that found a pattern for their input shapes
+  uint64_t misses;     // runs that had to trace a pattern
+  uint64_t evictions;  // patterns dropped to stay within the limits
+  size_t num_entries;  // patterns currently cached
+  size_t num_bytes;    // approximate host memory used by the cached patterns
+} OrtMemPatternCacheStats;
+
+ORT_API_STATUS(OrtInferenceSessionGetMemPatternCacheStats, _In_ const OrtSession* sess,
+               _Out_ OrtMemPatternCacheStats* out);
+
 /**
  * \param out  should be freed by OrtReleaseObject after use
  */
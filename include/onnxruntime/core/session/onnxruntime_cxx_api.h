@@ -64,6 +64,19 @@ class SessionOptionsWrapper {
   void EnableProfiling(_In_ const char* profile_file_prefix) {
     OrtEnableProfiling(value.get(), profile_file_prefix);
   }
+  void SetProfileSamplingInterval(uint32_t sampling_interval) {
+    OrtSetProfileSamplingInterval(value.get(), sampling_interval);
+  }
+  void SetProfileFileRotation(size_t max_file_bytes, uint32_t max_file_seconds) {
+    OrtSetProfileFileRotation(value.get(), max_file_bytes, max_file_seconds);
+  }
+  void SetMemPatternCacheLimits(size_t max_entries, size_t max_bytes) {
+    OrtSetMemPatternCacheLimits(value.get(), max_entries, max_bytes);
+  }
+  void SetMemPatternDimBuckets(const int64_t* dim_buckets, size_t dim_buckets_len) {
+    if (OrtSetMemPatternDimBuckets(value.get(), dim_buckets, dim_buckets_len) != 0)
+      throw std::runtime_error("memory pattern dimension buckets must be in ascending order");
+  }
 
   void SetSessionLogId(const char* logid) {
     OrtSetSessionLogId(value.get(), logid);
@@ -74,6 +87,15 @@ class SessionOptionsWrapper {
   void SetSessionThreadPoolSize(int session_thread_pool_size) {
     OrtSetSessionThreadPoolSize(value.get(), session_thread_pool_size);
   }
+  void SetIntraOpNumThreads(int intra_op_num_threads) {
+    OrtSetIntraOpNumThreads(value.get(), intra_op_num_threads);
+  }
+  void SetGraphOptimizationLevel(uint32_t graph_optimization_level) {
+    OrtSetSessionGraphOptimizationLevel(value.get(), graph_optimization_level);
+  }
+  void SetOptimizedModelCachePath(const char* cache_path) {
+    OrtSetOptimizedModelCachePath(value.get(), cache_path);
+  }
 
   /**
   * The order of invocation indicates the preference order as well. In other words call this method
@@ -117,6 +139,23 @@ inline OrtValue* OrtCreateTensorWithDataAsOrtValue(_In_ const OrtAllocatorInfo*
   return ret;
 }
 
+inline OrtPreparedRun* OrtCreatePreparedRun(_In_ const OrtSession* sess, const std::vector<const char*>& input_names,
+                                            const std::vector<const char*>& output_names) {
+  OrtPreparedRun* ret;
+  ORT_THROW_ON_ERROR(::OrtCreatePreparedRun(sess, input_names.data(), input_names.size(),
+                                            output_names.data(), output_names.size(), &ret));
+  return ret;
+}
+
+/**
+ * \param output must have one entry per output name of prepared. Null entries are allocated by the run.
+ */
+inline void OrtRunPrepared(_Inout_ OrtSession* sess, _In_ OrtRunOptions* run_options, _In_ const OrtPreparedRun* prepared,
+                           const std::vector<OrtValue*>& input, std::vector<OrtValue*>& output) {
+  ORT_THROW_ON_ERROR(::OrtRunPrepared(sess, run_options, prepared, input.data(), input.size(),
+                                      output.data(), output.size()));
+}
+
 inline std::vector<int64_t> GetTensorShape(const OrtTensorTypeAndShapeInfo* info) {
   size_t dims = OrtGetNumOfDimensions(info);
   std::vector<int64_t> ret(dims);
@@ -0,0 +1,266 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "contrib_ops/cpu/fused_elementwise.h"
+
+#include <unordered_map>
+
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
+#include "core/util/math_cpuonly.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+ONNX_OPERATOR_KERNEL_EX(
+    FusedElementwise,
+    kMSDomain,
+    1,
+    kCpuExecutionProvider,
+    KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    FusedElementwise);
+
+namespace {
+using OpType = FusedElementwise::OpType;
+using Step = FusedElementwise::Step;
+
+// number of output elements taken through the whole chain at a time, small enough for a tile and the
+// matching part of each operand to stay in the L1 cache.
+constexpr int64_t kTileSize = 1024;
+
+const std::unordered_map<std::string, OpType>& OpTypes() {
+  static const std::unordered_map<std::string, OpType> op_types{
+      {"Add", OpType::Add},
+      {"Sub", OpType::Sub},
+      {"Mul", OpType::Mul},
+      {"Div", OpType::Div},
+      {"Pow", OpType::Pow},
+      {"Abs", OpType::Abs},
+      {"Exp", OpType::Exp},
+      {"Log", OpType::Log},
+      {"Neg", OpType::Neg},
+      {"Reciprocal", OpType::Reciprocal},
+      {"Relu", OpType::Relu},
+      {"Sigmoid", OpType::Sigmoid},
+      {"Sqrt", OpType::Sqrt},
+      {"Tanh", OpType::Tanh}};
+  return op_types;
+}
+
+bool IsBinary(OpType op) {
+  return op <= OpType::Pow;
+}
+
+// An operand of a binary operator, broadcast to the output such that element i of the output uses
+// element (i / inner) % outer of the operand.
+struct Operand {
+  const float* data;
+  int64_t inner;
+  int64_t outer;
+};
+
+// Work out inner and outer for an operand. This holds when the dimensions of the operand that are not 1 are
+// one run of the dimensions of the output, e.g. for an output of [N, C, H, W] a scalar, a bias of [C, 1, 1],
+// a row of [W] or a tensor of the whole shape.
+bool GetOperandBroadcast(const TensorShape& output_shape, const TensorShape& operand_shape, Operand& operand) {
+  const size_t rank = output_shape.NumDimensions();
+  const size_t operand_rank = operand_shape.NumDimensions();
+  if (operand_rank > rank) {
+    return false;
+  }
+
+  operand.inner = 1;
+  operand.outer = 1;
+  // walk out from the innermost dimension: broadcast dimensions, then the run of the operand, then broadcast again
+  bool in_run = false;
+  bool past_run = false;
+  for (size_t i = rank; i-- > 0;) {
+    const int64_t dim = output_shape[i];
+    const int64_t operand_dim = i + operand_rank >= rank ? operand_shape[i + operand_rank - rank] : 1;
+    if (operand_dim != 1 && operand_dim != dim) {
+      return false;
+    }
+
+    if (dim == 1) {
+      continue;
+    }
+
+    if (operand_dim == 1) {
+      if (in_run) {
+        past_run = true;
+      } else if (!past_run) {
+        operand.inner *= dim;
+      }
+    } else {
+      if (past_run) {
+        return false;
+      }
+      in_run = true;
+      operand.outer *= dim;
+    }
+  }
+
+  return true;
+}
+
+template <typename TOperand>
+void ApplyBinary(OpType op, bool operand_first, EigenVectorArrayMap<float> y, const TOperand& b) {
+  switch (op) {
+    case OpType::Add:
+      y += b;
+      break;
+    case OpType::Sub:
+      if (operand_first)
+        y = b - y;
+      else
+        y -= b;
+      break;
+    case OpType::Mul:
+      y *= b;
+      break;
+    case OpType::Div:
+      if (operand_first)
+        y = b / y;
+      else
+        y /= b;
+      break;
+    case OpType::Pow:
+      if (operand_first)
+        y = Eigen::pow(b, y);
+      else
+        y = Eigen::pow(y, b);
+      break;
+    default:
+      ORT_THROW("Unexpected binary operator");
+  }
+}
+
+// apply a binary operator to the output elements [begin, end) of y
+void ApplyBinary(const Step& step, const Operand& operand, float* y, int64_t begin, int64_t end) {
+  if (operand.outer == 1) {
+    ApplyBinary(step.op, step.operand_first, EigenVectorArrayMap<float>(y + begin, end - begin), *operand.data);
+    return;
+  }
+
+  for (int64_t i = begin; i < end;) {
+    int64_t count;
+    if (operand.inner == 1) {
+      // a run of the operand, up to where it repeats
+      const int64_t index = i % operand.outer;
+      count = std::min(end - i, operand.outer - index);
+      ApplyBinary(step.op, step.operand_first, EigenVectorArrayMap<float>(y + i, count),
+                  ConstEigenVectorArrayMap<float>(operand.data + index, count));
+    } else {
+      // a run of the output that uses one element of the operand
+      count = std::min(end - i, operand.inner - i % operand.inner);
+      ApplyBinary(step.op, step.operand_first, EigenVectorArrayMap<float>(y + i, count),
+                  operand.data[(i / operand.inner) % operand.outer]);
+    }
+    i += count;
+  }
+}
+
+void ApplyUnary(OpType op, float* y, int64_t count) {
+  EigenVectorArrayMap<float> a(y, count);
+  switch (op) {
+    case OpType::Abs:
+      a = a.abs();
+      break;
+    case OpType::Exp:
+      a = a.exp();
+      break;
+    case OpType::Log:
+      a = a.log();
+      break;
+    case OpType::Neg:
+      a = -a;
+      break;
+    case OpType::Reciprocal:
+      a = a.inverse();
+      break;
+    case OpType::Relu:
+      a = a.cwiseMax(0.0f);
+      break;
+    case OpType::Sigmoid:
+      MlasComputeLogistic(y, y, static_cast<size_t>(count));
+      break;
+    case OpType::Sqrt:
+      a = a.sqrt();
+      break;
+    case OpType::Tanh:
+      MlasComputeTanh(y, y, static_cast<size_t>(count));
+      break;
+    default:
+      ORT_THROW("Unexpected unary operator");
+  }
+}
+}  // namespace
+
+FusedElementwise::FusedElementwise(const OpKernelInfo& info) : OpKernel(info) {
+  std::vector<std::string> ops;
+  ORT_ENFORCE(info.GetAttrs<std::string>("ops", ops).IsOK() && !ops.empty(), "Attribute ops is required.");
+  std::vector<int64_t> operands = info.GetAttrsOrDefault<int64_t>("operands", std::vector<int64_t>(ops.size(), -1));
+  std::vector<int64_t> operand_first = info.GetAttrsOrDefault<int64_t>("operand_first",
+                                                                       std::vector<int64_t>(ops.size(), 0));
+  ORT_ENFORCE(operands.size() == ops.size() && operand_first.size() == ops.size(),
+              "Attributes operands and operand_first must have a value for each operator in ops.");
+
+  const int64_t input_count = static_cast<int64_t>(info.GetInputCount());
+  steps_.reserve(ops.size());
+  for (size_t i = 0; i < ops.size(); ++i) {
+    auto op_type = OpTypes().find(ops[i]);
+    ORT_ENFORCE(op_type != OpTypes().end(), "Unsupported operator ", ops[i]);
+    if (IsBinary(op_type->second)) {
+      ORT_ENFORCE(operands[i] >= 0 && operands[i] < input_count, "Invalid operand ", operands[i], " for ", ops[i]);
+    } else {
+      ORT_ENFORCE(operands[i] == -1, "Unary operator ", ops[i], " must have an operand of -1");
+    }
+    steps_.push_back({op_type->second, static_cast<int>(operands[i]), operand_first[i] != 0});
+  }
+}
+
+Status FusedElementwise::Compute(OpKernelContext* context) const {
+  const Tensor& X = *context->Input<Tensor>(0);
+  const TensorShape& shape = X.Shape();
+  Tensor& Y = *context->Output(0, shape);
+  const int64_t size = shape.Size();
+  if (size == 0) {
+    return Status::OK();
+  }
+
+  std::vector<Operand> operands(steps_.size(), Operand{nullptr, 1, 1});
+  for (size_t i = 0; i < steps_.size(); ++i) {
+    if (steps_[i].operand < 0) {
+      continue;
+    }
+
+    const Tensor& B = *context->Input<Tensor>(steps_[i].operand);
+    operands[i].data = B.Data<float>();
+    if (!GetOperandBroadcast(shape, B.Shape(), operands[i])) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input ", steps_[i].operand, " with shape ", B.Shape(),
+                             " can not be broadcast to the shape of the first input ", shape);
+    }
+  }
+
+  const float* x = X.Data<float>();
+  float* y = Y.MutableData<float>();
+  auto compute = [&](int64_t begin, int64_t end) {
+    for (int64_t tile = begin; tile < end; tile += kTileSize) {
+      const int64_t tile_end = std::min(tile + kTileSize, end);
+      EigenVectorArrayMap<float>(y + tile, tile_end - tile) = ConstEigenVectorArrayMap<float>(x + tile, tile_end - tile);
+      for (size_t i = 0; i < steps_.size(); ++i) {
+        if (steps_[i].operand < 0) {
+          ApplyUnary(steps_[i].op, y + tile, tile_end - tile);
+        } else {
+          ApplyBinary(steps_[i], operands[i], y, tile, tile_end);
+        }
+      }
+    }
+  };
+
+  concurrency::ThreadPool::TryParallelFor(context->GetOperatorThreadPool(), size, 1, compute);
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
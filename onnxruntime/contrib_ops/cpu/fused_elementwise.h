@@ -0,0 +1,53 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "core/framework/op_kernel.h"
+
+namespace onnxruntime {
+namespace contrib {
+/*
+Evaluates a chain of float element-wise operators that ElementwiseFusion replaced with one node.
+The output is computed a cache sized tile at a time, taking each tile through the whole chain, so the
+intermediate results of the chain are never written out to memory.
+*/
+class FusedElementwise final : public OpKernel {
+ public:
+  enum class OpType {
+    // binary
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Pow,
+    // unary
+    Abs,
+    Exp,
+    Log,
+    Neg,
+    Reciprocal,
+    Relu,
+    Sigmoid,
+    Sqrt,
+    Tanh
+  };
+
+  struct Step {
+    OpType op;
+    // index of the input that is the other operand of a binary operator, or -1 for a unary operator.
+    int operand;
+    // whether that operand is the first input of the operator, e.g. the numerator of a Div.
+    bool operand_first;
+  };
+
+  explicit FusedElementwise(const OpKernelInfo& info);
+
+  Status Compute(OpKernelContext* context) const override;
+
+ private:
+  std::vector<Step> steps_;
+};
+}  // namespace contrib
+}  // namespace onnxruntime
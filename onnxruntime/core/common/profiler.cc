@@ -3,10 +3,39 @@
 
 #include "profiler.h"
 
+#include <algorithm>
+#include <sstream>
+
 namespace onnxruntime {
 namespace profiling {
 using namespace std::chrono;
 
+namespace {
+// whether the calling thread works on a run, and if so whether the run is sampled. see Profiler::RunScope.
+enum RunState : int {
+  kNotInRun = 0,
+  kSampledRun = 1,
+  kSkippedRun = 2,
+};
+
+thread_local int current_run_state = kNotInRun;
+
+uint64_t GetNextProfilerId() {
+  static std::atomic<uint64_t> next_id{1};
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+}  // namespace
+
+Profiler::Profiler() noexcept : id_(GetNextProfilerId()) {}
+
+Profiler::~Profiler() {
+  // a profile still running is completed so that its file is valid
+  if (writer_.joinable()) {
+    StopWriter();
+    CloseFile();
+  }
+}
+
 ::onnxruntime::TimePoint profiling::Profiler::StartTime() const {
   return std::chrono::high_resolution_clock::now();
 }
@@ -16,6 +45,12 @@ void Profiler::Initialize(const logging::Logger* session_logger) {
   session_logger_ = session_logger;
 }
 
+void Profiler::SetOptions(const ProfilerOptions& options) {
+  options_ = options;
+  options_.sampling_interval = std::max<uint32_t>(options_.sampling_interval, 1);
+  options_.thread_buffer_size = std::max<size_t>(options_.thread_buffer_size, 1);
+}
+
 void Profiler::StartProfiling(const logging::Logger* custom_logger) {
   ORT_ENFORCE(custom_logger != nullptr);
   profile_with_logger_ = true;
@@ -24,10 +59,47 @@ void Profiler::StartProfiling(const logging::Logger* custom_logger) {
 }
 
 void Profiler::StartProfiling(const std::string& file_name) {
-  enabled_ = true;
-  profile_stream_ = std::ofstream(file_name, std::ios::out | std::ios::trunc);
+  if (enabled_) {
+    EndProfiling();
+  }
+
+  // drop the events left in the buffers by a previous profile
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& buffer : thread_buffers_) {
+      buffer->head.store(buffer->tail.load(std::memory_order_acquire), std::memory_order_release);
+    }
+  }
+  num_dropped_events_.store(0, std::memory_order_relaxed);
+
   profile_stream_file_ = file_name;
+  file_index_ = 0;
   profiling_start_time_ = StartTime();
+  OpenFile();
+
+  stop_writer_ = false;
+  flush_requested_ = false;
+  writer_ = std::thread(&Profiler::WriterLoop, this);
+  enabled_ = true;
+}
+
+bool Profiler::SampleRun() {
+  if (!IsEnabled()) {
+    return false;
+  }
+  return num_runs_.fetch_add(1, std::memory_order_relaxed) % options_.sampling_interval == 0;
+}
+
+bool Profiler::IsRunSkipped() {
+  return current_run_state == kSkippedRun;
+}
+
+Profiler::RunScope::RunScope(bool is_sampled) : previous_state_(current_run_state) {
+  current_run_state = is_sampled ? kSampledRun : kSkippedRun;
+}
+
+Profiler::RunScope::~RunScope() {
+  current_run_state = previous_state_;
 }
 
 void Profiler::EndTimeAndRecordEvent(EventCategory category,
@@ -35,7 +107,7 @@ void Profiler::EndTimeAndRecordEvent(EventCategory category,
                                      TimePoint& start_time,
                                      const std::initializer_list<std::pair<std::string, std::string>>& event_args,
                                      bool /*sync_gpu*/) {
-  if (!enabled_ && !profile_with_logger_)
+  if (!IsEnabled())
     return;
   long long dur = TimeDiffMicroSeconds(start_time);
   long long ts = TimeDiffMicroSeconds(profiling_start_time_, start_time);
@@ -44,19 +116,196 @@ void Profiler::EndTimeAndRecordEvent(EventCategory category,
                     logging::GetThreadId(), event_name, ts, dur, { event_args.begin(), event_args.end() });
   if (profile_with_logger_) {
     custom_logger_->SendProfileEvent(event);
-  } else {
-    //TODO: sync_gpu if needed.
+    return;
+  }
+
+  //TODO: sync_gpu if needed.
+  ThreadBuffer* buffer = GetThreadBuffer();
+  const size_t capacity = buffer->events.size();
+  const size_t tail = buffer->tail.load(std::memory_order_relaxed);
+  const size_t head = buffer->head.load(std::memory_order_acquire);
+  if (tail - head >= capacity) {
+    num_dropped_events_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  buffer->events[tail % capacity] = std::move(event);
+  buffer->tail.store(tail + 1, std::memory_order_release);
+
+  // wake the writer early when a burst of events fills the buffer faster than it is flushed
+  if (tail + 1 - head == capacity / 2) {
+    {
+      std::lock_guard<std::mutex> lock(writer_mutex_);
+      flush_requested_ = true;
+    }
+    writer_wakeup_.notify_one();
+  }
+}
+
+Profiler::ThreadBuffer* Profiler::GetThreadBuffer() {
+  // threads usually record into a single profiler, so the buffer of the last one used is cached. the cache keeps
+  // the buffer alive until the thread exits or switches to another profiler, after which the writer can free it.
+  // the ids of the profilers are never reused, so the cache of a destroyed profiler is never hit.
+  struct CachedThreadBuffer {
+    uint64_t profiler_id = 0;
+    std::shared_ptr<ThreadBuffer> buffer;
+  };
+  thread_local CachedThreadBuffer cached;
+  if (cached.profiler_id == id_) {
+    return cached.buffer.get();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  const std::thread::id thread_id = std::this_thread::get_id();
+  auto it = std::find_if(thread_buffers_.cbegin(), thread_buffers_.cend(),
+                         [thread_id](const std::shared_ptr<ThreadBuffer>& buffer) {
+                           return buffer->thread_id == thread_id;
+                         });
+  if (it == thread_buffers_.cend()) {
+    thread_buffers_.push_back(std::make_shared<ThreadBuffer>(thread_id, options_.thread_buffer_size));
+    it = thread_buffers_.cend() - 1;
+  }
+
+  cached.profiler_id = id_;
+  cached.buffer = *it;
+  return cached.buffer.get();
+}
+
+void Profiler::WriterLoop() {
+  std::unique_lock<std::mutex> lock(writer_mutex_);
+  bool stop = false;
+  while (!stop) {
+    writer_wakeup_.wait_for(lock, milliseconds(options_.flush_interval_ms),
+                            [this]() { return stop_writer_ || flush_requested_; });
+    stop = stop_writer_;
+    flush_requested_ = false;
+
+    // the events still buffered when the profile ends are written by the last iteration
+    lock.unlock();
+    WriteBufferedEvents();
+    lock.lock();
+  }
+}
+
+void Profiler::StopWriter() {
+  {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    stop_writer_ = true;
+  }
+  writer_wakeup_.notify_one();
+  writer_.join();
+}
+
+void Profiler::WriteBufferedEvents() {
+  // the buffers are only freed by this thread, so they can be drained without holding the mutex
+  std::vector<ThreadBuffer*> buffers;
+  {
     std::lock_guard<std::mutex> lock(mutex_);
-    if (events_.size() < max_num_events_) {
-      events_.emplace_back(event);
-    } else {
-      if (session_logger_ && !max_events_reached) {
-        LOGS(*session_logger_, ERROR)
-            << "Maximum number of events reached, could not record profile event.";
-        max_events_reached = true;
-      }
+    buffers.reserve(thread_buffers_.size());
+    for (auto& buffer : thread_buffers_) {
+      buffers.push_back(buffer.get());
+    }
+  }
+
+  for (ThreadBuffer* buffer : buffers) {
+    const size_t capacity = buffer->events.size();
+    size_t head = buffer->head.load(std::memory_order_relaxed);
+    const size_t tail = buffer->tail.load(std::memory_order_acquire);
+    for (; head != tail; ++head) {
+      WriteEvent(buffer->events[head % capacity]);
+    }
+    buffer->head.store(head, std::memory_order_release);
+  }
+  profile_stream_.flush();
+  ReleaseIdleBuffers();
+
+  const uint64_t num_dropped_events = num_dropped_events_.exchange(0, std::memory_order_relaxed);
+  if (num_dropped_events != 0 && session_logger_) {
+    LOGS(*session_logger_, WARNING) << "Dropped " << num_dropped_events
+                                    << " profile events because the buffer of their thread was full.";
+  }
+}
+
+void Profiler::ReleaseIdleBuffers() {
+  // a buffer only referred to by the profiler belongs to a thread that exited or records into another profiler.
+  // it is freed once two flushes in a row found it empty, so that the last events of its thread are written.
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto is_idle = [](const std::shared_ptr<ThreadBuffer>& buffer) {
+    const bool is_empty = buffer->head.load(std::memory_order_relaxed) ==
+                          buffer->tail.load(std::memory_order_acquire);
+    buffer->idle_flushes = is_empty && buffer.use_count() == 1 ? buffer->idle_flushes + 1 : 0;
+    return buffer->idle_flushes >= 2;
+  };
+  thread_buffers_.erase(std::remove_if(thread_buffers_.begin(), thread_buffers_.end(), is_idle),
+                        thread_buffers_.end());
+}
+
+void Profiler::WriteEvent(const EventRecord& rec) {
+  if (file_num_events_ != 0) {
+    const bool is_file_full = options_.max_file_bytes != 0 && file_bytes_ >= options_.max_file_bytes;
+    const bool is_file_old = options_.max_file_seconds != 0 &&
+                             StartTime() - file_start_time_ >= seconds(options_.max_file_seconds);
+    if (is_file_full || is_file_old) {
+      CloseFile();
+      ++file_index_;
+      OpenFile();
     }
   }
+
+  std::ostringstream ss;
+  if (file_num_events_ != 0) {
+    ss << ",\n";
+  }
+  ss << R"({"cat" : ")" << event_categor_names_[rec.cat] << "\",";
+  ss << "\"pid\" :" << rec.pid << ",";
+  ss << "\"tid\" :" << rec.tid << ",";
+  ss << "\"dur\" :" << rec.dur << ",";
+  ss << "\"ts\" :" << rec.ts << ",";
+  ss << R"("ph" : "X",)";
+  ss << R"("name" :")" << rec.name << "\",";
+  ss << "\"args\" : {";
+  bool is_first_arg = true;
+  for (const auto& event_arg : rec.args) {
+    if (!is_first_arg) ss << ",";
+    ss << "\"" << event_arg.first << "\" : \"" << event_arg.second << "\"";
+    is_first_arg = false;
+  }
+  ss << "}}";
+
+  const std::string event = ss.str();
+  profile_stream_ << event;
+  file_bytes_ += event.size();
+  ++file_num_events_;
+}
+
+void Profiler::OpenFile() {
+  current_file_ = GetFileName(file_index_);
+  profile_stream_ = std::ofstream(current_file_, std::ios::out | std::ios::trunc);
+  profile_stream_ << "[\n";
+  file_bytes_ = 2;
+  file_num_events_ = 0;
+  file_start_time_ = StartTime();
+}
+
+void Profiler::CloseFile() {
+  profile_stream_ << (file_num_events_ == 0 ? "]\n" : "\n]\n");
+  profile_stream_.close();
+}
+
+std::string Profiler::GetFileName(size_t file_index) const {
+  if (file_index == 0) {
+    return profile_stream_file_;
+  }
+
+  // insert the index before the extension: profile.json, profile.1.json, profile.2.json...
+  const size_t separator = profile_stream_file_.find_last_of("/\\");
+  size_t extension = profile_stream_file_.find_last_of('.');
+  if (extension == std::string::npos || (separator != std::string::npos && extension < separator)) {
+    extension = profile_stream_file_.size();
+  }
+
+  return profile_stream_file_.substr(0, extension) + "." + std::to_string(file_index) +
+         profile_stream_file_.substr(extension);
 }
 
 std::string Profiler::EndProfiling() {
@@ -67,36 +316,11 @@ std::string Profiler::EndProfiling() {
     profile_with_logger_ = false;
     return std::string();
   }
-  std::lock_guard<std::mutex> lock(mutex_);
-  profile_stream_ << "[\n";
 
-  for (size_t i = 0; i < events_.size(); ++i) {
-    auto& rec = events_[i];
-    profile_stream_ << R"({"cat" : ")" << event_categor_names_[rec.cat] << "\",";
-    profile_stream_ << "\"pid\" :" << rec.pid << ",";
-    profile_stream_ << "\"tid\" :" << rec.tid << ",";
-    profile_stream_ << "\"dur\" :" << rec.dur << ",";
-    profile_stream_ << "\"ts\" :" << rec.ts << ",";
-    profile_stream_ << R"("ph" : "X",)";
-    profile_stream_ << R"("name" :")" << rec.name << "\",";
-    profile_stream_ << "\"args\" : {";
-    bool is_first_arg = true;
-    for (std::pair<std::string, std::string> event_arg : rec.args) {
-      if (!is_first_arg) profile_stream_ << ",";
-      profile_stream_ << "\"" << event_arg.first << "\" : \"" << event_arg.second << "\"";
-      is_first_arg = false;
-    }
-    profile_stream_ << "}";
-    if (i == events_.size() - 1) {
-      profile_stream_ << "}\n";
-    } else {
-      profile_stream_ << "},\n";
-    }
-  }
-  profile_stream_ << "]\n";
-  profile_stream_.close();
   enabled_ = false;  // will not collect profile after writing.
-  return profile_stream_file_;
+  StopWriter();
+  CloseFile();
+  return current_file_;
 }
 
 //
@@ -2,8 +2,12 @@
 // Licensed under the MIT License.
 
 #pragma once
+#include <atomic>
+#include <condition_variable>
 #include <iostream>
 #include <fstream>
+#include <memory>
+#include <thread>
 #include <tuple>
 #include <initializer_list>
 #include "core/common/logging/logging.h"
@@ -12,19 +16,51 @@ namespace onnxruntime {
 
 namespace profiling {
 
+/*
+Options of the profiles written to a file.
+*/
+struct ProfilerOptions {
+  // record the events of one in every sampling_interval runs. events outside of a run, such as the loading of the
+  // model, are always recorded. 0 and 1 record every run.
+  uint32_t sampling_interval = 1;
+
+  // start a new file once the current one holds max_file_bytes, or was started max_file_seconds ago. every file is a
+  // complete trace. 0 disables the limit.
+  size_t max_file_bytes = 0;
+  uint32_t max_file_seconds = 0;
+
+  // number of events buffered per thread until they are written. events recorded while the buffer of the thread is
+  // full are dropped.
+  size_t thread_buffer_size = 16384;
+
+  // interval at which the buffered events are written to the file.
+  uint32_t flush_interval_ms = 100;
+};
+
 /*
 Main class for profiling. It continues to accumulate events and produce
 a corresponding "complete event (X)" in "chrome tracing" format.
+
+When profiling to a file, every thread records its events into a bounded buffer of its own and a background thread
+writes them to the file as the session runs, so the memory used does not grow with the length of the profile and
+the file can be read before the profiling ends.
 */
 class Profiler {
  public:
-  Profiler() noexcept {};  // turned off by default.
+  Profiler() noexcept;  // turned off by default.
+
+  ~Profiler();
 
   /*
   Initializes Profiler with the session logger to log framework specific messages
   */
   void Initialize(const logging::Logger* session_logger);
 
+  /*
+  Set the sampling and file options. They apply to the profiles started after the call.
+  */
+  void SetOptions(const ProfilerOptions& options);
+
   /*
   Send profiling data to custom logger
   */
@@ -35,6 +71,31 @@ class Profiler {
   */
   void StartProfiling(const std::string& file_name);
 
+  /*
+  Whether events are recorded. Callers can skip building the names and arguments of events when it is false.
+  */
+  bool IsEnabled() const { return (enabled_ || profile_with_logger_) && !IsRunSkipped(); }
+
+  /*
+  Called when a run starts. Returns whether the events of the run are to be recorded, which is one in every
+  ProfilerOptions::sampling_interval runs while the profiler is enabled.
+  */
+  bool SampleRun();
+
+  /*
+  Marks the events recorded by the calling thread until the end of the scope as part of a run, and whether that run
+  was sampled. Threads working on a run on behalf of another thread open a scope of their own.
+  */
+  class RunScope {
+   public:
+    explicit RunScope(bool is_sampled);
+    ~RunScope();
+
+   private:
+    ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(RunScope);
+    int previous_state_;
+  };
+
   /*
   Produce current time point for any profiling action.
   */
@@ -51,15 +112,45 @@ class Profiler {
                              bool sync_gpu = false);
 
   /*
-  Write profile data to the given stream in chrome format defined below.
+  Write the remaining profile data to the file in chrome format defined below and close it.
   https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU/preview#
+  Returns the name of the last file written.
   */
   std::string EndProfiling();
 
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(Profiler);
 
-  // Mutex controlling access to profiler data
+  // Events recorded by a single thread. The thread appends at tail and the writer thread consumes from head, so
+  // neither needs a lock. Both indexes only grow and are taken modulo the capacity.
+  // The recording thread holds a reference to its buffer until it exits or records into another profiler. The
+  // writer thread frees the buffers nobody else refers to once they have stayed empty for a while, so threads
+  // that come and go do not accumulate buffers.
+  struct ThreadBuffer {
+    ThreadBuffer(std::thread::id id, size_t capacity) : thread_id(id), events(capacity) {}
+
+    const std::thread::id thread_id;
+    std::vector<EventRecord> events;
+    std::atomic<size_t> head{0};
+    std::atomic<size_t> tail{0};
+
+    // number of consecutive flushes that found the buffer empty and released by its thread, only used by the
+    // writer thread
+    size_t idle_flushes{0};
+  };
+
+  static bool IsRunSkipped();
+  ThreadBuffer* GetThreadBuffer();
+  void WriterLoop();
+  void StopWriter();
+  void WriteBufferedEvents();
+  void ReleaseIdleBuffers();
+  void WriteEvent(const EventRecord& rec);
+  void OpenFile();
+  void CloseFile();
+  std::string GetFileName(size_t file_index) const;
+
+  // Mutex controlling access to the thread buffers
   std::mutex mutex_;
   bool enabled_{false};
   std::ofstream profile_stream_;
@@ -67,10 +158,28 @@ class Profiler {
   const logging::Logger* session_logger_{nullptr};
   const logging::Logger* custom_logger_{nullptr};
   TimePoint profiling_start_time_;
-  std::vector<EventRecord> events_;
-  bool max_events_reached{false};
-  static constexpr size_t max_num_events_ = 1000000;
   bool profile_with_logger_{false};
+
+  ProfilerOptions options_;
+  std::atomic<uint64_t> num_runs_{0};
+
+  // identifies the buffers of this profiler in the cache of the recording threads
+  const uint64_t id_;
+  std::vector<std::shared_ptr<ThreadBuffer>> thread_buffers_;
+  std::atomic<uint64_t> num_dropped_events_{0};
+
+  std::thread writer_;
+  std::mutex writer_mutex_;
+  std::condition_variable writer_wakeup_;
+  bool stop_writer_{false};
+  bool flush_requested_{false};
+
+  // state of the current file, only used by the writer thread while it runs
+  std::string current_file_;
+  size_t file_index_{0};
+  size_t file_bytes_{0};
+  size_t file_num_events_{0};
+  TimePoint file_start_time_;
 };
 
 }  // namespace profiling
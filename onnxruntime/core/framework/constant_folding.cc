@@ -0,0 +1,234 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/constant_folding.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "core/common/logging/logging.h"
+#include "core/common/profiler.h"
+#include "core/framework/execution_providers.h"
+#include "core/framework/insert_cast_transformer.h"
+#include "core/framework/kernel_registry.h"
+#include "core/framework/kernel_registry_manager.h"
+#include "core/framework/sequential_executor.h"
+#include "core/framework/session_state.h"
+#include "core/framework/session_state_initializer.h"
+#include "core/framework/tensorprotoutils.h"
+#include "core/graph/graph_transformer_mgr.h"
+#include "core/graph/graph_viewer.h"
+#include "core/graph/model.h"
+
+using namespace ONNX_NAMESPACE;
+using namespace ::onnxruntime::common;
+namespace onnxruntime {
+
+namespace {
+// operators whose output is not a function of their inputs
+bool IsNondeterministic(const Node& node) {
+  static const std::unordered_set<std::string> nondeterministic_ops{
+      "RandomUniform", "RandomNormal", "RandomUniformLike", "RandomNormalLike", "Multinomial"};
+  return nondeterministic_ops.count(node.OpType()) != 0;
+}
+
+bool HasSubgraph(const Node& node) {
+  for (const auto& attribute : node.GetAttributes()) {
+    if (attribute.second.type() == AttributeProto_AttributeType_GRAPH ||
+        attribute.second.type() == AttributeProto_AttributeType_GRAPHS) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
+bool ConstantFolding::IsFoldable(const Graph& graph, const Node& node) const {
+  if ((node.Domain() != kOnnxDomain && node.Domain() != kOnnxDomainAlias && node.Domain() != kMSDomain) ||
+      (!node.GetExecutionProviderType().empty() && node.GetExecutionProviderType() != kCpuExecutionProvider) ||
+      IsNondeterministic(node) || HasSubgraph(node) || !node.ImplicitInputDefs().empty() ||
+      graph.IsNodeOutputsInGraphOutputs(node)) {
+    return false;
+  }
+
+  // the outputs become initializers, which can only hold tensors
+  for (const auto* output_def : node.OutputDefs()) {
+    const TypeProto* type = output_def->TypeAsProto();
+    if (output_def->Exists() && (type == nullptr || !type->has_tensor_type())) {
+      return false;
+    }
+  }
+
+  for (const auto* registry : kernel_registry_manager_.GetAllKernelRegistries()) {
+    if (registry->TryFindKernel(node, kCpuExecutionProvider) != nullptr) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Status ConstantFolding::Evaluate(const Graph& graph, const std::vector<const Node*>& nodes,
+                                 const std::vector<std::string>& output_names,
+                                 std::vector<TensorProto>& outputs) const {
+  // copy the nodes and the initializers they read into a graph of their own
+  Model model("ConstantFolding", false, ModelMetaData(), IOnnxRuntimeOpSchemaRegistryList(),
+              graph.DomainToVersionMap());
+  Graph& constant_graph = model.MainGraph();
+  for (const Node* node : nodes) {
+    std::vector<NodeArg*> input_args;
+    for (const auto* input_def : node->InputDefs()) {
+      input_args.push_back(&constant_graph.GetOrCreateNodeArg(input_def->Name(), input_def->TypeAsProto()));
+      const TensorProto* initializer = nullptr;
+      if (input_def->Exists() && graph.GetInitializedTensor(input_def->Name(), initializer)) {
+        constant_graph.AddInitializedTensor(*initializer);
+      }
+    }
+
+    std::vector<NodeArg*> output_args;
+    for (const auto* output_def : node->OutputDefs()) {
+      output_args.push_back(&constant_graph.GetOrCreateNodeArg(output_def->Name(), output_def->TypeAsProto()));
+    }
+
+    Node& constant_node = constant_graph.AddNode(node->Name(), node->OpType(), node->Description(),
+                                                 input_args, output_args, &node->GetAttributes(), node->Domain());
+    constant_node.SetExecutionProviderType(kCpuExecutionProvider);
+  }
+
+  // a value that is also read by another of the nodes would not be a graph output, so each is copied to one
+  std::vector<std::string> fetch_names;
+  std::vector<const NodeArg*> fetch_args;
+  for (const auto& name : output_names) {
+    NodeArg* value = constant_graph.GetNodeArg(name);
+    NodeArg& fetch = constant_graph.GetOrCreateNodeArg(constant_graph.GenerateNodeArgName(name), value->TypeAsProto());
+    constant_graph.AddNode(constant_graph.GenerateNodeName(name), "Identity", "", {value}, {&fetch})
+        .SetExecutionProviderType(kCpuExecutionProvider);
+    fetch_names.push_back(fetch.Name());
+    fetch_args.push_back(&fetch);
+  }
+  constant_graph.SetOutputOrder(fetch_args);
+  ORT_RETURN_IF_ERROR(constant_graph.Resolve());
+
+  // the weights buffers and the profiler must outlive the session state that refers to them
+  std::map<OrtAllocatorInfo, BufferUniquePtr> weights_buffers;
+  profiling::Profiler profiler;
+  SessionState session_state{execution_providers_};
+  session_state.SetLogger(logger_);
+  session_state.SetProfiler(profiler);
+
+  // the nodes are already assigned to the CPU, so there is nothing to transform or partition
+  GraphTransformerManager transformers{0};
+  InsertCastTransformer insert_cast_transformer{"CastFloat16Transformer"};
+  insert_cast_transformer.AddKernelRegistries(kernel_registry_manager_.GetAllKernelRegistries());
+
+  SessionStateInitializer initializer{constant_graph, session_state, execution_providers_,
+                                      kernel_registry_manager_, logger_};
+  ORT_RETURN_IF_ERROR(initializer.CreatePlan(transformers, insert_cast_transformer, {}, true));
+  ORT_RETURN_IF_ERROR(initializer.InitializeAndSave(false, weights_buffers));
+
+  SequentialExecutor executor;
+  std::vector<MLValue> fetches;
+  ORT_RETURN_IF_ERROR(executor.Execute(session_state, NameMLValMap{}, fetch_names, fetches, logger_));
+
+  outputs.resize(fetches.size());
+  for (size_t i = 0; i < fetches.size(); ++i) {
+    ORT_RETURN_IF_ERROR(utils::TensorToTensorProto(fetches[i].Get<Tensor>(), output_names[i], outputs[i]));
+  }
+  return Status::OK();
+}
+
+Status ConstantFolding::Apply(Graph& graph, bool& modified) const {
+  GraphViewer graph_viewer(graph);
+  const auto& order = graph_viewer.GetNodesInTopologicalOrder();
+
+  // the values known before Run: the initializers, then the outputs of the nodes folded so far.
+  // initializers that are also graph inputs are only default values, a feed can override them.
+  // external data is left in its file so that it can be mapped instead of copied into a new initializer.
+  std::unordered_set<std::string> overridable_values;
+  for (const auto* input_def : graph.GetInputsIncludingInitializers()) {
+    overridable_values.insert(input_def->Name());
+  }
+
+  std::unordered_set<std::string> constant_values;
+  for (const auto& initializer : graph.GetAllInitializedTensors()) {
+    if (!utils::HasExternalData(*initializer.second) && overridable_values.count(initializer.first) == 0) {
+      constant_values.insert(initializer.first);
+    }
+  }
+
+  std::vector<const Node*> folded_nodes;
+  std::unordered_set<NodeIndex> folded_indexes;
+  for (auto index : order) {
+    const Node& node = *graph.GetNode(index);
+    if (!IsFoldable(graph, node)) {
+      continue;
+    }
+
+    bool constant_inputs = true;
+    for (const auto* input_def : node.InputDefs()) {
+      if (input_def->Exists() && constant_values.count(input_def->Name()) == 0) {
+        constant_inputs = false;
+        break;
+      }
+    }
+    if (!constant_inputs) {
+      continue;
+    }
+
+    folded_nodes.push_back(&node);
+    folded_indexes.insert(index);
+    for (const auto* output_def : node.OutputDefs()) {
+      if (output_def->Exists()) {
+        constant_values.insert(output_def->Name());
+      }
+    }
+  }
+
+  if (folded_nodes.empty()) {
+    return Status::OK();
+  }
+
+  // only the values read by the nodes that are kept become initializers
+  std::unordered_set<std::string> folded_outputs;
+  for (const Node* node : folded_nodes) {
+    for (const auto* output_def : node->OutputDefs()) {
+      folded_outputs.insert(output_def->Name());
+    }
+  }
+
+  std::vector<std::string> output_names;
+  auto add_output = [&folded_outputs, &output_names](const NodeArg* def) {
+    if (def->Exists() && folded_outputs.erase(def->Name()) != 0) {
+      output_names.push_back(def->Name());
+    }
+  };
+  for (const auto& node : graph.Nodes()) {
+    if (folded_indexes.count(node.Index()) == 0) {
+      std::for_each(node.InputDefs().cbegin(), node.InputDefs().cend(), add_output);
+      std::for_each(node.ImplicitInputDefs().cbegin(), node.ImplicitInputDefs().cend(), add_output);
+    }
+  }
+
+  std::vector<TensorProto> outputs;
+  if (!output_names.empty()) {
+    Status status = Evaluate(graph, folded_nodes, output_names, outputs);
+    if (!status.IsOK()) {
+      // the nodes are left to be computed by Run, which reports the error if there is one
+      LOGS(logger_, WARNING) << "Constant folding of " << folded_nodes.size()
+                             << " nodes failed: " << status.ErrorMessage();
+      return Status::OK();
+    }
+  }
+
+  for (const auto& output : outputs) {
+    graph.AddInitializedTensor(output);
+  }
+
+  for (auto index : folded_indexes) {
+    graph.RemoveNode(index);
+  }
+
+  modified = true;
+  ORT_RETURN_IF_ERROR(graph.Resolve());
+  return Status::OK();
+}
+}  // namespace onnxruntime
@@ -0,0 +1,52 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/graph/graph_transformer.h"
+#include "core/graph/onnx_protobuf.h"
+
+namespace onnxruntime {
+class ExecutionProviders;
+class KernelRegistryManager;
+
+namespace logging {
+class Logger;
+}
+
+/**
+@class ConstantFolding
+Evaluate the nodes whose inputs are all initializers with the CPU kernels of the session, and replace them with
+initializers holding their outputs, so that the values are computed once when the session is initialized instead
+of on every Run. Chains of such nodes, e.g. Transpose->Cast->Mul of a weight, are folded together.
+Nodes with a subgraph, nodes that produce random values or a graph output, and nodes without a CPU kernel are kept.
+*/
+class ConstantFolding : public GraphTransformer {
+ public:
+  // The execution providers and kernel registries are the ones of the session, which are only complete once it is
+  // initialized, so they are looked up when the transformer is applied.
+  ConstantFolding(const ExecutionProviders& execution_providers,
+                  KernelRegistryManager& kernel_registry_manager,
+                  const logging::Logger& logger) noexcept
+      : GraphTransformer("ConstantFolding", "Evaluate nodes that only depend on initializers"),
+        execution_providers_{execution_providers},
+        kernel_registry_manager_{kernel_registry_manager},
+        logger_{logger} {}
+
+  Status Apply(Graph& graph, bool& modified) const override;
+
+ private:
+  bool IsFoldable(const Graph& graph, const Node& node) const;
+
+  // Run nodes, in topological order, in a graph of their own on the CPU execution provider and return the values
+  // of output_names.
+  Status Evaluate(const Graph& graph, const std::vector<const Node*>& nodes,
+                  const std::vector<std::string>& output_names,
+                  std::vector<ONNX_NAMESPACE::TensorProto>& outputs) const;
+
+  const ExecutionProviders& execution_providers_;
+  KernelRegistryManager& kernel_registry_manager_;
+  const logging::Logger& logger_;
+};
+
+}  // namespace onnxruntime
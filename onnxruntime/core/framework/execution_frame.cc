@@ -3,6 +3,8 @@
 
 #include "core/framework/execution_frame.h"
 
+#include <algorithm>
+#include <numeric>
 #include <sstream>
 
 #include "core/framework/mem_pattern_planner.h"
@@ -18,45 +20,38 @@ ExecutionFrame::ExecutionFrame(const std::unordered_map<std::string, MLValue>& f
                                const std::vector<std::string>& output_names,
                                const std::vector<MLValue>& fetches,
                                const ::onnxruntime::SessionState& session_state)
+    : ExecutionFrame(session_state) {
+  auto& mlvalue_idx_map = session_state.GetMLValueNameIdxMap();
+
+  std::vector<int> feed_mlvalue_idxs;
+  std::vector<MLValue> feed_values;
+  feed_mlvalue_idxs.reserve(feeds.size());
+  feed_values.reserve(feeds.size());
+  for (const auto& feed : feeds) {
+    int mlvalue_idx;
+    Status status = mlvalue_idx_map.GetIdx(feed.first, mlvalue_idx);
+    ORT_ENFORCE(status.IsOK(), status.ErrorMessage());
+    feed_mlvalue_idxs.push_back(mlvalue_idx);
+    feed_values.push_back(feed.second);
+  }
+
+  std::vector<int> fetch_mlvalue_idxs;
+  fetch_mlvalue_idxs.reserve(output_names.size());
+  for (const auto& oname : output_names) {
+    int mlvalue_idx;
+    Status status = mlvalue_idx_map.GetIdx(oname, mlvalue_idx);
+    ORT_ENFORCE(status.IsOK(), status.ErrorMessage());
+    fetch_mlvalue_idxs.push_back(mlvalue_idx);
+  }
+
+  Reset(feed_mlvalue_idxs, feed_values, fetch_mlvalue_idxs, fetches);
+}
+
+ExecutionFrame::ExecutionFrame(const ::onnxruntime::SessionState& session_state)
     : session_state_(session_state), mem_patterns_(nullptr), planner_(nullptr) {
   auto* graph = session_state.GetGraphViewer();
   ORT_ENFORCE(graph);
-  Init(*graph, feeds, output_names, fetches);
-
-  // If the session enable memory pattern optimization
-  // and we have execution plan generated, try to setup
-  // memory pattern optimization.
-  if (session_state.GetEnableMemoryPattern() &&
-      session_state.GetExecutionPlan()) {
-    std::vector<TensorShape> input_shapes;
-    bool all_tensors = true;
-    for (const auto& feed : feeds) {
-      if (!(feed.second.IsTensor())) {
-        all_tensors = false;
-        break;
-      }
-      auto& tensor = feed.second.Get<Tensor>();
-      input_shapes.push_back(tensor.Shape());
-    }
-    // if there is some traditional ml value type in inputs
-    // disable the memory pattern optimization.
-    if (all_tensors) {
-      mem_patterns_ = session_state.GetMemoryPatternGroup(input_shapes);
-      // if no existing patterns, generate one in this executionframe
-      if (!mem_patterns_) {
-        planner_ = std::make_unique<MLValuePatternPlanner>(*session_state.GetExecutionPlan());
-      } else {
-        // pre-allocate the big chunk requested in memory pattern.
-        // all the internal kernel's input/output tensors will be allocated on these buffer.
-        for (size_t i = 0; i < mem_patterns_->locations.size(); i++) {
-          ORT_ENFORCE(buffers_.find(mem_patterns_->locations[i]) == buffers_.end());
-          AllocatorPtr alloc = GetAllocator(mem_patterns_->locations[i]);
-          void* buffer = mem_patterns_->patterns[i].PeakSize() > 0 ? alloc->Alloc(mem_patterns_->patterns[i].PeakSize()) : nullptr;
-          buffers_[mem_patterns_->locations[i]] = BufferUniquePtr(buffer, alloc);
-        }
-      }
-    }
-  }
+  Init(*graph);
 }
 
 ExecutionFrame::~ExecutionFrame() = default;
@@ -112,17 +107,25 @@ Status ExecutionFrame::AllocateMLValueTensorSelfOwnBufferHelper(int mlvalue_inde
       // if block not found, fall back to default behavior
       if (block) {
         auto it = buffers_.find(location);
+        // a block larger than needed is fine, e.g. when the pattern was generated for a bucket of input shapes.
         // if the block is not correct, log message then fall back to default behavior
-        if (it != buffers_.end() && block->size_ == size) {
+        if (it != buffers_.end() && block->size_ >= size) {
           void* buffer = it->second.get();
           auto status = AllocateTensorWithPreAllocateBufferHelper(
               p_mlvalue, static_cast<void*>(static_cast<char*>(buffer) + block->offset_),
               element_type, location, shape);
+          // if the pattern is being regenerated keep the block at least as large as it is now
+          TraceAllocate(mlvalue_index, block->size_);
           return status;
         }
-        if (block->size_ != size) {
-          LOGS_DEFAULT(WARNING) << "For mlvalue with index: " << mlvalue_index << ", block in memory pattern size is: "
-                                << block->size_ << " but the actually size is: " << size << ", fall back to default allocation behavior";
+        if (block->size_ < size) {
+          VLOGS_DEFAULT(1) << "For mlvalue with index: " << mlvalue_index << ", block in memory pattern size is: "
+                           << block->size_ << " but the actually size is: " << size << ", fall back to default allocation behavior";
+          // have the next execution with these input shapes regenerate the pattern with the larger size
+          if (!planner_ && !mem_pattern_misfit_) {
+            mem_pattern_misfit_ = true;
+            session_state_.MarkMemoryPatternGroupForGrowth(input_shapes_);
+          }
         } else if (it == buffers_.end()) {
           LOGS_DEFAULT(WARNING) << "For mlvalue with index: " << mlvalue_index << ", block not found in target loation. "
                                                                                   " fall back to default allocation behavior";
@@ -308,11 +311,8 @@ Status ExecutionFrame::AllocateAsPerAllocationPlan(int mlvalue_index,
   return Status::OK();
 }
 
-void ExecutionFrame::Init(const onnxruntime::GraphViewer& graph,
-                          const std::unordered_map<std::string, MLValue>& feeds,
-                          const std::vector<std::string>& output_names,
-                          const std::vector<MLValue>& fetches) {
-  // 1. resize the node_offsets and all_value_ vector
+void ExecutionFrame::Init(const onnxruntime::GraphViewer& graph) {
+  // resize the node_offsets and all_value_ vector
   // We need to use the max index rather than number of nodes as we use Node.Index()
   // when inserting into node_offsets_
   auto max_node_index = graph.MaxNodeIndex();
@@ -322,63 +322,125 @@ void ExecutionFrame::Init(const onnxruntime::GraphViewer& graph,
 
   all_values_.resize(mlvalue_idx_map.MaxIdx() + 1);
 
-  // 2. handle the weights.
+  // set node args
+  for (auto& node : graph.Nodes()) {
+    ORT_ENFORCE(node.Index() < node_offsets_.size());
+    node_offsets_[node.Index()] = static_cast<int>(node_values_.size());
+
+    for (auto input_def : node.InputDefs()) {
+      SetupNodeArg(input_def);
+    }
+
+    for (auto input_def : node.ImplicitInputDefs()) {
+      SetupNodeArg(input_def);
+    }
+
+    for (auto output_def : node.OutputDefs()) {
+      SetupNodeArg(output_def);
+    }
+  }
+}
+
+void ExecutionFrame::Reset(const std::vector<int>& feed_mlvalue_idxs,
+                           const std::vector<MLValue>& feeds,
+                           const std::vector<int>& fetch_mlvalue_idxs,
+                           const std::vector<MLValue>& fetches) {
+  ORT_ENFORCE(feed_mlvalue_idxs.size() == feeds.size());
+
+  // 1. handle the weights.
   for (const auto& entry : session_state_.GetInitializedTensors()) {
     auto mlvalue_index = entry.first;
     all_values_[mlvalue_index] = entry.second;  // this copy should be cheap
   }
 
-  // 3. handle feed in values
-  for (const auto& feed : feeds) {
-    int mlvalue_idx;
-    Status status = mlvalue_idx_map.GetIdx(feed.first, mlvalue_idx);
-    ORT_ENFORCE(status.IsOK(), status.ErrorMessage());
+  // 2. handle feed in values
+  for (size_t i = 0; i < feeds.size(); ++i) {
     // we are sharing the underline tensor/object for MLValue
-    all_values_[mlvalue_idx] = feed.second;
+    all_values_[feed_mlvalue_idxs[i]] = feeds[i];
   }
 
-  // 4. Handle non-empty output vector
+  // 3. Handle non-empty output vector
   // setup output_indices_, we dont' want to generate mem plan on output tensors.
-  for (const auto& oname : output_names) {
-    int mlvalue_idx;
-    Status status = mlvalue_idx_map.GetIdx(oname, mlvalue_idx);
-    ORT_ENFORCE(status.IsOK(), status.ErrorMessage());
-    output_indices_.push_back(mlvalue_idx);
-  }
+  output_indices_.assign(fetch_mlvalue_idxs.cbegin(), fetch_mlvalue_idxs.cend());
 
   if (!fetches.empty()) {
     // should've already verified this much before when Run() starts
-    ORT_ENFORCE(output_names.size() == fetches.size(),
-                        "output_names vector size: " + std::to_string(output_names.size()) +
-                            " does not match that of fetches vector: " + std::to_string(fetches.size()));
-
-    auto idx = 0;
-    for (const auto& oname : output_names) {
-      int mlvalue_idx;
-      Status status = mlvalue_idx_map.GetIdx(oname, mlvalue_idx);
-      ORT_ENFORCE(status.IsOK(), status.ErrorMessage());
-      all_values_[mlvalue_idx] = fetches.at(idx++);
-      output_indices_.push_back(mlvalue_idx);
+    ORT_ENFORCE(fetch_mlvalue_idxs.size() == fetches.size(),
+                "output_names vector size: " + std::to_string(fetch_mlvalue_idxs.size()) +
+                    " does not match that of fetches vector: " + std::to_string(fetches.size()));
+
+    for (size_t i = 0; i < fetches.size(); ++i) {
+      all_values_[fetch_mlvalue_idxs[i]] = fetches[i];
     }
   }
 
-  // 5. set node args
-  for (auto& node : graph.Nodes()) {
-    ORT_ENFORCE(node.Index() < node_offsets_.size());
-    node_offsets_[node.Index()] = static_cast<int>(node_values_.size());
+  // 4. If the session enable memory pattern optimization
+  // and we have execution plan generated, try to setup
+  // memory pattern optimization.
+  if (session_state_.GetEnableMemoryPattern() &&
+      session_state_.GetExecutionPlan()) {
+    // order the shapes by MLValue index so that the patterns don't depend on the order the feeds were given in.
+    // the shapes of the previous execution are assigned over so that their storage is reused.
+    feed_order_.resize(feeds.size());
+    std::iota(feed_order_.begin(), feed_order_.end(), size_t{0});
+    std::sort(feed_order_.begin(), feed_order_.end(), [&feed_mlvalue_idxs](size_t lhs, size_t rhs) {
+      return feed_mlvalue_idxs[lhs] < feed_mlvalue_idxs[rhs];
+    });
 
-    for (auto input_def : node.InputDefs()) {
-      SetupNodeArg(input_def);
+    bool all_tensors = true;
+    input_shapes_.resize(feeds.size());
+    for (size_t n = 0; n < feed_order_.size(); ++n) {
+      const auto& feed = feeds[feed_order_[n]];
+      if (!(feed.IsTensor())) {
+        all_tensors = false;
+        input_shapes_.resize(n);
+        break;
+      }
+      input_shapes_[n] = feed.Get<Tensor>().Shape();
     }
+    // if there is some traditional ml value type in inputs
+    // disable the memory pattern optimization.
+    if (all_tensors) {
+      bool needs_growth = false;
+      mem_patterns_ = session_state_.GetMemoryPatternGroup(input_shapes_, &needs_growth);
+      // if no existing patterns, or a previous execution didn't fit in them, generate one in this executionframe
+      if (!mem_patterns_ || needs_growth) {
+        planner_ = std::make_unique<MLValuePatternPlanner>(*session_state_.GetExecutionPlan(),
+                                                           MemPatternPlanner::Strategy::kLifetime);
+      }
 
-    for (auto input_def : node.ImplicitInputDefs()) {
-      SetupNodeArg(input_def);
+      if (mem_patterns_) {
+        // pre-allocate the big chunk requested in memory pattern.
+        // all the internal kernel's input/output tensors will be allocated on these buffer.
+        // the entries of buffers_ are kept by Clear, so only the first execution with a location inserts one.
+        for (size_t i = 0; i < mem_patterns_->locations.size(); i++) {
+          BufferUniquePtr& location_buffer = buffers_[mem_patterns_->locations[i]];
+          ORT_ENFORCE(location_buffer == nullptr);
+          AllocatorPtr alloc = GetAllocator(mem_patterns_->locations[i]);
+          void* buffer = mem_patterns_->patterns[i].PeakSize() > 0 ? alloc->Alloc(mem_patterns_->patterns[i].PeakSize()) : nullptr;
+          location_buffer = BufferUniquePtr(buffer, alloc);
+        }
+      }
     }
+  }
+}
 
-    for (auto output_def : node.OutputDefs()) {
-      SetupNodeArg(output_def);
-    }
+void ExecutionFrame::Clear() {
+  // release the values before the buffers they may point into.
+  // assigning an empty MLValue keeps the capacity of all_values_ for the next execution.
+  for (auto& value : all_values_) {
+    value = MLValue();
+  }
+
+  // free the buffers but keep their entries, and keep input_shapes_, so that the next Reset doesn't allocate them
+  for (auto& buffer : buffers_) {
+    buffer.second.reset();
   }
+  planner_.reset();
+  mem_patterns_ = nullptr;
+  mem_pattern_misfit_ = false;
+  output_indices_.clear();
+  status_ = Status::OK();
 }
 
 void ExecutionFrame::SetupNodeArg(const onnxruntime::NodeArg* arg) {
@@ -428,7 +490,14 @@ Status ExecutionFrame::GeneratePatterns(MemoryPatternGroup* out) const {
     return Status(ONNXRUNTIME, FAIL, "Memory pattern planner is not enabled on this execution framework.");
   }
 
-  return planner_->GeneratePatterns(out);
+  ORT_RETURN_IF_ERROR(planner_->GeneratePatterns(out));
+  for (size_t i = 0; i < out->locations.size(); i++) {
+    VLOGS(session_state_.Logger(), 1) << "Memory pattern for " << out->locations[i].ToString()
+                                      << ": peak size " << out->patterns[i].PeakSize()
+                                      << ", lower bound " << out->patterns[i].LowerBoundSize();
+  }
+
+  return Status::OK();
 }
 
 // Return nullptr if index map to an value that is an unused optional input/output
@@ -31,8 +31,23 @@ class ExecutionFrame {
                  const std::vector<MLValue>& fetches,
                  const SessionState& session_state);
 
+  // Create a frame with the per-node value tables for session_state but no values.
+  // Reset must be called before the frame is used to execute the graph.
+  explicit ExecutionFrame(const SessionState& session_state);
+
   ~ExecutionFrame();
 
+  // Prepare the frame for an execution with the given feeds and fetches, identified by their MLValue index.
+  // fetches may be empty if no output is pre-allocated. The value tables built by the constructor are kept,
+  // so a frame can be reused by consecutive executions of the same session.
+  void Reset(const std::vector<int>& feed_mlvalue_idxs,
+             const std::vector<MLValue>& feeds,
+             const std::vector<int>& fetch_mlvalue_idxs,
+             const std::vector<MLValue>& fetches);
+
+  // Release all the values and memory pattern buffers held by the frame once an execution has completed.
+  void Clear();
+
   Status AllocateMLValueTensorSelfOwnBuffer(int mlvalue_index,
                                             MLDataType element_type,
                                             const OrtAllocatorInfo& location,
@@ -110,6 +125,11 @@ class ExecutionFrame {
     return planner_ != nullptr;
   }
 
+  // Shapes of the feeds used as the key of the memory pattern cache. Only valid if HasPlan() is true.
+  const std::vector<TensorShape>& GetInputShapes() const {
+    return input_shapes_;
+  }
+
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ExecutionFrame);
 
@@ -125,10 +145,7 @@ class ExecutionFrame {
                                                   const TensorShape& shape,
                                                   bool create_fence);
 
-  void Init(const onnxruntime::GraphViewer& graph,
-            const std::unordered_map<std::string, MLValue>& feeds,
-            const std::vector<std::string>& output_names,
-            const std::vector<MLValue>& fetches);
+  void Init(const onnxruntime::GraphViewer& graph);
 
   void SetupNodeArg(const onnxruntime::NodeArg* arg);
 
@@ -167,9 +184,12 @@ class ExecutionFrame {
   // If we already have cached memory pattern on these input shapes
   // Use this mem pattern that create a big chunk for all the internal
   // kernel's input/output tensors.
-  const MemoryPatternGroup* mem_patterns_;
+  std::shared_ptr<const MemoryPatternGroup> mem_patterns_;
+
+  // set when a tensor didn't fit in its block of mem_patterns_
+  bool mem_pattern_misfit_ = false;
 
-  // If no cached memory pattern, and we enable the memory pattern optimization
+  // If no cached memory pattern, or it needs to grow, and we enable the memory pattern optimization
   // use this planner_ to trace the memory allocation in current executor.
   std::unique_ptr<MLValuePatternPlanner> planner_;
 
@@ -179,5 +199,10 @@ class ExecutionFrame {
 
   // Big chunks on different locations that will be used by mem_pattern.
   std::map<OrtAllocatorInfo, BufferUniquePtr> buffers_;
+
+  // Shapes of the feeds of the current execution, in the order of their MLValue indices.
+  std::vector<TensorShape> input_shapes_;
+  // positions in the feeds passed to Reset, sorted by MLValue index.
+  std::vector<size_t> feed_order_;
 };
 }  // namespace onnxruntime
@@ -0,0 +1,22 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/feeds_fetches_info.h"
+
+namespace onnxruntime {
+
+Status FeedsFetchesInfo::SetMLValueIdxs(const MLValueNameIdxMap& mlvalue_name_idx_map) {
+  feeds_mlvalue_idxs.resize(feed_names.size());
+  for (size_t i = 0; i < feed_names.size(); ++i) {
+    ORT_RETURN_IF_ERROR(mlvalue_name_idx_map.GetIdx(feed_names[i], feeds_mlvalue_idxs[i]));
+  }
+
+  fetches_mlvalue_idxs.resize(output_names.size());
+  for (size_t i = 0; i < output_names.size(); ++i) {
+    ORT_RETURN_IF_ERROR(mlvalue_name_idx_map.GetIdx(output_names[i], fetches_mlvalue_idxs[i]));
+  }
+
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,43 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/status.h"
+#include "core/framework/data_types.h"
+#include "core/framework/mlvalue_name_idx_map.h"
+
+namespace onnxruntime {
+
+class SessionState;
+
+// The feed and output names of a Run call resolved to the MLValue indices of a session.
+// Created once by InferenceSession::PrepareRun so that repeated Run calls with the same inputs and outputs
+// pass the values by position and skip the per-call name lookups.
+struct FeedsFetchesInfo {
+  FeedsFetchesInfo() = default;
+  FeedsFetchesInfo(const std::vector<std::string>& feed_names_in,
+                   const std::vector<std::string>& output_names_in)
+      : feed_names{feed_names_in}, output_names{output_names_in} {}
+
+  // Resolve feed_names and output_names to indices in mlvalue_name_idx_map.
+  Status SetMLValueIdxs(const MLValueNameIdxMap& mlvalue_name_idx_map);
+
+  std::vector<std::string> feed_names;
+  std::vector<std::string> output_names;
+
+  std::vector<int> feeds_mlvalue_idxs;
+  std::vector<int> fetches_mlvalue_idxs;
+
+  // expected type of each feed. tensor types are checked by element type.
+  std::vector<MLDataType> feed_types;
+
+  // the session state the indices belong to. set by InferenceSession::PrepareRun.
+  const SessionState* session_state = nullptr;
+};
+
+}  // namespace onnxruntime
@@ -12,6 +12,7 @@
 
 namespace onnxruntime {
 
+class ExecutionFrame;
 class SessionState;
 namespace logging {
 class Logger;
@@ -26,5 +27,17 @@ class IExecutor {
                                  const std::vector<std::string>& output_names,
                                  std::vector<MLValue>& fetches,
                                  const logging::Logger& logger) = 0;
+
+  // Execute using a frame owned by the caller, so that it can be reused across executions.
+  // The frame must have been created for session_state and Reset with the feeds and fetches of this execution.
+  // fetch_mlvalue_idxs are the MLValue indices of the requested outputs.
+  // terminate_flag is used instead of the one given to the constructor, so that one executor can serve executions
+  // with different RunOptions.
+  virtual common::Status Execute(const SessionState& session_state,
+                                 ExecutionFrame& frame,
+                                 const std::vector<int>& fetch_mlvalue_idxs,
+                                 std::vector<MLValue>& fetches,
+                                 const bool& terminate_flag,
+                                 const logging::Logger& logger) = 0;
 };
 }  // namespace onnxruntime
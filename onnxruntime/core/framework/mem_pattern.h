@@ -22,11 +22,13 @@ class MemoryPattern {
 
   MemoryPattern(MemoryPattern&& rhs)
       : patterns_{std::move(rhs.patterns_)},
-        peak_size_{std::move(rhs.peak_size_)} {}
+        peak_size_{std::move(rhs.peak_size_)},
+        lower_bound_size_{std::move(rhs.lower_bound_size_)} {}
 
   MemoryPattern& operator=(MemoryPattern&& rhs) {
     patterns_ = std::move(rhs.patterns_);
     peak_size_ = std::move(rhs.peak_size_);
+    lower_bound_size_ = std::move(rhs.lower_bound_size_);
     return *this;
   }
 
@@ -34,6 +36,15 @@ class MemoryPattern {
     return peak_size_;
   }
 
+  // the largest total size of the blocks alive at the same time. no pattern can have a smaller peak size.
+  size_t LowerBoundSize() const {
+    return lower_bound_size_;
+  }
+
+  size_t NumBlocks() const {
+    return patterns_.size();
+  }
+
   const MemoryBlock* GetBlock(int ml_value_idx) const {
     auto it = patterns_.find(ml_value_idx);
     if (it == patterns_.end())
@@ -48,6 +59,7 @@ class MemoryPattern {
 
   std::unordered_map<int, MemoryBlock> patterns_;
   size_t peak_size_{0};
+  size_t lower_bound_size_{0};
 };
 
 struct MemoryPatternGroup {
@@ -0,0 +1,187 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/mem_pattern_cache.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace onnxruntime {
+
+// approximate memory held by a cache entry: its bookkeeping and the buffers its patterns allocate
+static size_t EntrySize(const std::vector<std::vector<int64_t>>& dims, const MemoryPatternGroup& mem_patterns) {
+  size_t size = sizeof(MemoryPatternGroup);
+  for (const auto& input_dims : dims) {
+    size += sizeof(input_dims) + input_dims.size() * sizeof(int64_t);
+  }
+
+  for (const auto& pattern : mem_patterns.patterns) {
+    // one hash node per block
+    size += pattern.PeakSize() + sizeof(OrtAllocatorInfo) + sizeof(MemoryPattern) +
+            pattern.NumBlocks() * (sizeof(std::pair<const int, MemoryBlock>) + 2 * sizeof(void*));
+  }
+
+  return size;
+}
+
+MemoryPatternCache::MemoryPatternCache(const MemoryPatternCacheOptions& options)
+    : options_{options}, entries_{std::make_shared<const EntryMap>()} {
+  ORT_ENFORCE(std::is_sorted(options_.dim_buckets.cbegin(), options_.dim_buckets.cend()),
+              "Memory pattern dimension buckets must be in ascending order.");
+}
+
+void MemoryPatternCache::SetOptions(const MemoryPatternCacheOptions& options) {
+  ORT_ENFORCE(std::is_sorted(options.dim_buckets.cbegin(), options.dim_buckets.cend()),
+              "Memory pattern dimension buckets must be in ascending order.");
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  options_ = options;
+  std::atomic_store(&entries_, std::make_shared<const EntryMap>());
+  num_bytes_ = 0;
+}
+
+int64_t MemoryPatternCache::BucketDim(int64_t dim) const {
+  auto bucket = std::lower_bound(options_.dim_buckets.cbegin(), options_.dim_buckets.cend(), dim);
+  return bucket == options_.dim_buckets.cend() ? dim : *bucket;
+}
+
+size_t MemoryPatternCache::Hash(const std::vector<TensorShape>& input_shapes) const {
+  size_t hash = input_shapes.size();
+  for (const auto& shape : input_shapes) {
+    const auto& dims = shape.GetDims();
+    // include the rank so that inputs of different ranks can't produce the same sequence of dimensions
+    hash = hash * 31 + dims.size();
+    for (auto dim : dims) {
+      hash = hash * 31 + std::hash<int64_t>()(BucketDim(dim));
+    }
+  }
+
+  return hash;
+}
+
+bool MemoryPatternCache::Matches(const Entry& entry, const std::vector<TensorShape>& input_shapes) const {
+  if (entry.dims.size() != input_shapes.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < input_shapes.size(); ++i) {
+    const auto& dims = input_shapes[i].GetDims();
+    const auto& entry_dims = entry.dims[i];
+    if (dims.size() != entry_dims.size()) {
+      return false;
+    }
+
+    for (size_t j = 0; j < dims.size(); ++j) {
+      if (BucketDim(dims[j]) != entry_dims[j]) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+const MemoryPatternCache::Entry* MemoryPatternCache::FindEntry(const EntryMap& entries, size_t hash,
+                                                               const std::vector<TensorShape>& input_shapes) const {
+  auto range = entries.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (Matches(*it->second, input_shapes)) {
+      return it->second.get();
+    }
+  }
+
+  return nullptr;
+}
+
+std::shared_ptr<const MemoryPatternGroup> MemoryPatternCache::Find(const std::vector<TensorShape>& input_shapes,
+                                                                   bool* needs_growth) const {
+  auto entries = std::atomic_load(&entries_);
+  const Entry* entry = FindEntry(*entries, Hash(input_shapes), input_shapes);
+  if (!entry) {
+    ++misses_;
+    return nullptr;
+  }
+
+  ++hits_;
+  entry->last_used.store(++clock_, std::memory_order_relaxed);
+  if (needs_growth) {
+    *needs_growth = entry->needs_growth.load(std::memory_order_relaxed);
+  }
+
+  return entry->mem_patterns;
+}
+
+void MemoryPatternCache::Insert(const std::vector<TensorShape>& input_shapes,
+                                std::unique_ptr<MemoryPatternGroup> mem_patterns) {
+  auto entry = std::make_shared<Entry>();
+  entry->dims.reserve(input_shapes.size());
+  for (const auto& shape : input_shapes) {
+    std::vector<int64_t> dims = shape.GetDims();
+    std::transform(dims.begin(), dims.end(), dims.begin(), [this](int64_t dim) { return BucketDim(dim); });
+    entry->dims.push_back(std::move(dims));
+  }
+
+  entry->num_bytes = EntrySize(entry->dims, *mem_patterns);
+  entry->mem_patterns = std::move(mem_patterns);
+  entry->last_used = ++clock_;
+
+  const size_t hash = Hash(input_shapes);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto entries = std::make_shared<EntryMap>(*std::atomic_load(&entries_));
+
+  // replace the existing pattern. it is either the same or was marked for growth and is smaller.
+  auto range = entries->equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (Matches(*it->second, input_shapes)) {
+      num_bytes_ -= it->second->num_bytes;
+      entries->erase(it);
+      break;
+    }
+  }
+
+  // evict the least recently used patterns until the new one fits in the budget. a pattern larger than the whole
+  // byte budget is still cached, on its own.
+  auto over_budget = [this, &entries, &entry]() {
+    return (options_.max_entries != 0 && entries->size() + 1 > options_.max_entries) ||
+           (options_.max_bytes != 0 && num_bytes_ + entry->num_bytes > options_.max_bytes);
+  };
+
+  while (!entries->empty() && over_budget()) {
+    auto lru = std::min_element(entries->begin(), entries->end(),
+                                [](const EntryMap::value_type& lhs, const EntryMap::value_type& rhs) {
+                                  return lhs.second->last_used.load(std::memory_order_relaxed) <
+                                         rhs.second->last_used.load(std::memory_order_relaxed);
+                                });
+    num_bytes_ -= lru->second->num_bytes;
+    entries->erase(lru);
+    ++evictions_;
+  }
+
+  num_bytes_ += entry->num_bytes;
+  entries->emplace(hash, std::move(entry));
+
+  std::atomic_store(&entries_, std::shared_ptr<const EntryMap>(std::move(entries)));
+}
+
+void MemoryPatternCache::MarkForGrowth(const std::vector<TensorShape>& input_shapes) const {
+  auto entries = std::atomic_load(&entries_);
+  const Entry* entry = FindEntry(*entries, Hash(input_shapes), input_shapes);
+  if (entry) {
+    entry->needs_growth.store(true, std::memory_order_relaxed);
+  }
+}
+
+MemoryPatternCacheStats MemoryPatternCache::GetStats() const {
+  MemoryPatternCacheStats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.evictions = evictions_;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats.num_entries = std::atomic_load(&entries_)->size();
+  stats.num_bytes = num_bytes_;
+  return stats;
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,105 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/framework/mem_pattern.h"
+#include "core/framework/tensor_shape.h"
+
+namespace onnxruntime {
+
+struct MemoryPatternCacheOptions {
+  // maximum number of cached patterns. 0 means no limit.
+  size_t max_entries = 64;
+
+  // maximum approximate memory used by the cached patterns, counting the peak size of every pattern as well as its
+  // bookkeeping. 0 means no limit.
+  size_t max_bytes = 0;
+
+  // ascending dimension boundaries. if not empty, every input dimension is rounded up to the next boundary to
+  // build the cache key so that runs with close shapes share a pattern. dimensions larger than the last boundary
+  // are used as is.
+  std::vector<int64_t> dim_buckets;
+};
+
+struct MemoryPatternCacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+  size_t num_entries = 0;
+  size_t num_bytes = 0;
+};
+
+// Cache of the memory patterns generated for the input shapes seen by a session, bounded by an entry count and a
+// byte budget with least recently used eviction.
+//
+// Find reads an immutable snapshot of the entries so Run calls never block each other. Insert and eviction copy
+// the snapshot under a lock; they only happen when a run had no usable pattern.
+//
+// A pattern can be used by a run whose tensors don't all fit in it, either because its shapes were bucketed or
+// because some output shapes depend on the input data. Such a run marks the entry, and the next run using it
+// regenerates the pattern with the larger of the old and the new sizes, so a bucket converges on a pattern that
+// fits all the shapes seen for it.
+class MemoryPatternCache {
+ public:
+  explicit MemoryPatternCache(const MemoryPatternCacheOptions& options = {});
+
+  // Replace the options and drop all cached patterns. Must not be called concurrently with the other methods.
+  void SetOptions(const MemoryPatternCacheOptions& options);
+  const MemoryPatternCacheOptions& GetOptions() const noexcept { return options_; }
+
+  // Get the pattern for the given input shapes or nullptr. Lock free.
+  // needs_growth is set if a run using the pattern didn't fit in it.
+  std::shared_ptr<const MemoryPatternGroup> Find(const std::vector<TensorShape>& input_shapes,
+                                                 bool* needs_growth = nullptr) const;
+
+  // Add or replace the pattern for the given input shapes, evicting the least recently used patterns if the cache
+  // is over budget.
+  void Insert(const std::vector<TensorShape>& input_shapes, std::unique_ptr<MemoryPatternGroup> mem_patterns);
+
+  // Request the pattern for the given input shapes to be regenerated by the next run using it.
+  void MarkForGrowth(const std::vector<TensorShape>& input_shapes) const;
+
+  MemoryPatternCacheStats GetStats() const;
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(MemoryPatternCache);
+
+  struct Entry {
+    // bucketed dimensions of each input
+    std::vector<std::vector<int64_t>> dims;
+    std::shared_ptr<const MemoryPatternGroup> mem_patterns;
+    size_t num_bytes = 0;
+    mutable std::atomic<uint64_t> last_used{0};
+    mutable std::atomic<bool> needs_growth{false};
+  };
+
+  // keyed by the hash of the bucketed input shapes
+  using EntryMap = std::unordered_multimap<size_t, std::shared_ptr<const Entry>>;
+
+  int64_t BucketDim(int64_t dim) const;
+  size_t Hash(const std::vector<TensorShape>& input_shapes) const;
+  bool Matches(const Entry& entry, const std::vector<TensorShape>& input_shapes) const;
+  const Entry* FindEntry(const EntryMap& entries, size_t hash, const std::vector<TensorShape>& input_shapes) const;
+
+  MemoryPatternCacheOptions options_;
+
+  // current snapshot. read and replaced with std::atomic_load/std::atomic_store.
+  std::shared_ptr<const EntryMap> entries_;
+  size_t num_bytes_ = 0;  // GUARDED_BY(mutex_)
+  mutable std::mutex mutex_;
+
+  mutable std::atomic<uint64_t> clock_{0};
+  mutable std::atomic<uint64_t> hits_{0};
+  mutable std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> evictions_{0};
+};
+
+}  // namespace onnxruntime
@@ -18,17 +18,41 @@ limitations under the License.
 #pragma once
 #include "core/framework/mem_pattern.h"
 #include "core/framework/allocation_planner.h"
+#include <algorithm>
+#include <limits>
 #include <list>
+#include <vector>
 
 namespace onnxruntime {
 // MemPatternPlanner is used to trace allocation/free steps
 // in a single iteration, record the pattern and cached for
 // future request if they have the same input shape.
+//
+// With kGreedy the offset of a block is decided when it is allocated, by a best-fit over the blocks alive at that
+// point. With kLifetime the allocation and free steps are only recorded, and the offsets are computed in
+// GenerateMemPattern from the whole lifetime of every block: the largest blocks are placed first, each at the
+// best-fitting gap among the already placed blocks whose lifetimes overlap with it.
 class MemPatternPlanner {
  public:
-  MemPatternPlanner() = default;
+  enum class Strategy {
+    kGreedy,
+    kLifetime,
+  };
+
+  explicit MemPatternPlanner(Strategy strategy = Strategy::kGreedy) : strategy_(strategy) {}
 
   void TraceAllocation(int ml_value_idx, size_t size) {
+    if (strategy_ == Strategy::kLifetime) {
+      if (size != 0) {
+        live_size_ += size;
+        lower_bound_size_ = std::max(lower_bound_size_, live_size_);
+      }
+
+      allocs_.emplace_back(ml_value_idx, MemoryBlock(0, size));
+      allocs_.back().alloc_step_ = clock_++;
+      return;
+    }
+
     if (size == 0) {
       allocs_.emplace_back(ml_value_idx, MemoryBlock(0, 0));
       return;
@@ -57,12 +81,29 @@ class MemPatternPlanner {
 
     allocs_.emplace_back(ml_value_idx, MemoryBlock(best_offset, size));
     buffer_size = std::max(buffer_size, best_offset + size);
+    live_size_ += size;
+    lower_bound_size_ = std::max(lower_bound_size_, live_size_);
     blocks_.insert(best_fit_it, (static_cast<int>(allocs_.size()) - 1));
   }
 
   void TraceFree(int ml_value_index) {
+    if (strategy_ == Strategy::kLifetime) {
+      // the most recent allocation of the value is the one being freed
+      for (auto it = allocs_.rbegin(); it != allocs_.rend(); it++) {
+        auto& alloc = *it;
+        if (alloc.index_ == ml_value_index && alloc.free_step_ == kNotFreed) {
+          alloc.free_step_ = clock_++;
+          live_size_ -= alloc.block_.size_;
+          break;
+        }
+      }
+
+      return;
+    }
+
     for (auto it = blocks_.begin(); it != blocks_.end(); it++) {
       if (allocs_[*it].index_ == ml_value_index) {
+        live_size_ -= allocs_[*it].block_.size_;
         blocks_.erase(it);
         break;
       }
@@ -70,8 +111,13 @@ class MemPatternPlanner {
   }
 
   MemoryPattern GenerateMemPattern() {
+    if (strategy_ == Strategy::kLifetime) {
+      AssignOffsetsByLifetime();
+    }
+
     MemoryPattern pattern;
     pattern.peak_size_ = buffer_size;
+    pattern.lower_bound_size_ = lower_bound_size_;
     for (auto& alloc : allocs_) {
       pattern.patterns_[alloc.index_] = alloc.block_;
     }
@@ -80,18 +126,92 @@ class MemPatternPlanner {
   }
 
  protected:
+  static constexpr size_t kNotFreed = std::numeric_limits<size_t>::max();
+
   struct MLValueAllocationBlock {
     int index_{-1};
     MemoryBlock block_;
+    // steps of the allocation and of the free. only recorded with Strategy::kLifetime.
+    size_t alloc_step_{0};
+    size_t free_step_{kNotFreed};
 
     MLValueAllocationBlock() = default;
     MLValueAllocationBlock(int index, MemoryBlock block) : index_(index), block_(block) {}
   };
 
+  void AssignOffsetsByLifetime() {
+    std::vector<int> order;
+    order.reserve(allocs_.size());
+    for (int i = 0; i < static_cast<int>(allocs_.size()); i++) {
+      if (allocs_[i].block_.size_ != 0) {
+        order.push_back(i);
+      }
+    }
+
+    // largest first, ties broken by allocation order so that the result is deterministic
+    std::sort(order.begin(), order.end(), [this](int lhs, int rhs) {
+      if (allocs_[lhs].block_.size_ != allocs_[rhs].block_.size_) {
+        return allocs_[lhs].block_.size_ > allocs_[rhs].block_.size_;
+      }
+      return allocs_[lhs].alloc_step_ < allocs_[rhs].alloc_step_;
+    });
+
+    buffer_size = 0;
+    std::vector<int> placed;
+    std::vector<const MemoryBlock*> overlapping;
+    placed.reserve(order.size());
+    for (int idx : order) {
+      auto& alloc = allocs_[idx];
+      const size_t size = alloc.block_.size_;
+
+      overlapping.clear();
+      for (int other_idx : placed) {
+        const auto& other = allocs_[other_idx];
+        if (other.alloc_step_ < alloc.free_step_ && alloc.alloc_step_ < other.free_step_) {
+          overlapping.push_back(&other.block_);
+        }
+      }
+
+      std::sort(overlapping.begin(), overlapping.end(), [](const MemoryBlock* lhs, const MemoryBlock* rhs) {
+        return lhs->offset_ < rhs->offset_;
+      });
+
+      size_t current = 0;
+      size_t waste_bytes = std::numeric_limits<size_t>::max();
+      size_t best_offset = kNotFreed;
+      for (const MemoryBlock* block : overlapping) {
+        if (block->offset_ > current) {
+          auto gap = block->offset_ - current;
+          if (gap >= size && (gap - size) < waste_bytes) {
+            waste_bytes = gap - size;
+            best_offset = current;
+          }
+        }
+        current = std::max(current, block->offset_ + block->size_);
+      }
+
+      if (best_offset == kNotFreed) {
+        best_offset = current;
+      }
+
+      alloc.block_.offset_ = best_offset;
+      buffer_size = std::max(buffer_size, best_offset + size);
+      placed.push_back(idx);
+    }
+  }
+
+  Strategy strategy_;
   std::vector<MLValueAllocationBlock> allocs_;
   // blocks_ the list of currently allocated memory blocks, sorted in order of their offset
   std::list<int> blocks_;
   size_t buffer_size{0};
+
+  // step counter of the traced allocations and frees, for Strategy::kLifetime
+  size_t clock_{0};
+
+  // sum of the sizes of the blocks alive at the same time, and its maximum which no placement can go below
+  size_t live_size_{0};
+  size_t lower_bound_size_{0};
 };
 
 }  // namespace onnxruntime
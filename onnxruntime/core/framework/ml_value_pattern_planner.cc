@@ -6,7 +6,8 @@
 #include "core/framework/sequential_execution_plan.h"
 
 namespace onnxruntime {
-MLValuePatternPlanner::MLValuePatternPlanner(const SequentialExecutionPlan& execution_plan)
+MLValuePatternPlanner::MLValuePatternPlanner(const SequentialExecutionPlan& execution_plan,
+                                             MemPatternPlanner::Strategy strategy)
     : execution_planner_{execution_plan} {
   std::set<OrtAllocatorInfo> locations;
   for (auto& alloc_plan : execution_planner_.allocation_plan) {
@@ -14,7 +15,7 @@ MLValuePatternPlanner::MLValuePatternPlanner(const SequentialExecutionPlan& exec
       locations.insert(alloc_plan.location);
   }
   for (auto& location : locations) {
-    pattern_planners_.push_back(std::make_unique<MemPatternPlanner>());
+    pattern_planners_.push_back(std::make_unique<MemPatternPlanner>(strategy));
     planner_map_[location] = pattern_planners_.back().get();
   }
 }
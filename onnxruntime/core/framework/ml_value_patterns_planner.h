@@ -14,7 +14,8 @@ struct SequentialExecutionPlan;
 
 class MLValuePatternPlanner {
  public:
-  explicit MLValuePatternPlanner(const SequentialExecutionPlan& execution_plan);
+  explicit MLValuePatternPlanner(const SequentialExecutionPlan& execution_plan,
+                                 MemPatternPlanner::Strategy strategy = MemPatternPlanner::Strategy::kGreedy);
 
   common::Status TraceAllocation(int ml_value_idx, size_t size) {
     auto location = execution_planner_.allocation_plan[ml_value_idx].location;
@@ -0,0 +1,96 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/node_statistics.h"
+
+#include <algorithm>
+
+namespace onnxruntime {
+
+namespace {
+// shard of the calling thread. threads are given consecutive shards the first time they record a call, so up to
+// kNumShards threads, e.g. the thread calling Run and the workers of the ParallelExecutor, get one each.
+size_t GetThreadShard(size_t num_shards) {
+  static std::atomic<size_t> next_shard{0};
+  thread_local const size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed);
+  return shard % num_shards;
+}
+
+void UpdateMin(std::atomic<uint64_t>& min, uint64_t value) {
+  uint64_t current = min.load(std::memory_order_relaxed);
+  while (value < current && !min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+  }
+}
+
+void UpdateMax(std::atomic<uint64_t>& max, uint64_t value) {
+  uint64_t current = max.load(std::memory_order_relaxed);
+  while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+  }
+}
+}  // namespace
+
+constexpr size_t NodeStatisticsCollector::kNumShards;
+
+void NodeStatisticsCollector::Resize(size_t max_node_index) {
+  max_node_index_ = max_node_index;
+  shards_.clear();
+  for (size_t i = 0; i < kNumShards; ++i) {
+    shards_.push_back(std::make_unique<Counters[]>(max_node_index));
+  }
+}
+
+void NodeStatisticsCollector::Record(NodeIndex node_index, uint64_t time_ns, uint64_t input_bytes,
+                                     uint64_t output_bytes) const {
+  if (node_index >= max_node_index_) {
+    return;
+  }
+
+  Counters& counters = shards_[GetThreadShard(kNumShards)][node_index];
+  counters.call_count.fetch_add(1, std::memory_order_relaxed);
+  counters.total_time_ns.fetch_add(time_ns, std::memory_order_relaxed);
+  UpdateMin(counters.min_time_ns, time_ns);
+  UpdateMax(counters.max_time_ns, time_ns);
+  counters.input_bytes.fetch_add(input_bytes, std::memory_order_relaxed);
+  counters.output_bytes.fetch_add(output_bytes, std::memory_order_relaxed);
+}
+
+std::vector<NodeStatistics> NodeStatisticsCollector::GetStatistics() const {
+  std::vector<NodeStatistics> statistics;
+  for (size_t node_index = 0; node_index < max_node_index_; ++node_index) {
+    NodeStatistics node_statistics;
+    node_statistics.node_index = node_index;
+    node_statistics.min_time_ns = std::numeric_limits<uint64_t>::max();
+    for (const auto& shard : shards_) {
+      const Counters& counters = shard[node_index];
+      node_statistics.call_count += counters.call_count.load(std::memory_order_relaxed);
+      node_statistics.total_time_ns += counters.total_time_ns.load(std::memory_order_relaxed);
+      node_statistics.min_time_ns = std::min(node_statistics.min_time_ns,
+                                             counters.min_time_ns.load(std::memory_order_relaxed));
+      node_statistics.max_time_ns = std::max(node_statistics.max_time_ns,
+                                             counters.max_time_ns.load(std::memory_order_relaxed));
+      node_statistics.input_bytes += counters.input_bytes.load(std::memory_order_relaxed);
+      node_statistics.output_bytes += counters.output_bytes.load(std::memory_order_relaxed);
+    }
+
+    if (node_statistics.call_count != 0) {
+      statistics.push_back(std::move(node_statistics));
+    }
+  }
+  return statistics;
+}
+
+void NodeStatisticsCollector::Reset() const {
+  for (const auto& shard : shards_) {
+    for (size_t node_index = 0; node_index < max_node_index_; ++node_index) {
+      Counters& counters = shard[node_index];
+      counters.call_count.store(0, std::memory_order_relaxed);
+      counters.total_time_ns.store(0, std::memory_order_relaxed);
+      counters.min_time_ns.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+      counters.max_time_ns.store(0, std::memory_order_relaxed);
+      counters.input_bytes.store(0, std::memory_order_relaxed);
+      counters.output_bytes.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+}  // namespace onnxruntime
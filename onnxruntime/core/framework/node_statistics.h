@@ -0,0 +1,76 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/graph/basic_types.h"
+
+namespace onnxruntime {
+
+struct NodeStatistics {
+  NodeIndex node_index = 0;
+  std::string node_name;
+  std::string op_type;
+
+  // number of times the kernel of the node was computed
+  uint64_t call_count = 0;
+
+  // time spent in the Compute of the kernel, in nanoseconds
+  uint64_t total_time_ns = 0;
+  uint64_t min_time_ns = 0;
+  uint64_t max_time_ns = 0;
+
+  // total size of the tensors read and written by the node over all calls
+  uint64_t input_bytes = 0;
+  uint64_t output_bytes = 0;
+};
+
+// Per node counters of the kernel calls of a graph, kept on every Run so that the statistics are available without
+// enabling the profiler.
+//
+// Record is lock free. The counters are split in shards and a thread always records into the same shard, so threads
+// running nodes concurrently rarely update the same cache lines. GetStatistics adds the shards up.
+class NodeStatisticsCollector {
+ public:
+  NodeStatisticsCollector() = default;
+
+  // Size the counters for node indexes up to max_node_index, excluded, and zero them.
+  // Must not be called concurrently with the other methods.
+  void Resize(size_t max_node_index);
+
+  // Add a call of the kernel of node_index.
+  void Record(NodeIndex node_index, uint64_t time_ns, uint64_t input_bytes, uint64_t output_bytes) const;
+
+  // Statistics of the nodes that were called at least once, ordered by node index. Only the counter fields are set.
+  std::vector<NodeStatistics> GetStatistics() const;
+
+  // Zero the counters. Calls recorded concurrently may be partially kept.
+  void Reset() const;
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(NodeStatisticsCollector);
+
+  static constexpr size_t kNumShards = 8;
+
+  struct Counters {
+    std::atomic<uint64_t> call_count{0};
+    std::atomic<uint64_t> total_time_ns{0};
+    std::atomic<uint64_t> min_time_ns{std::numeric_limits<uint64_t>::max()};
+    std::atomic<uint64_t> max_time_ns{0};
+    std::atomic<uint64_t> input_bytes{0};
+    std::atomic<uint64_t> output_bytes{0};
+  };
+
+  size_t max_node_index_ = 0;
+  std::vector<std::unique_ptr<Counters[]>> shards_;
+};
+
+}  // namespace onnxruntime
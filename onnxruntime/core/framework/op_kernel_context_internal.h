@@ -50,7 +50,31 @@ class OpKernelContextInternal : public OpKernelContext {
 
   const bool& GetTerminateFlag() const noexcept { return terminate_flag_; }
 
+  // total size of the input tensors, implicit inputs excluded
+  uint64_t GetInputBytes() const {
+    uint64_t bytes = 0;
+    for (int i = 0, end = InputCount(); i < end; ++i) {
+      bytes += GetTensorBytes(GetInputMLValue(i));
+    }
+    return bytes;
+  }
+
+  // total size of the output tensors produced so far
+  uint64_t GetOutputBytes() {
+    uint64_t bytes = 0;
+    for (int i = 0, end = OutputCount(); i < end; ++i) {
+      bytes += GetTensorBytes(GetOutputMLValue(i));
+    }
+    return bytes;
+  }
+
  private:
+  static uint64_t GetTensorBytes(const MLValue* p_ml_value) {
+    return p_ml_value != nullptr && p_ml_value->IsAllocated() && p_ml_value->IsTensor()
+               ? p_ml_value->Get<Tensor>().Size()
+               : 0;
+  }
+
   const std::vector<NodeArg*>& implicit_inputs_;
   const bool& terminate_flag_;
 };
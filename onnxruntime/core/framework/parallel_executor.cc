@@ -3,257 +3,523 @@
 
 #include "core/framework/parallel_executor.h"
 
-#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 #include "core/common/common.h"
 #include "core/common/logging/logging.h"
-#include "core/common/task_thread_pool.h"
 #include "core/framework/allocation_planner.h"
 #include "core/framework/execution_frame.h"
 #include "core/framework/session_state.h"
 #include "core/framework/op_kernel_context_internal.h"
+#include "core/platform/threadpool.h"
 
 namespace onnxruntime {
 
-ParallelExecutor::ParallelExecutor(const SessionState& session_state, const bool& terminate_flag)
-    : out_standings_(0), terminate_flag_{terminate_flag} {
-  auto graph_viewer = session_state.GetGraphViewer();
-  node_refs_.resize(graph_viewer->MaxNodeIndex());
-  for (auto& node : graph_viewer->Nodes()) {
-    node_refs_[node.Index()] = node.GetInputEdgesCount();
+namespace {
+
+// Work-stealing deque (Chase-Lev). The owning worker pushes and pops at the bottom, other workers steal from the
+// top. Every node is pushed at most once per Execute call, so the buffer is sized for the whole graph up front and
+// slots are only reused after a Reset between calls. That removes the need for the growable circular array of the
+// original algorithm.
+class WorkStealingQueue {
+ public:
+  explicit WorkStealingQueue(size_t capacity)
+      : buffer_(new std::atomic<size_t>[std::max<size_t>(capacity, 1)]) {}
+
+  // owner only
+  void Push(size_t value) {
+    const int64_t b = bottom_.load(std::memory_order_relaxed);
+    buffer_[b].store(value, std::memory_order_relaxed);
+    bottom_.store(b + 1, std::memory_order_release);
   }
-}
 
-Status ParallelExecutor::Execute(const SessionState& session_state,
-                                 const NameMLValMap& feeds,
-                                 const std::vector<std::string>& output_names,
-                                 std::vector<MLValue>& fetches,
-                                 const logging::Logger& logger) {
-  auto tp = session_state.Profiler().StartTime();
+  // owner only. LIFO so the most recently readied node, whose inputs are likely still in cache, runs next.
+  bool Pop(size_t& value) {
+    const int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
 
-  root_frame_ = std::make_unique<ExecutionFrame>(feeds, output_names, fetches, session_state);
-  //std::cout << "start nodes:" << std::endl;
-  for (auto node_index : session_state.GetGraphViewer()->GetRootNodes()) {
-    auto p_op_kernel = session_state.GetKernel(node_index);
-    if (!p_op_kernel)
-      continue;
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+
+    value = buffer_[b].load(std::memory_order_relaxed);
+    if (t == b) {
+      // last entry. race against concurrent stealers for it.
+      const bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return won;
+    }
+
+    return true;
+  }
 
-    //std::cout << "\t" << p_op_kernel->Node().Name() << std::endl;
-    EnqueueNode(node_index, session_state, logger);
+  // any thread. FIFO so thieves take the oldest entry, leaving the owner its hot work.
+  bool Steal(size_t& value) {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = bottom_.load(std::memory_order_acquire);
+
+    if (t >= b) {
+      return false;
+    }
+
+    value = buffer_[t].load(std::memory_order_relaxed);
+    return top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
   }
 
-  // Wait for finish.
-  {
-    std::unique_lock<std::mutex> lock(complete_mutex_);
-    while (out_standings_ > 0) complete_cv_.wait(lock);
+  bool Empty() const {
+    return top_.load(std::memory_order_acquire) >= bottom_.load(std::memory_order_acquire);
   }
 
-  VLOGS(logger, 1) << "Fetching output.";
-  ORT_RETURN_IF_ERROR(FetchOutput(session_state.GetMLValueNameIdxMap(), *root_frame_, output_names, fetches, logger));
-
-  if (root_frame_->HasPlan()) {
-    std::vector<TensorShape> input_shapes;
-    bool all_tensors = true;
-    for (const auto& feed : feeds) {
-      if (!(feed.second.IsTensor())) {
-        all_tensors = false;
-        break;
-      }
-      auto& tensor = feed.second.Get<Tensor>();
-      input_shapes.push_back(tensor.Shape());
+  // no other thread may access the deque
+  void Reset() {
+    top_.store(0, std::memory_order_relaxed);
+    bottom_.store(0, std::memory_order_relaxed);
+  }
+
+ private:
+  std::unique_ptr<std::atomic<size_t>[]> buffer_;
+  std::atomic<int64_t> top_{0};
+  // keep the index stolen from and the index pushed to on separate cache lines
+  char padding_[64];
+  std::atomic<int64_t> bottom_{0};
+
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(WorkStealingQueue);
+};
+
+}  // namespace
+
+namespace detail {
+
+// State of an Execute call shared by the calling thread and the helper workers scheduled on the inter-op pool.
+// A helper may only be dequeued by the pool after the run has already completed, so the state is reference counted
+// and such a helper simply observes 'done' and returns. The session state, frame and logger are only dereferenced
+// while a node is running, which cannot happen once 'done' is set.
+//
+// The executor keeps the state for its next Execute call. It is only Reset once active_helpers shows that every
+// helper of the previous call has returned, otherwise a late helper would join the new run as a second owner of
+// its deque.
+struct ParallelExecutionState {
+  ParallelExecutionState(size_t num_nodes, size_t num_workers)
+      : pending_inputs(new std::atomic<int>[std::max<size_t>(num_nodes, 1)]) {
+    queues.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+      queues.push_back(std::make_unique<WorkStealingQueue>(num_nodes));
     }
+  }
+
+  void Reset(const SessionState& session_state_in, ExecutionFrame& frame_in, const logging::Logger& logger_in,
+             const bool& terminate_flag_in, const std::vector<int>& node_refs) {
+    session_state = &session_state_in;
+    frame = &frame_in;
+    logger = &logger_in;
+    terminate_flag = &terminate_flag_in;
+    is_profiled = session_state_in.Profiler().IsEnabled();
 
-    if (all_tensors) {
-      auto mem_patterns = std::make_unique<MemoryPatternGroup>();
-      ORT_RETURN_IF_ERROR(root_frame_->GeneratePatterns(mem_patterns.get()));
-      ORT_RETURN_IF_ERROR(session_state.UpdateMemoryPatternGroupCache(input_shapes, std::move(mem_patterns)));
+    for (size_t i = 0; i < node_refs.size(); ++i) {
+      pending_inputs[i].store(node_refs[i], std::memory_order_relaxed);
     }
+    for (auto& queue : queues) {
+      queue->Reset();
+    }
+
+    outstanding.store(0, std::memory_order_relaxed);
+    done.store(false, std::memory_order_relaxed);
+    failed.store(false, std::memory_order_relaxed);
+    status = Status::OK();
   }
 
-  session_state.Profiler().EndTimeAndRecordEvent(profiling::SESSION_EVENT, "ParallelExecutor::Execute", tp);
-  return Status::OK();
+  bool HasWork() const {
+    return std::any_of(queues.cbegin(), queues.cend(),
+                       [](const std::unique_ptr<WorkStealingQueue>& queue) { return !queue->Empty(); });
+  }
+
+  const SessionState* session_state = nullptr;
+  ExecutionFrame* frame = nullptr;
+  const logging::Logger* logger = nullptr;
+  const bool* terminate_flag = nullptr;
+
+  // whether the run is sampled by the profiler, so the helpers record the events of its nodes alike
+  bool is_profiled = false;
+
+  // number of input edges whose producer has not completed yet, per node
+  std::unique_ptr<std::atomic<int>[]> pending_inputs;
+  std::vector<std::unique_ptr<WorkStealingQueue>> queues;
+
+  // nodes that are ready or running. the run is complete when this drops to zero.
+  std::atomic<int> outstanding{0};
+  std::atomic<bool> done{false};
+  std::atomic<bool> failed{false};
+
+  // helpers scheduled on the pool that have not returned from their WorkerLoop yet
+  std::atomic<int> active_helpers{0};
+
+  // idle workers park on work_available after spinning for a while. mutex also protects status.
+  std::atomic<int> num_sleeping{0};
+  std::mutex mutex;
+  std::condition_variable work_available;
+  Status status;
+};
+
+}  // namespace detail
+
+namespace {
+
+using RunState = detail::ParallelExecutionState;
+
+// number of attempts to find work before an idle worker parks
+constexpr int kIdleSpinCount = 64;
+
+void WakeIdleWorker(RunState& state) {
+  // pairs with the fence in WorkerLoop. either the parking worker sees the new entry, or we see it registered.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (state.num_sleeping.load(std::memory_order_relaxed) > 0) {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.work_available.notify_one();
+  }
 }
 
-void ParallelExecutor::RunNodeAsync(size_t p_node_index,
-                                    const SessionState& session_state,
-                                    const logging::Logger& logger) {
-  try {
-    RunNodeAsyncInternal(p_node_index, session_state, logger);
-  } catch (...) {
-    FinishNodeRun();
-	throw;
+void RecordFailure(RunState& state, const Status& status) {
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (state.status.IsOK()) {
+    state.status = status;
   }
+  state.failed.store(true, std::memory_order_relaxed);
 }
 
-void ParallelExecutor::RunNodeAsyncInternal(size_t p_node_index,
-                                            const SessionState& session_state,
-                                            const logging::Logger& logger) {
-  LOGS(logger, INFO) << "Begin execution";
+Status ExecuteNode(RunState& state, NodeIndex node_index) {
+  const SessionState& session_state = *state.session_state;
+  const logging::Logger& logger = *state.logger;
 
-  size_t node_index = p_node_index;
-  bool keep_running = true;
-  auto graph_viewer = session_state.GetGraphViewer();
-  // Avoid context switching if possible.
-  while (keep_running) {
-    // TODO: Convert RunNodeAsync return Status.
-    // to also handle exception propagation
-    if (terminate_flag_) {
-      LOGS(logger, WARNING) << "Exiting due to terminate flag being set to true.";
-      ORT_THROW("Exiting due to terminate flag being set to true.");
-    }
+  if (*state.terminate_flag) {
+    LOGS(logger, WARNING) << "Exiting due to terminate flag being set to true.";
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to terminate flag being set to true.");
+  }
 
-    auto p_op_kernel = session_state.GetKernel(node_index);
+  auto p_op_kernel = session_state.GetKernel(node_index);
 
-    // if a kernel has been added in the session state, it better be NON-null.
-    if (p_op_kernel == nullptr) {
-      ORT_THROW("Got nullptr from GetKernel for node: ",
-                        graph_viewer->GetNode(node_index)->Name());
-    }
+  // if a kernel has been added in the session state, it better be NON-null.
+  if (p_op_kernel == nullptr) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Got nullptr from GetKernel for node: ",
+                           session_state.GetGraphViewer()->GetNode(node_index)->Name());
+  }
 
-    OpKernelContextInternal op_kernel_context(*root_frame_, *p_op_kernel, logger,
-                                              p_op_kernel->Node().ImplicitInputDefs(),
-                                              terminate_flag_);
+  OpKernelContextInternal op_kernel_context(*state.frame, *p_op_kernel, logger,
+                                            p_op_kernel->Node().ImplicitInputDefs(),
+                                            *state.terminate_flag);
 
-    auto sync_time_begin = session_state.Profiler().StartTime();
-    // sync before compute
-    int queue_id = p_op_kernel->KernelDef().ExecQueueId();
+  // the names of the profiling events are only built when the profiler records them
+  const bool is_profiler_enabled = session_state.Profiler().IsEnabled();
 
-    for (int input_index = 0; input_index < op_kernel_context.InputCount(); ++input_index) {
-      Fence_t fence = op_kernel_context.InputFence(input_index);
-      if (fence) {
-        fence->BeforeUsingAsInput(p_op_kernel->Node().GetExecutionProviderType(), queue_id);
-      }
+  TimePoint sync_time_begin;
+  if (is_profiler_enabled) {
+    sync_time_begin = session_state.Profiler().StartTime();
+  }
+  // sync before compute
+  int queue_id = p_op_kernel->KernelDef().ExecQueueId();
+
+  for (int input_index = 0; input_index < op_kernel_context.InputCount(); ++input_index) {
+    Fence_t fence = op_kernel_context.InputFence(input_index);
+    if (fence) {
+      fence->BeforeUsingAsInput(p_op_kernel->Node().GetExecutionProviderType(), queue_id);
     }
+  }
 
-    for (int input_index = 0; input_index < op_kernel_context.ImplicitInputCount(); ++input_index) {
-      Fence_t fence = op_kernel_context.ImplicitInputFence(input_index);
-      if (fence) {
-        fence->BeforeUsingAsInput(p_op_kernel->Node().GetExecutionProviderType(), queue_id);
-      }
+  for (int input_index = 0; input_index < op_kernel_context.ImplicitInputCount(); ++input_index) {
+    Fence_t fence = op_kernel_context.ImplicitInputFence(input_index);
+    if (fence) {
+      fence->BeforeUsingAsInput(p_op_kernel->Node().GetExecutionProviderType(), queue_id);
     }
+  }
 
-    for (int output_index = 0; output_index < op_kernel_context.OutputCount(); ++output_index) {
-      Fence_t fence = op_kernel_context.OutputFence(output_index);
-      if (fence) {
-        fence->BeforeUsingAsOutput(p_op_kernel->Node().GetExecutionProviderType(), queue_id);
-      }
+  for (int output_index = 0; output_index < op_kernel_context.OutputCount(); ++output_index) {
+    Fence_t fence = op_kernel_context.OutputFence(output_index);
+    if (fence) {
+      fence->BeforeUsingAsOutput(p_op_kernel->Node().GetExecutionProviderType(), queue_id);
     }
+  }
 
-    const std::string& node_name = p_op_kernel->Node().Name();
-    const std::string& op_name = p_op_kernel->KernelDef().OpName();
+  const std::string& node_name = p_op_kernel->Node().Name();
+  const std::string& op_name = p_op_kernel->KernelDef().OpName();
 
+  if (is_profiler_enabled) {
     session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
                                                    node_name + "_fence_before",
                                                    sync_time_begin,
                                                    {{"op_name", op_name}});
+  }
 
-    // call compute on the kernel
-    VLOGS(logger, 1) << "Computing kernel: " << p_op_kernel->Node().Name();
+  // call compute on the kernel
+  VLOGS(logger, 1) << "Computing kernel: " << node_name;
 
-    auto kernel_begin_time = session_state.Profiler().StartTime();
+  auto kernel_begin_time = session_state.Profiler().StartTime();
 
-    // Execute the kernel.
-    auto status = p_op_kernel->Compute(&op_kernel_context);
-    if (!status.IsOK()) {
-      ORT_THROW("Compute failed for node: ", graph_viewer->GetNode(node_index)->Name());
-    }
+  // Execute the kernel.
+  ORT_RETURN_IF_ERROR(p_op_kernel->Compute(&op_kernel_context));
+
+  const NodeStatisticsCollector* node_statistics = session_state.GetNodeStatisticsCollector();
+  if (node_statistics != nullptr) {
+    node_statistics->Record(node_index, TimeDiffNanoSeconds(kernel_begin_time),
+                            op_kernel_context.GetInputBytes(), op_kernel_context.GetOutputBytes());
+  }
 
+  if (is_profiler_enabled) {
     session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
                                                    node_name + "_kernel_time",
                                                    kernel_begin_time,
                                                    {{"op_name", op_name}});
-
     sync_time_begin = session_state.Profiler().StartTime();
-    // sync after compute for outputs
-    for (int input_index = 0; input_index < op_kernel_context.InputCount(); ++input_index) {
-      Fence_t fence = op_kernel_context.InputFence(input_index);
-      if (fence) {
-        fence->AfterUsedAsInput(queue_id);
-      }
+  }
+
+  // sync after compute for outputs
+  for (int input_index = 0; input_index < op_kernel_context.InputCount(); ++input_index) {
+    Fence_t fence = op_kernel_context.InputFence(input_index);
+    if (fence) {
+      fence->AfterUsedAsInput(queue_id);
     }
+  }
 
-    for (int input_index = 0; input_index < op_kernel_context.ImplicitInputCount(); ++input_index) {
-      Fence_t fence = op_kernel_context.ImplicitInputFence(input_index);
-      if (fence) {
-        fence->AfterUsedAsInput(queue_id);
-      }
+  for (int input_index = 0; input_index < op_kernel_context.ImplicitInputCount(); ++input_index) {
+    Fence_t fence = op_kernel_context.ImplicitInputFence(input_index);
+    if (fence) {
+      fence->AfterUsedAsInput(queue_id);
     }
+  }
 
-    for (int output_index = 0; output_index < op_kernel_context.OutputCount(); ++output_index) {
-      Fence_t fence = op_kernel_context.OutputFence(output_index);
-      if (fence) {
-        fence->AfterUsedAsOutput(queue_id);
-      }
+  for (int output_index = 0; output_index < op_kernel_context.OutputCount(); ++output_index) {
+    Fence_t fence = op_kernel_context.OutputFence(output_index);
+    if (fence) {
+      fence->AfterUsedAsOutput(queue_id);
     }
+  }
+  if (is_profiler_enabled) {
     session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
                                                    node_name + "_fence_after",
                                                    sync_time_begin,
                                                    {{"op_name", op_name}});
+  }
 
-    //std::cout << "Run async node finish: " << p_node_index << std::endl;
+  return Status::OK();
+}
 
-    keep_running = false;
+// Run node_index and, as long as completing a node makes at least one consumer ready, keep running one of those
+// consumers on this thread. The other consumers go to this worker's deque where idle workers can steal them.
+void RunNodes(RunState& state, size_t worker, size_t node_index) {
+  for (;;) {
+    // once a node has failed the run is abandoned. nodes already made ready are drained without running them and
+    // without releasing their consumers, so 'outstanding' still drops to zero.
+    bool ok = false;
+    if (!state.failed.load(std::memory_order_relaxed)) {
+      Status status;
+      try {
+        status = ExecuteNode(state, node_index);
+      } catch (const std::exception& ex) {
+        status = ORT_MAKE_STATUS(ONNXRUNTIME, RUNTIME_EXCEPTION, ex.what());
+      }
 
-    // Checking which output nodes ready for running.
-    {
-      auto begin = p_op_kernel->Node().OutputEdgesBegin();
-      auto end = p_op_kernel->Node().OutputEdgesEnd();
+      if (status.IsOK()) {
+        ok = true;
+      } else {
+        LOGS(*state.logger, ERROR) << "Node " << state.session_state->GetGraphViewer()->GetNode(node_index)->Name()
+                                  << " failed: " << status.ErrorMessage();
+        RecordFailure(state, status);
+      }
+    }
 
-      std::lock_guard<std::mutex> lock(ref_mutex_);
-      for (auto it = begin; it != end; it++) {
-        auto idx = (*it).GetNode().Index();
-        if ((--node_refs_[idx]) == 0) {
+    bool keep_running = false;
+    if (ok) {
+      const Node& node = *state.session_state->GetGraphViewer()->GetNode(node_index);
+      for (auto it = node.OutputEdgesBegin(), end = node.OutputEdgesEnd(); it != end; ++it) {
+        const size_t idx = (*it).GetNode().Index();
+        // acq_rel: the last producer to finish sees the outputs written by all the others
+        if (state.pending_inputs[idx].fetch_sub(1, std::memory_order_acq_rel) == 1) {
           if (!keep_running) {
+            // continue with it on this thread. it inherits this node's 'outstanding' slot.
             node_index = idx;
             keep_running = true;
           } else {
-            EnqueueNode(idx, session_state, logger);
+            state.outstanding.fetch_add(1, std::memory_order_relaxed);
+            state.queues[worker]->Push(idx);
+            WakeIdleWorker(state);
           }
         }
-
-        //std::cout << "handle output, current name: " << p_op_kernel->Node().Name() << ", current index: " << p_node_index << ", output name: " << (*it)->GetNode().Name() << ", output index: " << (*it)->GetNode().Index() << ", after -- output ref: " << node_refs_[idx] << std::endl;
       }
     }
+
+    if (!keep_running) {
+      break;
+    }
+  }
+
+  if (state.outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.done.store(true, std::memory_order_release);
+    state.work_available.notify_all();
+  }
+}
+
+bool FindWork(RunState& state, size_t worker, size_t& node_index) {
+  if (state.queues[worker]->Pop(node_index)) {
+    return true;
+  }
+
+  const size_t num_workers = state.queues.size();
+  for (size_t i = 1; i < num_workers; ++i) {
+    if (state.queues[(worker + i) % num_workers]->Steal(node_index)) {
+      return true;
+    }
   }
 
-  FinishNodeRun();
+  return false;
+}
+
+void WorkerLoop(RunState& state, size_t worker) {
+  profiling::Profiler::RunScope profiler_run_scope{state.is_profiled};
+  int idle_spins = 0;
+
+  while (!state.done.load(std::memory_order_acquire)) {
+    size_t node_index;
+    if (FindWork(state, worker, node_index)) {
+      idle_spins = 0;
+      RunNodes(state, worker, node_index);
+      continue;
+    }
+
+    if (++idle_spins < kIdleSpinCount) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    idle_spins = 0;
+
+    // nothing to steal for a while, e.g. the remaining nodes form a chain running on another worker. park until a
+    // node is pushed or the run completes.
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.num_sleeping.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!state.done.load(std::memory_order_acquire) && !state.HasWork()) {
+      state.work_available.wait(lock);
+    }
+    state.num_sleeping.fetch_sub(1, std::memory_order_relaxed);
+  }
 }
 
-void ParallelExecutor::EnqueueNode(size_t p_node_index, const SessionState& session_state, const logging::Logger& logger) {
-  {
-    std::unique_lock<std::mutex> lock(complete_mutex_);
-    out_standings_++;
+}  // namespace
+
+ParallelExecutor::ParallelExecutor(const SessionState& session_state, const bool& terminate_flag)
+    : terminate_flag_{terminate_flag} {
+  auto graph_viewer = session_state.GetGraphViewer();
+  node_refs_.resize(graph_viewer->MaxNodeIndex());
+  for (auto& node : graph_viewer->Nodes()) {
+    node_refs_[node.Index()] = static_cast<int>(node.GetInputEdgesCount());
   }
-  //std::cout << "Enqueue async node: " << p_node_index << ", out_standings: " << out_standings_ << std::endl;
-  std::packaged_task<void()> task{std::bind(&ParallelExecutor::RunNodeAsync, this, p_node_index, std::cref(session_state), std::cref(logger))};
-  session_state.GetThreadPool()->RunTask(std::move(task));
 }
 
-Status ParallelExecutor::FetchOutput(const MLValueNameIdxMap& name_idx_map,
-                                     ExecutionFrame& frame,
-                                     const std::vector<std::string>& output_names,
+Status ParallelExecutor::Execute(const SessionState& session_state,
+                                 const NameMLValMap& feeds,
+                                 const std::vector<std::string>& output_names,
+                                 std::vector<MLValue>& fetches,
+                                 const logging::Logger& logger) {
+  ExecutionFrame frame{feeds, output_names, fetches, session_state};
+
+  std::vector<int> fetch_mlvalue_idxs(output_names.size());
+  for (size_t i = 0; i < output_names.size(); ++i) {
+    ORT_RETURN_IF_ERROR(session_state.GetMLValueNameIdxMap().GetIdx(output_names[i], fetch_mlvalue_idxs[i]));
+  }
+
+  return Execute(session_state, frame, fetch_mlvalue_idxs, fetches, terminate_flag_, logger);
+}
+
+Status ParallelExecutor::Execute(const SessionState& session_state,
+                                 ExecutionFrame& frame,
+                                 const std::vector<int>& fetch_mlvalue_idxs,
+                                 std::vector<MLValue>& fetches,
+                                 const bool& terminate_flag,
+                                 const logging::Logger& logger) {
+  auto tp = session_state.Profiler().StartTime();
+
+  root_nodes_.clear();
+  for (auto node_index : session_state.GetGraphViewer()->GetRootNodes()) {
+    if (session_state.GetKernel(node_index)) {
+      root_nodes_.push_back(node_index);
+    }
+  }
+
+  if (!root_nodes_.empty()) {
+    // there is no point in waking more helpers than there are nodes to run
+    concurrency::ThreadPool* thread_pool = session_state.GetThreadPool();
+    const int max_helpers = session_state.GetGraphViewer()->NumberOfNodes() - 1;
+    const size_t num_helpers = thread_pool ? static_cast<size_t>(std::min(thread_pool->NumThreads(), max_helpers))
+                                           : 0;
+
+    // worker 0 is this thread. a helper of the previous call that the pool has not run yet still holds the old
+    // state, which it will find done, so this call starts from a new one.
+    if (!state_ || state_->queues.size() != num_helpers + 1 ||
+        state_->active_helpers.load(std::memory_order_acquire) != 0) {
+      state_ = std::make_shared<detail::ParallelExecutionState>(node_refs_.size(), num_helpers + 1);
+    }
+
+    std::shared_ptr<detail::ParallelExecutionState> state = state_;
+    state->Reset(session_state, frame, logger, terminate_flag, node_refs_);
+
+    state->outstanding.store(static_cast<int>(root_nodes_.size()), std::memory_order_relaxed);
+    for (size_t i = 1; i < root_nodes_.size(); ++i) {
+      state->queues[0]->Push(root_nodes_[i]);
+    }
+
+    state->active_helpers.store(static_cast<int>(num_helpers), std::memory_order_relaxed);
+    for (size_t worker = 1; worker <= num_helpers; ++worker) {
+      thread_pool->Schedule([state, worker]() {
+        WorkerLoop(*state, worker);
+        state->active_helpers.fetch_sub(1, std::memory_order_release);
+      });
+    }
+
+    RunNodes(*state, 0, root_nodes_[0]);
+    WorkerLoop(*state, 0);
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    ORT_RETURN_IF_ERROR(state->status);
+  }
+
+  VLOGS(logger, 1) << "Fetching output.";
+  ORT_RETURN_IF_ERROR(FetchOutput(frame, fetch_mlvalue_idxs, fetches, logger));
+
+  if (frame.HasPlan()) {
+    auto mem_patterns = std::make_unique<MemoryPatternGroup>();
+    ORT_RETURN_IF_ERROR(frame.GeneratePatterns(mem_patterns.get()));
+    ORT_RETURN_IF_ERROR(session_state.UpdateMemoryPatternGroupCache(frame.GetInputShapes(), std::move(mem_patterns)));
+  }
+
+  session_state.Profiler().EndTimeAndRecordEvent(profiling::SESSION_EVENT, "ParallelExecutor::Execute", tp);
+  return Status::OK();
+}
+
+Status ParallelExecutor::FetchOutput(ExecutionFrame& frame,
+                                     const std::vector<int>& fetch_mlvalue_idxs,
                                      std::vector<MLValue>& fetches,
                                      const logging::Logger& logger) {
   if (fetches.empty()) {
-    fetches.resize(output_names.size());
+    fetches.resize(fetch_mlvalue_idxs.size());
   } else {
     // this should've been checked before already
-    ORT_ENFORCE(output_names.size() == fetches.size(),
-                        "output_names vector size: " + std::to_string(output_names.size()) +
-                            " does not match that of fetches vector: " + std::to_string(fetches.size()));
+    ORT_ENFORCE(fetch_mlvalue_idxs.size() == fetches.size(),
+                "output_names vector size: " + std::to_string(fetch_mlvalue_idxs.size()) +
+                    " does not match that of fetches vector: " + std::to_string(fetches.size()));
   }
 
-  auto idx = 0;
-
-  for (const auto& oname : output_names) {
-    VLOGS(logger, 1) << "Attempting to fetch output with name: " << oname;
-    int mlvalue_index;
-    ORT_RETURN_IF_ERROR(name_idx_map.GetIdx(oname, mlvalue_index));
-    const MLValue& output_mlvalue = frame.GetMLValue(mlvalue_index);
-    VLOGS(logger, 1) << "Copying fetched MLValue to output vector";
-    fetches[idx++] = output_mlvalue;
+  for (size_t idx = 0; idx < fetch_mlvalue_idxs.size(); ++idx) {
+    VLOGS(logger, 1) << "Copying fetched MLValue with index " << fetch_mlvalue_idxs[idx] << " to output vector";
+    fetches[idx] = frame.GetMLValue(fetch_mlvalue_idxs[idx]);
   }
 
   VLOGS(logger, 1) << "Done with execution.";
@@ -3,8 +3,8 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
-#include <condition_variable>
 #include "core/common/common.h"
 #include "core/common/status.h"
 #include "core/common/logging/logging.h"
@@ -18,6 +18,20 @@ namespace onnxruntime {
 
 class ExecutionFrame;
 
+namespace detail {
+struct ParallelExecutionState;
+}
+
+// Executes independent nodes of the graph concurrently using the session's inter-op thread pool.
+//
+// Readiness is tracked with one atomic counter of pending inputs per node, so completing a node never takes a
+// lock. Each participating thread owns a work-stealing deque: nodes that become ready are pushed to the deque of
+// the thread that made them ready, which keeps producer/consumer chains on the same core, while idle threads
+// steal from the other deques. The thread calling Execute is one of the workers and runs the first root node
+// inline, so a graph that turns out to be a single chain never leaves the calling thread.
+//
+// The counters and deques are kept from one Execute call to the next, so an executor that is reused across runs
+// allocates nothing per run. An executor must not run concurrent Execute calls.
 class ParallelExecutor : public IExecutor {
  public:
   ParallelExecutor(const bool& terminate_flag = false) : terminate_flag_{terminate_flag} {}
@@ -29,39 +43,29 @@ class ParallelExecutor : public IExecutor {
                          std::vector<MLValue>& fetches,
                          const logging::Logger& logger) override;
 
+  common::Status Execute(const SessionState& session_state,
+                         ExecutionFrame& frame,
+                         const std::vector<int>& fetch_mlvalue_idxs,
+                         std::vector<MLValue>& fetches,
+                         const bool& terminate_flag,
+                         const logging::Logger& logger) override;
+
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ParallelExecutor);
 
-  void RunNodeAsync(size_t p_node_index, const SessionState& session_state, const logging::Logger& logger);
-  void RunNodeAsyncInternal(size_t p_node_index, const SessionState& session_state, const logging::Logger& logger);
-
-  void EnqueueNode(size_t p_node_index, const SessionState& session_state, const logging::Logger& logger);
-
-  Status FetchOutput(const MLValueNameIdxMap& name_idx_map,
-                     ExecutionFrame& frame,
-                     const std::vector<std::string>& output_names,
+  Status FetchOutput(ExecutionFrame& frame,
+                     const std::vector<int>& fetch_mlvalue_idxs,
                      std::vector<MLValue>& fetches,
                      const logging::Logger& logger);
 
-  void FinishNodeRun() {
-    bool finished = false;
-    {
-      //Because we have a mutex here, it's not possible another thread is doing the test("while (out_standings_ > 0)"
-      std::lock_guard<std::mutex> lock(complete_mutex_);
-      finished = --out_standings_ == 0;
-    }
-    if (finished) {
-      //std::cout << "all out standing nodes are completed." << std::endl;
-      complete_cv_.notify_all();
-    }
-  }
+  // number of input edges of each node, indexed by NodeIndex. copied into atomic counters for every Execute call.
+  std::vector<int> node_refs_;
+
+  // root nodes with a kernel. rebuilt by each Execute call, kept to reuse the buffer.
+  std::vector<NodeIndex> root_nodes_;
 
-  std::unique_ptr<ExecutionFrame> root_frame_;
-  std::vector<size_t> node_refs_;
-  std::mutex ref_mutex_;
-  int out_standings_;  //protected by complete_mutex_
-  std::mutex complete_mutex_;
-  std::condition_variable complete_cv_;
+  // the state of the last Execute call, reused by the next one once all its helpers have returned
+  std::shared_ptr<detail::ParallelExecutionState> state_;
 
   const bool& terminate_flag_;
 };
@@ -15,9 +15,8 @@
 
 namespace onnxruntime {
 
-static Status FetchOutput(const MLValueNameIdxMap& name_idx_map,
-                          ExecutionFrame& frame,
-                          const std::vector<std::string>& output_names,
+static Status FetchOutput(ExecutionFrame& frame,
+                          const std::vector<int>& fetch_mlvalue_idxs,
                           std::vector<MLValue>& fetches,
                           const logging::Logger& logger);
 
@@ -31,10 +30,24 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
                                    const std::vector<std::string>& output_names,
                                    std::vector<MLValue>& fetches,
                                    const logging::Logger& logger) {
-  auto tp = session_state.Profiler().StartTime();
-
   ExecutionFrame frame{feeds, output_names, fetches, session_state};
 
+  std::vector<int> fetch_mlvalue_idxs(output_names.size());
+  for (size_t i = 0; i < output_names.size(); ++i) {
+    ORT_RETURN_IF_ERROR(session_state.GetMLValueNameIdxMap().GetIdx(output_names[i], fetch_mlvalue_idxs[i]));
+  }
+
+  return Execute(session_state, frame, fetch_mlvalue_idxs, fetches, terminate_flag_, logger);
+}
+
+Status SequentialExecutor::Execute(const SessionState& session_state,
+                                   ExecutionFrame& frame,
+                                   const std::vector<int>& fetch_mlvalue_idxs,
+                                   std::vector<MLValue>& fetches,
+                                   const bool& terminate_flag,
+                                   const logging::Logger& logger) {
+  auto tp = session_state.Profiler().StartTime();
+
   LOGS(logger, INFO) << "Begin execution";
   const SequentialExecutionPlan& seq_exec_plan = *session_state.GetExecutionPlan();
   const auto& exec_plan_vec = seq_exec_plan.execution_plan;
@@ -43,8 +56,12 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
   // uncomment the line below to dump execution plan
   //std::cout << std::make_pair(p_seq_exec_plan, &session_state) << "\n";
 
+  // the names of the profiling events are only built when the profiler records them
+  const bool is_profiler_enabled = session_state.Profiler().IsEnabled();
+  const NodeStatisticsCollector* node_statistics = session_state.GetNodeStatisticsCollector();
+
   for (const auto& node_exec_plan : exec_plan_vec) {
-    if (terminate_flag_) {
+    if (terminate_flag) {
       LOGS(logger, WARNING) << "Exiting due to terminate flag being set to true.";
       return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to terminate flag being set to true.");
     }
@@ -62,10 +79,13 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
     // construct OpKernelContext
     // TODO: log kernel inputs?
     OpKernelContextInternal op_kernel_context(frame, *p_op_kernel, logger, p_op_kernel->Node().ImplicitInputDefs(),
-                                              terminate_flag_);
+                                              terminate_flag);
     // TODO: log kernel outputs?
 
-    auto sync_time_begin = session_state.Profiler().StartTime();
+    TimePoint sync_time_begin;
+    if (is_profiler_enabled) {
+      sync_time_begin = session_state.Profiler().StartTime();
+    }
     // sync before compute
     int queue_id = p_op_kernel->KernelDef().ExecQueueId();
     for (int input_index = 0; input_index < op_kernel_context.InputCount(); ++input_index) {
@@ -89,22 +109,30 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
       }
     }
 
-    session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
-                                                   node_name + "_fence_before",
-                                                   sync_time_begin,
-                                                   {{"op_name", op_name}});
+    if (is_profiler_enabled) {
+      session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
+                                                     node_name + "_fence_before",
+                                                     sync_time_begin,
+                                                     {{"op_name", op_name}});
+    }
 
     // call compute on the kernel
     VLOGS(logger, 1) << "Computing kernel: " << p_op_kernel->Node().Name();
 
     auto kernel_begin_time = session_state.Profiler().StartTime();
     ORT_RETURN_IF_ERROR(p_op_kernel->Compute(&op_kernel_context));
-    session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
-                                                   node_name + "_kernel_time",
-                                                   kernel_begin_time,
-                                                   {{"op_name", op_name}});
+    if (node_statistics != nullptr) {
+      node_statistics->Record(node_index, TimeDiffNanoSeconds(kernel_begin_time),
+                              op_kernel_context.GetInputBytes(), op_kernel_context.GetOutputBytes());
+    }
+    if (is_profiler_enabled) {
+      session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
+                                                     node_name + "_kernel_time",
+                                                     kernel_begin_time,
+                                                     {{"op_name", op_name}});
+      sync_time_begin = session_state.Profiler().StartTime();
+    }
 
-    sync_time_begin = session_state.Profiler().StartTime();
     // sync after compute for outputs
     for (int input_index = 0; input_index < op_kernel_context.InputCount(); ++input_index) {
       Fence_t fence = op_kernel_context.InputFence(input_index);
@@ -126,10 +154,12 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
         fence->AfterUsedAsOutput(queue_id);
       }
     }
-    session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
-                                                   node_name + "_fence_after",
-                                                   sync_time_begin,
-                                                   {{"op_name", op_name}});
+    if (is_profiler_enabled) {
+      session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
+                                                     node_name + "_fence_after",
+                                                     sync_time_begin,
+                                                     {{"op_name", op_name}});
+    }
 
     // free ml-values corresponding to this node
     VLOGS(logger, 1) << "Releasing node ML values after computing kernel: " << p_op_kernel->Node().Name();
@@ -137,54 +167,34 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
   }
 
   VLOGS(logger, 1) << "Fetching output.";
-  ORT_RETURN_IF_ERROR(FetchOutput(session_state.GetMLValueNameIdxMap(), frame, output_names, fetches, logger));
+  ORT_RETURN_IF_ERROR(FetchOutput(frame, fetch_mlvalue_idxs, fetches, logger));
 
   if (frame.HasPlan()) {
-    std::vector<TensorShape> input_shapes;
-    bool all_tensors = true;
-    for (const auto& feed : feeds) {
-      if (!(feed.second.IsTensor())) {
-        all_tensors = false;
-        break;
-      }
-      auto& tensor = feed.second.Get<Tensor>();
-      input_shapes.push_back(tensor.Shape());
-    }
-
-    if (all_tensors) {
-      auto mem_patterns = std::make_unique<MemoryPatternGroup>();
-      ORT_RETURN_IF_ERROR(frame.GeneratePatterns(mem_patterns.get()));
-      ORT_RETURN_IF_ERROR(session_state.UpdateMemoryPatternGroupCache(input_shapes, std::move(mem_patterns)));
-    }
+    auto mem_patterns = std::make_unique<MemoryPatternGroup>();
+    ORT_RETURN_IF_ERROR(frame.GeneratePatterns(mem_patterns.get()));
+    ORT_RETURN_IF_ERROR(session_state.UpdateMemoryPatternGroupCache(frame.GetInputShapes(), std::move(mem_patterns)));
   }
 
   session_state.Profiler().EndTimeAndRecordEvent(profiling::SESSION_EVENT, "SequentialExecutor::Execute", tp);
   return Status::OK();
 }
 
-static Status FetchOutput(const MLValueNameIdxMap& name_idx_map,
-                          ExecutionFrame& frame,
-                          const std::vector<std::string>& output_names,
+static Status FetchOutput(ExecutionFrame& frame,
+                          const std::vector<int>& fetch_mlvalue_idxs,
                           std::vector<MLValue>& fetches,
                           const logging::Logger& logger) {
   if (fetches.empty()) {
-    fetches.resize(output_names.size());
+    fetches.resize(fetch_mlvalue_idxs.size());
   } else {
     // this should've been checked before already
-    ORT_ENFORCE(output_names.size() == fetches.size(),
-                        "output_names vector size: " + std::to_string(output_names.size()) +
-                            " does not match that of fetches vector: " + std::to_string(fetches.size()));
+    ORT_ENFORCE(fetch_mlvalue_idxs.size() == fetches.size(),
+                "output_names vector size: " + std::to_string(fetch_mlvalue_idxs.size()) +
+                    " does not match that of fetches vector: " + std::to_string(fetches.size()));
   }
 
-  auto idx = 0;
-
-  for (const auto& oname : output_names) {
-    VLOGS(logger, 1) << "Attempting to fetch output with name: " << oname;
-    int mlvalue_index;
-    ORT_RETURN_IF_ERROR(name_idx_map.GetIdx(oname, mlvalue_index));
-    const MLValue& output_mlvalue = frame.GetMLValue(mlvalue_index);
-    VLOGS(logger, 1) << "Copying fetched MLValue to output vector";
-    fetches[idx++] = output_mlvalue;
+  for (size_t idx = 0; idx < fetch_mlvalue_idxs.size(); ++idx) {
+    VLOGS(logger, 1) << "Copying fetched MLValue with index " << fetch_mlvalue_idxs[idx] << " to output vector";
+    fetches[idx] = frame.GetMLValue(fetch_mlvalue_idxs[idx]);
   }
 
   VLOGS(logger, 1) << "Done with execution.";
@@ -24,6 +24,13 @@ class SequentialExecutor : public IExecutor {
                          std::vector<MLValue>& fetches,
                          const logging::Logger& logger) override;
 
+  common::Status Execute(const SessionState& session_state,
+                         ExecutionFrame& frame,
+                         const std::vector<int>& fetch_mlvalue_idxs,
+                         std::vector<MLValue>& fetches,
+                         const bool& terminate_flag,
+                         const logging::Logger& logger) override;
+
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(SequentialExecutor);
   const bool& terminate_flag_;
@@ -14,6 +14,9 @@ namespace onnxruntime {
 void SessionState::SetGraphViewer(std::unique_ptr<onnxruntime::GraphViewer> graph_viewer) {
   ORT_ENFORCE(nullptr != graph_viewer);
   graph_viewer_ = std::move(graph_viewer);
+  if (enable_node_statistics_) {
+    node_statistics_.Resize(graph_viewer_->MaxNodeIndex());
+  }
 }
 
 const onnxruntime::GraphViewer* SessionState::GetGraphViewer() const {
@@ -69,36 +72,36 @@ void SessionState::SetProfiler(profiling::Profiler& profiler) {
   return *profiler_;
 }
 
-static int64_t CalculateMemoryPatternsKey(const std::vector<TensorShape>& shapes) {
-  int64_t key = 0;
-  for (auto& shape : shapes) {
-    for (auto dim : shape.GetDims())
-      key ^= dim;
-  }
-  return key;
+std::shared_ptr<const MemoryPatternGroup> SessionState::GetMemoryPatternGroup(
+    const std::vector<TensorShape>& input_shapes, bool* needs_growth) const {
+  return mem_patterns_.Find(input_shapes, needs_growth);
 }
 
-const MemoryPatternGroup* SessionState::GetMemoryPatternGroup(const std::vector<TensorShape>& input_shapes) const {
-  std::lock_guard<std::mutex> lock(mem_patterns_lock_);
-  int64_t key = CalculateMemoryPatternsKey(input_shapes);
-  auto it = mem_patterns_.find(key);
-  if (it == mem_patterns_.end())
-    return nullptr;
+Status SessionState::UpdateMemoryPatternGroupCache(const std::vector<TensorShape>& input_shape,
+                                                   std::unique_ptr<MemoryPatternGroup> mem_patterns) const {
+  mem_patterns_.Insert(input_shape, std::move(mem_patterns));
+  return Status::OK();
+}
 
-  return it->second.get();
+void SessionState::MarkMemoryPatternGroupForGrowth(const std::vector<TensorShape>& input_shapes) const {
+  mem_patterns_.MarkForGrowth(input_shapes);
 }
 
-Status SessionState::UpdateMemoryPatternGroupCache(const std::vector<TensorShape>& input_shape,
-                                                   std::unique_ptr<MemoryPatternGroup> mem_patterns) const {
-  int64_t key = CalculateMemoryPatternsKey(input_shape);
+void SessionState::SetMemoryPatternCacheOptions(const MemoryPatternCacheOptions& options) {
+  mem_patterns_.SetOptions(options);
+}
 
-  std::lock_guard<std::mutex> lock(mem_patterns_lock_);
-  auto it = mem_patterns_.find(key);
-  if (it == mem_patterns_.end()) {
-    mem_patterns_[key] = std::move(mem_patterns);
-  }
+MemoryPatternCacheStats SessionState::GetMemoryPatternCacheStats() const {
+  return mem_patterns_.GetStats();
+}
 
-  return Status::OK();
+void SessionState::SetEnableNodeStatistics(bool flag) {
+  enable_node_statistics_ = flag;
+  node_statistics_.Resize(flag && graph_viewer_ ? graph_viewer_->MaxNodeIndex() : 0);
+}
+
+const NodeStatisticsCollector* SessionState::GetNodeStatisticsCollector() const {
+  return enable_node_statistics_ ? &node_statistics_ : nullptr;
 }
 
 void SessionState::SetEnableMemoryPattern(bool flag) {
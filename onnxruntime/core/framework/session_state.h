@@ -16,16 +16,18 @@
 #include "core/framework/execution_providers.h"
 #include "core/framework/kernel_registry_manager.h"
 #include "core/framework/mem_pattern.h"
+#include "core/framework/mem_pattern_cache.h"
 #include "core/framework/ml_value.h"
 #include "core/framework/mlvalue_name_idx_map.h"
+#include "core/framework/node_statistics.h"
 #include "core/graph/graph_viewer.h"
+#include "core/platform/threadpool.h"
 
 namespace onnxruntime {
 
 class ExecutionProviders;
 class KernelDef;
 class OpKernel;
-class TaskThreadPool;
 struct SequentialExecutionPlan;
 struct MemoryPatternGroup;
 
@@ -93,9 +95,11 @@ class SessionState {
   profiling::Profiler& Profiler() const;
 
   /**
-  Get cached memory pattern based on input shapes
+  Get cached memory pattern based on input shapes. Does not lock.
+  needs_growth is set if the pattern has to be regenerated as a previous run didn't fit in it.
   */
-  const MemoryPatternGroup* GetMemoryPatternGroup(const std::vector<TensorShape>& input_shapes) const;
+  std::shared_ptr<const MemoryPatternGroup> GetMemoryPatternGroup(const std::vector<TensorShape>& input_shapes,
+                                                                  bool* needs_growth = nullptr) const;
 
   /**
   Set generated memory pattern with a given input shapes. 
@@ -104,6 +108,31 @@ class SessionState {
   Status UpdateMemoryPatternGroupCache(const std::vector<TensorShape>& input_shape,
                                        std::unique_ptr<MemoryPatternGroup> mem_patterns) const;
 
+  /**
+  Request the memory pattern for the given input shapes to be regenerated by the next run using it.
+  */
+  void MarkMemoryPatternGroupForGrowth(const std::vector<TensorShape>& input_shapes) const;
+
+  /**
+  Set the size limits and shape bucketing of the memory pattern cache. Clears the cache.
+  */
+  void SetMemoryPatternCacheOptions(const MemoryPatternCacheOptions& options);
+
+  /**
+  Get the hit, miss and eviction counts and the size of the memory pattern cache.
+  */
+  MemoryPatternCacheStats GetMemoryPatternCacheStats() const;
+
+  /**
+  Enable the per node statistics of the kernel calls. Disabled by default.
+  */
+  void SetEnableNodeStatistics(bool flag);
+
+  /**
+  Get the collector of the per node statistics, or nullptr if they are disabled.
+  */
+  const NodeStatisticsCollector* GetNodeStatisticsCollector() const;
+
   /**
   Set enable memory pattern flag
   */
@@ -145,8 +174,13 @@ class SessionState {
   /// Return SessionState for the given Node index and attribute name if found.
   const SessionState* GetSubgraphSessionState(onnxruntime::NodeIndex index, const std::string& attribute_name) const;
 
-  TaskThreadPool* GetThreadPool() const { return thread_pool_; }
-  void SetThreadPool(TaskThreadPool* p_pool) { thread_pool_ = p_pool; }
+  /// Thread pool used by the ParallelExecutor to run independent nodes concurrently. Owned by InferenceSession.
+  concurrency::ThreadPool* GetThreadPool() const { return thread_pool_; }
+  void SetThreadPool(concurrency::ThreadPool* p_pool) { thread_pool_ = p_pool; }
+
+  /// Thread pool shared by the kernels for intra-op parallelism. Owned by InferenceSession.
+  concurrency::ThreadPool* GetIntraOpThreadPool() const { return intra_op_thread_pool_; }
+  void SetIntraOpThreadPool(concurrency::ThreadPool* p_pool) { intra_op_thread_pool_ = p_pool; }
 
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(SessionState);
@@ -166,12 +200,13 @@ class SessionState {
   const logging::Logger* logger_;
   profiling::Profiler* profiler_;
 
+  bool enable_node_statistics_ = false;
+  NodeStatisticsCollector node_statistics_;
+
   // switch for enable memory pattern optimization or not.
   bool enable_mem_pattern_ = true;
-  // lock for the mem_patterns_
-  mutable std::mutex mem_patterns_lock_;
-  // cache for the generated mem_patterns. key is calculated based on input shapes.
-  mutable std::map<int64_t, std::unique_ptr<MemoryPatternGroup>> mem_patterns_;
+  // cache for the generated mem_patterns keyed by input shapes.
+  mutable MemoryPatternCache mem_patterns_;
 
   NameNodeInfoMapType input_names_to_nodeinfo_mapping_;
   NameNodeInfoMapType output_names_to_nodeinfo_mapping_;
@@ -182,6 +217,7 @@ class SessionState {
       std::unordered_map<onnxruntime::NodeIndex,
                          std::unordered_map<std::string, gsl::not_null<const SessionState*>>>;
   SubgraphSessionStateMap subgraph_session_states_;
-  TaskThreadPool* thread_pool_ = nullptr;
+  concurrency::ThreadPool* thread_pool_ = nullptr;
+  concurrency::ThreadPool* intra_op_thread_pool_ = nullptr;
 };
 }  // namespace onnxruntime
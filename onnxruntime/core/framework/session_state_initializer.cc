@@ -3,7 +3,9 @@
 
 #include "core/framework/session_state_initializer.h"
 
+#include <algorithm>
 #include <functional>
+#include <limits>
 
 #include "core/common/common.h"
 #include "core/common/logging/logging.h"
@@ -30,7 +32,8 @@ static common::Status TransformGraph(onnxruntime::Graph& graph,
                                      const onnxruntime::GraphTransformerManager& graph_transformer_mgr,
                                      const ExecutionProviders& exec_providers,
                                      KernelRegistryManager& kernel_registry_manager,
-                                     const InsertCastTransformer& insert_cast_transformer);
+                                     const InsertCastTransformer& insert_cast_transformer,
+                                     bool graph_is_partitioned);
 
 static common::Status SaveMLValueNameIndexMapping(const onnxruntime::Graph& graph,
                                                   MLValueNameIdxMap& mlvalue_name_idx_map,
@@ -43,10 +46,18 @@ static common::Status SaveInitializedTensors(const onnxruntime::Graph& graph,
                                              const SequentialExecutionPlan& execution_plan,
                                              const ExecutionProviders& exec_providers,
                                              const MLValueNameIdxMap& mlvalue_name_idx_map,
+                                             const std::string& model_dir,
                                              std::map<OrtAllocatorInfo, BufferUniquePtr>& weights_buffers,
                                              const SaveTensorFunc& save_tensor_func,
                                              const logging::Logger& logger);
 
+static common::Status SaveStaticMemoryPatterns(const onnxruntime::Graph& graph,
+                                               const SequentialExecutionPlan& execution_plan,
+                                               const ExecutionProviders& exec_providers,
+                                               const MLValueNameIdxMap& mlvalue_name_idx_map,
+                                               const SessionState& session_state,
+                                               const logging::Logger& logger);
+
 static common::Status SaveKernels(const ExecutionProviders& execution_providers,
                                   SessionState& session_state,
                                   const KernelRegistryManager& custom_registry_manager,
@@ -71,10 +82,13 @@ SessionStateInitializer::SessionStateInitializer(onnxruntime::Graph& graph,
 common::Status SessionStateInitializer::CreatePlan(const onnxruntime::GraphTransformerManager& graph_transformation_manager,
                                                    const InsertCastTransformer& insert_cast_transformer,
                                                    const std::vector<NodeArg*>& outer_scope_node_args,
-                                                   bool enable_sequential_execution) {
+                                                   bool enable_sequential_execution,
+                                                   bool graph_is_partitioned) {
+  enable_sequential_execution_ = enable_sequential_execution;
+
   ORT_RETURN_IF_ERROR(TransformGraph(graph_, graph_transformation_manager,
                                      execution_providers_, kernel_registry_manager_,
-                                     insert_cast_transformer));
+                                     insert_cast_transformer, graph_is_partitioned));
 
   // After transformation/partitioning, the graph now is fixed and graph viewer is created and set for execution.
   session_state_.SetGraphViewer(std::make_unique<onnxruntime::GraphViewer>(graph_));
@@ -118,7 +132,8 @@ common::Status SessionStateInitializer::CreatePlan(const onnxruntime::GraphTrans
 }
 
 common::Status SessionStateInitializer::InitializeAndSave(bool enable_memory_pattern,
-                                                          std::map<OrtAllocatorInfo, BufferUniquePtr>& weights_buffers) {
+                                                          std::map<OrtAllocatorInfo, BufferUniquePtr>& weights_buffers,
+                                                          const std::string& model_dir) {
   const auto* exec_plan_ptr = session_state_.GetExecutionPlan();
   ORT_ENFORCE(exec_plan_ptr, "Execution plan was not found in SessionState. CreatePlan must be called first.");
 
@@ -131,7 +146,7 @@ common::Status SessionStateInitializer::InitializeAndSave(bool enable_memory_pat
   };
 
   ORT_RETURN_IF_ERROR(SaveInitializedTensors(graph_, enable_memory_pattern, exec_plan,
-                                             execution_providers_, mlvalue_name_idx_map, weights_buffers,
+                                             execution_providers_, mlvalue_name_idx_map, model_dir, weights_buffers,
                                              add_initialized_tensor, logger_));
 
   graph_.CleanAllInitializedTensors();  // remove weights from the graph now to save memory
@@ -139,6 +154,13 @@ common::Status SessionStateInitializer::InitializeAndSave(bool enable_memory_pat
   ORT_RETURN_IF_ERROR(SaveKernels(execution_providers_, session_state_, kernel_registry_manager_, logger_));
   ORT_RETURN_IF_ERROR(SaveInputOutputNamesToNodeMapping(graph_, kernel_registry_manager_, session_state_));
 
+  // the parallel executor doesn't follow the order of the plan, and the feeds of a subgraph include values from the
+  // outer scope, so only plan ahead for the main graph executed sequentially.
+  if (enable_memory_pattern && enable_sequential_execution_ && !graph_.IsSubgraph()) {
+    ORT_RETURN_IF_ERROR(SaveStaticMemoryPatterns(graph_, exec_plan, execution_providers_, mlvalue_name_idx_map,
+                                                 session_state_, logger_));
+  }
+
   return Status::OK();
 }
 
@@ -146,7 +168,8 @@ common::Status TransformGraph(onnxruntime::Graph& graph,
                               const onnxruntime::GraphTransformerManager& graph_transformer_mgr,
                               const ExecutionProviders& providers,
                               KernelRegistryManager& kernel_registry_manager,
-                              const InsertCastTransformer& insert_cast_transformer) {
+                              const InsertCastTransformer& insert_cast_transformer,
+                              bool graph_is_partitioned) {
   // The transformer order:
   // 1. built-in graph rewriter
   // 2. each execution provider's transformer
@@ -159,9 +182,11 @@ common::Status TransformGraph(onnxruntime::Graph& graph,
 
   auto kernels{kernel_registry_manager.GetAllKernelRegistries()};
 
-  // Do partitioning based on execution providers' capability.
-  GraphPartitioner partitioner(kernel_registry_manager, providers);
-  ORT_RETURN_IF_ERROR(partitioner.Partition(graph));
+  // Do partitioning based on execution providers' capability, unless the nodes were already assigned.
+  if (!graph_is_partitioned) {
+    GraphPartitioner partitioner(kernel_registry_manager, providers);
+    ORT_RETURN_IF_ERROR(partitioner.Partition(graph));
+  }
 
   // Insert copy nodes.
   for (auto& provider : providers) {
@@ -239,6 +264,7 @@ common::Status SaveMLValueNameIndexMapping(const onnxruntime::Graph& graph,
 common::Status DeserializeTensorProto(const ONNX_NAMESPACE::TensorProto& tensor_proto,
                                       const OrtAllocatorInfo& alloc_info,
                                       const ExecutionProviders& exec_providers,
+                                      const std::string& model_dir,
                                       MLValue& mlvalue, void* preallocated, size_t preallocated_size) {
   auto alloc_ptr = utils::GetAllocator(exec_providers, alloc_info);
   if (!alloc_ptr) {
@@ -246,6 +272,16 @@ common::Status DeserializeTensorProto(const ONNX_NAMESPACE::TensorProto& tensor_
   }
 
   if (strcmp(alloc_info.name, CPU) == 0 || alloc_info.mem_type == OrtMemTypeCPUOutput) {
+    if (utils::HasExternalData(tensor_proto)) {
+      // the CPU tensor points into the mapped file, so it is never preallocated
+      std::unique_ptr<Tensor> p_tensor;
+      ORT_RETURN_IF_ERROR(utils::GetTensorFromExternalData(tensor_proto, model_dir, alloc_ptr, &p_tensor));
+      mlvalue.Init(p_tensor.release(),
+                   DataTypeImpl::GetType<Tensor>(),
+                   DataTypeImpl::GetType<Tensor>()->GetDeleteFunc());
+      return common::Status::OK();
+    }
+
     // deserialize directly to CPU tensor
     return utils::TensorProtoToMLValue(tensor_proto, alloc_ptr, preallocated, preallocated_size, mlvalue);
   }
@@ -255,8 +291,14 @@ common::Status DeserializeTensorProto(const ONNX_NAMESPACE::TensorProto& tensor_
   AllocatorPtr deserialize_alloc_ptr;
   std::unique_ptr<Tensor> p_deserialize_tensor;
   deserialize_alloc_ptr = exec_providers.Get(kCpuExecutionProvider)->GetAllocator(0, OrtMemTypeDefault);
-  ORT_RETURN_IF_ERROR(utils::GetTensorFromTensorProto(tensor_proto, &p_deserialize_tensor,
-                                                      deserialize_alloc_ptr));
+  if (utils::HasExternalData(tensor_proto)) {
+    // copy straight from the mapped file
+    ORT_RETURN_IF_ERROR(utils::GetTensorFromExternalData(tensor_proto, model_dir, deserialize_alloc_ptr,
+                                                         &p_deserialize_tensor));
+  } else {
+    ORT_RETURN_IF_ERROR(utils::GetTensorFromTensorProto(tensor_proto, &p_deserialize_tensor,
+                                                        deserialize_alloc_ptr));
+  }
   const IExecutionProvider* provider = exec_providers.Get(alloc_info);
   ORT_ENFORCE(provider != nullptr);
   p_tensor = std::make_unique<Tensor>(
@@ -287,6 +329,8 @@ common::Status DeserializeTensorProto(const ONNX_NAMESPACE::TensorProto& tensor_
 static common::Status PlanTensor(MLValuePatternPlanner& planner, const MLValueNameIdxMap& mlvalue_name_idx_map, const std::string& name, const ONNX_NAMESPACE::TensorProto& tensor_proto) {
   int mlvalue_index;
   ORT_RETURN_IF_ERROR(mlvalue_name_idx_map.GetIdx(name, mlvalue_index));
+  // external data is mapped instead of being copied into the weights buffer
+  if (utils::HasExternalData(tensor_proto)) return Status::OK();
   size_t len;
   Status st = utils::GetSizeInBytesFromTensorProto<256>(tensor_proto, &len);
   if (st.Code() == common::NOT_IMPLEMENTED) return Status::OK();
@@ -298,6 +342,7 @@ common::Status SaveInitializedTensorsWithMemPattern(const Graph& graph,
                                                     const SequentialExecutionPlan& execution_plan,
                                                     const ExecutionProviders& exec_providers,
                                                     const MLValueNameIdxMap& mlvalue_name_idx_map,
+                                                    const std::string& model_dir,
                                                     std::map<OrtAllocatorInfo, BufferUniquePtr>& weights_buffers,
                                                     const SaveTensorFunc& save_tensor_func,
                                                     const logging::Logger& logger) {
@@ -339,28 +384,33 @@ common::Status SaveInitializedTensorsWithMemPattern(const Graph& graph,
     const ONNX_NAMESPACE::TensorProto& tensor_proto = *(entry.second);
 
     auto& location = execution_plan.allocation_plan[mlvalue_index].location;
-    auto it = weights_buffers.find(location);
-    if (it == weights_buffers.end())
-      return Status(common::ONNXRUNTIME, common::FAIL, "Weight buffer not found");
-
-    auto pattern = mem_patterns.GetPatterns(location);
-    if (pattern == nullptr)
-      return Status(common::ONNXRUNTIME, common::FAIL, "mem pattern not found");
-    auto block = pattern->GetBlock(mlvalue_index);
     MLValue mlvalue;
-    // if block is not found, means this mlvalue is not traced
-    // fall back to allocate separate buffer.
-
-    // if it->second.get() is null, then fall back to the block not found case
-    if (it->second == nullptr) {
-      block = nullptr;
-    }
     Status st;
-    if (!block) {
-      st = DeserializeTensorProto(tensor_proto, location, exec_providers, mlvalue, nullptr, 0);
+    if (utils::HasExternalData(tensor_proto)) {
+      // not traced, and there may be no weights buffer at all for its location
+      st = DeserializeTensorProto(tensor_proto, location, exec_providers, model_dir, mlvalue, nullptr, 0);
     } else {
-      st = DeserializeTensorProto(tensor_proto, location, exec_providers, mlvalue,
-                                  (uint8_t*)it->second.get() + block->offset_, block->size_);
+      auto it = weights_buffers.find(location);
+      if (it == weights_buffers.end())
+        return Status(common::ONNXRUNTIME, common::FAIL, "Weight buffer not found");
+
+      auto pattern = mem_patterns.GetPatterns(location);
+      if (pattern == nullptr)
+        return Status(common::ONNXRUNTIME, common::FAIL, "mem pattern not found");
+      auto block = pattern->GetBlock(mlvalue_index);
+      // if block is not found, means this mlvalue is not traced
+      // fall back to allocate separate buffer.
+
+      // if it->second.get() is null, then fall back to the block not found case
+      if (it->second == nullptr) {
+        block = nullptr;
+      }
+      if (!block) {
+        st = DeserializeTensorProto(tensor_proto, location, exec_providers, model_dir, mlvalue, nullptr, 0);
+      } else {
+        st = DeserializeTensorProto(tensor_proto, location, exec_providers, model_dir, mlvalue,
+                                    (uint8_t*)it->second.get() + block->offset_, block->size_);
+      }
     }
     if (!st.IsOK()) {
       std::ostringstream oss;
@@ -381,6 +431,7 @@ common::Status SaveInitializedTensorsWithSeperateBuffer(const onnxruntime::Graph
                                                         const SequentialExecutionPlan& execution_plan,
                                                         const ExecutionProviders& exec_providers,
                                                         const MLValueNameIdxMap& mlvalue_name_idx_map,
+                                                        const std::string& model_dir,
                                                         const SaveTensorFunc& save_tensor_func,
                                                         const logging::Logger& logger) {
   LOGS(logger, INFO) << "Saving initialized tensors.";
@@ -395,7 +446,8 @@ common::Status SaveInitializedTensorsWithSeperateBuffer(const onnxruntime::Graph
     VLOGS(logger, 1) << "About to add weight with name: " << name << " and index: " << mlvalue_index;
     auto& location = execution_plan.allocation_plan[mlvalue_index].location;
     MLValue mlvalue;
-    ORT_RETURN_IF_ERROR(DeserializeTensorProto(*(entry.second), location, exec_providers, mlvalue, nullptr, 0));
+    ORT_RETURN_IF_ERROR(DeserializeTensorProto(*(entry.second), location, exec_providers, model_dir, mlvalue,
+                                               nullptr, 0));
     save_tensor_func(mlvalue_index, mlvalue);
     VLOGS(logger, 1) << "Added weight with name : " << name << " with index: " << mlvalue_index;
   }
@@ -409,6 +461,7 @@ common::Status SaveInitializedTensors(const onnxruntime::Graph& graph,
                                       const SequentialExecutionPlan& execution_plan,
                                       const ExecutionProviders& exec_providers,
                                       const MLValueNameIdxMap& mlvalue_name_idx_map,
+                                      const std::string& model_dir,
                                       std::map<OrtAllocatorInfo, BufferUniquePtr>& weights_buffers,
                                       const SaveTensorFunc& save_tensor_func,
                                       const logging::Logger& logger) {
@@ -417,10 +470,140 @@ common::Status SaveInitializedTensors(const onnxruntime::Graph& graph,
   // the weights.
   if (enable_memory_pattern) {
     return SaveInitializedTensorsWithMemPattern(graph, execution_plan, exec_providers,
-                                                mlvalue_name_idx_map, weights_buffers, save_tensor_func, logger);
+                                                mlvalue_name_idx_map, model_dir, weights_buffers, save_tensor_func,
+                                                logger);
   }
   return SaveInitializedTensorsWithSeperateBuffer(graph, execution_plan, exec_providers,
-                                                  mlvalue_name_idx_map, save_tensor_func, logger);
+                                                  mlvalue_name_idx_map, model_dir, save_tensor_func, logger);
+}
+
+// get the size of a tensor from the shape inferred for it. returns false if the shape isn't fully known or the size
+// doesn't fit in a size_t.
+static bool GetStaticTensorSize(const NodeArg& node_arg, const SequentialExecutionPlan::AllocPlanPerValue& alloc_plan,
+                                size_t& size) {
+  const auto* shape_proto = node_arg.Shape();
+  if (!shape_proto) {
+    return false;
+  }
+
+  int64_t len = 1;
+  for (const auto& dim : shape_proto->dim()) {
+    if (!dim.has_dim_value() || dim.dim_value() < 0) {
+      return false;
+    }
+    if (dim.dim_value() != 0 && len > std::numeric_limits<int64_t>::max() / dim.dim_value()) {
+      return false;
+    }
+    len *= dim.dim_value();
+  }
+
+  auto element_type = static_cast<const TensorTypeBase*>(alloc_plan.value_type)->GetElementType();
+  return IAllocator::CalcMemSizeForArray(len, element_type->Size(), &size);
+}
+
+// When the shapes of the graph inputs and of every value allocated while executing the plan are known,
+// trace the allocations and frees of the plan here instead of in the first Run, and cache the resulting memory
+// pattern for the input shapes.
+common::Status SaveStaticMemoryPatterns(const onnxruntime::Graph& graph,
+                                        const SequentialExecutionPlan& execution_plan,
+                                        const ExecutionProviders& exec_providers,
+                                        const MLValueNameIdxMap& mlvalue_name_idx_map,
+                                        const SessionState& session_state,
+                                        const logging::Logger& logger) {
+  // the cache is keyed by the shapes of the feeds in the order of their MLValue indices
+  std::vector<std::pair<int, TensorShape>> inputs;
+  for (const auto* node_arg : graph.GetInputs()) {
+    int mlvalue_index;
+    ORT_RETURN_IF_ERROR(mlvalue_name_idx_map.GetIdx(node_arg->Name(), mlvalue_index));
+
+    const auto* shape_proto = node_arg->Shape();
+    if (!shape_proto) {
+      return Status::OK();
+    }
+
+    std::vector<int64_t> dims;
+    for (const auto& dim : shape_proto->dim()) {
+      if (!dim.has_dim_value()) {
+        VLOGS(logger, 1) << "Input " << node_arg->Name() << " has a dynamic shape. Memory patterns will be traced.";
+        return Status::OK();
+      }
+      dims.push_back(dim.dim_value());
+    }
+
+    inputs.emplace_back(mlvalue_index, TensorShape(dims));
+  }
+
+  std::sort(inputs.begin(), inputs.end(),
+            [](const std::pair<int, TensorShape>& lhs, const std::pair<int, TensorShape>& rhs) {
+              return lhs.first < rhs.first;
+            });
+
+  MLValuePatternPlanner planner(execution_plan, MemPatternPlanner::Strategy::kLifetime);
+  const auto& alloc_plan = execution_plan.allocation_plan;
+  for (const auto& step : execution_plan.execution_plan) {
+    const auto* node = graph.GetNode(step.node_index);
+    ORT_ENFORCE(node, "Node with index ", step.node_index, " in the execution plan was not found in the graph.");
+
+    for (const auto* node_arg : node->OutputDefs()) {
+      int mlvalue_index;
+      if (!node_arg->Exists() || !mlvalue_name_idx_map.GetIdx(node_arg->Name(), mlvalue_index).IsOK()) {
+        continue;
+      }
+
+      // graph outputs, reused buffers and non-tensor values are not in memory patterns
+      const auto& per_alloc_plan = alloc_plan[mlvalue_index];
+      if (per_alloc_plan.alloc_kind != AllocKind::kAllocate) {
+        continue;
+      }
+
+      if (!per_alloc_plan.value_type || !per_alloc_plan.value_type->IsTensorType() ||
+          static_cast<const TensorTypeBase*>(per_alloc_plan.value_type)->GetElementType() ==
+              DataTypeImpl::GetType<std::string>()) {
+        continue;
+      }
+
+      size_t size;
+      if (!GetStaticTensorSize(*node_arg, per_alloc_plan, size)) {
+        VLOGS(logger, 1) << "Size of " << node_arg->Name() << " is not known ahead of execution or overflows. "
+                         << "Memory patterns will be traced.";
+        return Status::OK();
+      }
+
+      ORT_RETURN_IF_ERROR(planner.TraceAllocation(mlvalue_index, size));
+    }
+
+    for (int i = step.free_from_index; i <= step.free_to_index; ++i) {
+      // values that were never traced are ignored by the planner
+      ORT_RETURN_IF_ERROR(planner.TraceFree(execution_plan.to_be_freed[i]));
+    }
+  }
+
+  auto mem_patterns = std::make_unique<MemoryPatternGroup>();
+  ORT_RETURN_IF_ERROR(planner.GeneratePatterns(mem_patterns.get()));
+
+  // grow the arena of each location to the peak size now so that the first Run doesn't have to
+  for (size_t i = 0; i < mem_patterns->locations.size(); i++) {
+    const auto& pattern = mem_patterns->patterns[i];
+    auto alloc = utils::GetAllocator(exec_providers, mem_patterns->locations[i]);
+    if (!alloc)
+      return Status(common::ONNXRUNTIME, common::FAIL,
+                    "Failed to get allocator for location: " + mem_patterns->locations[i].ToString());
+
+    if (pattern.PeakSize() > 0) {
+      alloc->Free(alloc->Alloc(pattern.PeakSize()));
+    }
+
+    VLOGS(logger, 1) << "Static memory pattern for " << mem_patterns->locations[i].ToString()
+                     << ": peak size " << pattern.PeakSize() << ", lower bound " << pattern.LowerBoundSize();
+  }
+
+  std::vector<TensorShape> input_shapes;
+  input_shapes.reserve(inputs.size());
+  for (auto& input : inputs) {
+    input_shapes.push_back(std::move(input.second));
+  }
+
+  return session_state.UpdateMemoryPatternGroupCache(input_shapes, std::move(mem_patterns));
 }
 
 static common::Status CreateOpKernelInternal(const onnxruntime::Node& node,
@@ -3,6 +3,7 @@
 
 #pragma once
 #include <map>
+#include <string>
 
 #include "core/framework/allocator.h"
 #include "core/framework/tensor.h"
@@ -29,15 +30,22 @@ class SessionStateInitializer {
                           const logging::Logger& logger);
 
   // First perform any transformations and create the execution plan
+  // @param graph_is_partitioned if set, every node of the graph was already assigned to an execution provider, e.g.
+  // from the optimized model cache, and the graph is not partitioned again.
   common::Status CreatePlan(const onnxruntime::GraphTransformerManager& graph_transformation_manager,
                             const InsertCastTransformer& insert_cast_transformer,
                             const std::vector<NodeArg*>& outer_scope_node_args,
-                            bool enable_sequential_execution);
+                            bool enable_sequential_execution,
+                            bool graph_is_partitioned = false);
 
   // initialize tensors, and save. save kernels and input/output node mappings
-  // @param enable_memory_pattern
+  // @param enable_memory_pattern if set, also compute the memory pattern of the main graph when all shapes
+  // are known ahead of execution.
+  // @param model_dir the directory of the model file, which relative locations of external data are resolved
+  // against. Initializers with external data on the CPU point into the mapped files instead of weights_buffers.
   common::Status InitializeAndSave(bool enable_memory_pattern,
-                                   std::map<OrtAllocatorInfo, BufferUniquePtr>& weights_buffers);
+                                   std::map<OrtAllocatorInfo, BufferUniquePtr>& weights_buffers,
+                                   const std::string& model_dir = {});
 
  private:
   onnxruntime::Graph& graph_;
@@ -46,5 +54,8 @@ class SessionStateInitializer {
   const ExecutionProviders& execution_providers_;
   KernelRegistryManager& kernel_registry_manager_;
   const logging::Logger& logger_;
+
+  // set by CreatePlan
+  bool enable_sequential_execution_ = true;
 };
 }  // namespace onnxruntime
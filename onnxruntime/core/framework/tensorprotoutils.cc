@@ -3,6 +3,8 @@
 
 #include "core/framework/tensorprotoutils.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <memory>
 #include "core/graph/onnx_protobuf.h"
 #include "core/common/logging/logging.h"
@@ -10,6 +12,7 @@
 #include "core/framework/tensorutils.h"
 #include "core/framework/tensor.h"
 #include "core/framework/ml_value_patterns_planner.h"
+#include "core/platform/env.h"
 
 using namespace ONNX_NAMESPACE;
 using namespace ::onnxruntime::common;
@@ -182,6 +185,149 @@ common::Status GetTensorFromTensorProto(const TensorProto& tensor_proto,
   }
 }
 
+bool HasExternalData(const ONNX_NAMESPACE::TensorProto& tensor_proto) {
+  return tensor_proto.data_location() == TensorProto_DataLocation_EXTERNAL;
+}
+
+namespace {
+// The deleter of a tensor over mapped external data. It never allocates, and releasing the buffer of the tensor
+// unmaps the file.
+class MappedExternalData : public IAllocator {
+ public:
+  MappedExternalData(Env::MappedMemoryPtr mapped_memory, const OrtAllocatorInfo& info)
+      : mapped_memory_{std::move(mapped_memory)}, info_{info} {}
+
+  void* Alloc(size_t /*size*/) override { ORT_THROW("External data can not be allocated from."); }
+  void Free(void* /*p*/) override { mapped_memory_.reset(); }
+  const OrtAllocatorInfo& Info() const override { return info_; }
+
+ private:
+  Env::MappedMemoryPtr mapped_memory_;
+  const OrtAllocatorInfo info_;
+};
+
+Status ParseExternalDataSize(const TensorProto& tensor_proto, const std::string& value, size_t& size) {
+  char* end = nullptr;
+  const unsigned long long parsed = std::strtoull(value.c_str(), &end, 10);
+  if (value.empty() || *end != '\0') {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Invalid offset or length '", value,
+                           "' in the external data of tensor ", tensor_proto.name());
+  }
+  size = static_cast<size_t>(parsed);
+  return Status::OK();
+}
+
+bool IsAbsolutePath(const std::string& path) {
+#ifdef _WIN32
+  return (!path.empty() && (path[0] == '/' || path[0] == '\\')) || (path.size() > 1 && path[1] == ':');
+#else
+  return !path.empty() && path[0] == '/';
+#endif
+}
+
+bool HasParentDirectoryComponent(const std::string& path) {
+  size_t begin = 0;
+  while (begin <= path.size()) {
+    size_t end = path.find_first_of("/\\", begin);
+    if (end == std::string::npos) {
+      end = path.size();
+    }
+    if (path.compare(begin, end - begin, "..") == 0) {
+      return true;
+    }
+    begin = end + 1;
+  }
+  return false;
+}
+}  // namespace
+
+#define CASE_ELEMENT_TYPE(X, Y)                                        \
+  case ONNX_NAMESPACE::TensorProto_DataType::TensorProto_DataType_##X: \
+    element_type = DataTypeImpl::GetType<Y>();                        \
+    break;
+
+common::Status GetTensorFromExternalData(const ONNX_NAMESPACE::TensorProto& tensor_proto, const std::string& model_dir,
+                                         AllocatorPtr allocator, std::unique_ptr<Tensor>* p_tensor) {
+  MLDataType element_type = nullptr;
+  switch (tensor_proto.data_type()) {
+    CASE_ELEMENT_TYPE(FLOAT, float);
+    CASE_ELEMENT_TYPE(DOUBLE, double);
+    CASE_ELEMENT_TYPE(BOOL, bool);
+    CASE_ELEMENT_TYPE(INT8, int8_t);
+    CASE_ELEMENT_TYPE(INT16, int16_t);
+    CASE_ELEMENT_TYPE(INT32, int32_t);
+    CASE_ELEMENT_TYPE(INT64, int64_t);
+    CASE_ELEMENT_TYPE(UINT8, uint8_t);
+    CASE_ELEMENT_TYPE(UINT16, uint16_t);
+    CASE_ELEMENT_TYPE(UINT32, uint32_t);
+    CASE_ELEMENT_TYPE(UINT64, uint64_t);
+    CASE_ELEMENT_TYPE(FLOAT16, MLFloat16);
+    default:
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Tensor ", tensor_proto.name(),
+                             " has external data of unsupported type ", tensor_proto.data_type());
+  }
+
+  std::string location;
+  size_t offset = 0;
+  size_t length = 0;
+  bool has_length = false;
+  for (const auto& entry : tensor_proto.external_data()) {
+    if (entry.key() == "location") {
+      location = entry.value();
+    } else if (entry.key() == "offset") {
+      ORT_RETURN_IF_ERROR(ParseExternalDataSize(tensor_proto, entry.value(), offset));
+    } else if (entry.key() == "length") {
+      ORT_RETURN_IF_ERROR(ParseExternalDataSize(tensor_proto, entry.value(), length));
+      has_length = true;
+    }
+  }
+  if (location.empty()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Tensor ", tensor_proto.name(),
+                           " has external data without a location");
+  }
+
+  TensorShape tensor_shape{GetTensorShapeFromTensorProto(tensor_proto)};
+  size_t size;
+  if (tensor_shape.Size() < 0 ||
+      !IAllocator::CalcMemSizeForArray(static_cast<size_t>(tensor_shape.Size()), element_type->Size(), &size)) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Invalid shape ", tensor_shape, " of tensor ",
+                           tensor_proto.name());
+  }
+  if (has_length && length != size) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Tensor ", tensor_proto.name(), " of shape ", tensor_shape,
+                           " needs ", size, " bytes of external data, got ", length);
+  }
+
+  // the data has to be next to the model, a model must not be able to read any file of the host
+  if (IsAbsolutePath(location) || HasParentDirectoryComponent(location)) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Tensor ", tensor_proto.name(),
+                           " has external data outside of the model directory: ", location);
+  }
+
+  const std::string path = model_dir.empty() ? location : model_dir + "/" + location;
+  Env::MappedMemoryPtr mapped_memory;
+  ORT_RETURN_IF_ERROR(Env::Default().MapFileIntoMemory(path, offset, size, mapped_memory));
+
+  // the elements can be used in place if they are little endian, like raw_data, and suitably aligned
+  const uint16_t one = 1;
+  if (mapped_memory && *reinterpret_cast<const char*>(&one) == 1 &&
+      reinterpret_cast<uintptr_t>(mapped_memory.get()) % element_type->Size() == 0) {
+    void* p_data = mapped_memory.get();
+    auto deleter = std::make_shared<MappedExternalData>(std::move(mapped_memory), allocator->Info());
+    *p_tensor = std::make_unique<Tensor>(element_type, tensor_shape, p_data, allocator->Info(), deleter);
+    return Status::OK();
+  }
+
+  // otherwise read them like data stored in the model
+  TensorProto tensor_proto_with_data{tensor_proto};
+  tensor_proto_with_data.clear_external_data();
+  tensor_proto_with_data.set_data_location(TensorProto_DataLocation_DEFAULT);
+  if (mapped_memory) {
+    tensor_proto_with_data.set_raw_data(mapped_memory.get(), size);
+  }
+  return GetTensorFromTensorProto(tensor_proto_with_data, p_tensor, allocator);
+}
+
 TensorProto::DataType GetTensorProtoType(const Tensor& tensor) {
   auto tensor_type = tensor.DataType();
   TensorProto::DataType dtype = TensorProto_DataType_UNDEFINED;
@@ -212,5 +358,48 @@ TensorProto::DataType GetTensorProtoType(const Tensor& tensor) {
   return dtype;
 }
 
+common::Status TensorToTensorProto(const Tensor& tensor, const std::string& tensor_name,
+                                   ONNX_NAMESPACE::TensorProto& tensor_proto) {
+  TensorProto::DataType dtype = GetTensorProtoType(tensor);
+  if (tensor.DataType() == DataTypeImpl::GetType<MLFloat16>()) {
+    dtype = TensorProto_DataType_FLOAT16;
+  } else if (tensor.DataType() == DataTypeImpl::GetType<std::string>()) {
+    dtype = TensorProto_DataType_STRING;
+  }
+
+  if (dtype == TensorProto_DataType_UNDEFINED) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Tensor ", tensor_name,
+                           " has a type that can not be converted to a TensorProto");
+  }
+
+  tensor_proto.Clear();
+  tensor_proto.set_name(tensor_name);
+  tensor_proto.set_data_type(dtype);
+  for (auto dim : tensor.Shape().GetDims()) {
+    tensor_proto.add_dims(dim);
+  }
+
+  if (dtype == TensorProto_DataType_STRING) {
+    for (const auto& str : tensor.DataAsSpan<std::string>()) {
+      tensor_proto.add_string_data(str);
+    }
+    return Status::OK();
+  }
+
+  // raw_data holds the elements in little endian order, which UnpackTensor converts back from
+  const char* data = static_cast<const char*>(tensor.DataRaw());
+  const size_t element_size = tensor.DataType()->Size();
+  std::string* raw_data = tensor_proto.mutable_raw_data();
+  raw_data->assign(data, tensor.Size());
+  const uint16_t one = 1;
+  if (*reinterpret_cast<const char*>(&one) != 1) {
+    for (size_t i = 0; i < raw_data->size(); i += element_size) {
+      std::reverse(raw_data->begin() + i, raw_data->begin() + i + element_size);
+    }
+  }
+
+  return Status::OK();
+}
+
 }  // namespace utils
 }  // namespace onnxruntime
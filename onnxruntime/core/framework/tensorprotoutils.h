@@ -24,6 +24,19 @@ std::vector<int64_t> GetTensorShapeFromTensorProto(const ONNX_NAMESPACE::TensorP
 std::vector<int64_t> GetTensorShapeFromTensorShapeProto(const ONNX_NAMESPACE::TensorShapeProto& tensor_shape_proto);
 common::Status TensorProtoToMLValue(const ONNX_NAMESPACE::TensorProto& input, AllocatorPtr allocator, void* preallocated,
                                     size_t preallocated_size, MLValue& value);
+// Whether the data of tensor_proto is stored in a file of its own instead of in the model, see
+// https://github.com/onnx/onnx/blob/master/docs/ExternalData.md
+bool HasExternalData(const ONNX_NAMESPACE::TensorProto& tensor_proto);
+// Create a CPU tensor over the external data of tensor_proto, whose location is relative to model_dir unless
+// it is absolute. The data is mapped into memory and used in place, so it isn't copied and its pages are shared
+// with other processes mapping the same file; the mapping is released with the tensor. Data that can't be
+// used in place, e.g. on a big endian host, is copied into a buffer from allocator.
+common::Status GetTensorFromExternalData(const ONNX_NAMESPACE::TensorProto& tensor_proto, const std::string& model_dir,
+                                         AllocatorPtr allocator, std::unique_ptr<Tensor>* p_tensor);
 ONNX_NAMESPACE::TensorProto::DataType GetTensorProtoType(const Tensor& tensor);
+// Create a TensorProto named tensor_name with the shape and data of a CPU tensor, e.g. to turn a computed value
+// into an initializer. Numeric data is stored in raw_data, strings in string_data.
+common::Status TensorToTensorProto(const Tensor& tensor, const std::string& tensor_name,
+                                   ONNX_NAMESPACE::TensorProto& tensor_proto);
 }  // namespace utils
 }  // namespace onnxruntime
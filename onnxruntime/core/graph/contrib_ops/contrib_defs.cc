@@ -95,6 +95,32 @@ activation.)DOC")
         ONNX_NAMESPACE::convPoolTypeAndShapeInference(ctx, false, true);
       });
 
+  ONNX_CONTRIB_OPERATOR_SCHEMA(FusedElementwise)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(
+A chain of element-wise operators evaluated in a single pass. The chain starts from the first input and each
+operator in ops is applied in turn to the result so far. A binary operator takes its other operand from the
+input given by operands, which is broadcast to the shape of the first input.)DOC")
+      .Attr(
+          "ops",
+          "Operator types of the chain in the order they are applied.",
+          AttributeProto::STRINGS)
+      .Attr(
+          "operands",
+          "For each operator, the index of the input that is its other operand, or -1 for a unary operator.",
+          AttributeProto::INTS)
+      .Attr(
+          "operand_first",
+          "For each operator, 1 if its other operand is its first input, e.g. the numerator of a Div.",
+          AttributeProto::INTS,
+          OPTIONAL)
+      .Input(0, "inputs", "The start of the chain followed by the other operands of its binary operators.", "T",
+             OpSchema::Variadic)
+      .Output(0, "Y", "Result of the chain, with the shape of the first input.", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors.")
+      .TypeAndShapeInferenceFunction(ONNX_NAMESPACE::propagateShapeAndTypeFromFirstInput);
+
   ONNX_CONTRIB_OPERATOR_SCHEMA(ExpandDims)
       .SetDomain(kMSDomain)
       .SinceVersion(1)
@@ -22,7 +22,15 @@ Status ConvActivationFusion::Apply(Graph& graph, bool& modified) const {
   std::vector<onnxruntime::NodeIndex> removed_nodes;
   for (auto index : order) {
     auto node = graph.GetNode(index);
-    if (!utils::IsSupportedOptypeVersionAndDomain(*node, "Conv", 1) || node->GetOutputEdgesCount() != 1) {
+    if (!utils::IsSupportedOptypeVersionAndDomain(*node, "Conv", 1) || node->GetOutputEdgesCount() != 1 ||
+        graph.IsNodeOutputsInGraphOutputs(*node)) {
+      continue;
+    }
+
+    // FusedConv only has a CPU kernel, for float
+    const TypeProto* type = node->OutputDefs()[0]->TypeAsProto();
+    if ((!node->GetExecutionProviderType().empty() && node->GetExecutionProviderType() != kCpuExecutionProvider) ||
+        type == nullptr || type->tensor_type().elem_type() != TensorProto_DataType_FLOAT) {
       continue;
     }
     const Node& next_node = *(node->OutputNodesBegin());
@@ -42,7 +50,7 @@ Status ConvActivationFusion::Apply(Graph& graph, bool& modified) const {
                                      "com.microsoft");
 
     //Add a new attribute to specify the activation type
-    fused_conv.AddAttribute("activation", "string");
+    fused_conv.AddAttribute("activation", act_node.OpType());
 
     //Add optional attributes for activations
     if (act_node.OpType() == "LeakyRelu") {
@@ -29,6 +29,19 @@ Status ConvAddFusion::Apply(onnxruntime::Graph& graph, bool& modified) const {
     const auto& conv_inputs = conv_node.InputDefs();
     const auto& add_inputs = add_node.InputDefs();
 
+    // every value the fusion reads is folded into the bias, so none of them may be overridden by a feed
+    if (!utils::IsConstantInitializer(graph, *conv_inputs[1]) ||
+        (conv_inputs.size() == 3 && !utils::IsConstantInitializer(graph, *conv_inputs[2])) ||
+        !utils::IsConstantInitializer(graph, *add_inputs[1])) {
+      continue;
+    }
+
+    // the bias of the Conv, or the operand of the Add that becomes the bias, is rewritten in place,
+    // so it must not be shared with other nodes
+    if (!utils::IsUsedByOneNode(graph, conv_inputs.size() == 3 ? *conv_inputs[2] : *add_inputs[1])) {
+      continue;
+    }
+
     const ONNX_NAMESPACE::TensorProto* conv_W_tensor_proto = nullptr;
     graph.GetInitializedTensor(conv_inputs[1]->Name(), conv_W_tensor_proto);
 
@@ -37,6 +50,7 @@ Status ConvAddFusion::Apply(onnxruntime::Graph& graph, bool& modified) const {
 
     // Currently, fusion is only supported for float or double data type.
     if (!Initializer::IsSupportedDataType(add_B_tensor_proto) ||
+        conv_W_tensor_proto == nullptr ||
         conv_W_tensor_proto->dims_size() < 4 ||
         add_B_tensor_proto->dims_size() != conv_W_tensor_proto->dims_size() - 1 ||
         conv_W_tensor_proto->dims(0) != add_B_tensor_proto->dims(0)) {
@@ -28,20 +28,24 @@ Status ConvBNFusion::Apply(onnxruntime::Graph& graph, bool& modified) const {
 
     // Get value of attribute group
     const onnxruntime::NodeAttributes& conv_attributes = conv_node.GetAttributes();
-    const onnx::AttributeProto* group_attr = &(conv_attributes.find("group")->second);
-    if (group_attr != nullptr &&
-        group_attr->type() == AttributeProto_AttributeType_INT &&
-        group_attr->has_i() && group_attr->i() != 1) {
+    auto group_attr = conv_attributes.find("group");
+    if (group_attr != conv_attributes.end() &&
+        group_attr->second.type() == AttributeProto_AttributeType_INT &&
+        group_attr->second.has_i() && group_attr->second.i() != 1) {
       continue;
     }
 
     // Get value of attribute epsilon
     const onnxruntime::NodeAttributes& attributes = bn_node.GetAttributes();
-    const onnx::AttributeProto* attr = &(attributes.find("epsilon")->second);
-    if (attr == nullptr || attr->type() != AttributeProto_AttributeType_FLOAT) {
-      continue;
+    // epsilon defaults to 1e-5 when the attribute is missing
+    float epsilon = 1e-5f;
+    auto epsilon_attr = attributes.find("epsilon");
+    if (epsilon_attr != attributes.end()) {
+      if (epsilon_attr->second.type() != AttributeProto_AttributeType_FLOAT) {
+        continue;
+      }
+      epsilon = static_cast<float>(epsilon_attr->second.f());
     }
-    float epsilon = static_cast<float>(attr->f());
 
     // Get initializers of BatchNormalization
     const auto& bn_inputs = bn_node.InputDefs();
@@ -58,6 +62,22 @@ Status ConvBNFusion::Apply(onnxruntime::Graph& graph, bool& modified) const {
     graph.GetInitializedTensor(bn_inputs[4]->Name(), bn_var_tensor_proto);
 
     const auto& conv_inputs = conv_node.InputDefs();
+    // every value the fusion reads is folded into the weights, so none of them may be overridden by a feed
+    if (!utils::IsConstantInitializer(graph, *conv_inputs[1]) ||
+        (conv_inputs.size() == 3 && !utils::IsConstantInitializer(graph, *conv_inputs[2])) ||
+        !utils::IsConstantInitializer(graph, *bn_inputs[1]) ||
+        !utils::IsConstantInitializer(graph, *bn_inputs[2]) ||
+        !utils::IsConstantInitializer(graph, *bn_inputs[3]) ||
+        !utils::IsConstantInitializer(graph, *bn_inputs[4])) {
+      continue;
+    }
+
+    // the weights and bias of the Conv are rewritten in place, so they must not be shared with other nodes
+    if (!utils::IsUsedByOneNode(graph, *conv_inputs[1]) ||
+        !utils::IsUsedByOneNode(graph, conv_inputs.size() == 3 ? *conv_inputs[2] : *bn_inputs[2])) {
+      continue;
+    }
+
     const ONNX_NAMESPACE::TensorProto* conv_W_tensor_proto = nullptr;
     graph.GetInitializedTensor(conv_inputs[1]->Name(), conv_W_tensor_proto);
 
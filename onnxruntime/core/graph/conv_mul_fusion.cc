@@ -29,6 +29,19 @@ Status ConvMulFusion::Apply(onnxruntime::Graph& graph, bool& modified) const {
     const auto& conv_inputs = conv_node.InputDefs();
     const auto& mul_inputs = mul_node.InputDefs();
 
+    // every value the fusion reads is folded into the weights, so none of them may be overridden by a feed
+    if (!utils::IsConstantInitializer(graph, *conv_inputs[1]) ||
+        (conv_inputs.size() == 3 && !utils::IsConstantInitializer(graph, *conv_inputs[2])) ||
+        !utils::IsConstantInitializer(graph, *mul_inputs[1])) {
+      continue;
+    }
+
+    // the weights and bias of the Conv are rewritten in place, so they must not be shared with other nodes
+    if (!utils::IsUsedByOneNode(graph, *conv_inputs[1]) ||
+        (conv_inputs.size() == 3 && !utils::IsUsedByOneNode(graph, *conv_inputs[2]))) {
+      continue;
+    }
+
     const ONNX_NAMESPACE::TensorProto* conv_W_tensor_proto = nullptr;
     graph.GetInitializedTensor(conv_inputs[1]->Name(), conv_W_tensor_proto);
 
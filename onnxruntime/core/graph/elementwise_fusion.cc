@@ -0,0 +1,207 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/graph/elementwise_fusion.h"
+#include "core/graph/graph_utils.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+using namespace onnx;
+using namespace ::onnxruntime::common;
+namespace onnxruntime {
+
+namespace {
+// operators FusedElementwise evaluates, with the version of the schema they must have
+bool IsFusableElementwise(const Node& node) {
+  static const std::vector<std::pair<std::string, ONNX_NAMESPACE::OperatorSetVersion>> fusable_ops{
+      {"Add", 7}, {"Sub", 7}, {"Mul", 7}, {"Div", 7}, {"Pow", 7}, {"Abs", 6}, {"Exp", 6}, {"Log", 6},
+      {"Neg", 6}, {"Reciprocal", 6}, {"Relu", 6}, {"Sigmoid", 6}, {"Sqrt", 6}, {"Tanh", 6}};
+
+  if (!node.GetExecutionProviderType().empty() && node.GetExecutionProviderType() != kCpuExecutionProvider) {
+    return false;
+  }
+
+  const TypeProto* type = node.OutputDefs()[0]->TypeAsProto();
+  if (type == nullptr || type->tensor_type().elem_type() != TensorProto_DataType_FLOAT) {
+    return false;
+  }
+
+  for (const auto& op : fusable_ops) {
+    if (utils::IsSupportedOptypeVersionAndDomain(node, op.first, op.second)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool IsDimOne(const TensorShapeProto_Dimension& dim) {
+  return dim.has_dim_value() && dim.dim_value() == 1;
+}
+
+bool DimsEqual(const TensorShapeProto_Dimension& dim1, const TensorShapeProto_Dimension& dim2) {
+  if (dim1.has_dim_value() && dim2.has_dim_value()) {
+    return dim1.dim_value() == dim2.dim_value();
+  }
+  return dim1.has_dim_param() && dim2.has_dim_param() && dim1.dim_param() == dim2.dim_param();
+}
+
+bool ShapesEqual(const TensorShapeProto* shape1, const TensorShapeProto& shape2) {
+  if (shape1 == nullptr || shape1->dim_size() != shape2.dim_size()) {
+    return false;
+  }
+
+  for (int i = 0; i < shape2.dim_size(); ++i) {
+    if (!DimsEqual(shape1->dim(i), shape2.dim(i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Whether FusedElementwise can broadcast an operand to the shape of the chain: the dimensions of the operand
+// that are not 1 must be one run of the dimensions of the chain.
+bool CanBroadcastOperand(const TensorShapeProto* operand, const TensorShapeProto& shape) {
+  if (operand == nullptr || operand->dim_size() > shape.dim_size()) {
+    return false;
+  }
+
+  bool in_run = false;
+  bool past_run = false;
+  for (int i = shape.dim_size(); i-- > 0;) {
+    const int operand_i = i - (shape.dim_size() - operand->dim_size());
+    const bool operand_one = operand_i < 0 || IsDimOne(operand->dim(operand_i));
+    if (IsDimOne(shape.dim(i))) {
+      if (!operand_one) {
+        return false;
+      }
+      continue;
+    }
+
+    if (operand_one) {
+      past_run = in_run;
+    } else {
+      if (past_run || !DimsEqual(operand->dim(operand_i), shape.dim(i))) {
+        return false;
+      }
+      in_run = true;
+    }
+  }
+  return true;
+}
+
+// index of the input of the first node of a chain that the chain starts from, or -1 if there is none
+int ChainStartIndex(const Node& node, const TensorShapeProto& shape) {
+  const auto& input_defs = node.InputDefs();
+  for (int i = 0; i < static_cast<int>(input_defs.size()); ++i) {
+    if (ShapesEqual(input_defs[i]->Shape(), shape) &&
+        (input_defs.size() == 1 || CanBroadcastOperand(input_defs[1 - i]->Shape(), shape))) {
+      return i;
+    }
+  }
+  return -1;
+}
+}  // namespace
+
+Status ElementwiseFusion::Apply(Graph& graph, bool& modified) const {
+  GraphViewer graph_viewer(graph);
+  const auto& order = graph_viewer.GetNodesInTopologicalOrder();
+
+  std::unordered_set<NodeIndex> fused_nodes;
+  std::vector<onnxruntime::NodeIndex> removed_nodes;
+  for (auto index : order) {
+    Node* node = graph.GetNode(index);
+    if (fused_nodes.count(index) != 0 || !IsFusableElementwise(*node)) {
+      continue;
+    }
+
+    const TensorShapeProto* shape = node->OutputDefs()[0]->Shape();
+    if (shape == nullptr) {
+      continue;
+    }
+
+    const int start_index = ChainStartIndex(*node, *shape);
+    if (start_index < 0) {
+      continue;
+    }
+
+    // follow the chain while each output goes only to the next element-wise node, which keeps the shape
+    std::vector<Node*> chain{node};
+    std::vector<int> chain_input_indexes{start_index};
+    Node* last = node;
+    while (last->GetOutputEdgesCount() == 1 && !graph.IsNodeOutputsInGraphOutputs(*last)) {
+      Node* next = graph.GetNode(last->OutputNodesBegin()->Index());
+      if (fused_nodes.count(next->Index()) != 0 || !IsFusableElementwise(*next) ||
+          !ShapesEqual(next->OutputDefs()[0]->Shape(), *shape)) {
+        break;
+      }
+
+      const auto& input_defs = next->InputDefs();
+      const NodeArg* last_output = last->OutputDefs()[0];
+      const int input_index = input_defs[0] == last_output ? 0 : 1;
+      if (input_defs[input_index] != last_output ||
+          (input_defs.size() == 2 && (input_defs[1 - input_index] == last_output ||
+                                      !CanBroadcastOperand(input_defs[1 - input_index]->Shape(), *shape)))) {
+        break;
+      }
+
+      chain.push_back(next);
+      chain_input_indexes.push_back(input_index);
+      last = next;
+    }
+
+    if (chain.size() < 2) {
+      continue;
+    }
+
+    // the fused node takes the start of the chain, then each distinct operand of the binary operators
+    std::vector<NodeArg*> input_args{chain[0]->MutableInputDefs()[start_index]};
+    std::vector<std::string> ops;
+    std::vector<int64_t> operands;
+    std::vector<int64_t> operand_first;
+    for (size_t i = 0; i < chain.size(); ++i) {
+      Node& chain_node = *chain[i];
+      ops.push_back(chain_node.OpType());
+      if (chain_node.InputDefs().size() == 1) {
+        operands.push_back(-1);
+        operand_first.push_back(0);
+        continue;
+      }
+
+      const int operand_index = 1 - chain_input_indexes[i];
+      NodeArg* operand = chain_node.MutableInputDefs()[operand_index];
+      auto it = std::find(input_args.begin(), input_args.end(), operand);
+      if (it == input_args.end()) {
+        it = input_args.insert(input_args.end(), operand);
+      }
+      operands.push_back(it - input_args.begin());
+      operand_first.push_back(operand_index == 0 ? 1 : 0);
+    }
+
+    Node& fused_node = graph.AddNode(graph.GenerateNodeName("fused " + chain[0]->Name()), "FusedElementwise",
+                                     "fused element-wise chain from " + chain[0]->Name() + " to " + last->Name(),
+                                     input_args,
+                                     last->MutableOutputDefs(),
+                                     nullptr,
+                                     kMSDomain);
+    fused_node.AddAttribute("ops", ops);
+    fused_node.AddAttribute("operands", operands);
+    fused_node.AddAttribute("operand_first", operand_first);
+
+    for (Node* chain_node : chain) {
+      fused_nodes.insert(chain_node->Index());
+      removed_nodes.push_back(chain_node->Index());
+    }
+  }
+
+  for (auto i : removed_nodes) {
+    graph.RemoveNode(i);
+  }
+
+  if (!removed_nodes.empty()) {
+    modified = true;
+    ORT_RETURN_IF_ERROR(graph.Resolve());
+  }
+  return Status::OK();
+}
+}  // namespace onnxruntime
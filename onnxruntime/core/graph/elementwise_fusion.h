@@ -0,0 +1,23 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/graph/graph_transformer.h"
+
+namespace onnxruntime {
+
+/**
+@class ElementwiseFusion
+Replace each chain of two or more float element-wise operators, e.g. Mul->Add->Sigmoid->Mul, with one
+FusedElementwise node that evaluates the chain in a single pass over its output.
+A chain follows the output of each operator into the only node that consumes it. The other operand of
+a binary operator may be broadcast, as long as it does not change the shape of the chain.
+*/
+class ElementwiseFusion : public onnxruntime::GraphTransformer {
+ public:
+  ElementwiseFusion() noexcept : onnxruntime::GraphTransformer("ElementwiseFusion", "Fusing chains of element-wise operators") {}
+  Status Apply(onnxruntime::Graph& graph, bool& modified) const override;
+};
+
+}  // namespace onnxruntime
@@ -1921,6 +1921,19 @@ void Graph::CleanAllInitializedTensors() noexcept {
   }
 }
 
+void Graph::ReleaseGraphProtoNodes() noexcept {
+  // swap the content out instead of clearing it, as cleared elements keep their memory for reuse
+  RepeatedPtrField<NodeProto>().Swap(graph_proto_->mutable_node());
+  RepeatedPtrField<ValueInfoProto>().Swap(graph_proto_->mutable_value_info());
+  GraphProtoSyncNeeded(true);
+
+  for (auto& node : Nodes()) {
+    for (auto& subgraph : node.MutableSubgraphs()) {
+      subgraph->ReleaseGraphProtoNodes();
+    }
+  }
+}
+
 const InitializedTensorSet& Graph::GetAllInitializedTensors() const noexcept {
   return name_to_initial_tensor_;
 }
@@ -2,11 +2,38 @@
 // Licensed under the MIT License.
 
 #include "core/graph/graph_transformer_mgr.h"
+#include "core/graph/conv_activation_fusion.h"
+#include "core/graph/conv_add_fusion.h"
+#include "core/graph/conv_bn_fusion.h"
+#include "core/graph/conv_mul_fusion.h"
+#include "core/graph/elementwise_fusion.h"
+#include "core/graph/identity_elimination.h"
+#include "core/graph/unsqueeze_elimination.h"
 using namespace onnxruntime;
 using namespace ::onnxruntime::common;
 
 namespace onnxruntime {
 
+GraphTransformerManager::GraphTransformerManager(unsigned steps, TransformerLevel level) : steps_(steps) {
+  if (level >= TransformerLevel::Basic) {
+    // remove the Unsqueeze and Identity nodes first so that the Conv fusions see the initializers directly
+    transformers_.push_back(std::make_unique<UnsqueezeElimination>());
+    auto identity_elimination = std::make_unique<TopDownRuleBasedTransformer>("IdentityElimination",
+                                                                               "Eliminate Identity nodes");
+    identity_elimination->Register("Identity", std::make_unique<EliminateIdentity>());
+    transformers_.push_back(std::move(identity_elimination));
+    transformers_.push_back(std::make_unique<ConvBNFusion>());
+    transformers_.push_back(std::make_unique<ConvMulFusion>());
+    transformers_.push_back(std::make_unique<ConvAddFusion>());
+  }
+
+  if (level >= TransformerLevel::Extended) {
+    // the activation goes into the Conv before what is left is fused into element-wise chains
+    transformers_.push_back(std::make_unique<ConvActivationFusion>());
+    transformers_.push_back(std::make_unique<ElementwiseFusion>());
+  }
+}
+
 Status GraphTransformerManager::ApplyAll(Graph& graph) const {
   for (unsigned step = 0; step < steps_; ++step) {
     bool changed = false;
@@ -6,13 +6,24 @@
 #include "core/graph/graph_transformer.h"
 
 namespace onnxruntime {
-// Manages a list of graph transformers. It is initialized with a list of graph
-// transformers. Each inference session can further register additional ones.
+
+// Levels of the built-in graph optimizations. Each level also applies the transformers of the levels below it.
+enum class TransformerLevel : uint32_t {
+  // only the transformers registered by the caller
+  None = 0,
+  // rewrites that keep to ONNX operators: removing Identity nodes and Unsqueeze of initializers, and folding
+  // BatchNormalization, Mul and Add into the weights of the Conv before them
+  Basic = 1,
+  // fusions into com.microsoft operators that have CPU kernels: FusedConv and FusedElementwise
+  Extended = 2,
+  MaxLevel = Extended
+};
+
+// Manages a list of graph transformers. It is initialized with the built-in transformers of an optimization
+// level. Each inference session can further register additional ones, which run after the built-in ones.
 class GraphTransformerManager {
  public:
-  explicit GraphTransformerManager(unsigned steps) noexcept : steps_(steps) {
-    // TODO: Register default transformers.
-  }
+  explicit GraphTransformerManager(unsigned steps, TransformerLevel level = TransformerLevel::None);
 
   // Register a graph transformer.
   common::Status Register(std::unique_ptr<GraphTransformer> transformer) {
@@ -1,5 +1,6 @@
 
 #include "core/graph/graph_utils.h"
+#include <algorithm>
 
 namespace onnxruntime {
 
@@ -16,6 +17,35 @@ namespace utils {
     }
     return true;
   }
+
+  bool IsUsedByOneNode(const Graph& graph, const NodeArg& node_arg) {
+    const auto& graph_outputs = graph.GetOutputs();
+    if (std::find(graph_outputs.cbegin(), graph_outputs.cend(), &node_arg) != graph_outputs.cend()) {
+      return false;
+    }
+
+    int uses = 0;
+    for (const auto& node : graph.Nodes()) {
+      for (const auto* input_def : node.InputDefs()) {
+        uses += input_def == &node_arg;
+      }
+      for (const auto* input_def : node.ImplicitInputDefs()) {
+        uses += input_def == &node_arg;
+      }
+    }
+    return uses == 1;
+  }
+
+  bool IsConstantInitializer(const Graph& graph, const NodeArg& node_arg) {
+    const ONNX_NAMESPACE::TensorProto* initializer = nullptr;
+    if (!graph.GetInitializedTensor(node_arg.Name(), initializer)) {
+      return false;
+    }
+
+    const auto& graph_inputs = graph.GetInputsIncludingInitializers();
+    return std::none_of(graph_inputs.cbegin(), graph_inputs.cend(),
+                        [&node_arg](const NodeArg* input) { return input->Name() == node_arg.Name(); });
+  }
 }
 
 }  // namespace onnxruntime
\ No newline at end of file
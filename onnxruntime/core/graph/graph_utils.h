@@ -13,6 +13,15 @@ namespace utils {
                                          const std::string& op_type,
                                          ONNX_NAMESPACE::OperatorSetVersion version,
                                          const std::string& domain = kOnnxDomainAlias);
+
+  // Whether node_arg is read by a single node and is not a graph output,
+  // so that a transformer may rewrite its value for that node.
+  bool IsUsedByOneNode(const Graph& graph, const NodeArg& node_arg);
+
+  // Whether node_arg is an initializer that is not also a graph input. An initializer listed
+  // in the graph inputs is only a default value that a feed can override, so transformers must
+  // not read or rewrite it.
+  bool IsConstantInitializer(const Graph& graph, const NodeArg& node_arg);
 }
 
 }
\ No newline at end of file
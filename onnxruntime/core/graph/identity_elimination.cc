@@ -10,6 +10,11 @@
 namespace onnxruntime {
 
 Status EliminateIdentity::Apply(Graph& graph_editor, Node& node, bool& modified) {
+  // The output of the Identity has to keep being produced under its name if the graph returns it.
+  if (graph_editor.IsNodeOutputsInGraphOutputs(node)) {
+    return Status::OK();
+  }
+
   std::map<const NodeArg*, NodeArg*> replacement_defs;
   auto id_input = node.InputDefs()[0];
   auto id_output = node.OutputDefs()[0];
@@ -24,6 +29,7 @@ Status EliminateIdentity::Apply(Graph& graph_editor, Node& node, bool& modified)
 
   // Remove the Identity node.
   graph_editor.RemoveNode(node.Index());
+  modified = true;
 
   // TODO: Make sure resolve is not required here.
   //ORT_RETURN_IF_ERROR(graph_editor->Resolve());
@@ -15,7 +15,9 @@ namespace onnxruntime {
 class Initializer final {
  public:
   static bool IsSupportedDataType(const ONNX_NAMESPACE::TensorProto* tensor_proto) {
+    // the data of an external tensor is only read from its file when the session state is initialized
     if (tensor_proto == nullptr ||
+        tensor_proto->data_location() == ONNX_NAMESPACE::TensorProto_DataLocation_EXTERNAL ||
         (tensor_proto->data_type() != ONNX_NAMESPACE::TensorProto_DataType_FLOAT &&
          tensor_proto->data_type() != ONNX_NAMESPACE::TensorProto_DataType_DOUBLE)) {
       return false;
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include "core/graph/unsqueeze_elimination.h"
+#include "core/graph/graph_utils.h"
 
 using namespace onnx;
 using namespace ::onnxruntime::common;
@@ -17,10 +18,11 @@ Status UnsqueezeElimination::Apply(onnxruntime::Graph& graph, bool& modified) co
     }
 
     const onnxruntime::NodeAttributes& attributes = node.GetAttributes();
-    const onnx::AttributeProto* attr = &attributes.find("axes")->second;
-    if (attr == nullptr || attr->type() != AttributeProto_AttributeType_INTS) {
+    auto axes_attr = attributes.find("axes");
+    if (axes_attr == attributes.end() || axes_attr->second.type() != AttributeProto_AttributeType_INTS) {
       continue;
     }
+    const onnx::AttributeProto* attr = &axes_attr->second;
 
     // Get attribute of "axes"
     std::vector<int64_t> axes;
@@ -32,7 +34,9 @@ Status UnsqueezeElimination::Apply(onnxruntime::Graph& graph, bool& modified) co
     NodeArg* input_def = node.MutableInputDefs()[0];
     const ONNX_NAMESPACE::TensorProto* tensor_proto = nullptr;
     graph.GetInitializedTensor(input_def->Name(), tensor_proto);
-    if (tensor_proto == nullptr) {
+    // the initializer is reshaped in place, which other nodes reading it or a feed overriding it would not expect
+    if (tensor_proto == nullptr || !utils::IsConstantInitializer(graph, *input_def) ||
+        !utils::IsUsedByOneNode(graph, *input_def)) {
       continue;
     }
     std::vector<int64_t> new_dims(axes.size() + tensor_proto->dims().size(), 0);
@@ -37,6 +37,7 @@ Abstract:
 #if defined(__x86_64__)
 #include "x86_64/xgetbv.h"
 #endif
+#include <unistd.h>
 #endif
 
 //
@@ -86,6 +87,9 @@ Abstract:
 #elif defined(_WIN32)
 #define MLAS_USE_WIN32_THREADPOOL
 #define MLAS_HAS_THREADING_SUPPORT
+#else
+#define MLAS_USE_POSIX_THREADPOOL
+#define MLAS_HAS_THREADING_SUPPORT
 #endif
 
 //
@@ -220,8 +224,11 @@ extern "C" {
 // range of workloads and observing the ideal number of threads to complete
 // that workload. See EvaluateThreadingPerformance() in the unit test.
 //
+// N.B. The POSIX thread pool keeps its workers spinning for a short interval
+// after completing work, so the dispatch overhead is comparable to OpenMP.
+//
 
-#if defined(MLAS_USE_OPENMP)
+#if defined(MLAS_USE_OPENMP) || defined(MLAS_USE_POSIX_THREADPOOL)
 #define MLAS_SGEMM_THREAD_COMPLEXITY                (64 * 1024)
 #else
 #if defined(MLAS_TARGET_AMD64)
@@ -273,7 +280,7 @@ struct MLAS_PLATFORM {
     PMLAS_TANH_KERNEL_ROUTINE TanhKernelRoutine;
 #endif
 
-#if defined(MLAS_USE_WIN32_THREADPOOL)
+#if defined(MLAS_USE_WIN32_THREADPOOL) || defined(MLAS_USE_POSIX_THREADPOOL)
     int32_t MaximumThreadCount;
 #endif
 
@@ -284,7 +291,7 @@ struct MLAS_PLATFORM {
     {
 #if defined(MLAS_USE_OPENMP)
         return (omp_get_num_threads() == 1) ? omp_get_max_threads() : 1;
-#elif defined(MLAS_USE_WIN32_THREADPOOL)
+#elif defined(MLAS_USE_WIN32_THREADPOOL) || defined(MLAS_USE_POSIX_THREADPOOL)
         return MaximumThreadCount;
 #else
         return 1;
@@ -311,7 +318,13 @@ void
 MlasExecuteThreaded(
     PMLAS_THREADED_ROUTINE ThreadedRoutine,
     void* Context,
-    int32_t Iterations
+    int32_t Iterations,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+int32_t
+MlasGetMaximumThreadCount(
+    MLAS_THREADPOOL* ThreadPool
     );
 
 //
@@ -363,9 +376,45 @@ MlasExecuteThreaded(
 
 #if defined(MLAS_NEON_INTRINSICS)
 typedef float32x4_t MLAS_FLOAT32X4;
+typedef int32x4_t MLAS_INT32X4;
 #elif defined(MLAS_SSE2_INTRINSICS)
 typedef __m128 MLAS_FLOAT32X4;
+typedef __m128i MLAS_INT32X4;
+#endif
+
+inline
+MLAS_INT32X4
+MlasReinterpretAsInt32x4(MLAS_FLOAT32X4 Vector)
+{
+#if defined(MLAS_NEON_INTRINSICS)
+    return vreinterpretq_s32_f32(Vector);
+#elif defined(MLAS_SSE2_INTRINSICS)
+    return _mm_castps_si128(Vector);
 #endif
+}
+
+inline
+MLAS_FLOAT32X4
+MlasReinterpretAsFloat32x4(MLAS_INT32X4 Vector)
+{
+#if defined(MLAS_NEON_INTRINSICS)
+    return vreinterpretq_f32_s32(Vector);
+#elif defined(MLAS_SSE2_INTRINSICS)
+    return _mm_castsi128_ps(Vector);
+#endif
+}
+
+template<unsigned ShiftCount>
+inline
+MLAS_INT32X4
+MlasShiftLeftInt32x4(MLAS_INT32X4 Vector)
+{
+#if defined(MLAS_NEON_INTRINSICS)
+    return vshlq_n_s32(Vector, ShiftCount);
+#elif defined(MLAS_SSE2_INTRINSICS)
+    return _mm_slli_epi32(Vector, ShiftCount);
+#endif
+}
 
 inline
 MLAS_FLOAT32X4
@@ -575,6 +624,36 @@ MlasMinimumFloat32x4(MLAS_FLOAT32X4 Vector1, MLAS_FLOAT32X4 Vector2)
 #endif
 }
 
+inline
+float
+MlasReduceAddFloat32x4(MLAS_FLOAT32X4 Vector)
+{
+#if defined(MLAS_NEON_INTRINSICS)
+    float32x2_t VectorLow = vadd_f32(vget_low_f32(Vector), vget_high_f32(Vector));
+    return vget_lane_f32(vpadd_f32(VectorLow, VectorLow), 0);
+#elif defined(MLAS_SSE2_INTRINSICS)
+    Vector = _mm_add_ps(Vector, _mm_shuffle_ps(Vector, Vector, _MM_SHUFFLE(1, 0, 3, 2)));
+    Vector = _mm_add_ss(Vector, _mm_shuffle_ps(Vector, Vector, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(Vector);
+#endif
+}
+
+inline
+float
+MlasReduceMaximumFloat32x4(MLAS_FLOAT32X4 Vector)
+{
+#if defined(MLAS_NEON64_INTRINSICS)
+    return vmaxvq_f32(Vector);
+#elif defined(MLAS_NEON32_INTRINSICS)
+    float32x2_t VectorLow = vpmax_f32(vget_low_f32(Vector), vget_high_f32(Vector));
+    return vget_lane_f32(vpmax_f32(VectorLow, VectorLow), 0);
+#elif defined(MLAS_SSE2_INTRINSICS)
+    Vector = _mm_max_ps(Vector, _mm_shuffle_ps(Vector, Vector, _MM_SHUFFLE(1, 0, 3, 2)));
+    Vector = _mm_max_ss(Vector, _mm_shuffle_ps(Vector, Vector, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(Vector);
+#endif
+}
+
 //
 // Reads a platform specific time stamp counter.
 //
@@ -149,4 +149,69 @@ Return Value:
 
 #endif
 
+#if defined(MLAS_USE_POSIX_THREADPOOL)
+
+    //
+    // Retrieve the number of online processors in the system.
+    //
+
+    long NumberOfProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (NumberOfProcessors <= 0) {
+        this->MaximumThreadCount = 1;
+    } else if (NumberOfProcessors <= MLAS_MAXIMUM_THREAD_COUNT) {
+        this->MaximumThreadCount = int32_t(NumberOfProcessors);
+    } else {
+        this->MaximumThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+    }
+
+#endif
+
+}
+
+void
+MLASCALL
+MlasSetMaximumThreadCount(
+    int32_t MaximumThreadCount
+    )
+/*++
+
+Routine Description:
+
+    This routine sets the maximum number of threads, including the calling
+    thread, that the library uses to execute a single operation.
+
+    The count may be raised or lowered. The worker threads of the library
+    thread pool are created or retired when the next operation is dispatched
+    to the pool.
+
+    N.B. This routine has no effect when the library is built with OpenMP
+    support. The OpenMP runtime controls the thread count in that case.
+
+Arguments:
+
+    MaximumThreadCount - Supplies the maximum number of threads. The value is
+        clamped to the range supported by this implementation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+#if defined(MLAS_USE_WIN32_THREADPOOL) || defined(MLAS_USE_POSIX_THREADPOOL)
+
+    if (MaximumThreadCount < 1) {
+        MaximumThreadCount = 1;
+    } else if (MaximumThreadCount > MLAS_MAXIMUM_THREAD_COUNT) {
+        MaximumThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+    }
+
+    MlasPlatform.MaximumThreadCount = MaximumThreadCount;
+
+#else
+
+    MLAS_UNREFERENCED_PARAMETER(MaximumThreadCount);
+
+#endif
 }
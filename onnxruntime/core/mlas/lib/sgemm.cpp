@@ -40,6 +40,7 @@ struct MLAS_SGEMM_WORK_BLOCK {
     size_t ldc;
     float alpha;
     float beta;
+    bool BIsPacked;
     struct SEGMENT {
         size_t M;
         size_t N;
@@ -49,6 +50,31 @@ struct MLAS_SGEMM_WORK_BLOCK {
     } Segments[MLAS_MAXIMUM_THREAD_COUNT];
 };
 
+//
+// Define the parameters to execute a batch of SGEMM operations on worker
+// threads. Each thread either executes a range of whole operations or, when
+// there are fewer operations than threads, a segment of one operation.
+//
+
+struct MLAS_SGEMM_BATCH_WORK_BLOCK {
+    CBLAS_TRANSPOSE TransA;
+    CBLAS_TRANSPOSE TransB;
+    size_t M;
+    size_t N;
+    size_t K;
+    size_t lda;
+    size_t ldb;
+    size_t ldc;
+    float alpha;
+    float beta;
+    const float* const* A;
+    const float* const* B;
+    float* const* C;
+    size_t BatchCount;
+    int32_t ThreadCount;
+    int32_t SegmentsPerOperation;
+};
+
 #if defined(MLAS_TARGET_AMD64_IX86)
 
 //
@@ -772,6 +798,154 @@ Return Value:
     }
 }
 
+void
+MlasSgemmMultiplyPanelB(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t CountN,
+    size_t CountK,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const float* PanelB,
+    float* C,
+    size_t ldc,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine multiplies the rows of matrix A by a packed panel of matrix
+    B and either stores the product to or adds the product to matrix C.
+
+Arguments:
+
+    TransA - Supplies the transpose operation for matrix A.
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    CountN - Supplies the number of columns of the packed panel and matrix C.
+
+    CountK - Supplies the number of rows of the packed panel.
+
+    alpha - Supplies the scaler alpha multiplier (see SGEMM definition).
+
+    A - Supplies the address of the slice of matrix A that corresponds to the
+        rows of the packed panel.
+
+    lda - Supplies the first dimension of matrix A.
+
+    PanelB - Supplies the address of the packed panel of matrix B.
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    ZeroMode - Supplies true if the product is stored to matrix C, else false
+        if the product is added to matrix C.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    float PanelA[MLAS_SGEMM_TRANSA_ROWS * MLAS_SGEMM_STRIDEK];
+
+    //
+    // Select the kernel routine to use for this panel.
+    //
+
+#if defined(MLAS_TARGET_AMD64_IX86)
+    PMLAS_SGEMM_KERNEL_ROUTINE SgemmKernelRoutine =
+        ZeroMode ? MlasPlatform.KernelZeroRoutine : MlasPlatform.KernelAddRoutine;
+#endif
+
+    //
+    // Step through each slice of matrix A along the M dimension.
+    //
+
+    const float* a = A;
+    float* c = C;
+
+    size_t RowsRemaining = M;
+    size_t RowsHandled;
+
+    if (TransA == CblasNoTrans) {
+
+        //
+        // Step through the rows of matrix A.
+        //
+
+        do {
+
+#if defined(MLAS_TARGET_AMD64_IX86)
+            RowsHandled = SgemmKernelRoutine(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
+#else
+            if (ZeroMode) {
+                RowsHandled = MlasSgemmKernelZero(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
+            } else {
+                RowsHandled = MlasSgemmKernelAdd(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
+            }
+#endif
+
+            c += ldc * RowsHandled;
+            a += lda * RowsHandled;
+
+            RowsRemaining -= RowsHandled;
+
+        } while (RowsRemaining > 0);
+
+    } else {
+
+        do {
+
+            //
+            // Transpose elements from matrix A into a local buffer.
+            //
+
+            size_t RowsTransposed = RowsRemaining;
+
+            if (RowsTransposed > MLAS_SGEMM_TRANSA_ROWS) {
+                RowsTransposed = MLAS_SGEMM_TRANSA_ROWS;
+            }
+
+            RowsRemaining -= RowsTransposed;
+
+            MlasSgemmTransposeA(PanelA, a, lda, RowsTransposed, CountK);
+
+            a += RowsTransposed;
+
+            //
+            // Step through the rows of the local buffer.
+            //
+
+            const float* pa = PanelA;
+
+            do {
+
+#if defined(MLAS_TARGET_AMD64_IX86)
+                RowsHandled = SgemmKernelRoutine(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
+#else
+                if (ZeroMode) {
+                    RowsHandled = MlasSgemmKernelZero(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
+                } else {
+                    RowsHandled = MlasSgemmKernelAdd(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
+                }
+#endif
+
+                c += ldc * RowsHandled;
+                pa += CountK * RowsHandled;
+
+                RowsTransposed -= RowsHandled;
+
+            } while (RowsTransposed > 0);
+
+        } while (RowsRemaining > 0);
+    }
+}
+
 void
 MlasSgemmOperation(
     CBLAS_TRANSPOSE TransA,
@@ -830,7 +1004,6 @@ Return Value:
 
 --*/
 {
-    float PanelA[MLAS_SGEMM_TRANSA_ROWS * MLAS_SGEMM_STRIDEK];
     MLAS_DECLSPEC_ALIGN(float PanelB[MLAS_SGEMM_STRIDEN * MLAS_SGEMM_STRIDEK], 16 * sizeof(float));
 
     //
@@ -932,101 +1105,116 @@ Return Value:
             }
 
             //
-            // Select the kernel routine to use for this panel.
+            // Multiply matrix A by the packed panel of matrix B.
             //
 
-            bool UseKernelZeroRoutine = (k == 0 && beta == 0.0f);
+            const float* a = (TransA == CblasNoTrans) ? A + k : A + k * lda;
 
-#if defined(MLAS_TARGET_AMD64_IX86)
-            PMLAS_SGEMM_KERNEL_ROUTINE SgemmKernelRoutine =
-                UseKernelZeroRoutine ? MlasPlatform.KernelZeroRoutine : MlasPlatform.KernelAddRoutine;
-#endif
+            MlasSgemmMultiplyPanelB(TransA, M, CountN, CountK, alpha, a, lda,
+                PanelB, C + n, ldc, k == 0 && beta == 0.0f);
+        }
+    }
+}
 
-            //
-            // Step through each slice of matrix A along the M dimension.
-            //
+void
+MlasSgemmPackedOperation(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const float* PackedB,
+    float beta,
+    float* C,
+    size_t ldc
+    )
+/*++
 
-            float* c = C + n;
+Routine Description:
 
-            size_t RowsRemaining = M;
-            size_t RowsHandled;
+    This routine implements the single precision matrix/matrix multiply
+    operation (SGEMM) with a matrix B that was packed by MlasSgemmPackB.
 
-            if (TransA == CblasNoTrans) {
+Arguments:
 
-                const float* a = A + k;
+    TransA - Supplies the transpose operation for matrix A.
 
-                //
-                // Step through the rows of matrix A.
-                //
+    M - Supplies the number of rows of matrix A and matrix C.
 
-                do {
+    N - Supplies the number of columns of matrix B and matrix C.
 
-#if defined(MLAS_TARGET_AMD64_IX86)
-                    RowsHandled = SgemmKernelRoutine(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
-#else
-                    if (UseKernelZeroRoutine) {
-                        RowsHandled = MlasSgemmKernelZero(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
-                    } else {
-                        RowsHandled = MlasSgemmKernelAdd(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
-                    }
-#endif
+    K - Supplies the number of columns of matrix A and the number of rows of
+        matrix B.
 
-                    c += ldc * RowsHandled;
-                    a += lda * RowsHandled;
+    alpha - Supplies the scaler alpha multiplier (see SGEMM definition).
 
-                    RowsRemaining -= RowsHandled;
+    A - Supplies the address of matrix A.
 
-                } while (RowsRemaining > 0);
+    lda - Supplies the first dimension of matrix A.
 
-            } else {
+    PackedB - Supplies the address of the packed matrix B.
 
-                const float* a = A + k * lda;
+    beta - Supplies the scaler beta multiplier (see SGEMM definition).
 
-                do {
+    C - Supplies the address of matrix C.
 
-                    //
-                    // Transpose elements from matrix A into a local buffer.
-                    //
+    ldc - Supplies the first dimension of matrix C.
 
-                    size_t RowsTransposed = RowsRemaining;
+Return Value:
 
-                    if (RowsTransposed > MLAS_SGEMM_TRANSA_ROWS) {
-                        RowsTransposed = MLAS_SGEMM_TRANSA_ROWS;
-                    }
+    None.
 
-                    RowsRemaining -= RowsTransposed;
+--*/
+{
+    //
+    // Step through each slice of matrix B along the N dimension. The panels
+    // of the packed buffer follow each other in the same order as they are
+    // consumed here.
+    //
 
-                    MlasSgemmTransposeA(PanelA, a, lda, RowsTransposed, CountK);
+    const float* PanelB = PackedB;
 
-                    a += RowsTransposed;
+    size_t CountN;
+    size_t CountK;
 
-                    //
-                    // Step through the rows of the local buffer.
-                    //
+    for (size_t n = 0; n < N; n += CountN) {
 
-                    const float* pa = PanelA;
+        CountN = MLAS_SGEMM_STRIDEN;
 
-                    do {
+        if (CountN > (N - n)) {
+            CountN = N - n;
+        }
 
-#if defined(MLAS_TARGET_AMD64_IX86)
-                        RowsHandled = SgemmKernelRoutine(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
-#else
-                        if (UseKernelZeroRoutine) {
-                            RowsHandled = MlasSgemmKernelZero(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
-                        } else {
-                            RowsHandled = MlasSgemmKernelAdd(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
-                        }
-#endif
+        size_t AlignedCountN = (CountN + 15) & ~size_t(15);
+
+        //
+        // Multiply the output matrix by beta as needed.
+        //
 
-                        c += ldc * RowsHandled;
-                        pa += CountK * RowsHandled;
+        if (beta != 0.0f && beta != 1.0f) {
+            MlasSgemmMultiplyBeta(C + n, M, CountN, ldc, beta);
+        }
 
-                        RowsTransposed -= RowsHandled;
+        //
+        // Step through each slice of matrix B along the K dimension.
+        //
 
-                    } while (RowsTransposed > 0);
+        for (size_t k = 0; k < K; k += CountK) {
 
-                } while (RowsRemaining > 0);
+            CountK = MLAS_SGEMM_STRIDEK;
+
+            if (CountK > (K - k)) {
+                CountK = K - k;
             }
+
+            const float* a = (TransA == CblasNoTrans) ? A + k : A + k * lda;
+
+            MlasSgemmMultiplyPanelB(TransA, M, CountN, CountK, alpha, a, lda,
+                PanelB, C + n, ldc, k == 0 && beta == 0.0f);
+
+            PanelB += AlignedCountN * CountK;
         }
     }
 }
@@ -1059,10 +1247,16 @@ Return Value:
 
     MLAS_SGEMM_WORK_BLOCK::SEGMENT* Segment = &WorkBlock->Segments[Index];
 
-    MlasSgemmOperation(WorkBlock->TransA, WorkBlock->TransB, Segment->M,
-        Segment->N, WorkBlock->K, WorkBlock->alpha, Segment->A, WorkBlock->lda,
-        Segment->B, WorkBlock->ldb, WorkBlock->beta, Segment->C,
-        WorkBlock->ldc);
+    if (WorkBlock->BIsPacked) {
+        MlasSgemmPackedOperation(WorkBlock->TransA, Segment->M, Segment->N,
+            WorkBlock->K, WorkBlock->alpha, Segment->A, WorkBlock->lda,
+            Segment->B, WorkBlock->beta, Segment->C, WorkBlock->ldc);
+    } else {
+        MlasSgemmOperation(WorkBlock->TransA, WorkBlock->TransB, Segment->M,
+            Segment->N, WorkBlock->K, WorkBlock->alpha, Segment->A, WorkBlock->lda,
+            Segment->B, WorkBlock->ldb, WorkBlock->beta, Segment->C,
+            WorkBlock->ldc);
+    }
 }
 
 inline
@@ -1078,9 +1272,11 @@ MlasSgemmTryMultithread(
     size_t lda,
     const float* B,
     size_t ldb,
+    bool BIsPacked,
     float beta,
     float* C,
-    size_t ldc
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
     )
 /*++
 
@@ -1112,12 +1308,18 @@ Arguments:
 
     ldb - Supplies the first dimension of matrix B.
 
+    BIsPacked - Supplies true if matrix B was packed by MlasSgemmPackB, in
+        which case TransB and ldb are ignored.
+
     beta - Supplies the scaler beta multiplier (see SGEMM definition).
 
     C - Supplies the address of matrix C.
 
     ldc - Supplies the first dimension of matrix C.
 
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
 Return Value:
 
     Returns true if the operation was completed across multiple threads, else
@@ -1144,7 +1346,7 @@ Return Value:
         TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
     }
 
-    int32_t MaximumThreadCount = MlasPlatform.GetMaximumThreadCount();
+    int32_t MaximumThreadCount = MlasGetMaximumThreadCount(ThreadPool);
 
     if (TargetThreadCount >= MaximumThreadCount) {
         TargetThreadCount = MaximumThreadCount;
@@ -1166,6 +1368,7 @@ Return Value:
     WorkBlock.ldc = ldc;
     WorkBlock.alpha = alpha;
     WorkBlock.beta = beta;
+    WorkBlock.BIsPacked = BIsPacked;
 
     //
     // Segment the operation across multiple threads.
@@ -1181,10 +1384,23 @@ Return Value:
             StrideN++;
         }
 
-        StrideN =
-            (StrideN + MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1) & ~(MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1);
+        //
+        // A packed matrix B can only be split at the boundaries of its
+        // panels (see MlasSgemmPackB).
+        //
+
+        if (BIsPacked) {
+
+            StrideN =
+                (StrideN + MLAS_SGEMM_STRIDEN - 1) & ~(MLAS_SGEMM_STRIDEN - 1);
+
+        } else {
+
+            StrideN =
+                (StrideN + MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1) & ~(MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1);
+        }
 
-        size_t pldb = (TransB == CblasNoTrans) ? 1 : ldb;
+        size_t pldb = BIsPacked ? K : (TransB == CblasNoTrans) ? 1 : ldb;
 
         for (size_t CountN, n = 0; n < N; n += CountN) {
 
@@ -1231,7 +1447,7 @@ Return Value:
         }
     }
 
-    MlasExecuteThreaded(MlasSgemmOperationThreaded, &WorkBlock, Index);
+    MlasExecuteThreaded(MlasSgemmOperationThreaded, &WorkBlock, Index, ThreadPool);
 
     return true;
 
@@ -1251,9 +1467,11 @@ Return Value:
     MLAS_UNREFERENCED_PARAMETER(lda);
     MLAS_UNREFERENCED_PARAMETER(B);
     MLAS_UNREFERENCED_PARAMETER(ldb);
+    MLAS_UNREFERENCED_PARAMETER(BIsPacked);
     MLAS_UNREFERENCED_PARAMETER(beta);
     MLAS_UNREFERENCED_PARAMETER(C);
     MLAS_UNREFERENCED_PARAMETER(ldc);
+    MLAS_UNREFERENCED_PARAMETER(ThreadPool);
 
     return false;
 
@@ -1276,7 +1494,8 @@ MlasSgemm(
     size_t ldb,
     float beta,
     float* C,
-    size_t ldc
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
     )
 /*++
 
@@ -1314,6 +1533,9 @@ Arguments:
 
     ldc - Supplies the first dimension of matrix C.
 
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
 Return Value:
 
     None.
@@ -1325,7 +1547,440 @@ Return Value:
     // single thread based on the GEMM parameters and system configuration.
     //
 
-    if (!MlasSgemmTryMultithread(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc)) {
+    if (!MlasSgemmTryMultithread(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, false, beta, C, ldc, ThreadPool)) {
         MlasSgemmOperation(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
     }
 }
+
+void
+MlasSgemmBatchThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    batch of SGEMM operations.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_SGEMM_BATCH_WORK_BLOCK* WorkBlock = (MLAS_SGEMM_BATCH_WORK_BLOCK*)Context;
+
+    const size_t M = WorkBlock->M;
+    const size_t N = WorkBlock->N;
+
+    if (WorkBlock->SegmentsPerOperation == 1) {
+
+        //
+        // Execute a range of whole operations.
+        //
+
+        size_t BatchStart = WorkBlock->BatchCount * Index / WorkBlock->ThreadCount;
+        size_t BatchEnd = WorkBlock->BatchCount * (Index + 1) / WorkBlock->ThreadCount;
+
+        for (size_t b = BatchStart; b < BatchEnd; b++) {
+            MlasSgemmOperation(WorkBlock->TransA, WorkBlock->TransB, M, N,
+                WorkBlock->K, WorkBlock->alpha, WorkBlock->A[b], WorkBlock->lda,
+                WorkBlock->B[b], WorkBlock->ldb, WorkBlock->beta, WorkBlock->C[b],
+                WorkBlock->ldc);
+        }
+
+        return;
+    }
+
+    //
+    // Execute a segment of one operation, partitioned along the larger of the
+    // M and N dimensions as in MlasSgemmTryMultithread.
+    //
+
+    size_t b = size_t(Index / WorkBlock->SegmentsPerOperation);
+    size_t Segment = size_t(Index % WorkBlock->SegmentsPerOperation);
+    size_t SegmentCount = size_t(WorkBlock->SegmentsPerOperation);
+
+    const float* A = WorkBlock->A[b];
+    const float* B = WorkBlock->B[b];
+    float* C = WorkBlock->C[b];
+
+    if (N > M) {
+
+        size_t StrideN = (N + SegmentCount - 1) / SegmentCount;
+
+        StrideN =
+            (StrideN + MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1) & ~(MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1);
+
+        size_t n = StrideN * Segment;
+
+        if (n >= N) {
+            return;
+        }
+
+        size_t CountN = StrideN;
+
+        if (CountN > (N - n)) {
+            CountN = N - n;
+        }
+
+        size_t pldb = (WorkBlock->TransB == CblasNoTrans) ? 1 : WorkBlock->ldb;
+
+        MlasSgemmOperation(WorkBlock->TransA, WorkBlock->TransB, M, CountN,
+            WorkBlock->K, WorkBlock->alpha, A, WorkBlock->lda, B + n * pldb,
+            WorkBlock->ldb, WorkBlock->beta, C + n, WorkBlock->ldc);
+
+    } else {
+
+        size_t StrideM = (M + SegmentCount - 1) / SegmentCount;
+
+        size_t m = StrideM * Segment;
+
+        if (m >= M) {
+            return;
+        }
+
+        size_t CountM = StrideM;
+
+        if (CountM > (M - m)) {
+            CountM = M - m;
+        }
+
+        size_t plda = (WorkBlock->TransA == CblasNoTrans) ? WorkBlock->lda : 1;
+
+        MlasSgemmOperation(WorkBlock->TransA, WorkBlock->TransB, CountM, N,
+            WorkBlock->K, WorkBlock->alpha, A + m * plda, WorkBlock->lda, B,
+            WorkBlock->ldb, WorkBlock->beta, C + m * WorkBlock->ldc, WorkBlock->ldc);
+    }
+}
+
+void
+MLASCALL
+MlasSgemmBatch(
+    CBLAS_TRANSPOSE TransA,
+    CBLAS_TRANSPOSE TransB,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* const* A,
+    size_t lda,
+    const float* const* B,
+    size_t ldb,
+    float beta,
+    float* const* C,
+    size_t ldc,
+    size_t BatchCount,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements a batch of single precision matrix/matrix multiply
+    operations (SGEMM) that share the same shapes. The operations are
+    partitioned across threads by a single dispatch.
+
+Arguments:
+
+    TransA - Supplies the transpose operation for the A matrices.
+
+    TransB - Supplies the transpose operation for the B matrices.
+
+    M - Supplies the number of rows of the A and C matrices.
+
+    N - Supplies the number of columns of the B and C matrices.
+
+    K - Supplies the number of columns of the A matrices and the number of
+        rows of the B matrices.
+
+    alpha - Supplies the scaler alpha multiplier (see SGEMM definition).
+
+    A - Supplies the addresses of the A matrices.
+
+    lda - Supplies the first dimension of the A matrices.
+
+    B - Supplies the addresses of the B matrices.
+
+    ldb - Supplies the first dimension of the B matrices.
+
+    beta - Supplies the scaler beta multiplier (see SGEMM definition).
+
+    C - Supplies the addresses of the C matrices.
+
+    ldc - Supplies the first dimension of the C matrices.
+
+    BatchCount - Supplies the number of operations.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (BatchCount == 0 || M == 0 || N == 0) {
+        return;
+    }
+
+    MLAS_SGEMM_BATCH_WORK_BLOCK WorkBlock;
+
+    WorkBlock.TransA = TransA;
+    WorkBlock.TransB = TransB;
+    WorkBlock.M = M;
+    WorkBlock.N = N;
+    WorkBlock.K = K;
+    WorkBlock.lda = lda;
+    WorkBlock.ldb = ldb;
+    WorkBlock.ldc = ldc;
+    WorkBlock.alpha = alpha;
+    WorkBlock.beta = beta;
+    WorkBlock.A = A;
+    WorkBlock.B = B;
+    WorkBlock.C = C;
+    WorkBlock.BatchCount = BatchCount;
+
+#if defined(MLAS_HAS_THREADING_SUPPORT)
+
+    //
+    // Compute the number of target threads given the complexity of the whole
+    // batch. Small batches of small operations run on a single thread.
+    //
+
+    double Complexity = double(M) * double(N) * double(K) * double(BatchCount);
+
+    int32_t TargetThreadCount;
+
+    if (Complexity < double(MLAS_SGEMM_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
+        TargetThreadCount = int32_t(Complexity / double(MLAS_SGEMM_THREAD_COMPLEXITY)) + 1;
+    } else {
+        TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+    }
+
+    int32_t MaximumThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    //
+    // Split the batch by whole operations if there are enough of them to
+    // keep the threads busy, else also split each operation.
+    //
+
+    if (BatchCount >= size_t(TargetThreadCount)) {
+        WorkBlock.ThreadCount = TargetThreadCount;
+        WorkBlock.SegmentsPerOperation = 1;
+    } else {
+        WorkBlock.SegmentsPerOperation =
+            int32_t((size_t(TargetThreadCount) + BatchCount - 1) / BatchCount);
+        WorkBlock.ThreadCount = int32_t(BatchCount) * WorkBlock.SegmentsPerOperation;
+    }
+
+    MlasExecuteThreaded(MlasSgemmBatchThreaded, &WorkBlock, WorkBlock.ThreadCount, ThreadPool);
+
+#else
+
+    //
+    // No threading implementation is available.
+    //
+
+    MLAS_UNREFERENCED_PARAMETER(ThreadPool);
+
+    WorkBlock.ThreadCount = 1;
+    WorkBlock.SegmentsPerOperation = 1;
+
+    MlasSgemmBatchThreaded(&WorkBlock, 0);
+
+#endif
+}
+
+size_t
+MLASCALL
+MlasSgemmPackBSize(
+    size_t N,
+    size_t K
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the size of the buffer needed by MlasSgemmPackB to
+    pack a matrix B.
+
+Arguments:
+
+    N - Supplies the number of columns of matrix B.
+
+    K - Supplies the number of rows of matrix B.
+
+Return Value:
+
+    Returns the size in bytes of the packed buffer.
+
+--*/
+{
+    //
+    // Each panel is zero-padded to a multiple of 16 columns.
+    //
+
+    size_t AlignedN = (N + 15) & ~size_t(15);
+
+    return AlignedN * K * sizeof(float);
+}
+
+void
+MLASCALL
+MlasSgemmPackB(
+    CBLAS_TRANSPOSE TransB,
+    size_t N,
+    size_t K,
+    const float* B,
+    size_t ldb,
+    void* PackedB
+    )
+/*++
+
+Routine Description:
+
+    This routine packs a matrix B into the panel layout consumed by the SGEMM
+    kernels, so that a matrix B that is used by several SGEMM operations is
+    only packed once.
+
+    The matrix is split into panels of MLAS_SGEMM_STRIDEN columns by
+    MLAS_SGEMM_STRIDEK rows, which are stored one after the other by rows and
+    then by columns.
+
+Arguments:
+
+    TransB - Supplies the transpose operation for matrix B.
+
+    N - Supplies the number of columns of matrix B.
+
+    K - Supplies the number of rows of matrix B.
+
+    B - Supplies the address of matrix B.
+
+    ldb - Supplies the first dimension of matrix B.
+
+    PackedB - Supplies the address of the packed buffer, which must be at
+        least MlasSgemmPackBSize bytes long and aligned to 64 bytes.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    float* D = (float*)PackedB;
+
+    size_t CountN;
+    size_t CountK;
+
+    for (size_t n = 0; n < N; n += CountN) {
+
+        CountN = MLAS_SGEMM_STRIDEN;
+
+        if (CountN > (N - n)) {
+            CountN = N - n;
+        }
+
+        size_t AlignedCountN = (CountN + 15) & ~size_t(15);
+
+        for (size_t k = 0; k < K; k += CountK) {
+
+            CountK = MLAS_SGEMM_STRIDEK;
+
+            if (CountK > (K - k)) {
+                CountK = K - k;
+            }
+
+            if (TransB == CblasNoTrans) {
+                MlasSgemmCopyPackB(D, B + n + k * ldb, ldb, CountN, CountK);
+            } else {
+                MlasSgemmTransposePackB(D, B + k + n * ldb, ldb, CountN, CountK);
+            }
+
+            D += AlignedCountN * CountK;
+        }
+    }
+}
+
+void
+MLASCALL
+MlasSgemm(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const void* PackedB,
+    float beta,
+    float* C,
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the single precision matrix/matrix multiply
+    operation (SGEMM) with a matrix B that was packed by MlasSgemmPackB.
+
+Arguments:
+
+    TransA - Supplies the transpose operation for matrix A.
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    N - Supplies the number of columns of matrix B and matrix C.
+
+    K - Supplies the number of columns of matrix A and the number of rows of
+        matrix B.
+
+    alpha - Supplies the scaler alpha multiplier (see SGEMM definition).
+
+    A - Supplies the address of matrix A.
+
+    lda - Supplies the first dimension of matrix A.
+
+    PackedB - Supplies the address of the packed matrix B.
+
+    beta - Supplies the scaler beta multiplier (see SGEMM definition).
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const float* B = (const float*)PackedB;
+
+    //
+    // Try to run the operation across multiple threads or fall back to a
+    // single thread based on the GEMM parameters and system configuration.
+    //
+
+    if (!MlasSgemmTryMultithread(TransA, CblasNoTrans, M, N, K, alpha, A, lda, B, 0, true, beta, C, ldc, ThreadPool)) {
+        MlasSgemmPackedOperation(TransA, M, N, K, alpha, A, lda, B, beta, C, ldc);
+    }
+}
@@ -0,0 +1,369 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    softmax.cpp
+
+Abstract:
+
+    This module implements routines to compute the softmax and log softmax
+    functions over the rows of a matrix.
+
+    The exponential uses the same range reduction and polynomial coefficients
+    as found in Cephes. The maximum of each row is subtracted before the
+    exponential is computed, so the argument of the exponential is never
+    positive and the sum of the exponentials of a row is at least one.
+
+--*/
+
+#include "mlasi.h"
+#include <cmath>
+
+//
+// Bundles the floating point constants of the exponential.
+//
+
+static const struct {
+    float LowerRange;
+    float UpperRange;
+    float LOG2EF;
+    float C1;
+    float C2;
+    float RoundingBias;
+    float p0;
+    float p1;
+    float p2;
+    float p3;
+    float p4;
+    float p5;
+} MlasExpConstants = {
+    -87.3365447505531f,
+    88.0f,
+    1.44269504088896341f,
+    0.693359375f,
+    -2.12194440e-4f,
+    // 1.5 * 2^23 rounds to an integer. Adding 127 also biases the integer as
+    // the exponent of a float, so shifting it into place forms 2^n.
+    12582912.0f + 127.0f,
+    1.9875691500E-4f,
+    1.3981999507E-3f,
+    8.3334519073E-3f,
+    4.1665795894E-2f,
+    1.6666665459E-1f,
+    5.0000001201E-1f,
+};
+
+inline
+MLAS_FLOAT32X4
+MlasComputeExpFloat32x4(
+    MLAS_FLOAT32X4 Value
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the exponential of a vector.
+
+Arguments:
+
+    Value - Supplies the vector to exponentiate.
+
+Return Value:
+
+    The exponential of each element of the vector.
+
+--*/
+{
+    Value = MlasMaximumFloat32x4(MlasBroadcastFloat32x4(MlasExpConstants.LowerRange), Value);
+    Value = MlasMinimumFloat32x4(MlasBroadcastFloat32x4(MlasExpConstants.UpperRange), Value);
+
+    //
+    // Split the value into n * ln(2) + r, with |r| <= ln(2) / 2.
+    //
+
+    MLAS_FLOAT32X4 Biased = MlasMultiplyAddFloat32x4(Value, MlasBroadcastFloat32x4(MlasExpConstants.LOG2EF),
+        MlasBroadcastFloat32x4(MlasExpConstants.RoundingBias));
+    MLAS_FLOAT32X4 n = MlasSubtractFloat32x4(Biased, MlasBroadcastFloat32x4(MlasExpConstants.RoundingBias));
+
+    MLAS_FLOAT32X4 r;
+    r = MlasMultiplyAddFloat32x4(n, MlasBroadcastFloat32x4(-MlasExpConstants.C1), Value);
+    r = MlasMultiplyAddFloat32x4(n, MlasBroadcastFloat32x4(-MlasExpConstants.C2), r);
+
+    MLAS_FLOAT32X4 rSquared = MlasMultiplyFloat32x4(r, r);
+
+    MLAS_FLOAT32X4 p;
+    p = MlasMultiplyAddFloat32x4(r, MlasBroadcastFloat32x4(MlasExpConstants.p0),
+        MlasBroadcastFloat32x4(MlasExpConstants.p1));
+    p = MlasMultiplyAddFloat32x4(p, r, MlasBroadcastFloat32x4(MlasExpConstants.p2));
+    p = MlasMultiplyAddFloat32x4(p, r, MlasBroadcastFloat32x4(MlasExpConstants.p3));
+    p = MlasMultiplyAddFloat32x4(p, r, MlasBroadcastFloat32x4(MlasExpConstants.p4));
+    p = MlasMultiplyAddFloat32x4(p, r, MlasBroadcastFloat32x4(MlasExpConstants.p5));
+    p = MlasMultiplyAddFloat32x4(p, rSquared, r);
+    p = MlasAddFloat32x4(p, MlasBroadcastFloat32x4(1.0f));
+
+    //
+    // Scale by 2^n, built from the biased integer in the low bits of Biased.
+    //
+
+    MLAS_FLOAT32X4 Scale = MlasReinterpretAsFloat32x4(MlasShiftLeftInt32x4<23>(MlasReinterpretAsInt32x4(Biased)));
+
+    return MlasMultiplyFloat32x4(p, Scale);
+}
+
+inline
+float
+MlasComputeExpScalar(
+    float Value
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the exponential of a single value with the same
+    algorithm as the vector form, so that all elements of a row are computed
+    alike.
+
+Arguments:
+
+    Value - Supplies the value to exponentiate.
+
+Return Value:
+
+    The exponential of the value.
+
+--*/
+{
+    return MlasExtractLaneFloat32x4<0>(MlasComputeExpFloat32x4(MlasBroadcastFloat32x4(Value)));
+}
+
+inline
+float
+MlasReduceMaximumRow(
+    const float* Input,
+    size_t D
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the maximum of a row.
+
+Arguments:
+
+    Input - Supplies the row.
+
+    D - Supplies the number of elements of the row.
+
+Return Value:
+
+    The maximum of the row.
+
+--*/
+{
+    float Maximum = std::numeric_limits<float>::lowest();
+
+    if (D >= 4) {
+
+        MLAS_FLOAT32X4 MaximumVector = MlasLoadFloat32x4(Input);
+
+        Input += 4;
+        D -= 4;
+
+        while (D >= 4) {
+
+            MaximumVector = MlasMaximumFloat32x4(MaximumVector, MlasLoadFloat32x4(Input));
+
+            Input += 4;
+            D -= 4;
+        }
+
+        Maximum = MlasReduceMaximumFloat32x4(MaximumVector);
+    }
+
+    while (D > 0) {
+
+        Maximum = (std::max)(Maximum, *Input++);
+
+        D -= 1;
+    }
+
+    return Maximum;
+}
+
+inline
+float
+MlasComputeSumExpRow(
+    const float* Input,
+    float* Output,
+    size_t D,
+    float Maximum
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the exponentials of a row minus its maximum and
+    returns their sum.
+
+Arguments:
+
+    Input - Supplies the row.
+
+    Output - Optionally supplies the buffer receiving the exponentials.
+
+    D - Supplies the number of elements of the row.
+
+    Maximum - Supplies the maximum of the row.
+
+Return Value:
+
+    The sum of the exponentials.
+
+--*/
+{
+    MLAS_FLOAT32X4 MaximumVector = MlasBroadcastFloat32x4(Maximum);
+    MLAS_FLOAT32X4 SumVector = MlasZeroFloat32x4();
+
+    while (D >= 4) {
+
+        MLAS_FLOAT32X4 Value = MlasComputeExpFloat32x4(MlasSubtractFloat32x4(MlasLoadFloat32x4(Input), MaximumVector));
+
+        if (Output != nullptr) {
+            MlasStoreFloat32x4(Output, Value);
+            Output += 4;
+        }
+
+        SumVector = MlasAddFloat32x4(SumVector, Value);
+
+        Input += 4;
+        D -= 4;
+    }
+
+    float Sum = MlasReduceAddFloat32x4(SumVector);
+
+    while (D > 0) {
+
+        float Value = MlasComputeExpScalar(*Input++ - Maximum);
+
+        if (Output != nullptr) {
+            *Output++ = Value;
+        }
+
+        Sum += Value;
+
+        D -= 1;
+    }
+
+    return Sum;
+}
+
+void
+MLASCALL
+MlasComputeSoftmax(
+    const float* Input,
+    float* Output,
+    size_t N,
+    size_t D,
+    bool LogSoftmax
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the softmax or log softmax function of each row of
+    a matrix.
+
+Arguments:
+
+    Input - Supplies the input matrix of N rows of D elements.
+
+    Output - Supplies the output matrix. It may be the same buffer as Input.
+
+    N - Supplies the number of rows.
+
+    D - Supplies the number of elements of each row.
+
+    LogSoftmax - Supplies true to compute the log softmax function instead of
+        the softmax function.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    while (N > 0) {
+
+        const float Maximum = MlasReduceMaximumRow(Input, D);
+
+        if (LogSoftmax) {
+
+            //
+            // The exponentials are only needed for their sum, so the output
+            // is written in a second pass over the row: x - max - log(sum).
+            //
+
+            const float Sum = MlasComputeSumExpRow(Input, nullptr, D, Maximum);
+            const float Offset = Maximum + std::log(Sum);
+
+            MLAS_FLOAT32X4 OffsetVector = MlasBroadcastFloat32x4(Offset);
+
+            const float* RowInput = Input;
+            float* RowOutput = Output;
+            size_t Count = D;
+
+            while (Count >= 4) {
+
+                MlasStoreFloat32x4(RowOutput, MlasSubtractFloat32x4(MlasLoadFloat32x4(RowInput), OffsetVector));
+
+                RowInput += 4;
+                RowOutput += 4;
+                Count -= 4;
+            }
+
+            while (Count > 0) {
+
+                *RowOutput++ = *RowInput++ - Offset;
+
+                Count -= 1;
+            }
+
+        } else {
+
+            //
+            // The exponentials are stored in the output, then scaled in place.
+            //
+
+            const float Sum = MlasComputeSumExpRow(Input, Output, D, Maximum);
+            const float Scale = 1.0f / Sum;
+
+            MLAS_FLOAT32X4 ScaleVector = MlasBroadcastFloat32x4(Scale);
+
+            float* RowOutput = Output;
+            size_t Count = D;
+
+            while (Count >= 4) {
+
+                MlasStoreFloat32x4(RowOutput, MlasMultiplyFloat32x4(MlasLoadFloat32x4(RowOutput), ScaleVector));
+
+                RowOutput += 4;
+                Count -= 4;
+            }
+
+            while (Count > 0) {
+
+                *RowOutput++ *= Scale;
+
+                Count -= 1;
+            }
+        }
+
+        Input += D;
+        Output += D;
+        N -= 1;
+    }
+}
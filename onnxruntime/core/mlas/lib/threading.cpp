@@ -15,6 +15,15 @@ Abstract:
 --*/
 
 #include "mlasi.h"
+#include "core/platform/threadpool.h"
+
+#if defined(MLAS_USE_POSIX_THREADPOOL)
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
 
 #if defined(MLAS_USE_WIN32_THREADPOOL)
 
@@ -69,12 +78,573 @@ Return Value:
 
 #endif
 
+#if defined(MLAS_USE_POSIX_THREADPOOL)
+
+//
+// Define the number of times a thread polls for new work or for the completion
+// of outstanding work before blocking. Worker threads that exhaust this count
+// park on a condition variable until the next batch of work is dispatched.
+//
+
+#define MLAS_THREAD_POOL_SPIN_COUNT                 (64 * 1024)
+
+//
+// Define the layout of the dispatch state word. The upper 32 bits contain the
+// generation number of the current batch of work, the next 16 bits contain the
+// number of iterations in the batch, and the low 16 bits contain the index of
+// the next iteration to execute. Packing these fields into a single word
+// allows a thread to atomically claim an iteration only if it belongs to the
+// batch that the thread observed.
+//
+
+#define MLAS_THREAD_POOL_MAXIMUM_BATCH_ITERATIONS   0xFFFF
+
+#define MLAS_THREAD_POOL_STATE(Generation, Iterations, Index) \
+    ((uint64_t(Generation) << 32) | (uint64_t(Iterations) << 16) | uint64_t(Index))
+
+#define MLAS_THREAD_POOL_STATE_GENERATION(State)    uint32_t((State) >> 32)
+#define MLAS_THREAD_POOL_STATE_ITERATIONS(State)    uint32_t(((State) >> 16) & 0xFFFF)
+#define MLAS_THREAD_POOL_STATE_INDEX(State)         uint32_t((State) & 0xFFFF)
+
+//
+// Define the state of the persistent worker thread pool.
+//
+
+struct MLAS_THREAD_POOL {
+
+    MLAS_THREAD_POOL(
+        void
+        );
+
+    ~MLAS_THREAD_POOL(
+        void
+        );
+
+    //
+    // Serializes dispatching batches of work to the pool. The remaining
+    // non-atomic fields of the structure are only modified while this lock
+    // is held.
+    //
+
+    std::mutex DispatchLock;
+    std::vector<std::thread> Workers;
+    uint32_t Generation;
+
+    //
+    // Supplies the number of worker threads that remain part of the pool.
+    // Workers with an index at or above this count exit when they observe
+    // the next generation.
+    //
+
+    std::atomic<size_t> ActiveWorkerCount;
+
+    //
+    // Describes the batch of work that is currently being dispatched.
+    //
+
+    std::atomic<uint64_t> State;
+    std::atomic<uint32_t> CompletedIterations;
+    PMLAS_THREADED_ROUTINE ThreadedRoutine;
+    void* Context;
+    int32_t BaseIndex;
+
+    //
+    // Supports parking idle worker threads.
+    //
+
+    std::mutex ParkLock;
+    std::condition_variable ParkCondition;
+    std::atomic<int32_t> ParkedWorkerCount;
+    bool Shutdown;
+};
+
+//
+// Indicates whether the current thread is a worker thread of the pool or is
+// dispatching a batch of work to the pool. Nested requests from such a thread
+// cannot be dispatched to the pool and are executed on the calling thread.
+//
+
+thread_local bool MlasThreadPoolInsideDispatch = false;
+
+inline
+void
+MlasYieldProcessor(
+    void
+    )
+{
+#if defined(MLAS_TARGET_AMD64_IX86)
+    _mm_pause();
+#elif defined(MLAS_TARGET_ARM64) || defined(MLAS_TARGET_ARM)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+MLAS_THREAD_POOL::MLAS_THREAD_POOL(
+    void
+    ) : Generation(0), ActiveWorkerCount(0), State(0), CompletedIterations(0), ThreadedRoutine(nullptr),
+        Context(nullptr), BaseIndex(0), ParkedWorkerCount(0), Shutdown(false)
+{
+}
+
+MLAS_THREAD_POOL::~MLAS_THREAD_POOL(
+    void
+    )
+/*++
+
+Routine Description:
+
+    This routine signals the worker threads to terminate and waits for them to
+    exit.
+
+Arguments:
+
+    None.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    {
+        std::lock_guard<std::mutex> ParkGuard(ParkLock);
+        Shutdown = true;
+    }
+
+    ParkCondition.notify_all();
+
+    for (auto& Worker : Workers) {
+        Worker.join();
+    }
+}
+
+MLAS_THREAD_POOL*
+MlasGetThreadPool(
+    void
+    )
+{
+    //
+    // The pool is constructed on first use so that no threads are created
+    // for processes that never execute threaded work.
+    //
+
+    static MLAS_THREAD_POOL ThreadPool;
+
+    return &ThreadPool;
+}
+
+void
+MlasThreadPoolExecuteIterations(
+    MLAS_THREAD_POOL* ThreadPool,
+    uint32_t Generation
+    )
+/*++
+
+Routine Description:
+
+    This routine claims and executes iterations from the current batch of
+    threaded work until no iterations remain or until the batch is replaced by
+    a newer generation.
+
+Arguments:
+
+    ThreadPool - Supplies the thread pool.
+
+    Generation - Supplies the generation of the batch of work to execute.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    uint64_t State = ThreadPool->State.load(std::memory_order_acquire);
+
+    for (;;) {
+
+        if (MLAS_THREAD_POOL_STATE_GENERATION(State) != Generation) {
+            break;
+        }
+
+        uint32_t Index = MLAS_THREAD_POOL_STATE_INDEX(State);
+
+        if (Index >= MLAS_THREAD_POOL_STATE_ITERATIONS(State)) {
+            break;
+        }
+
+        if (!ThreadPool->State.compare_exchange_weak(State, State + 1,
+                std::memory_order_acq_rel, std::memory_order_acquire)) {
+            continue;
+        }
+
+        //
+        // The iteration belongs to this generation, so the dispatching thread
+        // cannot modify the work parameters until the iteration is marked as
+        // completed.
+        //
+
+        ThreadPool->ThreadedRoutine(ThreadPool->Context, ThreadPool->BaseIndex + int32_t(Index));
+
+        ThreadPool->CompletedIterations.fetch_add(1, std::memory_order_release);
+
+        State = ThreadPool->State.load(std::memory_order_acquire);
+    }
+}
+
+void
+MlasThreadPoolWorker(
+    MLAS_THREAD_POOL* ThreadPool,
+    size_t WorkerIndex,
+    uint32_t Generation
+    )
+/*++
+
+Routine Description:
+
+    This routine is the entry point for a worker thread of the thread pool.
+
+Arguments:
+
+    ThreadPool - Supplies the thread pool.
+
+    WorkerIndex - Supplies the index of the thread in the pool's workers.
+
+    Generation - Supplies the generation of the most recently dispatched batch
+        of work at the time the thread was created.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasThreadPoolInsideDispatch = true;
+
+    for (;;) {
+
+        //
+        // Spin waiting for a new batch of work to be dispatched and then park
+        // the thread if no work arrives.
+        //
+
+        uint64_t State = ThreadPool->State.load(std::memory_order_acquire);
+        uint32_t SpinCount = 0;
+
+        while (MLAS_THREAD_POOL_STATE_GENERATION(State) == Generation) {
+
+            if (SpinCount < MLAS_THREAD_POOL_SPIN_COUNT) {
+                MlasYieldProcessor();
+                SpinCount++;
+                State = ThreadPool->State.load(std::memory_order_acquire);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> ParkGuard(ThreadPool->ParkLock);
+
+            //
+            // N.B. The parked worker count is published before the state is
+            // reloaded, and the dispatching thread publishes the state before
+            // reading the parked worker count, so either this thread observes
+            // the new batch or the dispatching thread signals the condition.
+            //
+
+            ThreadPool->ParkedWorkerCount.fetch_add(1);
+
+            for (;;) {
+
+                if (ThreadPool->Shutdown) {
+                    ThreadPool->ParkedWorkerCount.fetch_sub(1);
+                    return;
+                }
+
+                State = ThreadPool->State.load();
+
+                if (MLAS_THREAD_POOL_STATE_GENERATION(State) != Generation) {
+                    break;
+                }
+
+                ThreadPool->ParkCondition.wait(ParkGuard);
+            }
+
+            ThreadPool->ParkedWorkerCount.fetch_sub(1);
+        }
+
+        Generation = MLAS_THREAD_POOL_STATE_GENERATION(State);
+
+        //
+        // Exit if the pool has been shrunk below this worker. The generation
+        // that retires workers contains no iterations.
+        //
+
+        if (WorkerIndex >= ThreadPool->ActiveWorkerCount.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        MlasThreadPoolExecuteIterations(ThreadPool, Generation);
+    }
+}
+
+void
+MlasThreadPoolRetireWorkers(
+    MLAS_THREAD_POOL* ThreadPool,
+    size_t WorkerCount
+    )
+/*++
+
+Routine Description:
+
+    This routine reduces the number of worker threads in the thread pool. The
+    dispatch lock must be held by the caller.
+
+Arguments:
+
+    ThreadPool - Supplies the thread pool.
+
+    WorkerCount - Supplies the number of worker threads to keep.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    ThreadPool->ActiveWorkerCount.store(WorkerCount, std::memory_order_release);
+
+    //
+    // Publish an empty generation so that spinning and parked workers observe
+    // the new worker count.
+    //
+
+    uint32_t Generation = ++ThreadPool->Generation;
+
+    ThreadPool->State.store(MLAS_THREAD_POOL_STATE(Generation, 0, 0));
+
+    {
+        std::lock_guard<std::mutex> ParkGuard(ThreadPool->ParkLock);
+        ThreadPool->ParkCondition.notify_all();
+    }
+
+    while (ThreadPool->Workers.size() > WorkerCount) {
+        ThreadPool->Workers.back().join();
+        ThreadPool->Workers.pop_back();
+    }
+}
+
+bool
+MlasThreadPoolTryExecute(
+    PMLAS_THREADED_ROUTINE ThreadedRoutine,
+    void* Context,
+    int32_t Iterations
+    )
+/*++
+
+Routine Description:
+
+    This routine attempts to execute the threaded work using the persistent
+    worker thread pool. The calling thread participates in executing the
+    iterations.
+
+Arguments:
+
+    ThreadedRoutine - Supplies the routine to execute for each iteration.
+
+    Context - Supplies the context to pass to the routine.
+
+    Iterations - Supplies the number of iterations to execute.
+
+Return Value:
+
+    Returns true if the work was executed by the thread pool, else false if
+    the thread pool is unavailable and the work should be executed serially.
+
+--*/
+{
+    //
+    // A nested request from a worker thread or from the thread that is
+    // dispatching the current batch executes on the calling thread. The
+    // dispatching thread already owns the dispatch lock, so the lock cannot
+    // be used to detect this case.
+    //
+
+    if (MlasThreadPoolInsideDispatch) {
+        return false;
+    }
+
+    MLAS_THREAD_POOL* ThreadPool = MlasGetThreadPool();
+
+    //
+    // The thread pool executes one batch of work at a time. If the pool is
+    // busy with a batch from another thread, then fall back to the calling
+    // thread.
+    //
+
+    std::unique_lock<std::mutex> DispatchGuard(ThreadPool->DispatchLock, std::try_to_lock);
+
+    if (!DispatchGuard.owns_lock()) {
+        return false;
+    }
+
+    int32_t MaximumThreadCount = MlasPlatform.GetMaximumThreadCount();
+
+    //
+    // Adjust the number of worker threads to the current maximum thread
+    // count, accounting for the calling thread also executing iterations.
+    //
+
+    size_t WorkerCount = (MaximumThreadCount > 1) ? size_t(MaximumThreadCount - 1) : 0;
+
+    if (ThreadPool->Workers.size() > WorkerCount) {
+        MlasThreadPoolRetireWorkers(ThreadPool, WorkerCount);
+    }
+
+    if (MaximumThreadCount <= 1) {
+        return false;
+    }
+
+    ThreadPool->ActiveWorkerCount.store(WorkerCount, std::memory_order_release);
+
+    while (ThreadPool->Workers.size() < WorkerCount) {
+
+        try {
+            ThreadPool->Workers.emplace_back(MlasThreadPoolWorker, ThreadPool,
+                ThreadPool->Workers.size(), ThreadPool->Generation);
+        } catch (...) {
+            break;
+        }
+    }
+
+    if (ThreadPool->Workers.empty()) {
+        return false;
+    }
+
+    MlasThreadPoolInsideDispatch = true;
+
+    for (int32_t BaseIndex = 0; BaseIndex < Iterations;
+        BaseIndex += MLAS_THREAD_POOL_MAXIMUM_BATCH_ITERATIONS) {
+
+        uint32_t BatchIterations = uint32_t(Iterations - BaseIndex);
+
+        if (BatchIterations > MLAS_THREAD_POOL_MAXIMUM_BATCH_ITERATIONS) {
+            BatchIterations = MLAS_THREAD_POOL_MAXIMUM_BATCH_ITERATIONS;
+        }
+
+        //
+        // Publish the batch of work to the worker threads.
+        //
+
+        ThreadPool->ThreadedRoutine = ThreadedRoutine;
+        ThreadPool->Context = Context;
+        ThreadPool->BaseIndex = BaseIndex;
+        ThreadPool->CompletedIterations.store(0, std::memory_order_relaxed);
+
+        uint32_t Generation = ++ThreadPool->Generation;
+
+        ThreadPool->State.store(MLAS_THREAD_POOL_STATE(Generation, BatchIterations, 0));
+
+        if (ThreadPool->ParkedWorkerCount.load() != 0) {
+            std::lock_guard<std::mutex> ParkGuard(ThreadPool->ParkLock);
+            ThreadPool->ParkCondition.notify_all();
+        }
+
+        //
+        // Execute iterations on this thread and then wait for the iterations
+        // claimed by the worker threads to complete.
+        //
+
+        MlasThreadPoolExecuteIterations(ThreadPool, Generation);
+
+        uint32_t SpinCount = 0;
+
+        while (ThreadPool->CompletedIterations.load(std::memory_order_acquire) != BatchIterations) {
+
+            if (SpinCount < MLAS_THREAD_POOL_SPIN_COUNT) {
+                MlasYieldProcessor();
+                SpinCount++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    MlasThreadPoolInsideDispatch = false;
+
+    return true;
+}
+
+#endif
+
+int32_t
+MlasGetMaximumThreadCount(
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the maximum number of threads that a threaded
+    operation should be segmented across.
+
+Arguments:
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    Returns the maximum number of threads.
+
+--*/
+{
+    if (ThreadPool != nullptr) {
+
+        //
+        // The caller of the thread pool participates in the operation, so the
+        // available parallelism is one more than the number of workers.
+        //
+
+        int32_t MaximumThreadCount = ThreadPool->NumThreads() + 1;
+
+        if (MaximumThreadCount > MLAS_MAXIMUM_THREAD_COUNT) {
+            MaximumThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+        }
+
+        return MaximumThreadCount;
+    }
+
+    return MlasPlatform.GetMaximumThreadCount();
+}
+
 void
 MlasExecuteThreaded(
     MLAS_THREADED_ROUTINE ThreadedRoutine,
     void* Context,
-    int32_t Iterations
+    int32_t Iterations,
+    MLAS_THREADPOOL* ThreadPool
     )
+/*++
+
+Routine Description:
+
+    This routine executes the supplied routine for the specified number of
+    iterations, potentially across multiple threads, and waits for all
+    iterations to complete.
+
+Arguments:
+
+    ThreadedRoutine - Supplies the routine to execute for each iteration.
+
+    Context - Supplies the context to pass to the threaded routine.
+
+    Iterations - Supplies the number of iterations to execute.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
 {
     //
     // Execute the routine directly if only one iteration is specified.
@@ -85,6 +655,16 @@ MlasExecuteThreaded(
         return;
     }
 
+    //
+    // Use the caller supplied thread pool if available. This allows the
+    // threads to be shared with the other operations of the caller.
+    //
+
+    if (ThreadPool != nullptr) {
+        ThreadPool->ParallelFor(Iterations, [&](int32_t tid) { ThreadedRoutine(Context, tid); });
+        return;
+    }
+
 #if defined(MLAS_USE_WIN32_THREADPOOL)
 
     //
@@ -125,6 +705,18 @@ MlasExecuteThreaded(
     // Fallback to a serialized implementation.
     //
 
+#endif
+
+#if defined(MLAS_USE_POSIX_THREADPOOL)
+
+    //
+    // Execute the iterations using the persistent worker thread pool.
+    //
+
+    if (MlasThreadPoolTryExecute(ThreadedRoutine, Context, Iterations)) {
+        return;
+    }
+
 #endif
 
     //
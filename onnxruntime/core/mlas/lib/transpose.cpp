@@ -0,0 +1,573 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    transpose.cpp
+
+Abstract:
+
+    This module implements routines to transpose matrices of 8-bit, 16-bit,
+    32-bit and 64-bit elements.
+
+    The matrix is recursively split along its larger dimension until a block
+    fits in the first level cache, so that the rows read from the input and the
+    rows written to the output stay cached whatever the size of the matrix.
+    Each block is then transposed by micro kernels that transpose a square tile
+    of elements in vector registers.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Maximum number of rows or columns of a block transposed by the micro kernels.
+//
+
+#define MLAS_TRANSPOSE_BLOCK_SIZE                   64
+
+template<typename ElementType, size_t TileSize>
+inline
+void
+MlasTransposeTileGeneric(
+    const ElementType* Input,
+    ElementType* Output,
+    size_t ldInput,
+    size_t ldOutput
+    )
+/*++
+
+Routine Description:
+
+    This routine transposes a square tile of elements without intrinsics.
+
+Arguments:
+
+    Input - Supplies the tile of the input matrix.
+
+    Output - Supplies the tile of the output matrix.
+
+    ldInput - Supplies the number of elements between the rows of the input.
+
+    ldOutput - Supplies the number of elements between the rows of the output.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    for (size_t n = 0; n < TileSize; n++) {
+        for (size_t m = 0; m < TileSize; m++) {
+            Output[n * ldOutput + m] = Input[m * ldInput + n];
+        }
+    }
+}
+
+//
+// Micro kernels that transpose a square tile of TileSize rows of each element
+// size.
+//
+
+template<typename ElementType>
+struct MLAS_TRANSPOSE_TILE;
+
+template<>
+struct MLAS_TRANSPOSE_TILE<uint8_t>
+{
+    static constexpr size_t TileSize = 8;
+
+    static
+    void
+    Transpose(
+        const uint8_t* Input,
+        uint8_t* Output,
+        size_t ldInput,
+        size_t ldOutput
+        )
+    {
+#if defined(MLAS_SSE2_INTRINSICS)
+
+        __m128i a0 = _mm_loadl_epi64((const __m128i*)&Input[ldInput * 0]);
+        __m128i a1 = _mm_loadl_epi64((const __m128i*)&Input[ldInput * 1]);
+        __m128i a2 = _mm_loadl_epi64((const __m128i*)&Input[ldInput * 2]);
+        __m128i a3 = _mm_loadl_epi64((const __m128i*)&Input[ldInput * 3]);
+        __m128i a4 = _mm_loadl_epi64((const __m128i*)&Input[ldInput * 4]);
+        __m128i a5 = _mm_loadl_epi64((const __m128i*)&Input[ldInput * 5]);
+        __m128i a6 = _mm_loadl_epi64((const __m128i*)&Input[ldInput * 6]);
+        __m128i a7 = _mm_loadl_epi64((const __m128i*)&Input[ldInput * 7]);
+
+        //
+        // Interleave pairs of rows, then pairs of pairs, then the halves of
+        // the tile: each step doubles the number of rows gathered per column.
+        //
+
+        __m128i b0 = _mm_unpacklo_epi8(a0, a1);
+        __m128i b1 = _mm_unpacklo_epi8(a2, a3);
+        __m128i b2 = _mm_unpacklo_epi8(a4, a5);
+        __m128i b3 = _mm_unpacklo_epi8(a6, a7);
+
+        __m128i c0 = _mm_unpacklo_epi16(b0, b1);
+        __m128i c1 = _mm_unpackhi_epi16(b0, b1);
+        __m128i c2 = _mm_unpacklo_epi16(b2, b3);
+        __m128i c3 = _mm_unpackhi_epi16(b2, b3);
+
+        __m128i d0 = _mm_unpacklo_epi32(c0, c2);
+        __m128i d1 = _mm_unpackhi_epi32(c0, c2);
+        __m128i d2 = _mm_unpacklo_epi32(c1, c3);
+        __m128i d3 = _mm_unpackhi_epi32(c1, c3);
+
+        _mm_storel_epi64((__m128i*)&Output[ldOutput * 0], d0);
+        _mm_storel_epi64((__m128i*)&Output[ldOutput * 1], _mm_unpackhi_epi64(d0, d0));
+        _mm_storel_epi64((__m128i*)&Output[ldOutput * 2], d1);
+        _mm_storel_epi64((__m128i*)&Output[ldOutput * 3], _mm_unpackhi_epi64(d1, d1));
+        _mm_storel_epi64((__m128i*)&Output[ldOutput * 4], d2);
+        _mm_storel_epi64((__m128i*)&Output[ldOutput * 5], _mm_unpackhi_epi64(d2, d2));
+        _mm_storel_epi64((__m128i*)&Output[ldOutput * 6], d3);
+        _mm_storel_epi64((__m128i*)&Output[ldOutput * 7], _mm_unpackhi_epi64(d3, d3));
+
+#elif defined(MLAS_NEON_INTRINSICS)
+
+        uint8x8_t a0 = vld1_u8(&Input[ldInput * 0]);
+        uint8x8_t a1 = vld1_u8(&Input[ldInput * 1]);
+        uint8x8_t a2 = vld1_u8(&Input[ldInput * 2]);
+        uint8x8_t a3 = vld1_u8(&Input[ldInput * 3]);
+        uint8x8_t a4 = vld1_u8(&Input[ldInput * 4]);
+        uint8x8_t a5 = vld1_u8(&Input[ldInput * 5]);
+        uint8x8_t a6 = vld1_u8(&Input[ldInput * 6]);
+        uint8x8_t a7 = vld1_u8(&Input[ldInput * 7]);
+
+        //
+        // Transpose the 2x2 tiles of bytes, then of 16-bit pairs, then of
+        // 32-bit quads.
+        //
+
+        uint8x8x2_t b01 = vtrn_u8(a0, a1);
+        uint8x8x2_t b23 = vtrn_u8(a2, a3);
+        uint8x8x2_t b45 = vtrn_u8(a4, a5);
+        uint8x8x2_t b67 = vtrn_u8(a6, a7);
+
+        uint16x4x2_t c02 = vtrn_u16(vreinterpret_u16_u8(b01.val[0]), vreinterpret_u16_u8(b23.val[0]));
+        uint16x4x2_t c13 = vtrn_u16(vreinterpret_u16_u8(b01.val[1]), vreinterpret_u16_u8(b23.val[1]));
+        uint16x4x2_t c46 = vtrn_u16(vreinterpret_u16_u8(b45.val[0]), vreinterpret_u16_u8(b67.val[0]));
+        uint16x4x2_t c57 = vtrn_u16(vreinterpret_u16_u8(b45.val[1]), vreinterpret_u16_u8(b67.val[1]));
+
+        uint32x2x2_t d04 = vtrn_u32(vreinterpret_u32_u16(c02.val[0]), vreinterpret_u32_u16(c46.val[0]));
+        uint32x2x2_t d26 = vtrn_u32(vreinterpret_u32_u16(c02.val[1]), vreinterpret_u32_u16(c46.val[1]));
+        uint32x2x2_t d15 = vtrn_u32(vreinterpret_u32_u16(c13.val[0]), vreinterpret_u32_u16(c57.val[0]));
+        uint32x2x2_t d37 = vtrn_u32(vreinterpret_u32_u16(c13.val[1]), vreinterpret_u32_u16(c57.val[1]));
+
+        vst1_u8(&Output[ldOutput * 0], vreinterpret_u8_u32(d04.val[0]));
+        vst1_u8(&Output[ldOutput * 1], vreinterpret_u8_u32(d15.val[0]));
+        vst1_u8(&Output[ldOutput * 2], vreinterpret_u8_u32(d26.val[0]));
+        vst1_u8(&Output[ldOutput * 3], vreinterpret_u8_u32(d37.val[0]));
+        vst1_u8(&Output[ldOutput * 4], vreinterpret_u8_u32(d04.val[1]));
+        vst1_u8(&Output[ldOutput * 5], vreinterpret_u8_u32(d15.val[1]));
+        vst1_u8(&Output[ldOutput * 6], vreinterpret_u8_u32(d26.val[1]));
+        vst1_u8(&Output[ldOutput * 7], vreinterpret_u8_u32(d37.val[1]));
+
+#else
+
+        MlasTransposeTileGeneric<uint8_t, TileSize>(Input, Output, ldInput, ldOutput);
+
+#endif
+    }
+};
+
+template<>
+struct MLAS_TRANSPOSE_TILE<uint16_t>
+{
+    static constexpr size_t TileSize = 8;
+
+    static
+    void
+    Transpose(
+        const uint16_t* Input,
+        uint16_t* Output,
+        size_t ldInput,
+        size_t ldOutput
+        )
+    {
+#if defined(MLAS_SSE2_INTRINSICS)
+
+        __m128i a0 = _mm_loadu_si128((const __m128i*)&Input[ldInput * 0]);
+        __m128i a1 = _mm_loadu_si128((const __m128i*)&Input[ldInput * 1]);
+        __m128i a2 = _mm_loadu_si128((const __m128i*)&Input[ldInput * 2]);
+        __m128i a3 = _mm_loadu_si128((const __m128i*)&Input[ldInput * 3]);
+        __m128i a4 = _mm_loadu_si128((const __m128i*)&Input[ldInput * 4]);
+        __m128i a5 = _mm_loadu_si128((const __m128i*)&Input[ldInput * 5]);
+        __m128i a6 = _mm_loadu_si128((const __m128i*)&Input[ldInput * 6]);
+        __m128i a7 = _mm_loadu_si128((const __m128i*)&Input[ldInput * 7]);
+
+        __m128i b0 = _mm_unpacklo_epi16(a0, a1);
+        __m128i b1 = _mm_unpackhi_epi16(a0, a1);
+        __m128i b2 = _mm_unpacklo_epi16(a2, a3);
+        __m128i b3 = _mm_unpackhi_epi16(a2, a3);
+        __m128i b4 = _mm_unpacklo_epi16(a4, a5);
+        __m128i b5 = _mm_unpackhi_epi16(a4, a5);
+        __m128i b6 = _mm_unpacklo_epi16(a6, a7);
+        __m128i b7 = _mm_unpackhi_epi16(a6, a7);
+
+        __m128i c0 = _mm_unpacklo_epi32(b0, b2);
+        __m128i c1 = _mm_unpackhi_epi32(b0, b2);
+        __m128i c2 = _mm_unpacklo_epi32(b1, b3);
+        __m128i c3 = _mm_unpackhi_epi32(b1, b3);
+        __m128i c4 = _mm_unpacklo_epi32(b4, b6);
+        __m128i c5 = _mm_unpackhi_epi32(b4, b6);
+        __m128i c6 = _mm_unpacklo_epi32(b5, b7);
+        __m128i c7 = _mm_unpackhi_epi32(b5, b7);
+
+        _mm_storeu_si128((__m128i*)&Output[ldOutput * 0], _mm_unpacklo_epi64(c0, c4));
+        _mm_storeu_si128((__m128i*)&Output[ldOutput * 1], _mm_unpackhi_epi64(c0, c4));
+        _mm_storeu_si128((__m128i*)&Output[ldOutput * 2], _mm_unpacklo_epi64(c1, c5));
+        _mm_storeu_si128((__m128i*)&Output[ldOutput * 3], _mm_unpackhi_epi64(c1, c5));
+        _mm_storeu_si128((__m128i*)&Output[ldOutput * 4], _mm_unpacklo_epi64(c2, c6));
+        _mm_storeu_si128((__m128i*)&Output[ldOutput * 5], _mm_unpackhi_epi64(c2, c6));
+        _mm_storeu_si128((__m128i*)&Output[ldOutput * 6], _mm_unpacklo_epi64(c3, c7));
+        _mm_storeu_si128((__m128i*)&Output[ldOutput * 7], _mm_unpackhi_epi64(c3, c7));
+
+#else
+
+        MlasTransposeTileGeneric<uint16_t, TileSize>(Input, Output, ldInput, ldOutput);
+
+#endif
+    }
+};
+
+template<>
+struct MLAS_TRANSPOSE_TILE<uint32_t>
+{
+    static constexpr size_t TileSize = 4;
+
+    static
+    void
+    Transpose(
+        const uint32_t* Input,
+        uint32_t* Output,
+        size_t ldInput,
+        size_t ldOutput
+        )
+    {
+#if defined(MLAS_SSE2_INTRINSICS)
+
+        __m128i a0 = _mm_loadu_si128((const __m128i*)&Input[ldInput * 0]);
+        __m128i a1 = _mm_loadu_si128((const __m128i*)&Input[ldInput * 1]);
+        __m128i a2 = _mm_loadu_si128((const __m128i*)&Input[ldInput * 2]);
+        __m128i a3 = _mm_loadu_si128((const __m128i*)&Input[ldInput * 3]);
+
+        __m128i b0 = _mm_unpacklo_epi32(a0, a1);
+        __m128i b1 = _mm_unpacklo_epi32(a2, a3);
+        __m128i b2 = _mm_unpackhi_epi32(a0, a1);
+        __m128i b3 = _mm_unpackhi_epi32(a2, a3);
+
+        _mm_storeu_si128((__m128i*)&Output[ldOutput * 0], _mm_unpacklo_epi64(b0, b1));
+        _mm_storeu_si128((__m128i*)&Output[ldOutput * 1], _mm_unpackhi_epi64(b0, b1));
+        _mm_storeu_si128((__m128i*)&Output[ldOutput * 2], _mm_unpacklo_epi64(b2, b3));
+        _mm_storeu_si128((__m128i*)&Output[ldOutput * 3], _mm_unpackhi_epi64(b2, b3));
+
+#elif defined(MLAS_NEON_INTRINSICS)
+
+        uint32x4_t a0 = vld1q_u32(&Input[ldInput * 0]);
+        uint32x4_t a1 = vld1q_u32(&Input[ldInput * 1]);
+        uint32x4_t a2 = vld1q_u32(&Input[ldInput * 2]);
+        uint32x4_t a3 = vld1q_u32(&Input[ldInput * 3]);
+
+        uint32x4x2_t b01 = vtrnq_u32(a0, a1);
+        uint32x4x2_t b23 = vtrnq_u32(a2, a3);
+
+        vst1q_u32(&Output[ldOutput * 0], vcombine_u32(vget_low_u32(b01.val[0]), vget_low_u32(b23.val[0])));
+        vst1q_u32(&Output[ldOutput * 1], vcombine_u32(vget_low_u32(b01.val[1]), vget_low_u32(b23.val[1])));
+        vst1q_u32(&Output[ldOutput * 2], vcombine_u32(vget_high_u32(b01.val[0]), vget_high_u32(b23.val[0])));
+        vst1q_u32(&Output[ldOutput * 3], vcombine_u32(vget_high_u32(b01.val[1]), vget_high_u32(b23.val[1])));
+
+#else
+
+        MlasTransposeTileGeneric<uint32_t, TileSize>(Input, Output, ldInput, ldOutput);
+
+#endif
+    }
+};
+
+template<>
+struct MLAS_TRANSPOSE_TILE<uint64_t>
+{
+    static constexpr size_t TileSize = 4;
+
+    static
+    void
+    Transpose(
+        const uint64_t* Input,
+        uint64_t* Output,
+        size_t ldInput,
+        size_t ldOutput
+        )
+    {
+        MlasTransposeTileGeneric<uint64_t, TileSize>(Input, Output, ldInput, ldOutput);
+    }
+};
+
+template<typename ElementType>
+void
+MlasTransposeBlock(
+    const ElementType* Input,
+    ElementType* Output,
+    size_t M,
+    size_t N,
+    size_t ldInput,
+    size_t ldOutput
+    )
+/*++
+
+Routine Description:
+
+    This routine transposes a block of a matrix that fits in the first level
+    cache. The tiles are transposed by the micro kernel of the element type and
+    the rows and columns left over are transposed one element at a time.
+
+Arguments:
+
+    Input - Supplies the block of the input matrix of M rows and N columns.
+
+    Output - Supplies the block of the output matrix of N rows and M columns.
+
+    M - Supplies the number of rows of the input block.
+
+    N - Supplies the number of columns of the input block.
+
+    ldInput - Supplies the number of elements between the rows of the input.
+
+    ldOutput - Supplies the number of elements between the rows of the output.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    constexpr size_t TileSize = MLAS_TRANSPOSE_TILE<ElementType>::TileSize;
+
+    size_t m = 0;
+
+    for (; m + TileSize <= M; m += TileSize) {
+
+        size_t n = 0;
+
+        for (; n + TileSize <= N; n += TileSize) {
+            MLAS_TRANSPOSE_TILE<ElementType>::Transpose(&Input[m * ldInput + n],
+                &Output[n * ldOutput + m], ldInput, ldOutput);
+        }
+
+        for (; n < N; n++) {
+            for (size_t mm = m; mm < m + TileSize; mm++) {
+                Output[n * ldOutput + mm] = Input[mm * ldInput + n];
+            }
+        }
+    }
+
+    for (; m < M; m++) {
+        for (size_t n = 0; n < N; n++) {
+            Output[n * ldOutput + m] = Input[m * ldInput + n];
+        }
+    }
+}
+
+template<typename ElementType>
+void
+MlasTransposeRecursive(
+    const ElementType* Input,
+    ElementType* Output,
+    size_t M,
+    size_t N,
+    size_t ldInput,
+    size_t ldOutput
+    )
+/*++
+
+Routine Description:
+
+    This routine transposes a matrix by splitting it in halves along its larger
+    dimension until the halves are small enough to be transposed as a block.
+
+Arguments:
+
+    Input - Supplies the input matrix of M rows and N columns.
+
+    Output - Supplies the output matrix of N rows and M columns.
+
+    M - Supplies the number of rows of the input matrix.
+
+    N - Supplies the number of columns of the input matrix.
+
+    ldInput - Supplies the number of elements between the rows of the input.
+
+    ldOutput - Supplies the number of elements between the rows of the output.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    constexpr size_t TileSize = MLAS_TRANSPOSE_TILE<ElementType>::TileSize;
+
+    while (M > MLAS_TRANSPOSE_BLOCK_SIZE || N > MLAS_TRANSPOSE_BLOCK_SIZE) {
+
+        //
+        // Split at a multiple of the tile size so that the micro kernels
+        // cover the whole of the first half.
+        //
+
+        if (M >= N) {
+
+            size_t M1 = (M / 2 + TileSize - 1) / TileSize * TileSize;
+
+            MlasTransposeRecursive(Input, Output, M1, N, ldInput, ldOutput);
+
+            Input += M1 * ldInput;
+            Output += M1;
+            M -= M1;
+
+        } else {
+
+            size_t N1 = (N / 2 + TileSize - 1) / TileSize * TileSize;
+
+            MlasTransposeRecursive(Input, Output, M, N1, ldInput, ldOutput);
+
+            Input += N1;
+            Output += N1 * ldOutput;
+            N -= N1;
+        }
+    }
+
+    MlasTransposeBlock(Input, Output, M, N, ldInput, ldOutput);
+}
+
+void
+MLASCALL
+MlasTranspose(
+    const uint8_t* Input,
+    uint8_t* Output,
+    size_t M,
+    size_t N,
+    size_t ldInput,
+    size_t ldOutput
+    )
+/*++
+
+Routine Description:
+
+    This routine transposes a matrix of 8-bit elements.
+
+Arguments:
+
+    Input - Supplies the input matrix of M rows and N columns.
+
+    Output - Supplies the output matrix of N rows and M columns. It must not
+        overlap the input matrix.
+
+    M - Supplies the number of rows of the input matrix.
+
+    N - Supplies the number of columns of the input matrix.
+
+    ldInput - Supplies the number of elements between the rows of the input.
+
+    ldOutput - Supplies the number of elements between the rows of the output.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasTransposeRecursive(Input, Output, M, N, ldInput, ldOutput);
+}
+
+void
+MLASCALL
+MlasTranspose(
+    const uint16_t* Input,
+    uint16_t* Output,
+    size_t M,
+    size_t N,
+    size_t ldInput,
+    size_t ldOutput
+    )
+/*++
+
+Routine Description:
+
+    This routine transposes a matrix of 16-bit elements.
+
+Arguments:
+
+    See the 8-bit version of MlasTranspose.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasTransposeRecursive(Input, Output, M, N, ldInput, ldOutput);
+}
+
+void
+MLASCALL
+MlasTranspose(
+    const uint32_t* Input,
+    uint32_t* Output,
+    size_t M,
+    size_t N,
+    size_t ldInput,
+    size_t ldOutput
+    )
+/*++
+
+Routine Description:
+
+    This routine transposes a matrix of 32-bit elements.
+
+Arguments:
+
+    See the 8-bit version of MlasTranspose.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasTransposeRecursive(Input, Output, M, N, ldInput, ldOutput);
+}
+
+void
+MLASCALL
+MlasTranspose(
+    const uint64_t* Input,
+    uint64_t* Output,
+    size_t M,
+    size_t N,
+    size_t ldInput,
+    size_t ldOutput
+    )
+/*++
+
+Routine Description:
+
+    This routine transposes a matrix of 64-bit elements.
+
+Arguments:
+
+    See the 8-bit version of MlasTranspose.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasTransposeRecursive(Input, Output, M, N, ldInput, ldOutput);
+}
@@ -109,6 +109,17 @@ class Env {
   virtual common::Status FileOpenWr(const std::string& path, /*out*/ int& fd) const = 0;
   //Mainly for use with protobuf library
   virtual common::Status FileClose(int fd) const = 0;
+
+  /// A read-only view of a region of a file, which is unmapped when the pointer is destroyed
+  using MappedMemoryPtr = std::unique_ptr<char[], std::function<void(char*)>>;
+
+  /// \brief Map length bytes of the file at path, starting at offset, into memory for reading.
+  ///
+  /// The pages are backed by the file, so they are only read from disk when they are accessed and are shared
+  /// with every other process mapping the same file. The offset doesn't need to be aligned to pages.
+  /// A length of 0 yields a null mapped_memory.
+  virtual common::Status MapFileIntoMemory(const std::string& path, size_t offset, size_t length,
+                                           /*out*/ MappedMemoryPtr& mapped_memory) const = 0;
   //This functions is always successful. It can't fail.
   virtual PIDType GetSelfPid() const = 0;
 
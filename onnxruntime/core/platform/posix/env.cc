@@ -15,6 +15,7 @@ limitations under the License.
 // Portions Copyright (c) Microsoft Corporation
 
 #include <unistd.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -119,6 +120,44 @@ class PosixEnv : public Env {
     return Status::OK();
   }
 
+  common::Status MapFileIntoMemory(const std::string& path, size_t offset, size_t length,
+                                   MappedMemoryPtr& mapped_memory) const override {
+    mapped_memory = MappedMemoryPtr{};
+    if (length == 0) {
+      return Status::OK();
+    }
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (0 > fd) {
+      return common::Status(common::SYSTEM, errno, "Failed to open " + path + ": " + strerror(errno));
+    }
+
+    // reading a mapped page past the end of the file raises SIGBUS, so check the region up front
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || static_cast<uint64_t>(file_stat.st_size) < static_cast<uint64_t>(offset) ||
+        static_cast<uint64_t>(file_stat.st_size) - offset < length) {
+      close(fd);
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "File ", path, " is too small to hold ", length,
+                             " bytes at offset ", offset);
+    }
+
+    // the mapping itself has to start at a page boundary
+    static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t offset_in_page = offset % page_size;
+    const size_t mapped_length = length + offset_in_page;
+    void* mapped_base = mmap(nullptr, mapped_length, PROT_READ, MAP_SHARED, fd,
+                             static_cast<off_t>(offset - offset_in_page));
+    const int mmap_error = errno;
+    close(fd);  // the mapping keeps the file open
+    if (mapped_base == MAP_FAILED) {
+      return common::Status(common::SYSTEM, mmap_error, "Failed to map " + path + ": " + strerror(mmap_error));
+    }
+
+    mapped_memory = MappedMemoryPtr{static_cast<char*>(mapped_base) + offset_in_page,
+                                    [mapped_base, mapped_length](char*) { munmap(mapped_base, mapped_length); }};
+    return Status::OK();
+  }
+
   virtual common::Status LoadDynamicLibrary(const std::string& library_filename, void** handle) const override {
     char* error_str = dlerror();  // clear any old error_str
     *handle = dlopen(library_filename.c_str(), RTLD_NOW | RTLD_LOCAL);
@@ -0,0 +1,196 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/platform/threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+#include <unsupported/Eigen/CXX11/ThreadPool>
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
+
+namespace onnxruntime {
+namespace concurrency {
+
+namespace {
+
+// State shared between the caller of ParallelFor and the helper tasks it schedules. Helpers may be dequeued
+// after the loop has already completed (e.g. if the caller ran every iteration itself), so the state is
+// reference counted and a late helper simply finds no iterations left to claim.
+struct ParallelForState {
+  ParallelForState(int32_t total_in, std::function<void(int32_t)> fn_in)
+      : total(total_in), fn(std::move(fn_in)) {}
+
+  const int32_t total;
+  const std::function<void(int32_t)> fn;
+
+  std::atomic<int32_t> next{0};
+  std::atomic<bool> failed{false};
+
+  std::mutex mutex;
+  std::condition_variable all_done;
+  int32_t completed = 0;
+  std::exception_ptr error;
+};
+
+void RunIterations(ParallelForState& state) {
+  int32_t done = 0;
+
+  for (;;) {
+    const int32_t i = state.next.fetch_add(1, std::memory_order_relaxed);
+    if (i >= state.total) {
+      break;
+    }
+
+    // once an iteration has failed the remaining ones are claimed but skipped
+    if (!state.failed.load(std::memory_order_relaxed)) {
+      try {
+        state.fn(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!state.error) {
+          state.error = std::current_exception();
+        }
+        state.failed.store(true, std::memory_order_relaxed);
+      }
+    }
+
+    ++done;
+  }
+
+  if (done != 0) {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.completed += done;
+    if (state.completed == state.total) {
+      state.all_done.notify_all();
+    }
+  }
+}
+
+}  // namespace
+
+class ThreadPool::Impl {
+ public:
+  Impl(const std::string& name, int num_threads) {
+    ORT_UNUSED_PARAMETER(name);
+    if (num_threads > 0) {
+      pool_ = std::make_unique<Eigen::ThreadPool>(num_threads);
+    }
+  }
+
+  void Schedule(std::function<void()> fn) {
+    if (pool_) {
+      pool_->Schedule(std::move(fn));
+    } else {
+      fn();
+    }
+  }
+
+  void ParallelFor(int32_t total, std::function<void(int32_t)> fn) {
+    if (total <= 0) {
+      return;
+    }
+
+    const int32_t num_helpers = std::min<int32_t>(total - 1, NumThreads());
+
+    if (num_helpers == 0) {
+      for (int32_t i = 0; i < total; i++) {
+        fn(i);
+      }
+      return;
+    }
+
+    auto state = std::make_shared<ParallelForState>(total, std::move(fn));
+
+    for (int32_t i = 0; i < num_helpers; i++) {
+      pool_->Schedule([state]() { RunIterations(*state); });
+    }
+
+    // the caller always participates. this guarantees forward progress when called from a pool worker or when
+    // all workers are busy with other requests.
+    RunIterations(*state);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->all_done.wait(lock, [&state]() { return state->completed == state->total; });
+
+    if (state->error) {
+      std::rethrow_exception(state->error);
+    }
+  }
+
+  int NumThreads() const {
+    return pool_ ? pool_->NumThreads() : 0;
+  }
+
+  int CurrentThreadId() const {
+    return pool_ ? pool_->CurrentThreadId() : -1;
+  }
+
+ private:
+  std::unique_ptr<Eigen::ThreadPool> pool_;
+};
+
+ThreadPool::ThreadPool(const std::string& name, int num_threads)
+    : impl_(std::make_unique<Impl>(name, num_threads)) {
+}
+
+ThreadPool::~ThreadPool() = default;
+
+void ThreadPool::Schedule(std::function<void()> fn) {
+  impl_->Schedule(std::move(fn));
+}
+
+void ThreadPool::ParallelFor(int32_t total, std::function<void(int32_t)> fn) {
+  impl_->ParallelFor(total, std::move(fn));
+}
+
+constexpr int64_t ThreadPool::kMinBlockCost;
+
+void ThreadPool::TryParallelFor(ThreadPool* tp, int64_t total, int64_t cost_per_unit,
+                                const std::function<void(int64_t first, int64_t last)>& fn,
+                                int64_t alignment, int64_t min_block_cost) {
+  if (total <= 0) {
+    return;
+  }
+
+  alignment = std::max<int64_t>(alignment, 1);
+  auto align = [alignment](int64_t units) { return (units + alignment - 1) / alignment * alignment; };
+
+  int64_t block_size = align(std::max<int64_t>(1, min_block_cost / std::max<int64_t>(cost_per_unit, 1)));
+  // ParallelFor takes int32_t iterations
+  if ((total + block_size - 1) / block_size > INT32_MAX) {
+    block_size = align((total + INT32_MAX - 1) / INT32_MAX);
+  }
+
+  const int64_t num_blocks = (total + block_size - 1) / block_size;
+  if (tp == nullptr || num_blocks <= 1) {
+    fn(0, total);
+    return;
+  }
+
+  tp->ParallelFor(static_cast<int32_t>(num_blocks), [&](int32_t block) {
+    const int64_t first = block * block_size;
+    fn(first, std::min(first + block_size, total));
+  });
+}
+
+int ThreadPool::NumThreads() const {
+  return impl_->NumThreads();
+}
+
+int ThreadPool::CurrentThreadId() const {
+  return impl_->CurrentThreadId();
+}
+
+}  // namespace concurrency
+}  // namespace onnxruntime
@@ -0,0 +1,82 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "core/common/common.h"
+
+namespace onnxruntime {
+
+namespace concurrency {
+
+/**
+ * Thread pool used for intra-op parallelism.
+ *
+ * A single instance is owned by the InferenceSession and shared by all CPU kernels (MLAS, RNN, element-wise ops)
+ * so that a session never oversubscribes the machine regardless of how many operators want to run in parallel.
+ * The calling thread always participates in ParallelFor, so a pool created with num_threads == 0 is valid and
+ * simply runs everything on the caller.
+ */
+class ThreadPool {
+ public:
+  /**
+  Create a pool with the given number of worker threads. The effective parallelism of ParallelFor is
+  num_threads + 1 as the caller executes iterations too.
+  */
+  ThreadPool(const std::string& name, int num_threads);
+
+  ~ThreadPool();
+
+  /**
+  Enqueue fn for asynchronous execution. If the pool has no worker threads fn is run inline.
+  */
+  void Schedule(std::function<void()> fn);
+
+  /**
+  Execute fn(i) for each i in [0, total) using the pool workers and the calling thread, and wait for all
+  iterations to complete. Safe to call concurrently from multiple threads and from within a pool worker.
+  If any iteration throws, the first exception is rethrown on the calling thread once all claimed iterations
+  have finished.
+  */
+  void ParallelFor(int32_t total, std::function<void(int32_t)> fn);
+
+  /**
+  Minimum number of elements processed by each block of TryParallelFor, large enough to amortize the cost of
+  dispatching a block to the pool.
+  */
+  static constexpr int64_t kMinBlockCost = 16384;
+
+  /**
+  Split [0, total) into contiguous blocks and execute fn(first, last) for each of them with ParallelFor on tp, or
+  fn(0, total) on the calling thread if tp is nullptr or the range is a single block.
+  Each unit of the range processes cost_per_unit elements, and each block but the last processes at least
+  min_block_cost elements. The blocks start at multiples of alignment, e.g. so that they do not write to the same
+  cache lines.
+  */
+  static void TryParallelFor(ThreadPool* tp, int64_t total, int64_t cost_per_unit,
+                             const std::function<void(int64_t first, int64_t last)>& fn,
+                             int64_t alignment = 1, int64_t min_block_cost = kMinBlockCost);
+
+  /**
+  Number of worker threads owned by the pool. Does not include the caller of ParallelFor.
+  */
+  int NumThreads() const;
+
+  /**
+  Index of the current thread within the pool in [0, NumThreads()), or -1 if not a pool worker.
+  */
+  int CurrentThreadId() const;
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ThreadPool);
+};
+
+}  // namespace concurrency
+}  // namespace onnxruntime
@@ -134,6 +134,51 @@ class WindowsEnv : public Env {
     return Status::OK();
   }
 
+  common::Status MapFileIntoMemory(const std::string& path, size_t offset, size_t length,
+                                   MappedMemoryPtr& mapped_memory) const override {
+    mapped_memory = MappedMemoryPtr{};
+    if (length == 0) {
+      return Status::OK();
+    }
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Failed to open ", path, ", error code: ", GetLastError());
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || static_cast<uint64_t>(file_size.QuadPart) < offset ||
+        static_cast<uint64_t>(file_size.QuadPart) - offset < length) {
+      CloseHandle(file);
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "File ", path, " is too small to hold ", length,
+                             " bytes at offset ", offset);
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);  // the mapping keeps the file open
+    if (mapping == nullptr) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Failed to map ", path, ", error code: ", GetLastError());
+    }
+
+    // a view has to start at a multiple of the allocation granularity
+    SYSTEM_INFO sysInfo;
+    GetSystemInfo(&sysInfo);
+    const uint64_t offset_in_view = offset % sysInfo.dwAllocationGranularity;
+    const uint64_t view_offset = offset - offset_in_view;
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, static_cast<DWORD>(view_offset >> 32),
+                               static_cast<DWORD>(view_offset & 0xFFFFFFFF),
+                               static_cast<SIZE_T>(length + offset_in_view));
+    CloseHandle(mapping);  // the view keeps the mapping alive
+    if (view == nullptr) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Failed to map ", path, ", error code: ", GetLastError());
+    }
+
+    mapped_memory = MappedMemoryPtr{static_cast<char*>(view) + offset_in_view,
+                                    [view](char*) { UnmapViewOfFile(view); }};
+    return Status::OK();
+  }
+
   virtual Status LoadDynamicLibrary(const std::string& library_filename, void** handle) const override {
     ORT_UNUSED_PARAMETER(library_filename);
     ORT_UNUSED_PARAMETER(handle);
@@ -3,9 +3,20 @@
 
 #include "core/providers/cpu/activation/activations.h"
 #include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
 
 namespace onnxruntime {
 
+namespace {
+template <typename TFunc>
+void ComputeElementwiseInParallel(concurrency::ThreadPool* tp, const float* input, float* output, int64_t size,
+                                  TFunc&& compute) {
+  concurrency::ThreadPool::TryParallelFor(tp, size, 1, [&](int64_t first, int64_t last) {
+    compute(input + first, output + first, last - first);
+  });
+}
+}  // namespace
+
 #define REGISTER_UNARY_ELEMENTWISE_KERNEL_ALIAS(alias, x, sinceVersion)                              \
   ONNX_CPU_OPERATOR_KERNEL(                                                                          \
       alias,                                                                                         \
@@ -35,7 +46,11 @@ Status Sigmoid<float>::Compute(OpKernelContext* context) const {
   const Tensor* X = context->Input<Tensor>(0);
   const auto& x_shape = X->Shape();
   Tensor* Y = context->Output(0, x_shape);
-  MlasComputeLogistic(X->template Data<float>(), Y->template MutableData<float>(), x_shape.Size());
+  ComputeElementwiseInParallel(context->GetOperatorThreadPool(), X->template Data<float>(),
+                               Y->template MutableData<float>(), x_shape.Size(),
+                               [](const float* input, float* output, int64_t count) {
+                                 MlasComputeLogistic(input, output, static_cast<size_t>(count));
+                               });
   return Status::OK();
 }
 
@@ -44,7 +59,11 @@ Status Tanh<float>::Compute(OpKernelContext* context) const {
   const Tensor* X = context->Input<Tensor>(0);
   const auto& x_shape = X->Shape();
   Tensor* Y = context->Output(0, x_shape);
-  MlasComputeTanh(X->template Data<float>(), Y->template MutableData<float>(), x_shape.Size());
+  ComputeElementwiseInParallel(context->GetOperatorThreadPool(), X->template Data<float>(),
+                               Y->template MutableData<float>(), x_shape.Size(),
+                               [](const float* input, float* output, int64_t count) {
+                                 MlasComputeTanh(input, output, static_cast<size_t>(count));
+                               });
   return Status::OK();
 }
 
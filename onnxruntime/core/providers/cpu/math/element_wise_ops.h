@@ -5,6 +5,7 @@
 
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
+#include "core/platform/threadpool.h"
 #include "core/util/math_cpuonly.h"
 
 namespace onnxruntime {
@@ -349,6 +350,18 @@ struct BroadcastIterator {
     return index;
   }
 
+  // Position the iterator at the given element of the output, as if AdvanceBy had been called with a total of offset
+  void Seek(size_t offset) {
+    index_ = 0;
+    // the number of steps taken by each counter in turn
+    size_t steps = offset;
+    for (size_t counterIndex = 0; counterIndex < counters_.size(); counterIndex++) {
+      index_ += deltas_[counterIndex] * steps;
+      counters_[counterIndex] = static_cast<int64_t>(steps % static_cast<size_t>(counts_[counterIndex]));
+      steps /= static_cast<size_t>(counts_[counterIndex]);
+    }
+  }
+
   void Init(int64_t axis, int64_t largest) {
     ORT_ENFORCE(axis == 1 || axis == largest, "Attempting to broadcast an axis by a dimension other than 1. ", axis, " by ", largest);
 
@@ -504,6 +517,16 @@ struct TBroadcaster {
   ConstEigenVectorMap<T> NextEigen0() { return ConstEigenVectorMap<T>(Next0(), span_size_); }
   ConstEigenVectorMap<T> NextEigen1() { return ConstEigenVectorMap<T>(Next1(), span_size_); }
 
+  // count elements of the next span, starting at its element offset
+  ConstEigenVectorMap<T> NextEigen0(size_t offset, size_t count) { return ConstEigenVectorMap<T>(Next0() + offset, count); }
+  ConstEigenVectorMap<T> NextEigen1(size_t offset, size_t count) { return ConstEigenVectorMap<T>(Next1() + offset, count); }
+
+  // Continue from the span that holds the given element of the output
+  void Seek(size_t offset) {
+    broadcaster_.iterator1_.Seek(offset);
+    broadcaster_.iterator2_.Seek(offset);
+  }
+
  private:
   const T* Next0() { return input0_ + broadcaster_.iterator1_.AdvanceBy(span_size_); }
   const T* Next1() { return input1_ + broadcaster_.iterator2_.AdvanceBy(span_size_); }
@@ -567,29 +590,77 @@ struct TensorAllocator {
   AllocatorPtr allocator_;
 };
 
-// Broadcast loop for when using eigen, functions are in this form:
-// Input0Scalar: [](EigenVectorMap<T> output, T input0, ConstEigenVectorMap<T> input1)
-// Input1Scalar: [](EigenVectorMap<T> output, ConstEigenVectorMap<T> input0, T input1)
-// General     : [](EigenVectorMap<T> output, ConstEigenVectorMap<T> input0, ConstEigenVectorMap<T> input1)
-template <typename TBroadcaster, typename Output, typename Input0Scalar, typename Input1Scalar, typename General>
-void BroadcastLoop(TBroadcaster& bc, Output& output, Input0Scalar input0scalar, Input1Scalar input1scalar, General general) {
+// Minimum number of output elements worth giving to each thread when a broadcast is split across the thread pool
+constexpr int64_t kMinBroadcastElementsPerThread = 16 * 1024;
+
+// Broadcast the output elements [begin, end) using a copy of the broadcaster positioned at begin.
+// A range may start and end part way through a span, in which case the functions get part of a span.
+template <typename TInput, typename TOutput, typename Input0Scalar, typename Input1Scalar, typename General>
+void BroadcastRange(TBroadcaster<TInput> bc, TOutput* output, size_t begin, size_t end,
+                    const Input0Scalar& input0scalar, const Input1Scalar& input1scalar, const General& general) {
+  const size_t span_size = bc.GetSpanSize();
+  size_t offset = begin;
+  size_t span_offset = begin % span_size;
+  bc.Seek(begin - span_offset);
+
   if (bc.IsInput0Scalar()) {
-    while (output)
-      input0scalar(output.NextEigenOutput(), bc.NextScalar0(), bc.NextEigen1());
+    while (offset < end) {
+      const size_t count = std::min(span_size - span_offset, end - offset);
+      input0scalar(EigenVectorMap<TOutput>(output + offset, count), bc.NextScalar0(), bc.NextEigen1(span_offset, count));
+      offset += count;
+      span_offset = 0;
+    }
   } else if (bc.IsInput1Scalar()) {
-    while (output)
-      input1scalar(output.NextEigenOutput(), bc.NextEigen0(), bc.NextScalar1());
+    while (offset < end) {
+      const size_t count = std::min(span_size - span_offset, end - offset);
+      input1scalar(EigenVectorMap<TOutput>(output + offset, count), bc.NextEigen0(span_offset, count), bc.NextScalar1());
+      offset += count;
+      span_offset = 0;
+    }
   } else {
-    while (output)
-      general(output.NextEigenOutput(), bc.NextEigen0(), bc.NextEigen1());
+    while (offset < end) {
+      const size_t count = std::min(span_size - span_offset, end - offset);
+      general(EigenVectorMap<TOutput>(output + offset, count), bc.NextEigen0(span_offset, count), bc.NextEigen1(span_offset, count));
+      offset += count;
+      span_offset = 0;
+    }
   }
 }
 
+// Broadcast loop for when using eigen, functions are in this form:
+// Input0Scalar: [](EigenVectorMap<T> output, T input0, ConstEigenVectorMap<T> input1)
+// Input1Scalar: [](EigenVectorMap<T> output, ConstEigenVectorMap<T> input0, T input1)
+// General     : [](EigenVectorMap<T> output, ConstEigenVectorMap<T> input0, ConstEigenVectorMap<T> input1)
+// Large outputs are split into contiguous ranges across the thread pool, so the functions must be safe to call
+// concurrently.
+template <typename TInput, typename TOutput, typename Input0Scalar, typename Input1Scalar, typename General>
+void BroadcastLoop(TBroadcaster<TInput>& bc, Tensor& output_tensor, concurrency::ThreadPool* tp,
+                   Input0Scalar input0scalar, Input1Scalar input1scalar, General general) {
+  TOutput* output = output_tensor.template MutableData<TOutput>();
+  const int64_t output_size = output_tensor.Shape().Size();
+  if (output_size == 0)
+    return;
+
+  int64_t num_tasks = tp ? std::min<int64_t>(tp->NumThreads() + 1, output_size / kMinBroadcastElementsPerThread) : 1;
+  if (num_tasks <= 1) {
+    BroadcastRange(bc, output, 0, static_cast<size_t>(output_size), input0scalar, input1scalar, general);
+    return;
+  }
+
+  const int64_t elements_per_task = (output_size + num_tasks - 1) / num_tasks;
+  num_tasks = (output_size + elements_per_task - 1) / elements_per_task;
+  tp->ParallelFor(static_cast<int32_t>(num_tasks), [&](int32_t task) {
+    const int64_t begin = task * elements_per_task;
+    const int64_t end = std::min(begin + elements_per_task, output_size);
+    BroadcastRange(bc, output, static_cast<size_t>(begin), static_cast<size_t>(end), input0scalar, input1scalar, general);
+  });
+}
+
 template <typename TInput, typename TOutput, typename Input0Scalar, typename Input1Scalar, typename General>
 Status BroadcastTwo(OpKernelContext& context, Input0Scalar input0scalar, Input1Scalar input1scalar, General general) {
   TBroadcaster<TInput> bc(*context.Input<Tensor>(0), *context.Input<Tensor>(1));
-  TBroadcastOutput<TOutput> output(bc.GetSpanSize(), *context.Output(0, bc.GetOutputShape()));
-  BroadcastLoop(bc, output, input0scalar, input1scalar, general);
+  Tensor& output = *context.Output(0, bc.GetOutputShape());
+  BroadcastLoop<TInput, TOutput>(bc, output, context.GetOperatorThreadPool(), input0scalar, input1scalar, general);
 
   return Status::OK();
 }
@@ -626,9 +697,7 @@ Status BroadcastVariadic(const Node& node, OpKernelContext& context, Input0Scala
       p_output = tempOutput.get();
     }
 
-    TBroadcastOutput<TOutput> output(bc.GetSpanSize(), *p_output);
-
-    BroadcastLoop(bc, output, input0scalar, input1scalar, general);
+    BroadcastLoop<TInput, TOutput>(bc, *p_output, context.GetOperatorThreadPool(), input0scalar, input1scalar, general);
 
     tempInput = std::move(tempOutput);
   }
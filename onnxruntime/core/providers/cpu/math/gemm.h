@@ -8,6 +8,7 @@
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
 #include "gemm_helper.h"
+#include "gemm_packed_b.h"
 
 namespace onnxruntime {
 
@@ -27,6 +28,9 @@ class Gemm final : public OpKernel {
 
     ORT_ENFORCE(info.GetAttr<float>("alpha", &alpha_).IsOK());
     ORT_ENFORCE(info.GetAttr<float>("beta", &beta_).IsOK());
+
+    // a constant W is packed once instead of by every call to math::Gemm
+    packed_w_.TryPack(info, 1, trans_B_ != CblasNoTrans);
   }
 
   Status Compute(OpKernelContext* context) const override {
@@ -91,6 +95,12 @@ class Gemm final : public OpKernel {
     }
 
     // W * x
+    if (packed_w_.IsPacked()) {
+      packed_w_.Gemm(trans_A_, M, alpha_, X->template Data<T_X>(), beta_, Y->template MutableData<T_Y>(),
+                     context->GetOperatorThreadPool());
+      return Status::OK();
+    }
+
     math::Gemm<T_X, CPUMathUtil>(
         trans_A_,
         trans_B_,
@@ -102,7 +112,8 @@ class Gemm final : public OpKernel {
         W->template Data<T_W>(),
         beta_,
         Y->template MutableData<T_Y>(),
-        &CPUMathUtil::Instance());
+        &CPUMathUtil::Instance(),
+        context->GetOperatorThreadPool());
 
     return Status::OK();
   }
@@ -112,6 +123,7 @@ class Gemm final : public OpKernel {
   CBLAS_TRANSPOSE trans_B_;
   float alpha_;
   float beta_;
+  GemmPackedB packed_w_;
 };
 
 }  // namespace onnxruntime
@@ -0,0 +1,67 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/providers/cpu/math/gemm_packed_b.h"
+
+namespace onnxruntime {
+
+// alignment of the packed buffer required by the SGEMM kernels
+static constexpr size_t kPackedBAlignment = 64;
+
+bool GemmPackedB::TryPack(const OpKernelInfo& info, int input_index, bool trans_b) {
+  const Tensor* B;
+  if (!info.TryGetConstantInput(input_index, &B) || B->DataType() != DataTypeImpl::GetType<float>() ||
+      B->Shape().NumDimensions() != 2) {
+    return false;
+  }
+
+  return Pack(info, B->Data<float>(), B->Shape()[trans_b ? 0 : 1], B->Shape()[trans_b ? 1 : 0], trans_b);
+}
+
+bool GemmPackedB::Pack(const OpKernelInfo& info, const float* B, int64_t N, int64_t K, bool trans_b) {
+#if defined(USE_MKLDNN)
+  // math::Gemm uses MKL-DNN rather than MLAS, so keep B in its original layout.
+  ORT_UNUSED_PARAMETER(info);
+  ORT_UNUSED_PARAMETER(B);
+  ORT_UNUSED_PARAMETER(N);
+  ORT_UNUSED_PARAMETER(K);
+  ORT_UNUSED_PARAMETER(trans_b);
+  return false;
+#else
+  if (N == 0 || K == 0) {
+    return false;
+  }
+
+  N_ = N;
+  K_ = K;
+
+  AllocatorPtr alloc = info.GetExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+  const size_t packed_size = MlasSgemmPackBSize(static_cast<size_t>(N_), static_cast<size_t>(K_));
+  buffer_ = BufferUniquePtr(alloc->Alloc(packed_size + kPackedBAlignment - 1), BufferDeleter(alloc));
+  void* packed_b = reinterpret_cast<void*>(
+      (reinterpret_cast<uintptr_t>(buffer_.get()) + kPackedBAlignment - 1) & ~(kPackedBAlignment - 1));
+
+  MlasSgemmPackB(trans_b ? CblasTrans : CblasNoTrans, static_cast<size_t>(N_), static_cast<size_t>(K_),
+                 B, static_cast<size_t>(trans_b ? K_ : N_), packed_b);
+  packed_b_ = packed_b;
+  return true;
+#endif
+}
+
+void GemmPackedB::Gemm(CBLAS_TRANSPOSE trans_a, int64_t M, float alpha, const float* A, float beta, float* Y,
+                       concurrency::ThreadPool* tp) const {
+  Gemm(trans_a, M, alpha, A, static_cast<size_t>(trans_a == CblasNoTrans ? K_ : M), beta, Y,
+       static_cast<size_t>(N_), tp);
+}
+
+void GemmPackedB::Gemm(CBLAS_TRANSPOSE trans_a, int64_t M, float alpha, const float* A, size_t lda, float beta,
+                       float* Y, size_t ldy, concurrency::ThreadPool* tp) const {
+  if (M == 0) {
+    return;
+  }
+
+  MlasSgemm(trans_a, static_cast<size_t>(M), static_cast<size_t>(N_), static_cast<size_t>(K_), alpha, A, lda,
+            packed_b_, beta, Y, ldy, tp);
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,64 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "core/framework/allocator.h"
+#include "core/framework/op_kernel.h"
+#include "core/mlas/inc/mlas.h"
+
+namespace onnxruntime {
+
+/**
+The B operand of a float GEMM packed once into the panel layout of the MLAS SGEMM kernels, so that a kernel
+whose weight is a constant initializer does not repack it on every call.
+*/
+class GemmPackedB {
+ public:
+  /**
+  Pack the input input_index of the kernel if it is a 2-D float constant initializer.
+  @param trans_b whether the input is used transposed, i.e. has a shape of (N, K) instead of (K, N).
+  @returns true if the input was packed.
+  */
+  bool TryPack(const OpKernelInfo& info, int input_index, bool trans_b);
+
+  /**
+  Pack B, a constant of shape (K, N), or of shape (N, K) if trans_b, with rows that are contiguous.
+  The buffer is allocated from the execution provider of the kernel.
+  @returns true if B was packed.
+  */
+  bool Pack(const OpKernelInfo& info, const float* B, int64_t N, int64_t K, bool trans_b);
+
+  bool IsPacked() const {
+    return packed_b_ != nullptr;
+  }
+
+  int64_t N() const {
+    return N_;
+  }
+
+  int64_t K() const {
+    return K_;
+  }
+
+  /**
+  Y = alpha * op(A) * B + beta * Y, where op(A) has M rows.
+  */
+  void Gemm(CBLAS_TRANSPOSE trans_a, int64_t M, float alpha, const float* A, float beta, float* Y,
+            concurrency::ThreadPool* tp) const;
+
+  /**
+  As above, with the leading dimensions of A and Y given, e.g. to multiply a block of rows of a larger matrix.
+  */
+  void Gemm(CBLAS_TRANSPOSE trans_a, int64_t M, float alpha, const float* A, size_t lda, float beta, float* Y,
+            size_t ldy, concurrency::ThreadPool* tp) const;
+
+ private:
+  BufferUniquePtr buffer_;
+  const void* packed_b_ = nullptr;
+  int64_t N_ = 0;
+  int64_t K_ = 0;
+};
+
+}  // namespace onnxruntime
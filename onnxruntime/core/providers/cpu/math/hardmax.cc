@@ -2,48 +2,52 @@
 // Licensed under the MIT License.
 
 #include "core/providers/cpu/math/hardmax.h"
-#include "core/util/math_cpuonly.h"
-#include "core/util/math.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "core/platform/threadpool.h"
 
 namespace onnxruntime {
 
+namespace {
+// set the first maximum of each of the count rows to 1 and the other elements to 0
+void HardmaxRows(const float* Xdata, float* Ydata, int64_t count, int64_t D) {
+  for (int64_t i = 0; i < count; ++i) {
+    const float* x = Xdata + i * D;
+    float* y = Ydata + i * D;
+    std::fill_n(y, D, 0.f);
+    if (D > 0) {
+      y[std::max_element(x, x + D) - x] = 1.f;
+    }
+  }
+}
+}  // namespace
+
 template <>
 Status Hardmax<float>::Compute(OpKernelContext* ctx) const {
   const Tensor* X = ctx->Input<Tensor>(0);
   const TensorShape& input_shape = X->Shape();
   const float* Xdata = X->template Data<float>();
 
-  size_t tmpN = input_shape.SizeToDimension(axis_);
-  size_t tmpD = input_shape.SizeFromDimension(axis_);
+  const int64_t N = input_shape.SizeToDimension(axis_);
+  const int64_t D = input_shape.SizeFromDimension(axis_);
 
-  // Math::RowwiseMax expects int N and D.
-  if (tmpN * tmpD > INT32_MAX || tmpN > INT32_MAX || tmpD > INT32_MAX) {
+  // the rows are split across the thread pool with int32_t task indices
+  if (N * D > INT32_MAX || N > INT32_MAX || D > INT32_MAX) {
     std::ostringstream ss;
-    ss << "Hardmax inputs N, D and N * D must be < " << INT32_MAX << ". N=" << tmpN << ", D=" << tmpD;
+    ss << "Hardmax inputs N, D and N * D must be < " << INT32_MAX << ". N=" << N << ", D=" << D;
     std::string msg = ss.str();
 
     return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT, msg);
   }
 
-  const int N = gsl::narrow_cast<int>(tmpN);
-  const int D = gsl::narrow_cast<int>(tmpD);
-
-  std::vector<float> rowmax_(N);
-  float* rowmax_data = rowmax_.data();
-  math::RowwiseMax<float, CPUMathUtil>(N, D, Xdata, rowmax_data, nullptr);
-
   Tensor* Y = ctx->Output(0, input_shape);
   float* Ydata = Y->template MutableData<float>();
-  math::Set<float, CPUMathUtil>(input_shape.Size(), 0.f, Ydata, &CPUMathUtil::Instance());
-
-  for (int i = 0; i < N; ++i) {
-    for (int j = 0; j < D; ++j) {
-      if (Xdata[i * D + j] == rowmax_data[i]) {
-        Ydata[i * D + j] = 1;
-        break;
-      }
-    }
-  }
+
+  concurrency::ThreadPool::TryParallelFor(ctx->GetOperatorThreadPool(), N, D, [&](int64_t first, int64_t last) {
+    HardmaxRows(Xdata + first * D, Ydata + first * D, last - first, D);
+  });
 
   return Status::OK();
 }
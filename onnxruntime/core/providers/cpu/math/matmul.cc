@@ -3,6 +3,7 @@
 
 #include "core/providers/cpu/math/matmul.h"
 
+#include "core/mlas/inc/mlas.h"
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
 #include "matmul_helper.h"
@@ -26,7 +27,21 @@ Status MatMul<float>::Compute(OpKernelContext* ctx) const {
 
   Tensor* Y = ctx->Output(0, helper.OutputShape());
 
-  // TODO: replace it with GemmBatch for performance, it's OK for now as GemmBatch unrolls as well
+  if (packed_right_.IsPacked()) {
+    // the right input is 2-D, so the matrices of the left input and of the output follow each other and are
+    // multiplied as one matrix of all their rows
+    packed_right_.Gemm(CblasNoTrans,
+                       helper.M() * static_cast<int64_t>(helper.OutputOffsets().size()),
+                       /* alpha */ 1.0f,
+                       left_X->template Data<float>(),
+                       /* beta */ 0.0f,
+                       Y->template MutableData<float>(),
+                       ctx->GetOperatorThreadPool());
+
+    return Status::OK();
+  }
+
+#if defined(USE_MKLDNN)
   for (int i = 0; i < helper.OutputOffsets().size(); i++) {
     math::Gemm<float, CPUMathUtil>(
         CblasNoTrans,
@@ -39,8 +54,29 @@ Status MatMul<float>::Compute(OpKernelContext* ctx) const {
         right_X->template Data<float>() + helper.RightOffsets()[i],
         /* beta */ 0.0f,
         Y->template MutableData<float>() + helper.OutputOffsets()[i],
-        &CPUMathUtil::Instance());
+        &CPUMathUtil::Instance(),
+        ctx->GetOperatorThreadPool());
   }
+#else
+  // all the broadcast matrices are multiplied by one batched call, which splits them across the thread pool
+  const size_t batch_count = helper.OutputOffsets().size();
+  std::vector<const float*> left_matrices(batch_count);
+  std::vector<const float*> right_matrices(batch_count);
+  std::vector<float*> output_matrices(batch_count);
+  for (size_t i = 0; i < batch_count; i++) {
+    left_matrices[i] = left_X->template Data<float>() + helper.LeftOffsets()[i];
+    right_matrices[i] = right_X->template Data<float>() + helper.RightOffsets()[i];
+    output_matrices[i] = Y->template MutableData<float>() + helper.OutputOffsets()[i];
+  }
+
+  const size_t M = static_cast<size_t>(helper.M());
+  const size_t N = static_cast<size_t>(helper.N());
+  const size_t K = static_cast<size_t>(helper.K());
+  MlasSgemmBatch(CblasNoTrans, CblasNoTrans, M, N, K, /* alpha */ 1.0f,
+                 left_matrices.data(), K, right_matrices.data(), N,
+                 /* beta */ 0.0f, output_matrices.data(), N,
+                 batch_count, ctx->GetOperatorThreadPool());
+#endif
 
   return Status::OK();
 }
@@ -5,6 +5,7 @@
 
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
+#include "gemm_packed_b.h"
 
 namespace onnxruntime {
 
@@ -13,9 +14,14 @@ class MatMul final : public OpKernel {
  public:
   MatMul(const OpKernelInfo& info)
       : OpKernel(info) {
+    // a constant 2-D right input is packed once instead of by every call to math::Gemm
+    packed_right_.TryPack(info, 1, false);
   }
 
   Status Compute(OpKernelContext* context) const override;
+
+ private:
+  GemmPackedB packed_right_;
 };
 
 }  // namespace onnxruntime
@@ -19,16 +19,25 @@
 #include "core/common/exceptions.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/tensor.h"
+#include "core/platform/threadpool.h"
+#include "core/providers/common.h"
 #include "core/util/math_cpuonly.h"
-#include <queue>
+#include <algorithm>
 using namespace std;
 namespace onnxruntime {
 // spec https://github.com/onnx/onnx/blob/master/docs/Operators.md#TopK
-ONNX_CPU_OPERATOR_KERNEL(
-    TopK,
-    1,
-    KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()).TypeConstraint("I", DataTypeImpl::GetTensorType<int64_t>()),
-    TopK<float>);
+#define REGISTER_TOPK_KERNEL(T)                                                                        \
+  ONNX_CPU_OPERATOR_TYPED_KERNEL(                                                                      \
+      TopK,                                                                                            \
+      1,                                                                                               \
+      T,                                                                                               \
+      KernelDefBuilder()                                                                               \
+          .TypeConstraint("T", DataTypeImpl::GetTensorType<T>())                                       \
+          .TypeConstraint("I", DataTypeImpl::GetTensorType<int64_t>()),                                \
+      TopK<T>);
+
+REGISTER_TOPK_KERNEL(float);
+REGISTER_TOPK_KERNEL(double);
 
 static int64_t SizeToDim(size_t k, const vector<int64_t>& dims) {
   ORT_ENFORCE(k <= dims.size());
@@ -39,96 +48,186 @@ static int64_t SizeToDim(size_t k, const vector<int64_t>& dims) {
   return r;
 }
 
-// Define these two names to allow lookup into the 2d tensors like
-// mytensor(i, j)
-template <typename T>
-using EigenMatrixMapRowMajor = Eigen::Map<
-    Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>;
+namespace {
+// the heap is used while k is at most this fraction of the searched elements: past the first elements, most are
+// smaller than the smallest kept one and are rejected without touching the heap.
+constexpr int64_t kHeapMaxFraction = 8;
 
-template <typename T>
-using ConstEigenMatrixMapRowMajor = Eigen::Map<
-    const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>;
+// elements are checked against the smallest kept one a block at a time, with a vectorized max
+constexpr int64_t kFilterBlockSize = 64;
 
+// a row is split across tasks only when its chunks hold at least this many times k elements, so that merging the
+// top k of every chunk stays cheap
+constexpr int64_t kMinChunkToK = 4;
+
+// Orders the elements as TopK outputs them: greater values first, and lower indices first among equal values.
 template <typename T>
 struct ValueCmp {
   bool operator()(
       const pair<T, int64_t>& lhs,
-      const pair<T, int64_t>& rhs) {
+      const pair<T, int64_t>& rhs) const {
     return (
         lhs.first > rhs.first ||
         (lhs.first == rhs.first && lhs.second < rhs.second));
   }
 };
 
-template <>
-Status TopK<float>::Compute(OpKernelContext* p_op_kernel_context) const {
+// Selects the k greatest of the n contiguous values, sorted by ValueCmp. The index of the first value is
+// first_index.
+template <typename T>
+void SelectTopK(const T* values, int64_t n, int64_t k, int64_t first_index, vector<pair<T, int64_t>>& selected) {
+  const ValueCmp<T> cmp;
+  k = std::min(k, n);
+  selected.clear();
+
+  if (k * kHeapMaxFraction <= n) {
+    // a heap of the k greatest values so far, the smallest one at the front
+    selected.reserve(k);
+    int64_t j = 0;
+    for (; j < k; ++j) {
+      selected.emplace_back(values[j], first_index + j);
+    }
+    make_heap(selected.begin(), selected.end(), cmp);
+
+    while (j < n) {
+      // the values that follow the kept ones only replace them when greater, equal values have greater indices
+      const int64_t block_end = std::min(j + kFilterBlockSize, n);
+      if (ConstEigenVectorArrayMap<T>(values + j, block_end - j).maxCoeff() <= selected.front().first) {
+        j = block_end;
+        continue;
+      }
+      for (; j < block_end; ++j) {
+        if (values[j] > selected.front().first) {
+          pop_heap(selected.begin(), selected.end(), cmp);
+          selected.back() = {values[j], first_index + j};
+          push_heap(selected.begin(), selected.end(), cmp);
+        }
+      }
+    }
+    sort_heap(selected.begin(), selected.end(), cmp);
+    return;
+  }
+
+  // k is a large part of n, partition around the k-th value and sort what comes before it
+  selected.reserve(n);
+  for (int64_t j = 0; j < n; ++j) {
+    selected.emplace_back(values[j], first_index + j);
+  }
+  if (k < n) {
+    nth_element(selected.begin(), selected.begin() + (k - 1), selected.end(), cmp);
+    selected.resize(k);
+  }
+  sort(selected.begin(), selected.end(), cmp);
+}
+
+// Returns the elements [begin, end) of a row whose consecutive elements are stride apart, contiguous.
+template <typename T>
+const T* GetRowElements(const T* row, int64_t stride, int64_t begin, int64_t end, vector<T>& buffer) {
+  if (stride == 1) {
+    return row + begin;
+  }
+  buffer.resize(end - begin);
+  for (int64_t j = begin; j < end; ++j) {
+    buffer[j - begin] = row[j * stride];
+  }
+  return buffer.data();
+}
+}  // namespace
+
+template <typename T>
+Status TopK<T>::Compute(OpKernelContext* p_op_kernel_context) const {
   const Tensor* X = p_op_kernel_context->Input<Tensor>(0);
   if (X == nullptr) return Status(common::ONNXRUNTIME, common::FAIL, "input count mismatch");
   const vector<int64_t>& in_dims = X->Shape().GetDims();
+  const auto axis = static_cast<size_t>(HandleNegativeAxis(axis_, static_cast<int64_t>(in_dims.size())));
 
-  // Linearize input tensor except for last dimension
-  // e.g. [3, 4, 5] -> [12, 5]
-  // [5] -> [5]
-  if (in_dims.back() < k_) {
+  if (in_dims[axis] < k_) {
     ostringstream err_msg;
-    err_msg << "k argment [" << k_ << "] should not be greater than last dim [" << in_dims.back() << "]";
+    err_msg << "k argment [" << k_ << "] should not be greater than the dim [" << in_dims[axis] << "] of axis ["
+            << axis << "]";
     return Status(common::ONNXRUNTIME, common::FAIL, err_msg.str());
   }
 
-  vector<int64_t> linear_shape = {SizeToDim(in_dims.size() - 1, in_dims),
-                                  in_dims[in_dims.size() - 1]};
-  auto input_map = ConstEigenMatrixMapRowMajor<float>(
-      static_cast<const float*>(X->template Data<float>()),
-      linear_shape[0],
-      linear_shape[1]);
-
-  // Resize output tensors to be the same shape as the linearized input except
-  // for the last dimension, which will be of size k. E.x. for an input tensor
-  // of shape [3, 4, 5] and k=2, both of these will be shape [3, 4, 2]
-  vector<int64_t> output_linear_shape = {linear_shape[0], k_};
-  auto* Values = p_op_kernel_context->Output(0, output_linear_shape);
-  auto* Indices = p_op_kernel_context->Output(1, output_linear_shape);
-
-  // Use Eigen maps to allow indexing into the 2d tensors like Values_map(i,j)
-  auto Values_map = EigenMatrixMapRowMajor<float>(
-      Values->template MutableData<float>(), linear_shape[0], k_);
-  auto Indices_map = EigenMatrixMapRowMajor<int64_t>(
-      Indices->template MutableData<int64_t>(), linear_shape[0], k_);
-
-  // Sort preserving Indices
-  for (int64_t i = 0; i < linear_shape[0]; ++i) {
-    // Build a min-heap, the heap element is pair of (value, idx)
-    // the top of the heap is the smallest value
-    priority_queue<
-        pair<float, int64_t>,
-        vector<pair<float, int64_t>>,
-        ValueCmp<float>>
-        min_heap;
-
-    // Maintain the size of heap to be less or equal to k_, so the
-    // heap will hold the k_ largest Values
-    for (int64_t j = 0; j < linear_shape[1]; ++j) {
-      const auto value = input_map(i, j);
-      if (min_heap.size() < k_ || value > min_heap.top().first) {
-        min_heap.push({value, j});
-      }
-      if (min_heap.size() > k_) {
-        min_heap.pop();
-      }
+  // The input is seen as [outer, n, inner] and every one of its outer * inner rows of n elements, inner elements
+  // apart, is reduced to the k greatest. The outputs are [outer, k, inner], in the layout of the input.
+  // e.g. [3, 4, 5] with axis 1 -> 15 rows of 4 elements, 5 elements apart
+  const int64_t outer = SizeToDim(axis, in_dims);
+  const int64_t n = in_dims[axis];
+  int64_t inner = 1;
+  for (size_t i = axis + 1; i < in_dims.size(); ++i) {
+    inner *= in_dims[i];
+  }
+  const int64_t k = k_;
+
+  auto out_dims = in_dims;
+  out_dims[axis] = k;
+  auto* Values = p_op_kernel_context->Output(0, out_dims);
+  auto* Indices = p_op_kernel_context->Output(1, out_dims);
+
+  const int64_t num_rows = outer * inner;
+  if (num_rows == 0) {
+    return Status::OK();
+  }
+
+  const T* input_data = X->template Data<T>();
+  T* values_data = Values->template MutableData<T>();
+  int64_t* indices_data = Indices->template MutableData<int64_t>();
+
+  auto write_row = [&](int64_t row, const vector<pair<T, int64_t>>& selected) {
+    const int64_t offset = (row / inner) * k * inner + row % inner;
+    for (int64_t j = 0; j < k; ++j) {
+      values_data[offset + j * inner] = selected[j].first;
+      indices_data[offset + j * inner] = selected[j].second;
     }
-    for (int64_t j = 0; j < k_; ++j) {
-      auto& pqElem = min_heap.top();
-      Values_map(i, k_ - j - 1) = pqElem.first;
-      Indices_map(i, k_ - j - 1) = pqElem.second;
-      min_heap.pop();
+  };
+
+  auto select_rows = [&](int64_t begin, int64_t end) {
+    vector<T> buffer;
+    vector<pair<T, int64_t>> selected;
+    for (int64_t row = begin; row < end; ++row) {
+      const T* row_data = input_data + (row / inner) * n * inner + row % inner;
+      SelectTopK(GetRowElements(row_data, inner, 0, n, buffer), n, k, 0, selected);
+      write_row(row, selected);
     }
+  };
+
+  concurrency::ThreadPool* tp = p_op_kernel_context->GetOperatorThreadPool();
+  const int64_t num_tasks = (num_rows * n + concurrency::ThreadPool::kMinBlockCost - 1) /
+                            concurrency::ThreadPool::kMinBlockCost;
+  if (tp == nullptr || num_rows >= num_tasks) {
+    concurrency::ThreadPool::TryParallelFor(tp, num_rows, n, select_rows);
+    return Status::OK();
   }
 
-  // Reshape output tensors to [a_1, a_2, ..., a_n, k]
-  auto out_dims = in_dims;
-  out_dims[out_dims.size() - 1] = k_;
-  Values->Reshape(out_dims);
-  Indices->Reshape(out_dims);
+  // fewer rows than tasks, split the rows in chunks, select the k greatest of every chunk and merge them
+  const int64_t num_chunks = std::min((num_tasks + num_rows - 1) / num_rows, n / (k * kMinChunkToK));
+  if (num_chunks <= 1) {
+    tp->ParallelFor(static_cast<int32_t>(num_rows), [&](int32_t row) { select_rows(row, row + 1); });
+    return Status::OK();
+  }
+
+  vector<vector<pair<T, int64_t>>> chunk_selected(num_rows * num_chunks);
+  tp->ParallelFor(static_cast<int32_t>(num_rows * num_chunks), [&](int32_t task) {
+    const int64_t row = task / num_chunks;
+    const int64_t chunk = task % num_chunks;
+    const int64_t begin = n * chunk / num_chunks;
+    const int64_t end = n * (chunk + 1) / num_chunks;
+    const T* row_data = input_data + (row / inner) * n * inner + row % inner;
+    vector<T> buffer;
+    SelectTopK(GetRowElements(row_data, inner, begin, end, buffer), end - begin, k, begin, chunk_selected[task]);
+  });
+
+  tp->ParallelFor(static_cast<int32_t>(num_rows), [&](int32_t row) {
+    vector<pair<T, int64_t>> candidates;
+    candidates.reserve(num_chunks * k);
+    for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+      const auto& selected = chunk_selected[row * num_chunks + chunk];
+      candidates.insert(candidates.end(), selected.cbegin(), selected.cend());
+    }
+    partial_sort(candidates.begin(), candidates.begin() + k, candidates.end(), ValueCmp<T>());
+    write_row(row, candidates);
+  });
+
   return Status::OK();
 }
 }  // namespace onnxruntime
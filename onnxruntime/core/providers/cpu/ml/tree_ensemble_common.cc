@@ -0,0 +1,141 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/providers/cpu/ml/tree_ensemble_common.h"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
+namespace onnxruntime {
+namespace ml {
+
+constexpr uint32_t TreeEnsemble::kFeatureMask;
+constexpr uint32_t TreeEnsemble::kModeShift;
+constexpr uint32_t TreeEnsemble::kModeMask;
+constexpr uint32_t TreeEnsemble::kMissingTracksTrueFlag;
+constexpr int64_t TreeEnsemble::kMaxTreeDepth;
+constexpr int64_t TreeEnsemble::kSamplesPerBlock;
+constexpr int64_t TreeEnsemble::kMinTreeWalksPerTask;
+constexpr int64_t TreeEnsemble::kMinTreesPerTask;
+
+static const int64_t kOffset = 4000000000L;
+
+TreeEnsemble::TreeEnsemble(const std::vector<int64_t>& nodes_treeids,
+                           const std::vector<int64_t>& nodes_nodeids,
+                           const std::vector<int64_t>& nodes_featureids,
+                           const std::vector<float>& nodes_values,
+                           const std::vector<NODE_MODE>& nodes_modes,
+                           const std::vector<int64_t>& nodes_truenodeids,
+                           const std::vector<int64_t>& nodes_falsenodeids,
+                           const std::vector<int64_t>& nodes_missing_value_tracks_true,
+                           const std::vector<int64_t>& weights_treeids,
+                           const std::vector<int64_t>& weights_nodeids,
+                           const std::vector<int64_t>& weights_ids,
+                           const std::vector<float>& weights) {
+  const size_t num_nodes = nodes_treeids.size();
+  ORT_ENFORCE(num_nodes == nodes_nodeids.size());
+  ORT_ENFORCE(num_nodes == nodes_featureids.size());
+  ORT_ENFORCE(num_nodes == nodes_values.size());
+  ORT_ENFORCE(num_nodes == nodes_modes.size());
+  ORT_ENFORCE(num_nodes == nodes_truenodeids.size());
+  ORT_ENFORCE(num_nodes == nodes_falsenodeids.size());
+  ORT_ENFORCE(weights_treeids.size() == weights_nodeids.size());
+  ORT_ENFORCE(weights_treeids.size() == weights_ids.size());
+  ORT_ENFORCE(weights_treeids.size() == weights.size());
+  ORT_ENFORCE(num_nodes < std::numeric_limits<uint32_t>::max() &&
+                  weights.size() < std::numeric_limits<uint32_t>::max(),
+              "Tree ensemble is too large.");
+
+  const bool use_missing_tracks_true = nodes_missing_value_tracks_true.size() == num_nodes;
+
+  // position of every node, keyed by tree id and node id
+  std::unordered_map<int64_t, size_t> indices;
+  for (size_t i = 0; i < num_nodes; ++i) {
+    ORT_ENFORCE(indices.emplace(nodes_treeids[i] * kOffset + nodes_nodeids[i], i).second,
+                "Node ", nodes_nodeids[i], " appears more than once in tree ", nodes_treeids[i]);
+  }
+
+  // children of the branches, and the roots which are the nodes no branch points to
+  std::vector<size_t> true_children(num_nodes);
+  std::vector<size_t> false_children(num_nodes);
+  std::vector<bool> has_parent(num_nodes, false);
+  auto find_child = [&](size_t i, int64_t child_id) {
+    auto it = indices.find(nodes_treeids[i] * kOffset + child_id);
+    ORT_ENFORCE(it != indices.end(), "Child node ", child_id, " of node ", nodes_nodeids[i],
+                " was not found in tree ", nodes_treeids[i]);
+    has_parent[it->second] = true;
+    return it->second;
+  };
+
+  for (size_t i = 0; i < num_nodes; ++i) {
+    if (nodes_modes[i] == NODE_MODE::LEAF) continue;
+    true_children[i] = find_child(i, nodes_truenodeids[i]);
+    false_children[i] = find_child(i, nodes_falsenodeids[i]);
+  }
+
+  // weights of every node, in the order of the attributes
+  std::vector<std::vector<LeafWeight>> node_weights(num_nodes);
+  for (size_t i = 0, end = weights.size(); i < end; ++i) {
+    auto it = indices.find(weights_treeids[i] * kOffset + weights_nodeids[i]);
+    if (it == indices.end()) continue;
+    ORT_ENFORCE(weights_ids[i] >= 0 && weights_ids[i] < std::numeric_limits<int32_t>::max(),
+                "Invalid id ", weights_ids[i], " for the weight of node ", weights_nodeids[i]);
+    node_weights[it->second].push_back({static_cast<int32_t>(weights_ids[i]), weights[i]});
+    num_ids_ = std::max(num_ids_, weights_ids[i] + 1);
+  }
+
+  // lay out each tree depth first, with the true child of a branch right after it.
+  // a node reachable from several branches is only laid out once.
+  const uint32_t kNotPlaced = std::numeric_limits<uint32_t>::max();
+  std::vector<uint32_t> placed(num_nodes, kNotPlaced);
+  std::vector<size_t> order;
+  order.reserve(num_nodes);
+  std::vector<size_t> stack;
+  for (size_t root = 0; root < num_nodes; ++root) {
+    if (has_parent[root]) continue;
+
+    roots_.push_back(static_cast<uint32_t>(order.size()));
+    stack.push_back(root);
+    while (!stack.empty()) {
+      size_t i = stack.back();
+      stack.pop_back();
+      if (placed[i] != kNotPlaced) continue;
+
+      placed[i] = static_cast<uint32_t>(order.size());
+      order.push_back(i);
+      if (nodes_modes[i] != NODE_MODE::LEAF) {
+        stack.push_back(false_children[i]);
+        stack.push_back(true_children[i]);
+      }
+    }
+  }
+
+  nodes_.reserve(order.size());
+  for (size_t i : order) {
+    Node node;
+    node.threshold = nodes_values[i];
+    node.feature_and_flags = static_cast<uint32_t>(nodes_modes[i]) << kModeShift;
+    if (use_missing_tracks_true && nodes_missing_value_tracks_true[i] != 0) {
+      node.feature_and_flags |= kMissingTracksTrueFlag;
+    }
+
+    if (nodes_modes[i] == NODE_MODE::LEAF) {
+      node.true_index = static_cast<uint32_t>(weights_.size());
+      weights_.insert(weights_.end(), node_weights[i].cbegin(), node_weights[i].cend());
+      node.false_index = static_cast<uint32_t>(weights_.size());
+    } else {
+      ORT_ENFORCE(nodes_featureids[i] >= 0 && nodes_featureids[i] <= kFeatureMask,
+                  "Invalid feature id ", nodes_featureids[i], " for node ", nodes_nodeids[i]);
+      node.feature_and_flags |= static_cast<uint32_t>(nodes_featureids[i]);
+      max_feature_id_ = std::max(max_feature_id_, nodes_featureids[i]);
+      node.true_index = placed[true_children[i]];
+      node.false_index = placed[false_children[i]];
+    }
+
+    nodes_.push_back(node);
+  }
+}
+
+}  // namespace ml
+}  // namespace onnxruntime
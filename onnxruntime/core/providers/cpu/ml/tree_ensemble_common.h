@@ -0,0 +1,244 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/platform/threadpool.h"
+#include "ml_common.h"
+
+namespace onnxruntime {
+namespace ml {
+
+// The trees of a TreeEnsembleClassifier or TreeEnsembleRegressor compiled into one array of nodes.
+// The nodes of each tree are laid out depth first from its root, so the true child of a branch is the next node,
+// and the weights of all the leaves are in one table.
+class TreeEnsemble {
+ public:
+  struct Node {
+    float threshold;
+    // feature id in the low bits, then the NODE_MODE and whether a missing value takes the true branch
+    uint32_t feature_and_flags;
+    // for a branch, the index of the children in nodes_.
+    // for a leaf, the range of its weights in weights_.
+    uint32_t true_index;
+    uint32_t false_index;
+
+    NODE_MODE Mode() const {
+      return static_cast<NODE_MODE>((feature_and_flags >> kModeShift) & kModeMask);
+    }
+
+    uint32_t FeatureId() const {
+      return feature_and_flags & kFeatureMask;
+    }
+
+    bool MissingTracksTrue() const {
+      return (feature_and_flags & kMissingTracksTrueFlag) != 0;
+    }
+  };
+
+  struct LeafWeight {
+    int32_t id;
+    float weight;
+  };
+
+  static constexpr uint32_t kFeatureMask = (1u << 28) - 1;
+  static constexpr uint32_t kModeShift = 28;
+  static constexpr uint32_t kModeMask = 7;
+  static constexpr uint32_t kMissingTracksTrueFlag = 1u << 31;
+  static constexpr int64_t kMaxTreeDepth = 1000;
+
+  // weights_ids are the class ids for a classifier and the target ids for a regressor.
+  // nodes_missing_value_tracks_true is ignored unless it has a value for every node.
+  TreeEnsemble(const std::vector<int64_t>& nodes_treeids,
+               const std::vector<int64_t>& nodes_nodeids,
+               const std::vector<int64_t>& nodes_featureids,
+               const std::vector<float>& nodes_values,
+               const std::vector<NODE_MODE>& nodes_modes,
+               const std::vector<int64_t>& nodes_truenodeids,
+               const std::vector<int64_t>& nodes_falsenodeids,
+               const std::vector<int64_t>& nodes_missing_value_tracks_true,
+               const std::vector<int64_t>& weights_treeids,
+               const std::vector<int64_t>& weights_nodeids,
+               const std::vector<int64_t>& weights_ids,
+               const std::vector<float>& weights);
+
+  size_t NumTrees() const {
+    return roots_.size();
+  }
+
+  // one more than the largest id a leaf has a weight for
+  int64_t NumIds() const {
+    return num_ids_;
+  }
+
+  // largest feature id a branch reads, or -1 if there are no branches
+  int64_t MaxFeatureId() const {
+    return max_feature_id_;
+  }
+
+  // Add the leaf weights of all the trees for the num_samples rows of x to scores and has_scores, which have
+  // num_scores values per row. Large batches are split across the thread pool by rows. Small batches are split
+  // by trees, each task summing into its own buffer which is then added to scores.
+  template <typename T>
+  void ComputeScores(const T* x, int64_t num_samples, int64_t stride, float* scores, unsigned char* has_scores,
+                     int64_t num_scores, concurrency::ThreadPool* tp) const;
+
+ private:
+  // number of rows walked through a tree together so that the loads of their nodes overlap
+  static constexpr int64_t kSamplesPerBlock = 8;
+  // minimum number of tree walks worth splitting across threads, and of trees per task when splitting by trees
+  static constexpr int64_t kMinTreeWalksPerTask = 512;
+  static constexpr int64_t kMinTreesPerTask = 16;
+
+  template <typename T>
+  const Node* NextNode(const Node& node, const T* x) const;
+
+  // add the weights of a leaf to scores, and flag the ids that got one
+  void AddLeafWeights(const Node& leaf, float* scores, unsigned char* has_scores) const {
+    for (uint32_t i = leaf.true_index; i < leaf.false_index; ++i) {
+      const LeafWeight& w = weights_[i];
+      scores[w.id] += w.weight;
+      has_scores[w.id] = 1;
+    }
+  }
+
+  template <typename T>
+  void ComputeScores(size_t tree_begin, size_t tree_end, const T* x, int64_t num_samples, int64_t stride,
+                     float* scores, unsigned char* has_scores, int64_t num_scores) const;
+
+  std::vector<Node> nodes_;
+  std::vector<LeafWeight> weights_;
+  std::vector<uint32_t> roots_;
+  int64_t num_ids_ = 0;
+  int64_t max_feature_id_ = -1;
+};
+
+template <typename T>
+inline const TreeEnsemble::Node* TreeEnsemble::NextNode(const Node& node, const T* x) const {
+  const T val = x[node.FeatureId()];
+  const float threshold = node.threshold;
+  bool is_true;
+  switch (node.Mode()) {
+    case NODE_MODE::BRANCH_LEQ:
+      is_true = val <= threshold;
+      break;
+    case NODE_MODE::BRANCH_LT:
+      is_true = val < threshold;
+      break;
+    case NODE_MODE::BRANCH_GTE:
+      is_true = val >= threshold;
+      break;
+    case NODE_MODE::BRANCH_GT:
+      is_true = val > threshold;
+      break;
+    case NODE_MODE::BRANCH_EQ:
+      is_true = val == threshold;
+      break;
+    default:
+      is_true = val != threshold;
+      break;
+  }
+
+  if (!is_true && node.MissingTracksTrue() && std::isnan(static_cast<float>(val))) {
+    is_true = true;
+  }
+
+  return &nodes_[is_true ? node.true_index : node.false_index];
+}
+
+template <typename T>
+void TreeEnsemble::ComputeScores(size_t tree_begin, size_t tree_end, const T* x, int64_t num_samples,
+                                 int64_t stride, float* scores, unsigned char* has_scores,
+                                 int64_t num_scores) const {
+  const Node* nodes[kSamplesPerBlock];
+  for (int64_t first = 0; first < num_samples; first += kSamplesPerBlock) {
+    const int64_t count = std::min(kSamplesPerBlock, num_samples - first);
+    const T* block_x = x + first * stride;
+    for (size_t tree = tree_begin; tree < tree_end; ++tree) {
+      for (int64_t k = 0; k < count; ++k) {
+        nodes[k] = &nodes_[roots_[tree]];
+      }
+
+      // take one step down the tree for every row of the block in turn
+      for (int64_t depth = 0; depth < kMaxTreeDepth; ++depth) {
+        bool all_leaves = true;
+        for (int64_t k = 0; k < count; ++k) {
+          if (nodes[k]->Mode() != NODE_MODE::LEAF) {
+            nodes[k] = NextNode(*nodes[k], block_x + k * stride);
+            all_leaves = false;
+          }
+        }
+
+        if (all_leaves) break;
+      }
+
+      for (int64_t k = 0; k < count; ++k) {
+        if (nodes[k]->Mode() == NODE_MODE::LEAF) {
+          AddLeafWeights(*nodes[k], scores + (first + k) * num_scores, has_scores + (first + k) * num_scores);
+        }
+      }
+    }
+  }
+}
+
+template <typename T>
+void TreeEnsemble::ComputeScores(const T* x, int64_t num_samples, int64_t stride, float* scores,
+                                 unsigned char* has_scores, int64_t num_scores, concurrency::ThreadPool* tp) const {
+  const int64_t num_trees = static_cast<int64_t>(NumTrees());
+  const int64_t num_threads = tp ? tp->NumThreads() + 1 : 1;
+  if (num_threads == 1 || num_samples * num_trees < 2 * kMinTreeWalksPerTask) {
+    ComputeScores(0, NumTrees(), x, num_samples, stride, scores, has_scores, num_scores);
+    return;
+  }
+
+  if (num_samples >= num_threads * kSamplesPerBlock) {
+    // split by rows, a few tasks per thread so that uneven tree depths even out
+    int64_t samples_per_task = (num_samples + 4 * num_threads - 1) / (4 * num_threads);
+    samples_per_task = std::max(samples_per_task, kMinTreeWalksPerTask / num_trees);
+    samples_per_task = (samples_per_task + kSamplesPerBlock - 1) / kSamplesPerBlock * kSamplesPerBlock;
+    const int64_t num_tasks = (num_samples + samples_per_task - 1) / samples_per_task;
+    tp->ParallelFor(static_cast<int32_t>(num_tasks), [&](int32_t task) {
+      const int64_t first = task * samples_per_task;
+      const int64_t count = std::min(samples_per_task, num_samples - first);
+      ComputeScores(0, NumTrees(), x + first * stride, count, stride, scores + first * num_scores,
+                    has_scores + first * num_scores, num_scores);
+    });
+    return;
+  }
+
+  // split by trees. the first task adds to scores directly, the others to their own buffer.
+  const int64_t num_tasks = std::min({num_threads, num_trees / kMinTreesPerTask,
+                                      num_samples * num_trees / kMinTreeWalksPerTask});
+  if (num_tasks <= 1) {
+    ComputeScores(0, NumTrees(), x, num_samples, stride, scores, has_scores, num_scores);
+    return;
+  }
+
+  const int64_t scores_size = num_samples * num_scores;
+  std::vector<float> partial_scores((num_tasks - 1) * scores_size, 0.f);
+  std::vector<unsigned char> partial_has_scores((num_tasks - 1) * scores_size, 0);
+  tp->ParallelFor(static_cast<int32_t>(num_tasks), [&](int32_t task) {
+    const size_t tree_begin = static_cast<size_t>(num_trees * task / num_tasks);
+    const size_t tree_end = static_cast<size_t>(num_trees * (task + 1) / num_tasks);
+    float* task_scores = task == 0 ? scores : partial_scores.data() + (task - 1) * scores_size;
+    unsigned char* task_has_scores = task == 0 ? has_scores : partial_has_scores.data() + (task - 1) * scores_size;
+    ComputeScores(tree_begin, tree_end, x, num_samples, stride, task_scores, task_has_scores, num_scores);
+  });
+
+  for (int64_t task = 1; task < num_tasks; ++task) {
+    const float* task_scores = partial_scores.data() + (task - 1) * scores_size;
+    const unsigned char* task_has_scores = partial_has_scores.data() + (task - 1) * scores_size;
+    for (int64_t i = 0; i < scores_size; ++i) {
+      scores[i] += task_scores[i];
+      has_scores[i] |= task_has_scores[i];
+    }
+  }
+}
+
+}  // namespace ml
+}  // namespace onnxruntime
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include "core/providers/cpu/reduction/reduction_ops.h"
+#include "core/platform/threadpool.h"
 #include "core/util/math_cpuonly.h"
 using namespace std;
 namespace onnxruntime {
@@ -34,387 +35,441 @@ REGISTER_UNARY_ELEMENTWISE_KERNEL(ReduceSumSquare, 1);
 REGISTER_UNARY_ELEMENTWISE_KERNEL(ArgMax, 1);
 REGISTER_UNARY_ELEMENTWISE_KERNEL(ArgMin, 1);
 
-// When all reduce axises located at the tail of the dims, quite general cases, transpose and extra
-// copy could be skiped to improve performance, if required by check_no_transpose = true;
-// return value: true means transposedInputData is not created/copied, input tensor data could
-//               be direct use as row major matrix [block_size, blocks], where blocks is the
-//               size of each reduce.
-template <typename T>
-bool PrepareForReduce(OpKernelContext* ctx,
-                      std::vector<T>& transposedInputData,
-                      Tensor** reducedTensor,
-                      int64_t& block_size,
-                      int64_t& blocks,
-                      const std::vector<int64_t>& axes_,
-                      bool keepdims_,
-                      bool check_no_transpose = false) {
-  const Tensor* input_tensor_ptr = ctx->Input<Tensor>(0);
-  ORT_ENFORCE(input_tensor_ptr != nullptr);
-  const Tensor& input = *input_tensor_ptr;
-
-  size_t ndim = input.Shape().GetDims().size();
-  for (int64_t axe : axes_) {
-    ORT_ENFORCE(axe >= 0 && axe < (int64_t)ndim, "Axis attribute out of range");
+namespace {
+// the outputs of a task start at a multiple of this, so that tasks do not write to the same cache lines
+constexpr int64_t kOutputsAlignment = 16;
+
+// Axes walked in row-major order, from the outermost one
+struct ReduceAxes {
+  std::vector<int64_t> dims;
+  std::vector<int64_t> strides;
+  int64_t size = 1;
+};
+
+// The input of a reduction as seen from its outputs, without moving any data. The axes of size 1 are dropped and
+// the consecutive axes that are all kept or all reduced are merged.
+//
+// When the innermost axis is reduced, every output reduces rows of row_size contiguous elements that start at the
+// offsets of reduced_axes, relative to the offset of the output in output_axes, and inner_size is 1.
+// When the innermost axis is kept, the outputs come in groups of inner_size consecutive outputs whose elements are
+// next to each other, so a group is reduced as columns of contiguous vectors of inner_size elements at the
+// offsets of reduced_axes, and row_size is 1.
+struct ReducePlan {
+  ReduceAxes output_axes;  // for every group of inner_size outputs
+  ReduceAxes reduced_axes;
+  int64_t row_size = 1;
+  int64_t inner_size = 1;
+  int64_t output_size = 1;
+  int64_t reduced_size = 1;
+};
+
+// Walks the offsets of the elements of ReduceAxes in row-major order with an odometer, so that the offsets of the
+// outputs and of the reduced elements are never stored.
+class OffsetWalker {
+ public:
+  explicit OffsetWalker(const ReduceAxes& axes, int64_t position = 0)
+      : axes_(axes), index_(axes.dims.size(), 0) {
+    Seek(position);
   }
 
-  std::vector<int64_t> axes = axes_;
-  if (axes.empty()) {
-    // This is the default case for non-arg kind reductions. Reduce on all dimensions.
-    for (int i = 0; i < ndim; i++)
-      axes.push_back(i);
+  void Seek(int64_t position) {
+    offset_ = 0;
+    for (size_t j = axes_.dims.size(); j-- > 0;) {
+      index_[j] = position % axes_.dims[j];
+      offset_ += index_[j] * axes_.strides[j];
+      position /= axes_.dims[j];
+    }
   }
 
-  std::sort(axes.begin(), axes.end());
-
-  // If all reduced axes are located at the tail of the input shape, then copy could be skipped is required
-  bool need_copy = true;
-  if (axes.size() <= ndim && axes.front() == static_cast<int64_t>(ndim - axes.size()) 
-      && axes.back() == static_cast<int64_t>(ndim) - 1) {
-    need_copy = false;
+  // move to the next element, or back to the first one after the last
+  void Next() {
+    for (size_t j = axes_.dims.size(); j-- > 0;) {
+      offset_ += axes_.strides[j];
+      if (++index_[j] < axes_.dims[j]) {
+        return;
+      }
+      offset_ -= axes_.dims[j] * axes_.strides[j];
+      index_[j] = 0;
+    }
   }
 
-  vector<bool> keep_axis(ndim, true);
-  for (auto i : axes) {
-    keep_axis[i] = false;
+  int64_t Offset() const { return offset_; }
+  int64_t Size() const { return axes_.size; }
+
+ private:
+  const ReduceAxes& axes_;
+  std::vector<int64_t> index_;
+  int64_t offset_ = 0;
+};
+
+ReducePlan BuildReducePlan(const std::vector<int64_t>& in_dims, const std::vector<bool>& keep_axis) {
+  const size_t ndim = in_dims.size();
+
+  // merge the axes, from the innermost one
+  std::vector<int64_t> merged_dims;
+  std::vector<int64_t> merged_strides;
+  std::vector<bool> merged_keep_axis;
+  int64_t stride = 1;
+  for (size_t i = ndim; i-- > 0;) {
+    if (in_dims[i] != 1) {
+      if (!merged_dims.empty() && merged_keep_axis.back() == keep_axis[i]) {
+        merged_dims.back() *= in_dims[i];
+      } else {
+        merged_dims.push_back(in_dims[i]);
+        merged_strides.push_back(stride);
+        merged_keep_axis.push_back(keep_axis[i]);
+      }
+    }
+    stride *= in_dims[i];
   }
 
-  //transpose the input so that all to-be-reduced axes are at the head
-  vector<int64_t> transposed_axes(axes.begin(), axes.end());
-  for (int i = 0; i < ndim; ++i) {
-    if (keep_axis[i]) {
-      transposed_axes.push_back(i);
+  // the innermost axis is handled by the rows or the columns, the others by the walked axes
+  ReducePlan plan;
+  for (size_t i = merged_dims.size(); i-- > 0;) {
+    if (merged_keep_axis[i]) {
+      plan.output_size *= merged_dims[i];
+    } else {
+      plan.reduced_size *= merged_dims[i];
     }
-  }
 
-  vector<int64_t> new_dims_(transposed_axes.size());
-  for (int i = 0; i < transposed_axes.size(); ++i) {
-    new_dims_[i] = input.Shape().GetDims().at(transposed_axes[i]);
+    if (i == 0) {
+      (merged_keep_axis[i] ? plan.inner_size : plan.row_size) = merged_dims[i];
+    } else {
+      ReduceAxes& axes = merged_keep_axis[i] ? plan.output_axes : plan.reduced_axes;
+      axes.dims.push_back(merged_dims[i]);
+      axes.strides.push_back(merged_strides[i]);
+      axes.size *= merged_dims[i];
+    }
   }
 
-  int num_axes = static_cast<int>(transposed_axes.size());
-  auto in_dims = input.Shape().GetDims();
+  return plan;
+}
 
-  // Measure amount of contiguous data we can copy at once
-  int64_t blocksize = 1;
-  int n_shared_idxs = 0;
-  for (int i = num_axes - 1; i >= 0; --i) {
-    if (transposed_axes[i] == i) {
-      blocksize *= new_dims_[i];
-      ++n_shared_idxs;
-    } else {
-      break;
-    }
+void PrepareForReduce(OpKernelContext* ctx,
+                      ReducePlan& plan,
+                      Tensor** reducedTensor,
+                      const std::vector<int64_t>& axes_,
+                      bool keepdims_) {
+  const Tensor* input_tensor_ptr = ctx->Input<Tensor>(0);
+  ORT_ENFORCE(input_tensor_ptr != nullptr);
+  const Tensor& input = *input_tensor_ptr;
+
+  const std::vector<int64_t>& in_dims = input.Shape().GetDims();
+  size_t ndim = in_dims.size();
+  for (int64_t axe : axes_) {
+    ORT_ENFORCE(axe >= 0 && axe < (int64_t)ndim, "Axis attribute out of range");
   }
 
-  const T* from_data = input.template Data<T>();
-  size_t count = input.Shape().Size();
+  vector<bool> keep_axis(ndim, !axes_.empty());
+  for (auto i : axes_) {
+    keep_axis[i] = false;
+  }
 
   //set to-be-reduced axes to one. squeeze is keepdims_ is false
-  int64_t first_dim = 1;
   std::vector<int64_t> reduced_dims;
-  for (int i = 0; i < in_dims.size(); i++) {
+  for (size_t i = 0; i < ndim; i++) {
     if (keep_axis[i]) {
       reduced_dims.push_back(in_dims[i]);
-    } else {
-      first_dim *= in_dims[i];
-      if (keepdims_) {
-        reduced_dims.push_back(1);
-      }
+    } else if (keepdims_) {
+      reduced_dims.push_back(1);
     }
   }
 
   *reducedTensor = ctx->Output(0, reduced_dims);
-  block_size = input.Shape().Size() / first_dim;
-  blocks = first_dim;
-
-  if (!need_copy && check_no_transpose) {
-    return true;
-  }
-
-  transposedInputData.resize(input.Shape().Size(), 0);
-  T* to_data = &transposedInputData[0];
-  if (num_axes < 2 || n_shared_idxs == num_axes) {
-    memcpy(to_data, from_data, count * sizeof(T));
-    return false;
-  }
 
-  int itr_axes = num_axes - n_shared_idxs;
+  plan = BuildReducePlan(in_dims, keep_axis);
+}
 
-  // Calculate strides
-  std::vector<int64_t> stride_x(itr_axes, 0);
-  for (size_t i = 0; i < itr_axes; i++) {
-    stride_x[i] = 1;
-    for (size_t j = transposed_axes[i] + 1; j < itr_axes; j++) {
-      stride_x[i] *= in_dims[j];
+// Reductions that combine the elements, after an optional transform, with an associative operation. Op provides:
+//   Reduce(x): the reduction of the elements of x
+//   Combine(a, b): the reduction of two partial reductions
+//   Init(acc, x), Update(acc, x): the elementwise reduction of acc and x into acc, when acc holds nothing yet or
+//                                 holds partial reductions
+//   Finalize(acc, reduced_size): the output of a complete reduction
+template <typename T, typename Op>
+struct ReduceAggregator {
+  static T ReduceRows(const T* data, OffsetWalker& rows, int64_t row_size, int64_t reduced_size) {
+    rows.Seek(0);
+    T acc = Op::Reduce(ConstEigenVectorArrayMap<T>(data + rows.Offset(), row_size));
+    rows.Next();
+    for (int64_t i = 1; i < rows.Size(); ++i, rows.Next()) {
+      acc = Op::Combine(acc, Op::Reduce(ConstEigenVectorArrayMap<T>(data + rows.Offset(), row_size)));
     }
+    return Op::Finalize(acc, reduced_size);
   }
 
-  std::vector<int64_t> itr_idxs(itr_axes, 0);
-
-  // Branch here to avoid branching within the loop
-  if (blocksize > 1) {
-    for (size_t index = 0; index < (count / blocksize); index++) {
-      int64_t from_index = 0;
-      for (int i = 0; i < itr_axes; ++i) {
-        from_index += stride_x[i] * itr_idxs[i];
-      }
-
-      memcpy(
-          to_data + blocksize * index,
-          from_data + blocksize * from_index,
-          blocksize * sizeof(T));
-
-      ++itr_idxs[itr_axes - 1];
-      for (int i = itr_axes - 1; i >= 1; --i) {
-        auto expected_dim = new_dims_[i];
-        if (itr_idxs[i] < expected_dim) {
-          break;
-        }
-        itr_idxs[i] %= expected_dim;
-        ++itr_idxs[i - 1];
-      }
+  static void ReduceColumns(const T* data, OffsetWalker& columns, int64_t num_columns, T* output,
+                            int64_t reduced_size) {
+    EigenVectorArrayMap<T> acc(output, num_columns);
+    columns.Seek(0);
+    Op::Init(acc, ConstEigenVectorArrayMap<T>(data + columns.Offset(), num_columns));
+    columns.Next();
+    for (int64_t i = 1; i < columns.Size(); ++i, columns.Next()) {
+      Op::Update(acc, ConstEigenVectorArrayMap<T>(data + columns.Offset(), num_columns));
     }
-  } else {
-    for (size_t index = 0; index < count; index++) {
-      int64_t from_index = 0;
-      for (int i = 0; i < itr_axes; ++i) {
-        from_index += stride_x[i] * itr_idxs[i];
-      }
-
-      *(to_data + index) = *(from_data + from_index);
-
-      ++itr_idxs[itr_axes - 1];
-      for (int i = itr_axes - 1; i >= 1; --i) {
-        auto expected_dim = new_dims_[i];
-        if (itr_idxs[i] < expected_dim) {
-          break;
-        }
-        itr_idxs[i] %= expected_dim;
-        ++itr_idxs[i - 1];
-      }
+    for (int64_t i = 0; i < num_columns; ++i) {
+      output[i] = Op::Finalize(output[i], reduced_size);
     }
   }
-  return false;
-}
+};
 
 template <typename T>
-Status ReduceL1<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
+struct ReduceOpSum {
+  static T Reduce(const ConstEigenVectorArrayMap<T>& x) { return x.sum(); }
+  static T Combine(T a, T b) { return a + b; }
+  static void Init(EigenVectorArrayMap<T>& acc, const ConstEigenVectorArrayMap<T>& x) { acc = x; }
+  static void Update(EigenVectorArrayMap<T>& acc, const ConstEigenVectorArrayMap<T>& x) { acc += x; }
+  static T Finalize(T acc, int64_t /*reduced_size*/) { return acc; }
+};
 
-  T* output_data = reduced->template MutableData<T>();
-
-  EigenVectorMap<T> out_vec(output_data, block_size);
-  out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).cwiseAbs().rowwise().sum();
+template <typename T>
+struct ReduceOpMean : ReduceOpSum<T> {
+  static T Finalize(T acc, int64_t reduced_size) { return acc / static_cast<T>(reduced_size); }
+};
 
-  return Status::OK();
-}
+template <typename T>
+struct ReduceOpLogSum : ReduceOpSum<T> {
+  static T Finalize(T acc, int64_t /*reduced_size*/) { return static_cast<T>(std::log(acc)); }
+};
 
 template <typename T>
-Status ReduceL2<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
+struct ReduceOpL1 : ReduceOpSum<T> {
+  static T Reduce(const ConstEigenVectorArrayMap<T>& x) { return x.abs().sum(); }
+  static void Init(EigenVectorArrayMap<T>& acc, const ConstEigenVectorArrayMap<T>& x) { acc = x.abs(); }
+  static void Update(EigenVectorArrayMap<T>& acc, const ConstEigenVectorArrayMap<T>& x) { acc += x.abs(); }
+};
 
-  T* output_data = reduced->template MutableData<T>();
+template <typename T>
+struct ReduceOpSumSquare : ReduceOpSum<T> {
+  static T Reduce(const ConstEigenVectorArrayMap<T>& x) { return x.square().sum(); }
+  static void Init(EigenVectorArrayMap<T>& acc, const ConstEigenVectorArrayMap<T>& x) { acc = x.square(); }
+  static void Update(EigenVectorArrayMap<T>& acc, const ConstEigenVectorArrayMap<T>& x) { acc += x.square(); }
+};
 
-  EigenVectorMap<T> out_vec(output_data, block_size);
-  out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).rowwise().norm();
+template <typename T>
+struct ReduceOpL2 : ReduceOpSumSquare<T> {
+  static T Finalize(T acc, int64_t /*reduced_size*/) { return static_cast<T>(std::sqrt(acc)); }
+};
 
-  return Status::OK();
-}
+template <typename T>
+struct ReduceOpProd : ReduceOpSum<T> {
+  static T Reduce(const ConstEigenVectorArrayMap<T>& x) { return x.prod(); }
+  static T Combine(T a, T b) { return a * b; }
+  static void Update(EigenVectorArrayMap<T>& acc, const ConstEigenVectorArrayMap<T>& x) { acc *= x; }
+};
 
 template <typename T>
-Status ReduceLogSum<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
+struct ReduceOpMax : ReduceOpSum<T> {
+  static T Reduce(const ConstEigenVectorArrayMap<T>& x) { return x.maxCoeff(); }
+  static T Combine(T a, T b) { return std::max(a, b); }
+  static void Update(EigenVectorArrayMap<T>& acc, const ConstEigenVectorArrayMap<T>& x) { acc = acc.max(x); }
+};
 
-  T* output_data = reduced->template MutableData<T>();
+template <typename T>
+struct ReduceOpMin : ReduceOpSum<T> {
+  static T Reduce(const ConstEigenVectorArrayMap<T>& x) { return x.minCoeff(); }
+  static T Combine(T a, T b) { return std::min(a, b); }
+  static void Update(EigenVectorArrayMap<T>& acc, const ConstEigenVectorArrayMap<T>& x) { acc = acc.min(x); }
+};
 
-  EigenVectorMap<T> out_vec(output_data, block_size);
-  out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).rowwise().sum();
-  for (int j = 0; j < block_size; ++j) {
-    *(output_data) = static_cast<T>(std::log(*(output_data)));
-    ++output_data;
+// exp of every element, each result converted back to T
+template <typename T>
+struct ReduceExp {
+  template <typename Derived>
+  static auto Apply(const Eigen::ArrayBase<Derived>& x) {
+    return x.unaryExpr([](T value) { return static_cast<T>(std::exp(value)); });
   }
+};
 
-  return Status::OK();
-}
+template <>
+struct ReduceExp<float> {
+  template <typename Derived>
+  static auto Apply(const Eigen::ArrayBase<Derived>& x) {
+    return x.exp();
+  }
+};
 
+// log(sum(exp(x))), computed as max(x) + log(sum(exp(x - max(x)))) so that the exps do not overflow
 template <typename T>
-Status ReduceLogSumExp<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
-
-  T* output_data = reduced->template MutableData<T>();
-
-  for (int j = 0; j < block_size; ++j) {
+struct ReduceAggregatorLogSumExp {
+  static T ReduceRows(const T* data, OffsetWalker& rows, int64_t row_size, int64_t /*reduced_size*/) {
     T max_value = std::numeric_limits<T>::lowest();
-    for (int i = 0; i < blocks; ++i) {
-      max_value = std::max(max_value, transposedInputData[i * block_size + j]);
+    rows.Seek(0);
+    for (int64_t i = 0; i < rows.Size(); ++i, rows.Next()) {
+      max_value = std::max(max_value, ConstEigenVectorArrayMap<T>(data + rows.Offset(), row_size).maxCoeff());
     }
     T scaled_exp_sum = 0;
-    for (int i = 0; i < blocks; ++i) {
-      scaled_exp_sum += static_cast<T>(std::exp(transposedInputData[i * block_size + j] - max_value));
+    rows.Seek(0);
+    for (int64_t i = 0; i < rows.Size(); ++i, rows.Next()) {
+      scaled_exp_sum +=
+          ReduceExp<T>::Apply(ConstEigenVectorArrayMap<T>(data + rows.Offset(), row_size) - max_value).sum();
     }
-    *(output_data++) = static_cast<T>(std::log(scaled_exp_sum) + max_value);
+    return static_cast<T>(std::log(scaled_exp_sum) + max_value);
   }
-  return Status::OK();
-}
-
-template <typename T>
-Status ReduceMax<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
 
-  T* output_data = reduced->template MutableData<T>();
+  static void ReduceColumns(const T* data, OffsetWalker& columns, int64_t num_columns, T* output,
+                            int64_t reduced_size) {
+    EigenVectorArrayMap<T> max_values(output, num_columns);
+    ReduceAggregator<T, ReduceOpMax<T>>::ReduceColumns(data, columns, num_columns, output, reduced_size);
 
-  EigenVectorMap<T> out_vec(output_data, block_size);
-  out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).rowwise().maxCoeff();
+    Eigen::Array<T, Eigen::Dynamic, 1> scaled_exp_sums = Eigen::Array<T, Eigen::Dynamic, 1>::Zero(num_columns);
+    columns.Seek(0);
+    for (int64_t i = 0; i < columns.Size(); ++i, columns.Next()) {
+      scaled_exp_sums +=
+          ReduceExp<T>::Apply(ConstEigenVectorArrayMap<T>(data + columns.Offset(), num_columns) - max_values);
+    }
+    for (int64_t i = 0; i < num_columns; ++i) {
+      output[i] = static_cast<T>(std::log(scaled_exp_sums[i]) + output[i]);
+    }
+  }
+};
+
+// index of the first element that is greater, or less, than all the others. a single axis is reduced, so the
+// rows, or the columns, come in the order of the axis.
+template <typename T, typename Compare>
+struct ReduceAggregatorArg {
+  static int64_t ReduceRows(const T* data, OffsetWalker& rows, int64_t row_size, int64_t /*reduced_size*/) {
+    const Compare compare;
+    rows.Seek(0);
+    T best_value = data[rows.Offset()];
+    int64_t best_index = 0;
+    for (int64_t i = 0; i < rows.Size(); ++i, rows.Next()) {
+      const T* row = data + rows.Offset();
+      for (int64_t j = 0; j < row_size; ++j) {
+        if (compare(row[j], best_value)) {
+          best_value = row[j];
+          best_index = i * row_size + j;
+        }
+      }
+    }
+    return best_index;
+  }
 
-  return Status::OK();
-}
+  static void ReduceColumns(const T* data, OffsetWalker& columns, int64_t num_columns, int64_t* output,
+                            int64_t /*reduced_size*/) {
+    const Compare compare;
+    columns.Seek(0);
+    std::vector<T> best_values(data + columns.Offset(), data + columns.Offset() + num_columns);
+    std::fill_n(output, num_columns, 0);
+    columns.Next();
+    for (int64_t i = 1; i < columns.Size(); ++i, columns.Next()) {
+      const T* column = data + columns.Offset();
+      for (int64_t j = 0; j < num_columns; ++j) {
+        if (compare(column[j], best_values[j])) {
+          best_values[j] = column[j];
+          output[j] = i;
+        }
+      }
+    }
+  }
+};
 
-template <typename T>
-Status ReduceMean<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  bool no_transpose = PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_, true);
+template <typename T, typename TOut, typename Aggregator>
+void ReduceOutputs(const ReducePlan& plan, const T* input, TOut* output, int64_t begin, int64_t end) {
+  OffsetWalker reduced(plan.reduced_axes);
 
-  T* output_data = reduced->template MutableData<T>();
+  if (plan.inner_size == 1) {
+    OffsetWalker outputs(plan.output_axes, begin);
+    for (int64_t i = begin; i < end; ++i, outputs.Next()) {
+      output[i] = Aggregator::ReduceRows(input + outputs.Offset(), reduced, plan.row_size, plan.reduced_size);
+    }
+    return;
+  }
 
-  if (no_transpose) {
-    const T* input_data = ctx->Input<Tensor>(0)->template Data<T>();
+  OffsetWalker groups(plan.output_axes, begin / plan.inner_size);
+  for (int64_t i = begin; i < end; groups.Next()) {
+    const int64_t column = i % plan.inner_size;
+    const int64_t num_columns = std::min(end - i, plan.inner_size - column);
+    Aggregator::ReduceColumns(input + groups.Offset() + column, reduced, num_columns, output + i,
+                              plan.reduced_size);
+    i += num_columns;
+  }
+}
 
-    #pragma omp parallel for
-    for (int64_t i = 0; i < block_size; ++i) {
-      output_data[i] = ConstEigenVectorMap<T>(input_data + (i * blocks), blocks).mean();
-    }
+template <typename T, typename TOut, typename Aggregator>
+Status Reduce(OpKernelContext* ctx, const std::vector<int64_t>& axes, bool keepdims) {
+  ReducePlan plan;
+  Tensor* reduced;
+  PrepareForReduce(ctx, plan, &reduced, axes, keepdims);
+  if (plan.output_size == 0) {
+    return Status::OK();
   }
-  else {
-    EigenVectorMap<T> out_vec(output_data, block_size);
-    out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).rowwise().mean();
+  if (plan.reduced_size == 0) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Can't reduce over an axis of size 0.");
   }
 
+  const T* input_data = ctx->Input<Tensor>(0)->template Data<T>();
+  TOut* output_data = reduced->template MutableData<TOut>();
+
+  // the outputs are split across the threads, each one reduces all of its elements
+  concurrency::ThreadPool::TryParallelFor(
+      ctx->GetOperatorThreadPool(), plan.output_size, plan.reduced_size,
+      [&](int64_t first, int64_t last) {
+        ReduceOutputs<T, TOut, Aggregator>(plan, input_data, output_data, first, last);
+      },
+      kOutputsAlignment);
   return Status::OK();
 }
+}  // namespace
 
 template <typename T>
-Status ReduceMin<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
+Status ReduceL1<T>::Compute(OpKernelContext* ctx) const {
+  return Reduce<T, T, ReduceAggregator<T, ReduceOpL1<T>>>(ctx, axes_, keepdims_);
+}
 
-  T* output_data = reduced->template MutableData<T>();
+template <typename T>
+Status ReduceL2<T>::Compute(OpKernelContext* ctx) const {
+  return Reduce<T, T, ReduceAggregator<T, ReduceOpL2<T>>>(ctx, axes_, keepdims_);
+}
 
-  EigenVectorMap<T> out_vec(output_data, block_size);
-  out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).rowwise().minCoeff();
+template <typename T>
+Status ReduceLogSum<T>::Compute(OpKernelContext* ctx) const {
+  return Reduce<T, T, ReduceAggregator<T, ReduceOpLogSum<T>>>(ctx, axes_, keepdims_);
+}
 
-  return Status::OK();
+template <typename T>
+Status ReduceLogSumExp<T>::Compute(OpKernelContext* ctx) const {
+  return Reduce<T, T, ReduceAggregatorLogSumExp<T>>(ctx, axes_, keepdims_);
 }
 
 template <typename T>
-Status ReduceProd<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
+Status ReduceMax<T>::Compute(OpKernelContext* ctx) const {
+  return Reduce<T, T, ReduceAggregator<T, ReduceOpMax<T>>>(ctx, axes_, keepdims_);
+}
 
-  T* output_data = reduced->template MutableData<T>();
+template <typename T>
+Status ReduceMean<T>::Compute(OpKernelContext* ctx) const {
+  return Reduce<T, T, ReduceAggregator<T, ReduceOpMean<T>>>(ctx, axes_, keepdims_);
+}
 
-  EigenVectorMap<T> out_vec(output_data, block_size);
-  out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).rowwise().prod();
+template <typename T>
+Status ReduceMin<T>::Compute(OpKernelContext* ctx) const {
+  return Reduce<T, T, ReduceAggregator<T, ReduceOpMin<T>>>(ctx, axes_, keepdims_);
+}
 
-  return Status::OK();
+template <typename T>
+Status ReduceProd<T>::Compute(OpKernelContext* ctx) const {
+  return Reduce<T, T, ReduceAggregator<T, ReduceOpProd<T>>>(ctx, axes_, keepdims_);
 }
 
 template <typename T>
 Status ReduceSum<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  bool no_transpose = PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_, true);
-
-  T* output_data = reduced->template MutableData<T>();
-
-  if (no_transpose) {
-    const T* input_data = ctx->Input<Tensor>(0)->template Data<T>();
-    
-    #pragma omp parallel for
-    for (int64_t i = 0; i < block_size; ++i) {
-      output_data[i] = ConstEigenVectorMap<T>(input_data + (i * blocks), blocks).sum();
-    }
-  }
-  else {
-    EigenVectorMap<T> out_vec(output_data, block_size);
-    out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).rowwise().sum();
-  }
-
-  return Status::OK();
+  return Reduce<T, T, ReduceAggregator<T, ReduceOpSum<T>>>(ctx, axes_, keepdims_);
 }
 
 template <typename T>
 Status ReduceSumSquare<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
-
-  T* output_data = reduced->template MutableData<T>();
-
-  EigenVectorMap<T> out_vec(output_data, block_size);
-  out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).rowwise().squaredNorm();
-
-  return Status::OK();
+  return Reduce<T, T, ReduceAggregator<T, ReduceOpSumSquare<T>>>(ctx, axes_, keepdims_);
 }
 
 template <typename T>
 Status ArgMax<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
-
-  int64_t* output_data = reduced->template MutableData<int64_t>();
-
-  Eigen::MatrixXf::Index maxIndex;
-  auto matrixData = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks);
-  for (int i = 0; i < block_size; ++i) {
-    matrixData.row(i).maxCoeff(&maxIndex);
-    *(output_data++) = maxIndex;
-  }
-
-  return Status::OK();
+  return Reduce<T, int64_t, ReduceAggregatorArg<T, std::greater<T>>>(ctx, axes_, keepdims_);
 }
 
 template <typename T>
 Status ArgMin<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
-
-  int64_t* output_data = reduced->template MutableData<int64_t>();
-
-  Eigen::MatrixXf::Index minIndex;
-  auto matrixData = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks);
-  for (int i = 0; i < block_size; ++i) {
-    matrixData.row(i).minCoeff(&minIndex);
-    *(output_data++) = minIndex;
-  }
-
-  return Status::OK();
+  return Reduce<T, int64_t, ReduceAggregatorArg<T, std::less<T>>>(ctx, axes_, keepdims_);
 }
 
 }  // namespace onnxruntime
@@ -12,7 +12,6 @@
 #include "core/providers/cpu/rnn/deep_cpu_gru.h"
 
 #include <algorithm>
-#include <future>
 #include <stdexcept>
 
 #include "core/common/logging/logging.h"
@@ -177,13 +176,14 @@ class UniDirectionalGru {
                     const ActivationFuncs::Entry& activation_func_f,
                     const ActivationFuncs::Entry& activation_func_g,
                     const float clip,
-                    TaskThreadPool& ttp);
+                    concurrency::ThreadPool* ttp);
 
   void Compute(const gsl::span<const T>& inputs,
                const gsl::span<const int>& sequence_lengths,
                const int num_directions,
-               const gsl::span<const T>& input_weights,
-               const gsl::span<const T>& recurrent_weights,
+               const GemmWeights<T>& input_weights,
+               const GemmWeights<T>& recurrent_weightsZR,
+               const GemmWeights<T>& recurrent_weightsH,
                gsl::span<T>& outputs,
                gsl::span<T>& final_hidden_state);
 
@@ -192,7 +192,7 @@ class UniDirectionalGru {
  private:
   AllocatorPtr allocator_;
   const logging::Logger& logger_;
-  TaskThreadPool& ttp_;
+  concurrency::ThreadPool* ttp_;
 
   int seq_length_;
   int batch_size_;
@@ -312,6 +312,9 @@ Status DeepCpuGruOp::ComputeImpl(OpKernelContext& context) const {
   AllocatorPtr alloc;
   status = context.GetTempSpaceAllocator(&alloc);
   ORT_RETURN_IF_ERROR(status);
+
+  concurrency::ThreadPool* ttp = context.GetOperatorThreadPool();
+
   gsl::span<const T> input_weights = W.DataAsSpan<T>();
   gsl::span<const T> recurrent_weights = R.DataAsSpan<T>();
   gsl::span<const T> bias = B != nullptr ? B->DataAsSpan<T>() : gsl::span<const T>();
@@ -321,8 +324,16 @@ Status DeepCpuGruOp::ComputeImpl(OpKernelContext& context) const {
   const size_t recurrent_weights_size_per_direction = 3 * hidden_size_ * hidden_size_;
   const size_t bias_size_per_direction = 6 * hidden_size_;
 
-  gsl::span<const T> input_weights_1 = input_weights.subspan(0, input_weights_size_per_direction);
-  gsl::span<const T> recurrent_weights_1 = recurrent_weights.subspan(0, recurrent_weights_size_per_direction);
+  // R of each direction is used as two blocks, the ZR gates and the H gate, which are also packed separately
+  const size_t recurrent_weights_zr_size = 2 * hidden_size_ * hidden_size_;
+  const size_t recurrent_weights_h_size = hidden_size_ * hidden_size_;
+
+  GemmWeights<T> input_weights_1(input_weights.subspan(0, input_weights_size_per_direction),
+                                 GetPackedWeights(packed_input_weights_, 0));
+  GemmWeights<T> recurrent_weights_zr_1(recurrent_weights.subspan(0, recurrent_weights_zr_size),
+                                        GetPackedWeights(packed_recurrent_weights_, 0));
+  GemmWeights<T> recurrent_weights_h_1(recurrent_weights.subspan(recurrent_weights_zr_size, recurrent_weights_h_size),
+                                       GetPackedWeights(packed_recurrent_weights_, 1));
   gsl::span<const T> bias_1 = bias.empty() ? bias : bias.subspan(0, bias_size_per_direction);
 
   gsl::span<const T> input = X.DataAsSpan<T>();
@@ -357,10 +368,16 @@ Status DeepCpuGruOp::ComputeImpl(OpKernelContext& context) const {
 
   if (direction_ == Direction::kBidirectional) {
     // spans for second direction
-    gsl::span<const T> input_weights_2 = input_weights.subspan(input_weights_size_per_direction,
-                                                               input_weights_size_per_direction);
-    gsl::span<const T> recurrent_weights_2 = recurrent_weights.subspan(recurrent_weights_size_per_direction,
-                                                                       recurrent_weights_size_per_direction);
+    GemmWeights<T> input_weights_2(input_weights.subspan(input_weights_size_per_direction,
+                                                         input_weights_size_per_direction),
+                                   GetPackedWeights(packed_input_weights_, 1));
+    GemmWeights<T> recurrent_weights_zr_2(recurrent_weights.subspan(recurrent_weights_size_per_direction,
+                                                                    recurrent_weights_zr_size),
+                                          GetPackedWeights(packed_recurrent_weights_, 2));
+    GemmWeights<T> recurrent_weights_h_2(recurrent_weights.subspan(recurrent_weights_size_per_direction +
+                                                                       recurrent_weights_zr_size,
+                                                                   recurrent_weights_h_size),
+                                         GetPackedWeights(packed_recurrent_weights_, 3));
     gsl::span<const T> bias_2 = bias.empty() ? bias : bias.subspan(bias_size_per_direction, bias_size_per_direction);
 
     gsl::span<const T> initial_hidden_2 = initial_hidden.empty()
@@ -374,30 +391,32 @@ Status DeepCpuGruOp::ComputeImpl(OpKernelContext& context) const {
     gsl::span<T> hidden_output_2 = hidden_output.subspan(hidden_output_size_per_direction,
                                                          hidden_output_size_per_direction);
 
-    std::packaged_task<void()> task_fw{
-        [&]() {
-          std::unique_ptr<detail::UniDirectionalGru<T>> fw = std::make_unique<detail::UniDirectionalGru<T>>(
-              alloc, logger,
-              seq_length, batch_size, input_size, hidden_size_, linear_before_reset_, Direction::kForward,
-              bias_1, initial_hidden_1,
-              activation_funcs_.Entries()[0],
-              activation_funcs_.Entries()[1],
-              clip_, ttp_);
-          fw->Compute(input, sequence_lens_span, num_directions_, input_weights_1, recurrent_weights_1, output_1, hidden_output_1);
-        }};
-    auto task_results_fw = task_fw.get_future();
-    ttp_.RunTask(std::move(task_fw));
-
-    std::unique_ptr<detail::UniDirectionalGru<T>> bw = std::make_unique<detail::UniDirectionalGru<T>>(
-        alloc, logger,
-        seq_length, batch_size, input_size, hidden_size_, linear_before_reset_, Direction::kReverse,
-        bias_2, initial_hidden_2,
-        activation_funcs_.Entries()[2],
-        activation_funcs_.Entries()[3],
-        clip_, ttp_);
-    bw->Compute(input, sequence_lens_span, num_directions_, input_weights_2, recurrent_weights_2, output_2, hidden_output_2);
-
-    task_results_fw.get();
+    // run the forward and reverse directions concurrently
+    auto compute_direction = [&](int direction) {
+      if (direction == 0) {
+        std::unique_ptr<detail::UniDirectionalGru<T>> fw = std::make_unique<detail::UniDirectionalGru<T>>(
+            alloc, logger,
+            seq_length, batch_size, input_size, hidden_size_, linear_before_reset_, Direction::kForward,
+            bias_1, initial_hidden_1,
+            activation_funcs_.Entries()[0],
+            activation_funcs_.Entries()[1],
+            clip_, ttp);
+        fw->Compute(input, sequence_lens_span, num_directions_, input_weights_1, recurrent_weights_zr_1,
+                    recurrent_weights_h_1, output_1, hidden_output_1);
+      } else {
+        std::unique_ptr<detail::UniDirectionalGru<T>> bw = std::make_unique<detail::UniDirectionalGru<T>>(
+            alloc, logger,
+            seq_length, batch_size, input_size, hidden_size_, linear_before_reset_, Direction::kReverse,
+            bias_2, initial_hidden_2,
+            activation_funcs_.Entries()[2],
+            activation_funcs_.Entries()[3],
+            clip_, ttp);
+        bw->Compute(input, sequence_lens_span, num_directions_, input_weights_2, recurrent_weights_zr_2,
+                    recurrent_weights_h_2, output_2, hidden_output_2);
+      }
+    };
+
+    ExecuteLambdaInParallel("Processing directions", compute_direction, num_directions_, 1, ttp, logger);
   } else {
     std::unique_ptr<detail::UniDirectionalGru<T>> gru_p = std::make_unique<detail::UniDirectionalGru<T>>(
         alloc, logger,
@@ -405,9 +424,10 @@ Status DeepCpuGruOp::ComputeImpl(OpKernelContext& context) const {
         bias_1, initial_hidden_1,
         activation_funcs_.Entries()[0],
         activation_funcs_.Entries()[1],
-        clip_, ttp_);
+        clip_, ttp);
 
-    gru_p->Compute(input, sequence_lens_span, num_directions_, input_weights_1, recurrent_weights_1, output_1, hidden_output_1);
+    gru_p->Compute(input, sequence_lens_span, num_directions_, input_weights_1, recurrent_weights_zr_1,
+                   recurrent_weights_h_1, output_1, hidden_output_1);
   }
 
   if (!output.empty())
@@ -436,7 +456,7 @@ UniDirectionalGru<T>::UniDirectionalGru(AllocatorPtr allocator,
                                         const ActivationFuncs::Entry& activation_func_f,
                                         const ActivationFuncs::Entry& activation_func_g,
                                         const float clip,
-                                        TaskThreadPool& ttp)
+                                        concurrency::ThreadPool* ttp)
     : allocator_(allocator),
       logger_(logger),
       ttp_(ttp),
@@ -511,8 +531,9 @@ template <typename T>
 void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
                                    const gsl::span<const int>& sequence_lengths_arg,
                                    const int num_directions,
-                                   const gsl::span<const T>& input_weights,
-                                   const gsl::span<const T>& recurrent_weights,
+                                   const GemmWeights<T>& input_weights,
+                                   const GemmWeights<T>& recurrent_weightsZR,
+                                   const GemmWeights<T>& recurrent_weightsH,
                                    gsl::span<T>& outputs,
                                    gsl::span<T>& final_hidden_state) {
   using span_T_const_iter = typename gsl::span<T>::const_iterator;
@@ -529,11 +550,8 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
   }
 
   DumpMatrix("Inputs", inputs.data(), seq_length_ * batch_size_, input_size_);
-  DumpMatrix("input_weights", input_weights.data(), 3 * hidden_size_, input_size_);
-  DumpMatrix("recurrent_weights", recurrent_weights.data(), 3 * hidden_size_, hidden_size_);
-
-  gsl::span<const T> recurrent_weightsZR = recurrent_weights.subspan(0, 2 * hidden_size_ * hidden_size_);
-  gsl::span<const T> recurrent_weightsH = recurrent_weights.subspan(2 * hidden_size_ * hidden_size_, hidden_size_ * hidden_size_);
+  DumpMatrix("input_weights", input_weights.weights.data(), 3 * hidden_size_, input_size_);
+  DumpMatrix("recurrent_weights", recurrent_weightsZR.weights.data(), 3 * hidden_size_, hidden_size_);
 
   gsl::span<T> original_outputs = outputs;
   const bool output_sequence = !outputs.empty();
@@ -565,10 +583,10 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
   ComputeGemm(total_rows, hidden_size_x3, input_size_, alpha,
               inputs.cbegin(), inputs.cend(),
               input_size_,
-              input_weights.cbegin(), input_weights.cend(),
+              input_weights,
               input_size_, beta,
               outputZRH_.begin(), outputZRH_.end(),
-              hidden_size_x3);
+              hidden_size_x3, ttp_);
 
   DumpMatrix("inputs with weights applied", outputZRH_.data(), seq_length_ * batch_size_ * 3, hidden_size_);
 
@@ -597,7 +615,7 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
     if (batch_size_ % hidden_num_threads_ != 0)
       fused_hidden_rows++;
 
-    // lambda executed by TaskThreadPool
+    // lambda executed by the intra-op thread pool
     auto hidden_gemm_and_activations = [&](const int row) {
       //handling boundaries
       int local_fused_hidden_rows = fused_hidden_rows;
@@ -643,10 +661,10 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
         ComputeGemm(local_fused_hidden_rows, hidden_size_x2, hidden_size_, alpha,
                     prev_Ht, prev_Ht_end,
                     hidden_size_,
-                    recurrent_weightsZR.cbegin(), recurrent_weightsZR.cend(),
+                    recurrent_weightsZR,
                     hidden_size_, beta,
                     outputZRH_.begin() + out_added_offset, outputZRH_.end(),
-                    hidden_size_x3);
+                    hidden_size_x3, ttp_);
 
         DumpMatrix("Xt*(W[zr]^T) + Ht-1 * R[zr]" + row_str,
                    outputZRH_.data() + out_added_offset, local_fused_hidden_rows, hidden_size_x2, 0, hidden_size_x3);
@@ -660,10 +678,10 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
           ComputeGemm(local_fused_hidden_rows, hidden_size_, hidden_size_, alpha,
                       prev_Ht, prev_Ht_end,  // Ht-1
                       hidden_size_,
-                      recurrent_weightsH.cbegin(), recurrent_weightsH.cend(),  // Rh^T
+                      recurrent_weightsH,  // Rh^T
                       hidden_size_, beta,
                       linear_output_local, linear_output_.end(),  // pre: Rbh, post:output
-                      hidden_size_);
+                      hidden_size_, ttp_);
 
           DumpMatrix("Ht-1 * (Rh^T) + Rbh " + row_str, &*linear_output_local, batch_size_, hidden_size_);
         }
@@ -723,10 +741,10 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
           ComputeGemm(local_fused_hidden_rows, hidden_size_, hidden_size_, alpha,
                       cur_h_local, cur_h_local_end,
                       hidden_size_,
-                      recurrent_weightsH.cbegin(), recurrent_weightsH.cend(),
+                      recurrent_weightsH,
                       hidden_size_, beta,
                       outputZRH_.begin() + out_added_offset + hidden_size_x2, outputZRH_.end(),
-                      hidden_size_x3);
+                      hidden_size_x3, ttp_);
         }
 
         DumpMatrix("Xt*(Wh^T) + (" + label + ")" + row_str,
@@ -850,10 +868,10 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
       ComputeGemm(batch_size_, hidden_size_x2, hidden_size_, alpha,
                   prev_Ht, prev_Ht_end,
                   hidden_size_,
-                  recurrent_weightsZR.cbegin(), recurrent_weightsZR.cend(),
+                  recurrent_weightsZR,
                   hidden_size_, beta,
                   outputZRH_.begin() + out_added_offset, outputZRH_.end(),
-                  hidden_size_x3);
+                  hidden_size_x3, ttp_);
 
       DumpMatrix("Ht-1 * R[zr] + Xt*(W[zr]^T)" + seqno_str,
                  outputZRH_.data() + out_added_offset, batch_size_, hidden_size_x2, 0, hidden_size_x3);
@@ -866,10 +884,10 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
         ComputeGemm(batch_size_, hidden_size_, hidden_size_, alpha,
                     prev_Ht, prev_Ht_end,  // Ht-1
                     hidden_size_,
-                    recurrent_weightsH.cbegin(), recurrent_weightsH.cend(),  // Rh^T
+                    recurrent_weightsH,  // Rh^T
                     hidden_size_, beta,
                     linear_output_.begin(), linear_output_.end(),  // pre: Rbh, post:output
-                    hidden_size_);
+                    hidden_size_, ttp_);
 
         DumpMatrix("Ht-1 * (Rh^T) + Rbh " + seqno_str, linear_output_.data(), batch_size_, hidden_size_);
       }
@@ -933,10 +951,10 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
         ComputeGemm(batch_size_, hidden_size_, hidden_size_, alpha,
                     cur_h_local, cur_h_local_end,  // rt (.) Ht-1
                     hidden_size_,
-                    recurrent_weightsH.cbegin(), recurrent_weightsH.cend(),  // Rh^T
+                    recurrent_weightsH,  // Rh^T
                     hidden_size_, beta,
                     out_H, outputZRH_.end(),
-                    hidden_size_x3);
+                    hidden_size_x3, ttp_);
       }
 
       DumpMatrix("Xt*(Wh^T) + (" + label + ")" + seqno_str, outputZRH_.data() + out_added_offset,
@@ -1065,10 +1083,8 @@ void UniDirectionalGru<T>::AllocateBuffers() {
 
 template <typename T>
 void UniDirectionalGru<T>::SetNumThreads() {
-  int threads = std::thread::hardware_concurrency() - 1;
-
-  if (threads < 1)
-    threads = 1;
+  // the thread calling Compute participates in the work
+  int threads = ttp_ != nullptr ? ttp_->NumThreads() + 1 : 1;
 
   hidden_num_threads_ = threads;
   batch_parallel_ = false;
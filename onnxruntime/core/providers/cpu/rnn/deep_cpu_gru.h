@@ -5,7 +5,6 @@
 
 #include <limits>
 
-#include "core/common/task_thread_pool.h"
 #include "core/framework/allocator.h"
 #include "core/framework/op_kernel.h"
 #include "core/providers/cpu/rnn/rnn_helpers.h"
@@ -51,6 +50,9 @@ class DeepCpuGruOp final : public OpKernel {
     activation_funcs_ = rnn::detail::ActivationFuncs(activation_func_names,
                                                      activation_func_alphas,
                                                      activation_func_betas);
+
+    packed_input_weights_ = rnn::detail::PackWeights(info, 1, num_directions_, {3 * hidden_size_});
+    packed_recurrent_weights_ = rnn::detail::PackWeights(info, 2, num_directions_, {2 * hidden_size_, hidden_size_});
   }
 
   Status Compute(OpKernelContext* context) const override;
@@ -67,11 +69,10 @@ class DeepCpuGruOp final : public OpKernel {
 
   rnn::detail::ActivationFuncs activation_funcs_;
 
-  // Threadpool for operator. If concurrent Compute calls are possible, it will be shared
-  // across them. mutable due to this.
-  // The alternative would be to create a threadpool in each call to Compute but that would incur thread creation
-  // cost on every call.
-  mutable TaskThreadPool ttp_{std::thread::hardware_concurrency()};
+  // W of each direction, and the ZR and H blocks of R of each direction, packed once if they are
+  // constant initializers, else empty
+  std::vector<GemmPackedB> packed_input_weights_;
+  std::vector<GemmPackedB> packed_recurrent_weights_;
 
   template <typename T>
   Status ComputeImpl(OpKernelContext& context) const;
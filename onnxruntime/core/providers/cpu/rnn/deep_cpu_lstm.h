@@ -6,7 +6,6 @@
 #include <limits>
 
 #include "core/framework/op_kernel.h"
-#include "core/common/task_thread_pool.h"
 #include "core/providers/cpu/rnn/rnn_helpers.h"
 
 namespace onnxruntime {
@@ -49,6 +48,9 @@ class DeepCpuLstmOp final : public OpKernel {
     activation_funcs_ = rnn::detail::ActivationFuncs(activation_func_names,
                                                      activation_func_alphas,
                                                      activation_func_betas);
+
+    packed_input_weights_ = rnn::detail::PackWeights(info, 1, num_directions_, {4 * hidden_size_});
+    packed_recurrent_weights_ = rnn::detail::PackWeights(info, 2, num_directions_, {4 * hidden_size_});
   }
 
   Status Compute(OpKernelContext* context) const override;
@@ -78,11 +80,9 @@ class DeepCpuLstmOp final : public OpKernel {
 
   rnn::detail::ActivationFuncs activation_funcs_;
 
-  // Threadpool for operator. If concurrent Compute calls are possible, it will be shared
-  // across them. mutable due to this.
-  // The alternative would be to create a threadpool in each call to Compute but that would incur thread creation
-  // cost on every call.
-  mutable TaskThreadPool ttp_{std::thread::hardware_concurrency()};
+  // W and R of each direction packed once if they are constant initializers, else empty
+  std::vector<GemmPackedB> packed_input_weights_;
+  std::vector<GemmPackedB> packed_recurrent_weights_;
 };
 
 }  // namespace onnxruntime
@@ -160,18 +160,24 @@ Status RNN<float>::Compute(OpKernelContext* ctx) const {
     }
 
     // X * W[direction]^t + B
-    math::Gemm<float, CPUMathUtil>(
-        CblasNoTrans,
-        CblasTrans,
-        static_cast<int>(seq_length * batch_size),
-        static_cast<int>(hidden_size_),
-        static_cast<int>(input_size),
-        1,
-        X.template Data<float>(),
-        W.template Data<float>() + direction * hidden_size_ * input_size,
-        1,
-        x_matmul_w_buffer_data,
-        &CPUMathUtil::Instance());
+    if (!packed_W_.empty()) {
+      packed_W_[direction].Gemm(CblasNoTrans, seq_length * batch_size, 1.0f, X.template Data<float>(), 1.0f,
+                                x_matmul_w_buffer_data, ctx->GetOperatorThreadPool());
+    } else {
+      math::Gemm<float, CPUMathUtil>(
+          CblasNoTrans,
+          CblasTrans,
+          static_cast<int>(seq_length * batch_size),
+          static_cast<int>(hidden_size_),
+          static_cast<int>(input_size),
+          1,
+          X.template Data<float>(),
+          W.template Data<float>() + direction * hidden_size_ * input_size,
+          1,
+          x_matmul_w_buffer_data,
+          &CPUMathUtil::Instance(),
+          ctx->GetOperatorThreadPool());
+    }
 
     for (int64_t t = 0; t < seq_length; t++) {
       int64_t time_step = isReverse ? (seq_length - t - 1) : t;
@@ -190,7 +196,11 @@ Status RNN<float>::Compute(OpKernelContext* ctx) const {
           h_prev = Y_buffer_data_current_frame - num_directions * Y_frame_size;
       }
 
-      if (h_prev != nullptr) {
+      if (h_prev != nullptr && !packed_R_.empty()) {
+        // H_t_1 * R[direction]^t
+        packed_R_[direction].Gemm(CblasNoTrans, batch_size, 1.0f, h_prev, 0.0f, Y_buffer_data_current_frame,
+                                  ctx->GetOperatorThreadPool());
+      } else if (h_prev != nullptr) {
         // H_t_1 * R[direction]^t
         math::Gemm<float, CPUMathUtil>(
             CblasNoTrans,
@@ -203,7 +213,8 @@ Status RNN<float>::Compute(OpKernelContext* ctx) const {
             R.template Data<float>() + direction * hidden_size_ * hidden_size_,
             0,
             Y_buffer_data_current_frame,
-            &CPUMathUtil::Instance());
+            &CPUMathUtil::Instance(),
+            ctx->GetOperatorThreadPool());
       } else {
         math::Set<float, CPUMathUtil>(batch_size * hidden_size_, 0, Y_buffer_data_current_frame, &CPUMathUtil::Instance());
       }
@@ -8,6 +8,7 @@
 #include "core/common/common.h"
 #include "core/common/exceptions.h"
 #include "core/framework/op_kernel.h"
+#include "core/providers/cpu/rnn/rnn_helpers.h"
 
 namespace onnxruntime {
 template <typename T>
@@ -38,6 +39,9 @@ class RNN : public OpKernel {
     for (int direction = 1; direction < num_directions; direction++) {
       ORT_ENFORCE(allowed_activations.find(activations_[direction]) != allowed_activations.end());
     }
+
+    packed_W_ = rnn::detail::PackWeights(info, 1, num_directions, {hidden_size_});
+    packed_R_ = rnn::detail::PackWeights(info, 2, num_directions, {hidden_size_});
   }
 
   Status Compute(OpKernelContext* context) const override;
@@ -61,6 +65,10 @@ class RNN : public OpKernel {
   // required
   int64_t hidden_size_;
 
+  // W and R of each direction packed once if they are constant initializers, else empty
+  std::vector<GemmPackedB> packed_W_;
+  std::vector<GemmPackedB> packed_R_;
+
   // const std::string default_activation = "Tanh";
 };
 
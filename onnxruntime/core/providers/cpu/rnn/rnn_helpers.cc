@@ -7,6 +7,7 @@
 #include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <numeric>
 #include <stdlib.h>
 #include <string>
 #include <unordered_map>
@@ -23,6 +24,39 @@ namespace detail {
 
 using namespace ::onnxruntime::common;
 
+std::vector<GemmPackedB> PackWeights(const OpKernelInfo& info, int input_index, int64_t num_directions,
+                                     const std::vector<int64_t>& block_rows) {
+  std::vector<GemmPackedB> packed_weights;
+
+  const Tensor* weights;
+  if (!info.TryGetConstantInput(input_index, &weights) || weights->DataType() != DataTypeImpl::GetType<float>()) {
+    return packed_weights;
+  }
+
+  // a shape that doesn't match is reported by the validation of the inputs in Compute
+  const auto& shape = weights->Shape();
+  const int64_t rows = std::accumulate(block_rows.cbegin(), block_rows.cend(), int64_t{0});
+  if (shape.NumDimensions() != 3 || shape[0] != num_directions || shape[1] != rows) {
+    return packed_weights;
+  }
+
+  const int64_t K = shape[2];
+  const float* data = weights->Data<float>();
+  packed_weights.resize(static_cast<size_t>(num_directions) * block_rows.size());
+  auto packed = packed_weights.begin();
+  for (int64_t direction = 0; direction < num_directions; ++direction) {
+    for (int64_t N : block_rows) {
+      if (!(packed++)->Pack(info, data, N, K, true)) {
+        packed_weights.clear();
+        return packed_weights;
+      }
+      data += N * K;
+    }
+  }
+
+  return packed_weights;
+}
+
 Status ValidateCommonRnnInputs(const Tensor& X,
                                const Tensor& W,
                                const Tensor& R,
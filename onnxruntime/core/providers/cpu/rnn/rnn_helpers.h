@@ -5,7 +5,6 @@
 
 #include <algorithm>
 #include <functional>
-#include <future>
 #include <string>
 #include <vector>
 
@@ -13,9 +12,10 @@
 #include "gsl/gsl_algorithm"
 
 #include "core/common/common.h"
-#include "core/common/task_thread_pool.h"
 #include "core/common/logging/logging.h"
 #include "core/framework/allocator.h"
+#include "core/platform/threadpool.h"
+#include "core/providers/cpu/math/gemm_packed_b.h"
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
 
@@ -151,7 +151,8 @@ void ComputeGemm(const int M,
                  const float beta,
                  TSpanCIter C,
                  TSpanCIter C_end,
-                 const int ldc) {
+                 const int ldc,
+                 concurrency::ThreadPool* ttp) {
   // validate all the inputs
   // need to use the lda/ldb/ldc strides which should be >= the columns for the span
   ORT_ENFORCE(lda >= K && ldb >= K && ldc >= N);
@@ -164,7 +165,62 @@ void ComputeGemm(const int M,
       M, N, K, alpha,
       &*A, lda,
       &*B, ldb, beta,
-      &*C, ldc, &CPUMathUtil::Instance());
+      &*C, ldc, &CPUMathUtil::Instance(), ttp);
+}
+
+/** The B operand of ComputeGemm: weights of size N x K (transposed), and optionally the same weights packed for the
+MLAS SGEMM kernels. The kernels pack W and R once at construction when they are constant initializers, see
+PackWeights, so that Compute does not repack them for every GEMM.
+*/
+template <typename T>
+struct GemmWeights {
+  GemmWeights(const gsl::span<const T>& weights_in, const GemmPackedB* packed_in)
+      : weights(weights_in), packed(packed_in) {}
+
+  gsl::span<const T> weights;
+  const GemmPackedB* packed;
+};
+
+// As above, multiplying by the packed weights of B when there are any
+template <typename TSpanAIter, typename T, typename TSpanCIter>
+void ComputeGemm(const int M,
+                 const int N,
+                 const int K,
+                 const float alpha,
+                 TSpanAIter A,
+                 TSpanAIter A_end,
+                 const int lda,
+                 const GemmWeights<T>& B,
+                 const int ldb,
+                 const float beta,
+                 TSpanCIter C,
+                 TSpanCIter C_end,
+                 const int ldc,
+                 concurrency::ThreadPool* ttp) {
+  if (B.packed == nullptr) {
+    ComputeGemm(M, N, K, alpha, A, A_end, lda, B.weights.cbegin(), B.weights.cend(), ldb, beta, C, C_end, ldc, ttp);
+    return;
+  }
+
+  ORT_ENFORCE(B.packed->N() == N && B.packed->K() == K);
+  ORT_ENFORCE(lda >= K && ldc >= N);
+  ORT_ENFORCE(A + (M * lda - (lda - K)) <= A_end);
+  ORT_ENFORCE(C + (M * ldc - (ldc - N)) <= C_end);
+
+  B.packed->Gemm(CblasNoTrans, M, alpha, &*A, lda, beta, &*C, ldc, ttp);
+}
+
+/** Pack the weights input input_index of an RNN kernel if it is a float constant initializer of shape
+[num_directions, N, K]. The N rows of each direction are split into blocks of block_rows rows, e.g. the ZR and H
+gates of GRU, and every block is packed as the transposed B operand of a GEMM.
+@returns the packed blocks ordered by direction and then by block, or an empty vector if the input was not packed.
+*/
+std::vector<GemmPackedB> PackWeights(const OpKernelInfo& info, int input_index, int64_t num_directions,
+                                     const std::vector<int64_t>& block_rows);
+
+// the block index of the weights packed by PackWeights, or nullptr if they were not packed
+inline const GemmPackedB* GetPackedWeights(const std::vector<GemmPackedB>& packed_weights, size_t index) {
+  return packed_weights.empty() ? nullptr : &packed_weights[index];
 }
 
 // helper to convert a span to a raw pointer
@@ -203,38 +259,38 @@ T* SafeRawPointer(typename gsl::span<T> span, size_t offset, size_t size) {
   return span.data() + offset;
 }
 
+// Execute lambda(i) for i in [0, max) with the given step using the session's intra-op thread pool.
+// The lambdas are executed directly and in order if ttp is nullptr.
 template <typename TLambda>
 void ExecuteLambdaInParallel(const std::string& name, TLambda lambda, int max, int step,
-                             TaskThreadPool& ttp, const ::onnxruntime::logging::Logger& logger) {
+                             concurrency::ThreadPool* ttp, const ::onnxruntime::logging::Logger& logger) {
   // #define NOTHREADS to execute the lambdas directly and in order if you need to do that to debug
 
 #ifdef NOTHREADS
-  ORT_UNUSED_PARAMETER(ttp);
-  ORT_UNUSED_PARAMETER(logger);
+  ttp = nullptr;
+#endif
 
-  for (int i = 0; i < max; i += step) {
-    (void)name;
-    std::bind(lambda, i)();
-  }
-#else
-  std::vector<std::future<void> > task_results{};
-  task_results.reserve(static_cast<size_t>(std::ceil(max / step)));
-
-  for (int i = 0; i < max; i += step) {
-    std::packaged_task<void()> task{std::bind(lambda, i)};
-    task_results.emplace_back(task.get_future());
-    ttp.RunTask(std::move(task));
+  if (ttp == nullptr) {
+    ORT_UNUSED_PARAMETER(name);
+    ORT_UNUSED_PARAMETER(logger);
+
+    for (int i = 0; i < max; i += step) {
+      lambda(i);
+    }
+
+    return;
   }
 
+  const int num_tasks = (max + step - 1) / step;
+
   try {
-    // wait for all and propagate any exceptions
-    for (auto& future : task_results)
-      future.get();
+    // the calling thread participates and ParallelFor returns once all the tasks are done,
+    // propagating the first exception if any
+    ttp->ParallelFor(num_tasks, [&lambda, step](int32_t task) { lambda(task * step); });
   } catch (const std::exception& ex) {
     LOGS(logger, ERROR) << name << " - exception running tasks: " << ex.what();
     throw;
   }
-#endif
 }
 
 void DumpMatrixImpl(const std::string& name, const float* src, int row, int col,
@@ -3,6 +3,11 @@
 
 #include "core/providers/cpu/tensor/transpose.h"
 
+#include <algorithm>
+
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
+
 namespace onnxruntime {
 
 /* A permutation [a,b,c,...] indicates that 
@@ -12,87 +17,217 @@ namespace onnxruntime {
    etc.
    */
 
-// ComputeOffset: compute offset into a tensor. This is essentially the dot-product of
-// index and stride, restricted to the specified number of axes.
-size_t ComputeOffset(const std::vector<int64_t>& index, const std::vector<size_t>& stride, int64_t num_axes) {
-  size_t offset = 0;
-  for (int64_t j = 0; j < num_axes; ++j) {
-    offset += index[j] * stride[j];
+namespace {
+// The transpose reduced to as few axes as possible. The elements are moved by a 2D transpose of num_rows x num_cols
+// elements at every index of the outer axes. The rows are along the input axis that becomes the innermost output
+// axis and the columns are along the innermost input axis. When the innermost input axis stays innermost, the
+// num_rows elements at every outer index are contiguous in both tensors and is_copy is set instead.
+struct TransposePlan {
+  size_t num_rows = 1;
+  size_t num_cols = 1;
+  size_t input_row_stride = 1;
+  size_t output_col_stride = 1;
+  bool is_copy = true;
+
+  // the other axes, in output order
+  std::vector<size_t> outer_dims;
+  std::vector<size_t> outer_input_strides;
+  std::vector<size_t> outer_output_strides;
+  size_t outer_size = 1;
+};
+
+TransposePlan BuildTransposePlan(const std::vector<int64_t>& input_dims, const std::vector<int64_t>& perm) {
+  const size_t rank = input_dims.size();
+
+  // axes of size 1 do not move any element, drop them
+  std::vector<size_t> reduced_axis(rank);
+  size_t reduced_rank = 0;
+  for (size_t axis = 0; axis < rank; ++axis) {
+    if (input_dims[axis] != 1) {
+      reduced_axis[axis] = reduced_rank++;
+    }
+  }
+
+  // output axes that come from consecutive input axes move together, so each run of them is merged into one axis.
+  // the runs are identified by their first input axis, in output order.
+  std::vector<size_t> run_first_axis;
+  std::vector<size_t> run_dims;
+  size_t last_axis = 0;
+  for (size_t i = 0; i < rank; ++i) {
+    const auto axis = static_cast<size_t>(perm[i]);
+    if (input_dims[axis] == 1) {
+      continue;
+    }
+
+    if (!run_first_axis.empty() && reduced_axis[axis] == last_axis + 1) {
+      run_dims.back() *= static_cast<size_t>(input_dims[axis]);
+    } else {
+      run_first_axis.push_back(reduced_axis[axis]);
+      run_dims.push_back(static_cast<size_t>(input_dims[axis]));
+    }
+    last_axis = reduced_axis[axis];
+  }
+
+  // the runs partition the input axes, so their input order is the order of their first axis
+  const size_t merged_rank = run_first_axis.size();
+  std::vector<size_t> merged_perm(merged_rank);
+  for (size_t i = 0; i < merged_rank; ++i) {
+    merged_perm[i] = static_cast<size_t>(std::count_if(run_first_axis.cbegin(), run_first_axis.cend(),
+                                                       [&](size_t axis) { return axis < run_first_axis[i]; }));
+  }
+
+  std::vector<size_t> merged_input_dims(merged_rank);
+  for (size_t i = 0; i < merged_rank; ++i) {
+    merged_input_dims[merged_perm[i]] = run_dims[i];
+  }
+
+  std::vector<size_t> input_strides(merged_rank);
+  std::vector<size_t> output_strides(merged_rank);
+  size_t input_stride = 1;
+  size_t output_stride = 1;
+  for (size_t i = merged_rank; i-- > 0;) {
+    input_strides[i] = input_stride;
+    input_stride *= merged_input_dims[i];
+    output_strides[i] = output_stride;
+    output_stride *= run_dims[i];
+  }
+
+  TransposePlan plan;
+  if (merged_rank == 0) {
+    return plan;
   }
-  return offset;
-}
 
-// IncrementIndex: Increment an index into a tensor (in lexicographic ordering), wrapping
-// around the specified upper_bound.
-void IncrementIndex(std::vector<int64_t>& index, const std::vector<int64_t>& upper_bound, int64_t num_axes) {
-  for (int64_t k = num_axes - 1; k >= 0; --k) {
-    index[k]++;
-    if (index[k] < upper_bound[k]) break;
-    index[k] = 0;
+  // output positions of the innermost input axis and of the innermost output axis, which are moved by the 2D
+  // transposes. when both are the same axis the elements are copied instead.
+  const size_t inner_output_axis = merged_rank - 1;
+  const size_t inner_input_axis = static_cast<size_t>(
+      std::find(merged_perm.cbegin(), merged_perm.cend(), merged_rank - 1) - merged_perm.cbegin());
+
+  plan.is_copy = inner_input_axis == inner_output_axis;
+  plan.num_rows = run_dims[inner_output_axis];
+  plan.input_row_stride = input_strides[merged_perm[inner_output_axis]];
+  if (!plan.is_copy) {
+    plan.num_cols = run_dims[inner_input_axis];
+    plan.output_col_stride = output_strides[inner_input_axis];
   }
+
+  for (size_t i = 0; i < merged_rank; ++i) {
+    if (i != inner_output_axis && i != inner_input_axis) {
+      plan.outer_dims.push_back(run_dims[i]);
+      plan.outer_input_strides.push_back(input_strides[merged_perm[i]]);
+      plan.outer_output_strides.push_back(output_strides[i]);
+      plan.outer_size *= run_dims[i];
+    }
+  }
+
+  return plan;
+}
+
+// the fixed size types are moved as unsigned integers of the same size
+template <typename T>
+void Transpose2D(const T* input, T* output, size_t num_rows, size_t num_cols, size_t input_row_stride,
+                 size_t output_col_stride) {
+  MlasTranspose(input, output, num_rows, num_cols, input_row_stride, output_col_stride);
 }
 
-// DoTranspose: copies source tensor to target, transposing elements.
-// The stride vector indicates the transposition.
-void DoTranspose(int64_t num_axes, const std::vector<int64_t>& target_dims,
-                 size_t num_blocks, size_t num_elts_in_block,
-                 const std::vector<size_t>& stride,
-                 float* target, const float* source) {
-  size_t blocksize = num_elts_in_block * sizeof(float);
-  // index used to iterate over target iteration-space
-  std::vector<int64_t> target_index(num_axes, 0);
-  for (size_t i = 0; i < num_blocks; ++i) {
-    // convert target_index into an offset in source data
-    size_t source_offset = ComputeOffset(target_index, stride, num_axes);
-
-    // copy
-    memcpy(target, source + source_offset, blocksize);
-
-    // increment target_index:
-    IncrementIndex(target_index, target_dims, num_axes);
-    target += num_elts_in_block;
+void Transpose2D(const std::string* input, std::string* output, size_t num_rows, size_t num_cols,
+                 size_t input_row_stride, size_t output_col_stride) {
+  // blocked so that the rows read and the rows written stay cached
+  constexpr size_t kBlockSize = 16;
+  for (size_t row_block = 0; row_block < num_rows; row_block += kBlockSize) {
+    const size_t row_block_end = std::min(row_block + kBlockSize, num_rows);
+    for (size_t col_block = 0; col_block < num_cols; col_block += kBlockSize) {
+      const size_t col_block_end = std::min(col_block + kBlockSize, num_cols);
+      for (size_t row = row_block; row < row_block_end; ++row) {
+        for (size_t col = col_block; col < col_block_end; ++col) {
+          output[col * output_col_stride + row] = input[row * input_row_stride + col];
+        }
+      }
+    }
   }
 }
 
-// DoTransposeEltWise: specialization of DoTranspose for the num_elts_in_block=1 case.
-// copies source tensor to target, transposing elements.
-// The stride vector indicates the transposition.
-void DoTransposeEltWise(int64_t num_axes, const std::vector<int64_t>& target_dims,
-                        size_t num_blocks,
-                        const std::vector<size_t>& stride,
-                        float* target, const float* source) {
-  // index used to iterate over target iteration-space
-  std::vector<int64_t> target_index(num_axes, 0);
-  for (size_t i = 0; i < num_blocks; ++i) {
-    // convert target_index into an offset in source data
-    size_t source_offset = ComputeOffset(target_index, stride, num_axes);
-
-    // copy
-    *target = *(source + source_offset);
-
-    // increment target_index:
-    IncrementIndex(target_index, target_dims, num_axes);
-    target++;
+// Moves the rows [row_begin, row_end) at the outer indexes [outer_begin, outer_end).
+template <typename T>
+void TransposeRange(const TransposePlan& plan, const T* input, T* output, size_t outer_begin, size_t outer_end,
+                    size_t row_begin, size_t row_end) {
+  const size_t num_outer_axes = plan.outer_dims.size();
+
+  std::vector<size_t> index(num_outer_axes);
+  size_t input_offset = 0;
+  size_t output_offset = 0;
+  size_t remainder = outer_begin;
+  for (size_t i = num_outer_axes; i-- > 0;) {
+    index[i] = remainder % plan.outer_dims[i];
+    remainder /= plan.outer_dims[i];
+    input_offset += index[i] * plan.outer_input_strides[i];
+    output_offset += index[i] * plan.outer_output_strides[i];
+  }
+
+  for (size_t outer = outer_begin; outer < outer_end; ++outer) {
+    const T* source = input + input_offset + row_begin * plan.input_row_stride;
+    T* target = output + output_offset + row_begin;
+    if (plan.is_copy) {
+      std::copy(source, source + (row_end - row_begin), target);
+    } else {
+      Transpose2D(source, target, row_end - row_begin, plan.num_cols, plan.input_row_stride,
+                  plan.output_col_stride);
+    }
+
+    for (size_t i = num_outer_axes; i-- > 0;) {
+      input_offset += plan.outer_input_strides[i];
+      output_offset += plan.outer_output_strides[i];
+      if (++index[i] < plan.outer_dims[i]) {
+        break;
+      }
+      input_offset -= plan.outer_dims[i] * plan.outer_input_strides[i];
+      output_offset -= plan.outer_dims[i] * plan.outer_output_strides[i];
+      index[i] = 0;
+    }
   }
 }
 
-// DoTransposeSingleBlock: specialization of DoTranspose for the num_blocks=1 case.
-// copies source tensor to target, transposing elements.
-// The stride vector indicates the transposition.
-void DoTransposeSingleBlock(size_t num_elts_in_block, float* target, const float* source) {
-  size_t blocksize = num_elts_in_block * sizeof(float);
-  // copy
-  memcpy(target, source, blocksize);
+template <typename T>
+void DoTranspose(const TransposePlan& plan, const T* input, T* output, concurrency::ThreadPool* tp) {
+  // the units of work are blocks of kRowAlignment rows at every outer index, so that a few large transposes are
+  // split as well. splitting at these boundaries keeps the tasks off each other's cache lines of the output.
+  constexpr int64_t kRowAlignment = 16;
+  const auto num_rows = static_cast<int64_t>(plan.num_rows);
+  const int64_t row_blocks = (num_rows + kRowAlignment - 1) / kRowAlignment;
+
+  auto transpose_units = [&](int64_t first, int64_t last) {
+    while (first < last) {
+      const int64_t outer = first / row_blocks;
+      const int64_t row_block = first % row_blocks;
+      if (row_block == 0 && last - first >= row_blocks) {
+        // whole outer indices
+        const int64_t outer_end = last / row_blocks;
+        TransposeRange(plan, input, output, static_cast<size_t>(outer), static_cast<size_t>(outer_end),
+                       0, plan.num_rows);
+        first = outer_end * row_blocks;
+      } else {
+        const int64_t row_block_end = std::min(row_blocks, row_block + last - first);
+        TransposeRange(plan, input, output, static_cast<size_t>(outer), static_cast<size_t>(outer + 1),
+                       static_cast<size_t>(row_block * kRowAlignment),
+                       static_cast<size_t>(std::min(row_block_end * kRowAlignment, num_rows)));
+        first += row_block_end - row_block;
+      }
+    }
+  };
+
+  // a transpose is bound by memory bandwidth, so its tasks are larger than the ones of the element-wise ops
+  concurrency::ThreadPool::TryParallelFor(tp, static_cast<int64_t>(plan.outer_size) * row_blocks,
+                                          kRowAlignment * static_cast<int64_t>(plan.num_cols), transpose_units, 1,
+                                          4 * concurrency::ThreadPool::kMinBlockCost);
 }
+}  // namespace
 
-template <>
-Status Transpose<float>::Compute(OpKernelContext* ctx) const {
+Status Transpose::Compute(OpKernelContext* ctx) const {
   // Get input and output:
   const Tensor* input_tensor_ptr = ctx->Input<Tensor>(0);
   ORT_ENFORCE(input_tensor_ptr != nullptr);
   const Tensor& X = *input_tensor_ptr;
-  const TensorShape& input_shape = X.Shape();
-  const std::vector<int64_t>& input_dims = input_shape.GetDims();
+  const std::vector<int64_t>& input_dims = X.Shape().GetDims();
   size_t rank = input_dims.size();
 
   std::vector<int64_t> output_dims(rank);
@@ -100,43 +235,39 @@ Status Transpose<float>::Compute(OpKernelContext* ctx) const {
   std::vector<int64_t> default_perm(rank);
   ComputeOutputShape(X, output_dims, default_perm, p_perm);
 
-  std::vector<size_t> stride(rank);
-  for (int i = 0; i < rank; i++) {
-    size_t inpdim = (*p_perm)[i];
-    if (inpdim + 1 < rank)
-      stride[i] = input_shape.SizeFromDimension(inpdim + 1);
-    else
-      stride[i] = 1;
-  }
-
   TensorShape output_shape{output_dims};
   Tensor* Y = ctx->Output(0, output_shape);
-  const float* Xdata = X.template Data<float>();
-  float* Ydata = Y->template MutableData<float>();
-
-  // Partition the permutation into a prefix and the largest suffix such that
-  // every axis i in the suffix is mapped to i.
-  int64_t num_axes_in_prefix = 0;  // number of axes in prefix
-  size_t suffix_blocksize = 1;     // product of dimensions in the suffix
-  size_t prefix_blocksize = 1;     // product of dimensions in the prefix
-  bool is_suffix = true;
-  for (int64_t i = rank - 1; i >= 0; --i) {
-    int64_t inpaxis = (*p_perm)[i];
-    if (is_suffix && (inpaxis == i)) {
-      suffix_blocksize *= input_dims[inpaxis];
-    } else {
-      is_suffix = false;
-      prefix_blocksize *= input_dims[inpaxis];
-      ++num_axes_in_prefix;
-    }
+  if (output_shape.Size() == 0) {
+    return Status::OK();
   }
 
-  if (1 == prefix_blocksize)
-    DoTransposeSingleBlock(suffix_blocksize, Ydata, Xdata);
-  else if (1 == suffix_blocksize)
-    DoTransposeEltWise(num_axes_in_prefix, output_dims, prefix_blocksize, stride, Ydata, Xdata);
-  else
-    DoTranspose(num_axes_in_prefix, output_dims, prefix_blocksize, suffix_blocksize, stride, Ydata, Xdata);
+  const TransposePlan plan = BuildTransposePlan(input_dims, *p_perm);
+  concurrency::ThreadPool* tp = ctx->GetOperatorThreadPool();
+
+  if (X.DataType() == DataTypeImpl::GetType<std::string>()) {
+    DoTranspose(plan, X.template Data<std::string>(), Y->template MutableData<std::string>(), tp);
+    return Status::OK();
+  }
+
+  const void* Xdata = X.DataRaw();
+  void* Ydata = Y->MutableDataRaw();
+  switch (X.DataType()->Size()) {
+    case sizeof(uint8_t):
+      DoTranspose(plan, static_cast<const uint8_t*>(Xdata), static_cast<uint8_t*>(Ydata), tp);
+      break;
+    case sizeof(uint16_t):
+      DoTranspose(plan, static_cast<const uint16_t*>(Xdata), static_cast<uint16_t*>(Ydata), tp);
+      break;
+    case sizeof(uint32_t):
+      DoTranspose(plan, static_cast<const uint32_t*>(Xdata), static_cast<uint32_t*>(Ydata), tp);
+      break;
+    case sizeof(uint64_t):
+      DoTranspose(plan, static_cast<const uint64_t*>(Xdata), static_cast<uint64_t*>(Ydata), tp);
+      break;
+    default:
+      return ORT_MAKE_STATUS(ONNXRUNTIME, NOT_IMPLEMENTED, "Transpose of elements of ", X.DataType()->Size(),
+                             " bytes is not supported.");
+  }
 
   return Status::OK();
 }
@@ -144,7 +275,7 @@ Status Transpose<float>::Compute(OpKernelContext* ctx) const {
 ONNX_CPU_OPERATOR_KERNEL(
     Transpose,
     1,
-    KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
-    Transpose<float>);
+    KernelDefBuilder().TypeConstraint("T", DataTypeImpl::AllTensorTypes()),
+    Transpose);
 
 }  // namespace onnxruntime
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include "core/session/onnxruntime_c_api.h"
+#include <algorithm>
 #include <cstring>
 #include <cassert>
 #include "core/session/inference_session.h"
@@ -58,6 +59,16 @@ ORT_API(void, OrtDisableProfiling, _In_ OrtSessionOptions* options) {
   options->value.profile_file_prefix.clear();
 }
 
+ORT_API(void, OrtSetProfileSamplingInterval, _In_ OrtSessionOptions* options, uint32_t sampling_interval) {
+  options->value.profile_sampling_interval = sampling_interval;
+}
+
+ORT_API(void, OrtSetProfileFileRotation, _In_ OrtSessionOptions* options, size_t max_file_bytes,
+        uint32_t max_file_seconds) {
+  options->value.profile_max_file_bytes = max_file_bytes;
+  options->value.profile_max_file_seconds = max_file_seconds;
+}
+
 // enable the memory pattern optimization.
 // The idea is if the input shapes are the same, we could trace the internal memory allocation
 // and generate a memory pattern for future request. So next time we could just do one allocation
@@ -69,6 +80,18 @@ ORT_API(void, OrtDisableMemPattern, _In_ OrtSessionOptions* options) {
   options->value.enable_mem_pattern = false;
 }
 
+ORT_API(void, OrtSetMemPatternCacheLimits, _In_ OrtSessionOptions* options, size_t max_entries, size_t max_bytes) {
+  options->value.mem_pattern_cache_max_entries = max_entries;
+  options->value.mem_pattern_cache_max_bytes = max_bytes;
+}
+
+ORT_API(int, OrtSetMemPatternDimBuckets, _In_ OrtSessionOptions* options, _In_ const int64_t* dim_buckets,
+        size_t dim_buckets_len) {
+  if (dim_buckets_len > 0 && !std::is_sorted(dim_buckets, dim_buckets + dim_buckets_len)) return -1;
+  options->value.mem_pattern_dim_buckets.assign(dim_buckets, dim_buckets + dim_buckets_len);
+  return 0;
+}
+
 // enable the memory arena on CPU
 // Arena may pre-allocate memory for future usage.
 // set this option to false if you don't want it.
@@ -97,6 +120,24 @@ ORT_API(int, OrtSetSessionThreadPoolSize, _In_ OrtSessionOptions* options, int s
   return 0;
 }
 
+///How many threads the CPU kernels use to parallelize a single operator. 0 lets onnxruntime choose.
+ORT_API(int, OrtSetIntraOpNumThreads, _In_ OrtSessionOptions* options, int intra_op_num_threads) {
+  if (intra_op_num_threads < 0) return -1;
+  options->value.intra_op_num_threads = intra_op_num_threads;
+  return 0;
+}
+
+///Level of the built-in graph optimizations, one of GraphOptimizationLevel.
+ORT_API(int, OrtSetSessionGraphOptimizationLevel, _In_ OrtSessionOptions* options, uint32_t graph_optimization_level) {
+  if (graph_optimization_level > static_cast<uint32_t>(onnxruntime::TransformerLevel::MaxLevel)) return -1;
+  options->value.graph_optimization_level = static_cast<onnxruntime::TransformerLevel>(graph_optimization_level);
+  return 0;
+}
+
+ORT_API(void, OrtSetOptimizedModelCachePath, _In_ OrtSessionOptions* options, _In_ const char* cache_path) {
+  options->value.optimized_model_cache_path = cache_path;
+}
+
 ORT_API(void, OrtAddCustomOp, _In_ OrtSessionOptions* options, const char* custom_op_path) {
   options->custom_op_paths.emplace_back(custom_op_path);
 }
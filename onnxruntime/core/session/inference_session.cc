@@ -6,19 +6,22 @@
 #include <memory>
 #include <mutex>
 #include <sstream>
+#include <thread>
 #include <unordered_set>
 #include <list>
+#include <algorithm>
 
 #include "core/common/logging/logging.h"
-#include "core/common/task_thread_pool.h"
 #include "core/graph/graph_viewer.h"
 #include "core/graph/graph_transformer.h"
 #include "core/graph/graph_transformer_mgr.h"
 #include "core/graph/model.h"
 #include "core/framework/allocatormgr.h"
+#include "core/framework/constant_folding.h"
 #include "core/framework/customregistry.h"
 #include "core/framework/environment.h"
 #include "core/framework/execution_frame.h"
+#include "core/framework/feeds_fetches_info.h"
 #include "core/framework/graph_partitioner.h"
 #include "core/framework/insert_cast_transformer.h"
 #include "core/framework/kernel_def_builder.h"
@@ -35,9 +38,11 @@
 #include "core/framework/transformer_memcpy.h"
 #include "core/framework/utils.h"
 #include "core/platform/notification.h"
+#include "core/platform/threadpool.h"
 #include "core/providers/cpu/cpu_execution_provider.h"
 #include "core/session/CustomOpsLoader.h"
 #include "core/session/IOBinding.h"
+#include "core/session/optimized_model_cache.h"
 
 using namespace ONNX_NAMESPACE;
 
@@ -47,7 +52,8 @@ class InferenceSession::Impl {
  public:
   Impl(const SessionOptions& session_options, logging::LoggingManager* logging_manager)
       : session_options_{session_options},
-        graph_transformation_mgr_{session_options_.max_num_graph_transformation_steps},
+        graph_transformation_mgr_{session_options_.max_num_graph_transformation_steps,
+                                  session_options_.graph_optimization_level},
         logging_manager_{logging_manager},
         session_state_{execution_providers_},
         insert_cast_transformer_{"CastFloat16Transformer"} {
@@ -56,18 +62,37 @@ class InferenceSession::Impl {
 
     InitLogger(logging_manager);
 
+    // constant folding runs the kernels of the session, so it is registered here rather than by the
+    // GraphTransformerManager, ahead of any transformer registered with RegisterGraphTransformer.
+    if (session_options_.graph_optimization_level >= TransformerLevel::Basic) {
+      graph_transformation_mgr_.Register(std::make_unique<ConstantFolding>(execution_providers_,
+                                                                           kernel_registry_manager_,
+                                                                           *session_logger_));
+    }
+
     // currently the threadpool is used by the parallel executor only and hence
     // there is no point creating it when only sequential execution is enabled.
     if (!session_options.enable_sequential_execution) {
       int pool_size = session_options_.session_thread_pool_size == 0
                           ? std::thread::hardware_concurrency() / 2
                           : session_options_.session_thread_pool_size;
-      thread_pool_ = std::make_unique<TaskThreadPool>(pool_size);
+      thread_pool_ = std::make_unique<concurrency::ThreadPool>("inter_op_thread_pool", pool_size);
     }
 
     session_state_.SetThreadPool(thread_pool_.get());
+
+    // the thread invoking the kernel participates in the parallel work so the pool needs one thread less.
+    int intra_op_num_threads = session_options_.intra_op_num_threads == 0
+                                   ? static_cast<int>(std::thread::hardware_concurrency())
+                                   : session_options_.intra_op_num_threads;
+    intra_op_thread_pool_ = std::make_unique<concurrency::ThreadPool>("intra_op_thread_pool",
+                                                                      std::max(intra_op_num_threads - 1, 0));
+    session_state_.SetIntraOpThreadPool(intra_op_thread_pool_.get());
     session_state_.SetEnableMemoryPattern(session_options.enable_mem_pattern);
+    session_state_.SetEnableNodeStatistics(session_options.enable_node_statistics);
+    session_state_.SetMemoryPatternCacheOptions(GetMemoryPatternCacheOptions());
     session_profiler_.Initialize(session_logger_);
+    session_profiler_.SetOptions(GetProfilerOptions());
     session_state_.SetProfiler(session_profiler_);
     if (session_options.enable_profiling) {
       StartProfiling(session_options.profile_file_prefix);
@@ -90,6 +115,7 @@ class InferenceSession::Impl {
     if (p_graph_transformer == nullptr) {
       return Status(common::ONNXRUNTIME, common::FAIL, "Received nullptr for graph transformer");
     }
+    has_registered_graph_transformers_ = true;
     return graph_transformation_mgr_.Register(std::move(p_graph_transformer));
   }
 
@@ -130,11 +156,19 @@ class InferenceSession::Impl {
       }
 
       std::shared_ptr<onnxruntime::Model> p_tmp_model;
-      ORT_RETURN_IF_ERROR(onnxruntime::Model::Load(model_uri, p_tmp_model,
-                                                   HasLocalSchema() ? &custom_schema_registries_ : nullptr));
+      ORT_RETURN_IF_ERROR(LoadFromOptimizedModelCache(model_uri, p_tmp_model));
+      if (!p_tmp_model) {
+        ORT_RETURN_IF_ERROR(onnxruntime::Model::Load(model_uri, p_tmp_model,
+                                                     HasLocalSchema() ? &custom_schema_registries_ : nullptr));
+      }
       model_ = p_tmp_model;
+      model_dir_ = GetModelDirectory(model_uri);
 
       ORT_RETURN_IF_ERROR(DoPostLoadProcessing(*model_.get()));
+      if (loaded_from_optimized_model_cache_) {
+        model_metadata_.custom_metadata_map.erase(OptimizedModelCache::kKeyMetadataName);
+        model_metadata_.custom_metadata_map.erase(OptimizedModelCache::kPartitionMetadataName);
+      }
 
       // all steps complete, mark the model as loaded.
       is_model_loaded_ = true;
@@ -220,14 +254,15 @@ class InferenceSession::Impl {
         return common::Status(common::ONNXRUNTIME, common::MODEL_LOADED, "This session already contains a loaded model.");
       }
 
-      ModelProto model_proto;
-      const bool result = model_proto.ParseFromIstream(&model_istream);
+      // parse into a ModelProto the Model takes ownership of, so that the weights are not copied
+      auto model_proto = std::make_unique<ModelProto>();
+      const bool result = model_proto->ParseFromIstream(&model_istream);
       if (!result) {
         return Status(common::ONNXRUNTIME, common::INVALID_PROTOBUF, "Failed to load model because protobuf parsing failed.");
       }
 
       std::shared_ptr<onnxruntime::Model> p_tmp_model;
-      ORT_RETURN_IF_ERROR(onnxruntime::Model::Load(model_proto, p_tmp_model,
+      ORT_RETURN_IF_ERROR(onnxruntime::Model::Load(std::move(model_proto), p_tmp_model,
                                                    HasLocalSchema() ? &custom_schema_registries_ : nullptr));
       model_ = p_tmp_model;
 
@@ -247,6 +282,19 @@ class InferenceSession::Impl {
     return common::Status::OK();
   }
 
+  // external data of initializers is located relative to the model file
+  static std::string GetModelDirectory(const std::string& model_uri) {
+    auto pos = model_uri.find_last_of("/\\");
+    return pos == std::string::npos ? std::string{} : model_uri.substr(0, pos);
+  }
+
+#ifdef _WIN32
+  // Env maps files by narrow path, so relative locations are resolved against the current directory
+  static std::string GetModelDirectory(const std::wstring& /*model_uri*/) {
+    return {};
+  }
+#endif
+
   // memory allocations for a subgraph that are owned by InferenceSession
   struct SubgraphMemory {
     std::unique_ptr<SessionState> session_state;
@@ -272,6 +320,8 @@ class InferenceSession::Impl {
           // create SessionState for executing subgraph
           subgraph_info.session_state = std::make_unique<SessionState>(execution_providers_);
           subgraph_info.session_state->SetProfiler(session_profiler_);
+          subgraph_info.session_state->SetIntraOpThreadPool(intra_op_thread_pool_.get());
+          subgraph_info.session_state->SetMemoryPatternCacheOptions(GetMemoryPatternCacheOptions());
 
           // setup everything required to execute the subgraph and save it in subgraph_session_state
           SessionStateInitializer initializer{*subgraph, *subgraph_info.session_state,
@@ -283,7 +333,7 @@ class InferenceSession::Impl {
                                      session_options_.enable_sequential_execution));
 
           ORT_RETURN_IF_ERROR(initializer.InitializeAndSave(session_state_.GetEnableMemoryPattern(),
-                                                            subgraph_info.weights_buffers));
+                                                            subgraph_info.weights_buffers, model_dir_));
 
           // add the subgraph SessionState instance to the parent graph SessionState so it can be retrieved
           // by Compute() via OpKernelContextInternal.
@@ -344,18 +394,63 @@ class InferenceSession::Impl {
 
       insert_cast_transformer_.AddKernelRegistries(kernel_registry_manager_.GetAllKernelRegistries());
 
+      // the transformers of a model loaded from the cache were already applied before it was saved, and its
+      // partition is reused if it was made for the same execution providers
+      GraphTransformerManager no_graph_transformers{0};
+      GraphTransformerManager* graph_transformers = &graph_transformation_mgr_;
+      bool graph_is_partitioned = false;
+      if (!optimized_model_cache_key_.empty() && HasCustomGraphOptimizations()) {
+        // registered after the model was loaded. a model loaded from the cache still gets all the transformers.
+        LOGS(*session_logger_, WARNING) << "The optimized model cache is not used with custom graph transformers "
+                                        << "or custom op registries.";
+      } else if (loaded_from_optimized_model_cache_) {
+        graph_transformers = &no_graph_transformers;
+        graph_is_partitioned = OptimizedModelCache::ApplyPartition(*model_, graph, execution_providers_);
+        if (!graph_is_partitioned) {
+          LOGS(*session_logger_, INFO) << "The optimized model cache has no partition for the execution providers "
+                                       << "of the session. The cached graph is partitioned again.";
+        }
+      } else if (!optimized_model_cache_key_.empty()) {
+        // the cache holds the graph as transformed, before the partitioner fuses any nodes, and the partition
+        ORT_RETURN_IF_ERROR(graph_transformation_mgr_.ApplyAll(graph));
+        graph_transformers = &no_graph_transformers;
+        ORT_RETURN_IF_ERROR(graph.Resolve());
+        ONNX_NAMESPACE::ModelProto cache_proto = model_->ToProto();
+
+        GraphPartitioner partitioner(kernel_registry_manager_, execution_providers_);
+        ORT_RETURN_IF_ERROR(partitioner.Partition(graph));
+        graph_is_partitioned = true;
+        OptimizedModelCache::SetPartition(cache_proto, graph, execution_providers_);
+
+        Status status = OptimizedModelCache::Save(cache_proto, session_options_.optimized_model_cache_path,
+                                                  optimized_model_cache_key_);
+        if (!status.IsOK()) {
+          LOGS(*session_logger_, WARNING) << "Failed to save the optimized model cache: " << status.ErrorMessage();
+        }
+      } else if (!session_options_.optimized_model_cache_path.empty()) {
+        LOGS(*session_logger_, WARNING) << "The optimized model cache is only used for models loaded from a file.";
+      }
+
       SessionStateInitializer session_initializer{graph, session_state_, execution_providers_,
                                                   kernel_registry_manager_, *session_logger_};
 
-      ORT_RETURN_IF_ERROR(session_initializer.CreatePlan(graph_transformation_mgr_, insert_cast_transformer_,
-                                                         {}, session_options_.enable_sequential_execution));
+      ORT_RETURN_IF_ERROR(session_initializer.CreatePlan(*graph_transformers, insert_cast_transformer_,
+                                                         {}, session_options_.enable_sequential_execution,
+                                                         graph_is_partitioned));
 
       ORT_RETURN_IF_ERROR(session_initializer.InitializeAndSave(session_state_.GetEnableMemoryPattern(),
-                                                                weights_buffers_));
+                                                                weights_buffers_, model_dir_));
 
       // handle any subgraphs
       ORT_RETURN_IF_ERROR(InitializeSubgraphSessions(graph, session_state_));
 
+      // the session state and the Graph instances hold everything needed by Run
+      if (session_options_.release_graph_proto_after_initialize) {
+        graph.ReleaseGraphProtoNodes();
+      }
+
+      cpu_provider_only_ = std::next(execution_providers_.begin()) == execution_providers_.end();
+
       is_inited_ = true;
 
       LOGS(*session_logger_, INFO) << "Session successfully initialized.";
@@ -378,6 +473,35 @@ class InferenceSession::Impl {
     return current_num_runs_.load();
   }
 
+  MemoryPatternCacheStats GetMemoryPatternCacheStats() const {
+    return session_state_.GetMemoryPatternCacheStats();
+  }
+
+  std::vector<NodeStatistics> GetNodeStatistics() const {
+    const NodeStatisticsCollector* collector = session_state_.GetNodeStatisticsCollector();
+    const GraphViewer* graph_viewer = session_state_.GetGraphViewer();
+    if (collector == nullptr || graph_viewer == nullptr) {
+      return {};
+    }
+
+    std::vector<NodeStatistics> statistics = collector->GetStatistics();
+    for (auto& node_statistics : statistics) {
+      const Node* node = graph_viewer->GetNode(node_statistics.node_index);
+      if (node != nullptr) {
+        node_statistics.node_name = node->Name();
+        node_statistics.op_type = node->OpType();
+      }
+    }
+    return statistics;
+  }
+
+  void ResetNodeStatistics() {
+    const NodeStatisticsCollector* collector = session_state_.GetNodeStatisticsCollector();
+    if (collector != nullptr) {
+      collector->Reset();
+    }
+  }
+
   common::Status Run(const NameMLValMap& feeds,
                      const std::vector<std::string>& output_names,
                      std::vector<MLValue>* p_fetches) {
@@ -395,6 +519,16 @@ class InferenceSession::Impl {
                   "Unexpected input data type. Actual: (" + actual_name + ") , expected: (" + expected_name + ")");
   }
 
+  static common::Status CheckInputType(const MLValue& input_ml_value, MLDataType expected_type) {
+    if (!input_ml_value.IsTensor()) {
+      return CheckTypes(input_ml_value.Type(), expected_type);
+    }
+
+    auto expected_element_type = expected_type->AsTensorType()->GetElementType();
+    auto input_element_type = input_ml_value.Get<Tensor>().DataType();
+    return CheckTypes(input_element_type, expected_element_type);
+  }
+
   common::Status ValidateInputTypes(const NameMLValMap& feeds) {
     for (auto& arg : input_def_list_) {
       auto& arg_name = arg->Name();
@@ -402,24 +536,7 @@ class InferenceSession::Impl {
         continue;
       }
 
-      auto& input_ml_value = feeds.at(arg_name);
-      auto input_type = input_ml_value.Type();
-      auto expected_type = utils::GetMLDataType(*arg);
-
-      if (!input_ml_value.IsTensor()) {
-        auto retval = CheckTypes(input_type, expected_type);
-        if (!retval.IsOK()) {
-          return retval;
-        }
-        continue;
-      }
-
-      auto expected_element_type = expected_type->AsTensorType()->GetElementType();
-      auto input_element_type = input_ml_value.Get<Tensor>().DataType();
-      auto retval = CheckTypes(input_element_type, expected_element_type);
-      if (!retval.IsOK()) {
-        return retval;
-      }
+      ORT_RETURN_IF_ERROR(CheckInputType(feeds.at(arg_name), utils::GetMLDataType(*arg)));
     }
     return Status::OK();
   }
@@ -474,7 +591,7 @@ class InferenceSession::Impl {
   }
 
   common::Status ValidateOutputs(const std::vector<std::string>& output_names,
-                                 const std::vector<MLValue>* p_fetches) {
+                                 const std::vector<MLValue>* p_fetches) const {
     if (!p_fetches) {
       return common::Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
                             "Output vector pointer is NULL");
@@ -523,6 +640,14 @@ class InferenceSession::Impl {
   common::Status CopyInputsAcrossDevices(const SessionState& session_state,
                                          const NameMLValMap& orig_feeds,
                                          NameMLValMap& new_feeds) {
+    // new_feeds may hold the entries of a previous Run. keep them if the feed names are unchanged so that
+    // assigning the values below does not allocate.
+    if (new_feeds.size() != orig_feeds.size() ||
+        std::any_of(orig_feeds.cbegin(), orig_feeds.cend(),
+                    [&new_feeds](const NameMLValMap::value_type& pair) { return new_feeds.count(pair.first) == 0; })) {
+      new_feeds.clear();
+    }
+
     for (auto& pair : orig_feeds) {
       MLValue new_mlvalue;
       auto& input_name = pair.first;
@@ -545,13 +670,14 @@ class InferenceSession::Impl {
     }
     new_fetches.resize(output_names.size());
 
-    std::set<std::string> seen_outputs;
+    // each value is produced by exactly one node so counting the matches is enough to stop early
+    size_t num_seen_outputs = 0;
     auto p_graph = session_state_.GetGraphViewer();
     ORT_ENFORCE(p_graph);
 
     std::pair<bool, size_t> found;
     for (auto& node : p_graph->Nodes()) {  // TODO optimize this
-      if (seen_outputs.size() == fetches.size()) {
+      if (num_seen_outputs == fetches.size()) {
         break;
       }
       for (auto* arg : node.OutputDefs()) {
@@ -561,7 +687,7 @@ class InferenceSession::Impl {
           continue;
         }
 
-        seen_outputs.insert(arg->Name());
+        ++num_seen_outputs;
         size_t idx = found.second;
         MLValue orig_mlvalue = fetches[idx];
         if (orig_mlvalue.IsAllocated()) {
@@ -595,13 +721,14 @@ class InferenceSession::Impl {
     }
 
     // If we've already seen all the outputs requested just return.
-    if (seen_outputs.size() == output_names.size()) {
+    if (num_seen_outputs == output_names.size()) {
       return Status::OK();
     }
 
     // Handle the case when a constant is an output but has been folded into a weight
     // and hence it doesn't show up in any of the OutputDefs before.
-    // assume that the weight has already been placed in the appropriate device before
+    // assume that the weight has already been placed in the appropriate device before.
+    // a weight is never produced by a node so it can't have been counted above.
     auto& defs = p_graph->GetOutputs();
     auto& mlvalue_name_idx_map{session_state_.GetMLValueNameIdxMap()};
     auto& weights = session_state_.GetInitializedTensors();
@@ -609,7 +736,6 @@ class InferenceSession::Impl {
     for (auto& one_def : defs) {
       if (!one_def->Exists() ||
           one_def->Name().empty() ||
-          seen_outputs.count(one_def->Name()) ||
           !(found = Contains(output_names, one_def->Name())).first) {
         continue;
       }
@@ -622,14 +748,14 @@ class InferenceSession::Impl {
         LOGS(*session_logger_, INFO) << "Output with name " << def_name << " is not a weight.";
         continue;
       }
-      seen_outputs.insert(def_name);
+      ++num_seen_outputs;
       const auto& weight = weights.at(mlvalue_idx);
       new_fetches[idx] = weight;
     }
 
-    if (seen_outputs.size() != output_names.size())  // make sure we've seen all outputs
+    if (num_seen_outputs != output_names.size())  // make sure we've seen all outputs
       return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "output size mismatch, expected ", output_names.size(),
-                             " got ", seen_outputs.size());
+                             " got ", num_seen_outputs);
 
     return Status::OK();
   }
@@ -723,12 +849,105 @@ class InferenceSession::Impl {
     return Status::OK();
   }
 
+  common::Status ValidatePreparedRun(const FeedsFetchesInfo& info,
+                                     const std::vector<MLValue>& feeds,
+                                     const std::vector<MLValue>* p_fetches) {
+    if (info.session_state != &session_state_) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "FeedsFetchesInfo was not prepared by this session.");
+    }
+
+    if (feeds.size() != info.feeds_mlvalue_idxs.size()) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Expected ", info.feeds_mlvalue_idxs.size(),
+                             " feeds but got ", feeds.size());
+    }
+
+    if (!p_fetches) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Output vector pointer is NULL");
+    }
+
+    if (!p_fetches->empty() && p_fetches->size() != info.fetches_mlvalue_idxs.size()) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Output vector incorrectly sized: expected ",
+                             info.fetches_mlvalue_idxs.size(), " got ", p_fetches->size());
+    }
+
+    for (size_t i = 0; i < feeds.size(); ++i) {
+      ORT_RETURN_IF_ERROR(CheckInputType(feeds[i], info.feed_types[i]));
+    }
+
+    return Status::OK();
+  }
+
+  // Per-Run state whose construction cost grows with the size of the graph. A completed Run returns its context
+  // to the session so the next Run can reuse it, which keeps the steady state free of heap allocations other than
+  // the output tensors. Each concurrent Run holds its own context, so at most one is cached per concurrent caller.
+  struct RunContext {
+    RunContext(const SessionState& session_state, bool sequential_execution) : frame(session_state) {
+      if (sequential_execution) {
+        executor = std::make_unique<SequentialExecutor>();
+      } else {
+        executor = std::make_unique<ParallelExecutor>(session_state);
+      }
+    }
+
+    ExecutionFrame frame;
+    // the executor keeps its own per-run state, e.g. the ready counters and deques of the ParallelExecutor
+    std::unique_ptr<IExecutor> executor;
+    NameMLValMap copied_feeds;
+    std::vector<MLValue> fetches;
+
+    // feeds and fetches resolved to MLValue indices for the ExecutionFrame
+    std::vector<int> feed_mlvalue_idxs;
+    std::vector<MLValue> feed_values;
+    std::vector<int> fetch_mlvalue_idxs;
+  };
+
+  common::Status ExecuteGraph(const RunOptions& run_options,
+                              RunContext& run_context,
+                              const std::vector<int>& feed_mlvalue_idxs,
+                              const std::vector<MLValue>& feeds,
+                              const std::vector<int>& fetch_mlvalue_idxs,
+                              std::vector<MLValue>& fetches,
+                              const logging::Logger& run_logger) {
+    run_context.frame.Reset(feed_mlvalue_idxs, feeds, fetch_mlvalue_idxs, fetches);
+    return run_context.executor->Execute(session_state_, run_context.frame, fetch_mlvalue_idxs, fetches,
+                                         run_options.terminate, run_logger);
+  }
+
+  std::unique_ptr<RunContext> AcquireRunContext() {
+    {
+      std::lock_guard<std::mutex> l(run_contexts_mutex_);
+      if (!run_contexts_.empty()) {
+        auto run_context = std::move(run_contexts_.back());
+        run_contexts_.pop_back();
+        return run_context;
+      }
+    }
+
+    return std::make_unique<RunContext>(session_state_, session_options_.enable_sequential_execution);
+  }
+
+  void ReleaseRunContext(std::unique_ptr<RunContext> run_context) {
+    // drop all references to the user's tensors and the intermediate values but keep the containers
+    run_context->frame.Clear();
+    for (auto& feed : run_context->copied_feeds) {
+      feed.second = MLValue();
+    }
+    run_context->fetches.clear();
+    run_context->feed_values.clear();
+
+    std::lock_guard<std::mutex> l(run_contexts_mutex_);
+    run_contexts_.push_back(std::move(run_context));
+  }
+
   Status Run(const RunOptions& run_options,
              const NameMLValMap& feeds,
              const std::vector<std::string>& output_names,
              std::vector<MLValue>* p_fetches) {
     auto tp = session_profiler_.StartTime();
+    // the events of the runs that are not sampled are not recorded, including the ones of the executor
+    profiling::Profiler::RunScope profiler_run_scope{session_profiler_.SampleRun()};
     Status retval = Status::OK();
+    std::unique_ptr<RunContext> run_context;
 
     try {
       {
@@ -762,32 +981,185 @@ class InferenceSession::Impl {
       for (auto& xp : execution_providers_)
         ORT_CHECK_AND_SET_RETVAL(xp->OnRunStart());
 
-      NameMLValMap copied_feeds;
-      ORT_CHECK_AND_SET_RETVAL(CopyInputsAcrossDevices(session_state_, feeds, copied_feeds));
+      if (retval.IsOK()) {
+        run_context = AcquireRunContext();
+
+        NameMLValMap& copied_feeds = run_context->copied_feeds;
+        ORT_CHECK_AND_SET_RETVAL(CopyInputsAcrossDevices(session_state_, feeds, copied_feeds));
+
+        std::vector<MLValue>& new_fetches = run_context->fetches;
+        ORT_CHECK_AND_SET_RETVAL(MatchOutputsWithProviders(output_names, *p_fetches, new_fetches));
+
+        if (retval.IsOK()) {
+          const auto& mlvalue_name_idx_map = session_state_.GetMLValueNameIdxMap();
+          std::vector<int>& feed_mlvalue_idxs = run_context->feed_mlvalue_idxs;
+          std::vector<MLValue>& feed_values = run_context->feed_values;
+          feed_mlvalue_idxs.resize(copied_feeds.size());
+          feed_values.resize(copied_feeds.size());
+          size_t i = 0;
+          for (const auto& feed : copied_feeds) {
+            ORT_CHECK_AND_SET_RETVAL(mlvalue_name_idx_map.GetIdx(feed.first, feed_mlvalue_idxs[i]));
+            feed_values[i++] = feed.second;
+          }
+
+          std::vector<int>& fetch_mlvalue_idxs = run_context->fetch_mlvalue_idxs;
+          fetch_mlvalue_idxs.resize(output_names.size());
+          for (i = 0; i < output_names.size(); ++i) {
+            ORT_CHECK_AND_SET_RETVAL(mlvalue_name_idx_map.GetIdx(output_names[i], fetch_mlvalue_idxs[i]));
+          }
+
+          if (retval.IsOK()) {
+            retval = ExecuteGraph(run_options, *run_context, feed_mlvalue_idxs, feed_values,
+                                  fetch_mlvalue_idxs, new_fetches, run_logger);
+          }
+        }
+
+        ORT_CHECK_AND_SET_RETVAL(CopyOutputsAcrossDevices(new_fetches, *p_fetches));
+      }
+
+    } catch (const std::exception& e) {
+      retval = Status(common::ONNXRUNTIME, common::FAIL, e.what());
+    } catch (...) {
+      retval = Status(common::ONNXRUNTIME, common::RUNTIME_EXCEPTION, "Encountered unknown exception in Run()");
+    }
+
+    if (run_context) {
+      ReleaseRunContext(std::move(run_context));
+    }
+
+    // info all execution providers InferenceSession:Run ended
+    for (auto& xp : execution_providers_)
+      ORT_CHECK_AND_SET_RETVAL(xp->OnRunEnd());
+
+    --current_num_runs_;
+    session_profiler_.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "model_run", tp);
+    return retval;
+  }
+
+  common::Status PrepareRun(const std::vector<std::string>& feed_names,
+                            const std::vector<std::string>& output_names,
+                            std::unique_ptr<FeedsFetchesInfo>* info) const {
+    if (!info) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "FeedsFetchesInfo output pointer is NULL");
+    }
+
+    {
+      std::lock_guard<std::mutex> l(session_mutex_);
+      if (!is_inited_) {
+        LOGS(*session_logger_, ERROR) << "Session was not initialized";
+        return Status(common::ONNXRUNTIME, common::FAIL, "Session not initialized.");
+      }
+    }
+
+    std::unordered_set<std::string> unique_feed_names;
+    for (const auto& name : feed_names) {
+      if (model_input_names_.find(name) == model_input_names_.end()) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Invalid Feed Input Name: ", name);
+      }
+      if (!unique_feed_names.insert(name).second) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Duplicate Feed Input Name: ", name);
+      }
+    }
+
+    for (const auto& name : required_model_input_names_) {
+      if (unique_feed_names.find(name) == unique_feed_names.end()) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Missing required input: ", name);
+      }
+    }
+
+    std::vector<MLValue> no_fetches;
+    ORT_RETURN_IF_ERROR(ValidateOutputs(output_names, &no_fetches));
+
+    auto new_info = std::make_unique<FeedsFetchesInfo>(feed_names, output_names);
+    ORT_RETURN_IF_ERROR(new_info->SetMLValueIdxs(session_state_.GetMLValueNameIdxMap()));
+
+    new_info->feed_types.reserve(feed_names.size());
+    for (const auto& name : feed_names) {
+      auto arg = std::find_if(input_def_list_.cbegin(), input_def_list_.cend(),
+                              [&name](const NodeArg* def) { return def->Name() == name; });
+      ORT_ENFORCE(arg != input_def_list_.cend());
+      new_info->feed_types.push_back(utils::GetMLDataType(**arg));
+    }
+
+    new_info->session_state = &session_state_;
+    *info = std::move(new_info);
+    return Status::OK();
+  }
+
+  Status Run(const RunOptions& run_options,
+             const FeedsFetchesInfo& info,
+             const std::vector<MLValue>& feeds,
+             std::vector<MLValue>* p_fetches) {
+    auto tp = session_profiler_.StartTime();
+    // the events of the runs that are not sampled are not recorded, including the ones of the executor
+    profiling::Profiler::RunScope profiler_run_scope{session_profiler_.SampleRun()};
+    Status retval = Status::OK();
+    std::unique_ptr<RunContext> run_context;
 
-      std::vector<MLValue> new_fetches;
-      ORT_CHECK_AND_SET_RETVAL(MatchOutputsWithProviders(output_names, *p_fetches, new_fetches));
+    try {
+      {
+        std::lock_guard<std::mutex> l(session_mutex_);
+        if (!is_inited_) {
+          LOGS(*session_logger_, ERROR) << "Session was not initialized";
+          retval = Status(common::ONNXRUNTIME, common::FAIL, "Session not initialized.");
+        }
+      }
 
-      std::unique_ptr<IExecutor> p_exec;
+      ORT_CHECK_AND_SET_RETVAL(ValidatePreparedRun(info, feeds, p_fetches));
+
+      if (!run_options.run_tag.empty()) {
+        LOGS(*session_logger_, INFO) << "Running with tag: " << run_options.run_tag;
+      }
+
+      ++current_num_runs_;
+
+      std::unique_ptr<logging::Logger> owned_run_logger;
+      auto run_logger = CreateLoggerForRun(run_options, owned_run_logger);
+
+      for (auto& xp : execution_providers_)
+        ORT_CHECK_AND_SET_RETVAL(xp->OnRunStart());
 
       if (retval.IsOK()) {
-        if (session_options_.enable_sequential_execution) {
-          p_exec = std::unique_ptr<IExecutor>(new SequentialExecutor(run_options.terminate));
+        run_context = AcquireRunContext();
+
+        if (cpu_provider_only_) {
+          // everything runs on CPU so the feeds and the user's fetches can be used as is
+          if (p_fetches->empty()) {
+            p_fetches->resize(info.output_names.size());
+          }
+
+          retval = ExecuteGraph(run_options, *run_context, info.feeds_mlvalue_idxs, feeds,
+                                info.fetches_mlvalue_idxs, *p_fetches, run_logger);
         } else {
-          p_exec = std::unique_ptr<IExecutor>(new ParallelExecutor(session_state_, run_options.terminate));
+          std::vector<MLValue>& feed_values = run_context->feed_values;
+          feed_values.resize(feeds.size());
+          for (size_t i = 0; i < feeds.size(); ++i) {
+            ORT_CHECK_AND_SET_RETVAL(IOBinding::CopyOneInputAcrossDevices(session_state_, info.feed_names[i],
+                                                                          feeds[i], feed_values[i]));
+          }
+
+          std::vector<MLValue>& new_fetches = run_context->fetches;
+          ORT_CHECK_AND_SET_RETVAL(MatchOutputsWithProviders(info.output_names, *p_fetches, new_fetches));
+
+          if (retval.IsOK()) {
+            retval = ExecuteGraph(run_options, *run_context, info.feeds_mlvalue_idxs, feed_values,
+                                  info.fetches_mlvalue_idxs, new_fetches, run_logger);
+          }
+
+          ORT_CHECK_AND_SET_RETVAL(CopyOutputsAcrossDevices(new_fetches, *p_fetches));
         }
       }
 
-      ORT_CHECK_AND_SET_RETVAL(p_exec->Execute(session_state_, copied_feeds, output_names, new_fetches, run_logger));
-      ORT_CHECK_AND_SET_RETVAL(CopyOutputsAcrossDevices(new_fetches, *p_fetches));
-
     } catch (const std::exception& e) {
       retval = Status(common::ONNXRUNTIME, common::FAIL, e.what());
     } catch (...) {
       retval = Status(common::ONNXRUNTIME, common::RUNTIME_EXCEPTION, "Encountered unknown exception in Run()");
     }
 
-    // info all execution providers InferenceSession:Run ended
+    if (run_context) {
+      ReleaseRunContext(std::move(run_context));
+    }
+
     for (auto& xp : execution_providers_)
       ORT_CHECK_AND_SET_RETVAL(xp->OnRunEnd());
 
@@ -892,6 +1264,63 @@ class InferenceSession::Impl {
     return !custom_schema_registries_.empty();
   }
 
+  // Whether graph transformers were registered with RegisterGraphTransformer or custom op registries were added.
+  // Either can change the transformed graph in ways the key of the optimized model cache doesn't capture.
+  bool HasCustomGraphOptimizations() const {
+    return has_registered_graph_transformers_ || HasLocalSchema();
+  }
+
+  profiling::ProfilerOptions GetProfilerOptions() const {
+    profiling::ProfilerOptions options;
+    options.sampling_interval = session_options_.profile_sampling_interval;
+    options.max_file_bytes = session_options_.profile_max_file_bytes;
+    options.max_file_seconds = session_options_.profile_max_file_seconds;
+    return options;
+  }
+
+  MemoryPatternCacheOptions GetMemoryPatternCacheOptions() const {
+    MemoryPatternCacheOptions options;
+    options.max_entries = session_options_.mem_pattern_cache_max_entries;
+    options.max_bytes = session_options_.mem_pattern_cache_max_bytes;
+    options.dim_buckets = session_options_.mem_pattern_dim_buckets;
+    return options;
+  }
+
+  // Load the model from the optimized model cache of the session options if it is enabled and matches model_uri.
+  // model is null if the model has to be loaded from model_uri.
+  template <typename T>
+  common::Status LoadFromOptimizedModelCache(const T& model_uri, std::shared_ptr<onnxruntime::Model>& model) {
+    model.reset();
+    if (session_options_.optimized_model_cache_path.empty()) {
+      return Status::OK();
+    }
+
+    if (HasCustomGraphOptimizations()) {
+      LOGS(*session_logger_, WARNING) << "The optimized model cache is not used with custom graph transformers "
+                                      << "or custom op registries.";
+      return Status::OK();
+    }
+
+    ORT_RETURN_IF_ERROR(OptimizedModelCache::ComputeKey(model_uri, session_options_.graph_optimization_level,
+                                                        session_options_.max_num_graph_transformation_steps,
+                                                        optimized_model_cache_key_));
+
+    // a cache that can't be read is rewritten once the model is transformed
+    Status status = OptimizedModelCache::Load(session_options_.optimized_model_cache_path, optimized_model_cache_key_,
+                                              HasLocalSchema() ? &custom_schema_registries_ : nullptr, model);
+    if (!status.IsOK()) {
+      LOGS(*session_logger_, WARNING) << "Failed to load the optimized model cache: " << status.ErrorMessage();
+      model.reset();
+    }
+
+    loaded_from_optimized_model_cache_ = model != nullptr;
+    if (loaded_from_optimized_model_cache_) {
+      LOGS(*session_logger_, INFO) << "Loaded the model from the optimized model cache "
+                                   << session_options_.optimized_model_cache_path;
+    }
+    return Status::OK();
+  }
+
   // assumes model has already been loaded before
   common::Status DoPostLoadProcessing(onnxruntime::Model& model) {
     // TODO add other post load processing here
@@ -1033,6 +1462,10 @@ class InferenceSession::Impl {
 
   ExecutionProviders execution_providers_;
 
+  // true if the CPU execution provider is the only one, in which case no feed or fetch ever needs copying.
+  // set by Initialize.
+  bool cpu_provider_only_ = false;
+
   KernelRegistryManager kernel_registry_manager_;
   std::list<std::shared_ptr<onnxruntime::IOnnxRuntimeOpSchemaCollection>> custom_schema_registries_;
 
@@ -1066,11 +1499,18 @@ class InferenceSession::Impl {
 
   // Threadpool for this session
   //thread::ThreadPool thread_pool_; // not used for now; will add it later when implementing RunAsync
-  std::unique_ptr<TaskThreadPool> thread_pool_;
+  std::unique_ptr<concurrency::ThreadPool> thread_pool_;
+
+  // Threadpool shared by all the kernels of this session for intra-op parallelism
+  std::unique_ptr<concurrency::ThreadPool> intra_op_thread_pool_;
 
   // Number of concurrently running executors
   std::atomic<int> current_num_runs_;
 
+  // Contexts of completed Run calls available for reuse. Declared after session_state_ as the frames refer to it.
+  std::vector<std::unique_ptr<RunContext>> run_contexts_;
+  std::mutex run_contexts_mutex_;
+
   mutable std::mutex session_mutex_;  // to ensure only one thread can invoke Load/Initialize
   bool is_model_loaded_ = false;      // GUARDED_BY(session_mutex_)
   bool is_inited_ = false;            // GUARDED_BY(session_mutex_)
@@ -1078,6 +1518,16 @@ class InferenceSession::Impl {
   std::map<OrtAllocatorInfo, BufferUniquePtr> weights_buffers_;
   InsertCastTransformer insert_cast_transformer_;
 
+  // directory of the model file when loaded from one. empty otherwise.
+  std::string model_dir_;
+
+  // key of the optimized model cache when it is enabled and the model was loaded from a file. empty otherwise.
+  std::string optimized_model_cache_key_;
+  bool loaded_from_optimized_model_cache_ = false;
+
+  // true once a transformer was registered with RegisterGraphTransformer.
+  bool has_registered_graph_transformers_ = false;
+
   // memory allocations for any subgraphs
   std::vector<SubgraphMemory> subgraph_memory_;
 };  // namespace onnxruntime
@@ -1133,6 +1583,18 @@ std::pair<common::Status, const OutputDefList*> InferenceSession::GetModelOutput
   return impl_->GetModelOutputs();
 }
 
+MemoryPatternCacheStats InferenceSession::GetMemoryPatternCacheStats() const {
+  return impl_->GetMemoryPatternCacheStats();
+}
+
+std::vector<NodeStatistics> InferenceSession::GetNodeStatistics() const {
+  return impl_->GetNodeStatistics();
+}
+
+void InferenceSession::ResetNodeStatistics() {
+  impl_->ResetNodeStatistics();
+}
+
 int InferenceSession::GetCurrentNumRuns() {
   return impl_->GetCurrentNumRuns();
 }
@@ -1169,6 +1631,19 @@ common::Status InferenceSession::Load(std::unique_ptr<ModelProto> p_model_proto)
   return impl_->Load(std::move(p_model_proto));
 }
 
+common::Status InferenceSession::PrepareRun(const std::vector<std::string>& feed_names,
+                                            const std::vector<std::string>& output_names,
+                                            std::unique_ptr<FeedsFetchesInfo>* info) const {
+  return impl_->PrepareRun(feed_names, output_names, info);
+}
+
+common::Status InferenceSession::Run(const RunOptions& run_options,
+                                     const FeedsFetchesInfo& info,
+                                     const std::vector<MLValue>& feeds,
+                                     std::vector<MLValue>* p_fetches) {
+  return impl_->Run(run_options, info, feeds, p_fetches);
+}
+
 common::Status InferenceSession::NewIOBinding(std::unique_ptr<IOBinding>* io_binding) {
   return impl_->NewIOBinding(io_binding);
 }
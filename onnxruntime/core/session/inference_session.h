@@ -9,7 +9,10 @@
 #include "core/common/common.h"
 #include "core/common/status.h"
 #include "core/framework/framework_common.h"
+#include "core/framework/mem_pattern_cache.h"
+#include "core/framework/node_statistics.h"
 #include "core/graph/basic_types.h"
+#include "core/graph/graph_transformer_mgr.h"
 #include "core/common/logging/logging.h"
 
 namespace onnxruntime {  // forward declarations
@@ -23,6 +26,7 @@ class ModelProto;
 namespace onnxruntime {
 class IExecutionProvider;  // forward decl
 class IOBinding;
+struct FeedsFetchesInfo;
 
 class CustomRegistry;
 
@@ -40,12 +44,25 @@ struct SessionOptions {
   // enable profiling for this session.
   bool enable_profiling = false;
 
+  // keep per node counters of the kernel calls of the main graph: call count, min/max/total compute time and bytes
+  // read and written. Unlike profiling they are cheap enough to be always on, see InferenceSession::GetNodeStatistics.
+  bool enable_node_statistics = true;
+
   // enable the memory pattern optimization.
   // The idea is if the input shapes are the same, we could trace the internal memory allocation
   // and generate a memory pattern for future request. So next time we could just do one allocation
   // with a big chunk for all the internal memory allocation.
   bool enable_mem_pattern = true;
 
+  // limits of the memory pattern cache. the least recently used patterns are dropped when either is exceeded.
+  // 0 means no limit.
+  size_t mem_pattern_cache_max_entries = 64;
+  size_t mem_pattern_cache_max_bytes = 0;
+
+  // ascending boundaries the input dimensions are rounded up to before looking up a memory pattern, so that inputs
+  // with a variable dimension such as the sequence length share patterns. empty means the shapes must match exactly.
+  std::vector<int64_t> mem_pattern_dim_buckets;
+
   // enable the memory arena on CPU
   // Arena may pre-allocate memory for future usage.
   // set this option to false if you don't want it.
@@ -54,13 +71,45 @@ struct SessionOptions {
   // the prefix of the profile file. The current time will be appended to the file name.
   std::string profile_file_prefix = "onnxruntime_profile_";
 
+  // record the profile events of one in every profile_sampling_interval runs. 1 records every run.
+  uint32_t profile_sampling_interval = 1;
+
+  // start a new profile file once the current one holds profile_max_file_bytes, or was started
+  // profile_max_file_seconds ago. 0 disables the limit.
+  size_t profile_max_file_bytes = 0;
+  uint32_t profile_max_file_seconds = 0;
+
   std::string session_logid;                 ///< logger id to use for session output
   unsigned session_log_verbosity_level = 0;  ///< applies to session load, initialization, etc
 
   unsigned max_num_graph_transformation_steps = 5;  // TODO choose a good default here?
 
+  // release the protobuf representation of the graph once the session is initialized. the initializers are always
+  // released as they are copied into the session state, this also releases the nodes, which include a copy of every
+  // subgraph with its initializers. disable it to keep the nodes of the loaded model in their protobuf form.
+  bool release_graph_proto_after_initialize = true;
+
+  // Level of the built-in graph optimizations applied when the session is initialized, before the transformers
+  // registered with RegisterGraphTransformer. Extended adds fusions into com.microsoft operators that only have
+  // CPU kernels, so the fused nodes run on the CPU even when another execution provider is registered.
+  TransformerLevel graph_optimization_level = TransformerLevel::Basic;
+
+  // Path of a file caching the model loaded from a file after the graph transformers were applied to it, with the
+  // execution provider assigned to each node. If the cache matches the model and the optimization options,
+  // Initialize skips the transformers of the main graph, and its partitioning if the session has the same execution
+  // providers, otherwise the cache is (re)written once the transformers have run. The execution plan, kernels, memory
+  // patterns and initializers are not cached and are always created by Initialize. Empty disables the cache. The
+  // cache is not used by sessions with transformers registered with RegisterGraphTransformer or with custom op
+  // registries.
+  std::string optimized_model_cache_path;
+
   // How many threads in the session thread pool.
   int session_thread_pool_size = 0;
+
+  // How many threads the CPU kernels may use to parallelize a single operator. The threads are shared by all
+  // kernels of the session (MLAS, RNN, element-wise ops). 0 lets onnxruntime choose one per core.
+  // The thread calling Run participates in the work, so a value of 1 runs every kernel single threaded.
+  int intra_op_num_threads = 0;
 };
 
 /**
@@ -196,6 +245,32 @@ class InferenceSession {
                      const std::vector<std::string>& output_names,
                      std::vector<MLValue>* p_fetches);
 
+  /**
+    * Resolve the feed and output names of repeated Run calls to MLValue indices once.
+    * The returned object can be passed to Run(const RunOptions&, const FeedsFetchesInfo&, ...) from any thread
+    * for as long as this session is alive.
+    * @param feed_names names of the inputs that will be fed, in the order the feeds will be passed.
+    * @param output_names names of the outputs to fetch, in the order the fetches will be returned.
+    * @param info receives the resolved indices.
+    * @return OK if success.
+    */
+  common::Status PrepareRun(const std::vector<std::string>& feed_names,
+                            const std::vector<std::string>& output_names,
+                            std::unique_ptr<FeedsFetchesInfo>* info) const;
+
+  /**
+    * Run with feeds and fetches passed by position instead of by name.
+    * Equivalent to Run(const RunOptions&, const NameMLValMap&, const std::vector<std::string>&, std::vector<MLValue>*)
+    * but without any name lookups or map allocations on the calling path.
+    * @param info created by PrepareRun on this session.
+    * @param feeds input values in the order of the feed_names passed to PrepareRun.
+    * @param p_fetches output values in the order of the output_names passed to PrepareRun.
+    */
+  common::Status Run(const RunOptions& run_options,
+                     const FeedsFetchesInfo& info,
+                     const std::vector<MLValue>& feeds,
+                     std::vector<MLValue>* p_fetches);
+
   /**
   * Creates a new binding object for binding inputs and outputs.
   * @param provider_type specifies the location where the inputs need to be potentially copied. 
@@ -206,6 +281,22 @@ class InferenceSession {
   common::Status Run(const RunOptions& run_options, IOBinding& io_binding);
   common::Status Run(IOBinding& io_binding);
 
+  /**
+    * Get the hit, miss and eviction counts of the memory pattern cache of the main graph.
+    */
+  MemoryPatternCacheStats GetMemoryPatternCacheStats() const;
+
+  /**
+    * Get the statistics of the kernel calls of the nodes of the main graph that ran since the session was initialized
+    * or the statistics were reset. Empty if SessionOptions::enable_node_statistics is false.
+    */
+  std::vector<NodeStatistics> GetNodeStatistics() const;
+
+  /**
+    * Zero the statistics of the kernel calls of the nodes of the main graph.
+    */
+  void ResetNodeStatistics();
+
   /**
     * @return pair.first = OK; FAIL otherwise. pair.second is non-NULL when pair.first = OK.
     * @note lifetime of the returned pointer is valid as long as the Session object is live.
@@ -18,6 +18,7 @@
 #include "core/framework/tensor.h"
 #include "core/framework/ml_value.h"
 #include "core/framework/environment.h"
+#include "core/framework/feeds_fetches_info.h"
 #include "core/framework/tensorprotoutils.h"
 #include "core/framework/onnxruntime_typeinfo.h"
 #include "core/framework/onnx_object_cxx.h"
@@ -456,6 +457,87 @@ ORT_API_STATUS_IMPL(OrtRunInference, _In_ OrtSession* sess,
   API_IMPL_END
 }
 
+ORT_API_STATUS_IMPL(OrtCreatePreparedRun, _In_ const OrtSession* sess,
+                    _In_ const char* const* input_names, size_t input_len,
+                    _In_ const char* const* output_names1, size_t output_names_len, _Out_ OrtPreparedRun** out) {
+  API_IMPL_BEGIN
+  auto session = reinterpret_cast<const ::onnxruntime::InferenceSession*>(sess);
+  std::vector<std::string> feed_names(input_len);
+  for (size_t i = 0; i != input_len; ++i) {
+    if (input_names[i] == nullptr || input_names[i][0] == '\0') {
+      return OrtCreateStatus(ORT_INVALID_ARGUMENT, "input name cannot be empty");
+    }
+    feed_names[i] = input_names[i];
+  }
+
+  std::vector<std::string> output_names(output_names_len);
+  for (size_t i = 0; i != output_names_len; ++i) {
+    if (output_names1[i] == nullptr || output_names1[i][0] == '\0') {
+      return OrtCreateStatus(ORT_INVALID_ARGUMENT, "output name cannot be empty");
+    }
+    output_names[i] = output_names1[i];
+  }
+
+  std::unique_ptr<::onnxruntime::FeedsFetchesInfo> info;
+  auto status = session->PrepareRun(feed_names, output_names, &info);
+  if (!status.IsOK())
+    return ToOrtStatus(status);
+  *out = reinterpret_cast<OrtPreparedRun*>(info.release());
+  return nullptr;
+  API_IMPL_END
+}
+
+ORT_API_STATUS_IMPL(OrtRunPrepared, _Inout_ OrtSession* sess,
+                    _In_ OrtRunOptions* run_options, _In_ const OrtPreparedRun* prepared,
+                    _In_ const OrtValue* const* input, size_t input_len,
+                    _Out_ OrtValue** output, size_t output_len) {
+  API_IMPL_BEGIN
+  auto session = reinterpret_cast<::onnxruntime::InferenceSession*>(sess);
+  auto& info = *reinterpret_cast<const ::onnxruntime::FeedsFetchesInfo*>(prepared);
+  if (output_len != info.output_names.size()) {
+    return OrtCreateStatus(ORT_INVALID_ARGUMENT, "output count doesn't match the prepared run");
+  }
+
+  const int queue_id = 0;
+  std::vector<MLValue> feeds(input_len);
+  for (size_t i = 0; i != input_len; ++i) {
+    feeds[i] = *reinterpret_cast<const ::onnxruntime::MLValue*>(input[i]);
+    if (feeds[i].Fence())
+      feeds[i].Fence()->BeforeUsingAsInput(onnxruntime::kCpuExecutionProvider, queue_id);
+  }
+
+  std::vector<MLValue> fetches(output_len);
+  for (size_t i = 0; i != output_len; ++i) {
+    if (output[i] != nullptr) {
+      ::onnxruntime::MLValue& value = *reinterpret_cast<::onnxruntime::MLValue*>(output[i]);
+      if (value.Fence())
+        value.Fence()->BeforeUsingAsOutput(onnxruntime::kCpuExecutionProvider, queue_id);
+      fetches[i] = value;
+    }
+  }
+
+  Status status;
+  if (run_options == nullptr) {
+    OrtRunOptions op;
+    status = session->Run(op, info, feeds, &fetches);
+  } else {
+    status = session->Run(*run_options, info, feeds, &fetches);
+  }
+
+  if (!status.IsOK())
+    return ToOrtStatus(status);
+  for (size_t i = 0; i != output_len; ++i) {
+    ::onnxruntime::MLValue& value = fetches[i];
+    if (value.Fence())
+      value.Fence()->BeforeUsingAsInput(onnxruntime::kCpuExecutionProvider, queue_id);
+    if (output[i] == nullptr) {
+      output[i] = reinterpret_cast<OrtValue*>(new MLValue(value));
+    }
+  }
+  return nullptr;
+  API_IMPL_END
+}
+
 ORT_API_STATUS_IMPL(OrtGetTensorMutableData, _In_ OrtValue* value, _Out_ void** output) {
   TENSOR_READWRITE_API_BEGIN
   //TODO: test if it's a string tensor
@@ -531,6 +613,20 @@ ORT_API_STATUS_IMPL(OrtInferenceSessionGetInputCount, _In_ const OrtSession* ses
   API_IMPL_END
 }
 
+ORT_API_STATUS_IMPL(OrtInferenceSessionGetMemPatternCacheStats, _In_ const OrtSession* sess,
+                    _Out_ OrtMemPatternCacheStats* out) {
+  API_IMPL_BEGIN
+  auto session = reinterpret_cast<const ::onnxruntime::InferenceSession*>(sess);
+  const ::onnxruntime::MemoryPatternCacheStats stats = session->GetMemoryPatternCacheStats();
+  out->hits = stats.hits;
+  out->misses = stats.misses;
+  out->evictions = stats.evictions;
+  out->num_entries = stats.num_entries;
+  out->num_bytes = stats.num_bytes;
+  return nullptr;
+  API_IMPL_END
+}
+
 ORT_API_STATUS_IMPL(OrtInferenceSessionGetOutputCount, _In_ const OrtSession* sess, _Out_ size_t* out) {
   API_IMPL_BEGIN
   auto session = reinterpret_cast<const ::onnxruntime::InferenceSession*>(sess);
@@ -634,6 +730,7 @@ ORT_API_STATUS_IMPL(OrtInferenceSessionGetOutputName, _In_ const OrtSession* ses
 
 DEFINE_RELEASE_ORT_OBJECT_FUNCTION(Value, MLValue)
 DEFINE_RELEASE_ORT_OBJECT_FUNCTION(Session, ::onnxruntime::InferenceSession)
+DEFINE_RELEASE_ORT_OBJECT_FUNCTION(PreparedRun, ::onnxruntime::FeedsFetchesInfo)
 DEFINE_RELEASE_ORT_OBJECT_FUNCTION_FOR_ARRAY(Status, char)
 
 ORT_API(void, OrtReleaseEnv, OrtEnv* env) {
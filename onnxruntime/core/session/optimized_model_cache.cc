@@ -0,0 +1,253 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/session/optimized_model_cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+
+#include "core/framework/execution_providers.h"
+#include "core/platform/env.h"
+
+#ifndef ORT_VERSION_NUMBER
+#define ORT_VERSION_NUMBER "unknown"
+#endif
+
+using namespace ONNX_NAMESPACE;
+using namespace ::onnxruntime::common;
+
+namespace onnxruntime {
+
+namespace {
+// version of the content of the cache. increase it when the way the cache is written or read changes.
+constexpr int kCacheFormatVersion = 2;
+
+// 64-bit FNV-1a of the content of a file, which is fast enough to not matter next to parsing the model
+template <typename T>
+Status HashFile(const T& file_path, uint64_t& hash) {
+  std::ifstream file(file_path, std::ios::binary);
+  if (!file) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, NO_SUCHFILE, "Failed to open the model file to compute its hash.");
+  }
+
+  hash = 14695981039346656037ULL;
+  std::vector<char> buffer(1 << 20);
+  while (file) {
+    file.read(buffer.data(), buffer.size());
+    const auto count = static_cast<size_t>(file.gcount());
+    for (size_t i = 0; i < count; ++i) {
+      hash = (hash ^ static_cast<unsigned char>(buffer[i])) * 1099511628211ULL;
+    }
+  }
+  return Status::OK();
+}
+
+// the types of the execution providers in the order of their priority, which the partition depends on
+std::string GetProviderTypes(const ExecutionProviders& providers) {
+  std::string types;
+  for (const auto& provider : providers) {
+    types += (types.empty() ? "" : ",") + provider->Type();
+  }
+  return types;
+}
+
+// nodes are identified by their first output, as their indices change when the cached graph is loaded
+const std::string* GetNodeId(const Node& node) {
+  for (const auto* output : node.OutputDefs()) {
+    if (output->Exists()) {
+      return &output->Name();
+    }
+  }
+  return nullptr;
+}
+}  // namespace
+
+constexpr const char* OptimizedModelCache::kKeyMetadataName;
+constexpr const char* OptimizedModelCache::kPartitionMetadataName;
+
+template <typename T>
+Status OptimizedModelCache::ComputeKey(const T& model_uri, TransformerLevel level, unsigned steps,
+                                       std::string& key) {
+  uint64_t hash;
+  ORT_RETURN_IF_ERROR(HashFile(model_uri, hash));
+
+  std::ostringstream oss;
+  oss << "format=" << kCacheFormatVersion << ";onnxruntime=" << ORT_VERSION_NUMBER
+      << ";level=" << static_cast<int>(level) << ";steps=" << steps
+      << ";model_fnv1a=" << std::hex << std::setw(16) << std::setfill('0') << hash;
+  key = oss.str();
+  return Status::OK();
+}
+
+template Status OptimizedModelCache::ComputeKey<std::string>(const std::string&, TransformerLevel, unsigned,
+                                                             std::string&);
+#ifdef _WIN32
+template Status OptimizedModelCache::ComputeKey<std::wstring>(const std::wstring&, TransformerLevel, unsigned,
+                                                              std::string&);
+#endif
+
+Status OptimizedModelCache::Load(const std::string& cache_path, const std::string& key,
+                                 const IOnnxRuntimeOpSchemaRegistryList* local_registries,
+                                 std::shared_ptr<Model>& model) {
+  model.reset();
+
+  int fd;
+  if (!Env::Default().FileOpenRd(cache_path, fd).IsOK()) {
+    // nothing cached yet
+    return Status::OK();
+  }
+
+  // check the key before the graph is created and resolved
+  auto model_proto = std::make_unique<ModelProto>();
+  bool parsed;
+  {
+    google::protobuf::io::FileInputStream raw_input(fd);
+    google::protobuf::io::CodedInputStream coded_input(&raw_input);
+    // Allows protobuf library versions < 3.2.0 to parse messages greater than 64MB.
+    coded_input.SetTotalBytesLimit(INT_MAX, INT_MAX);
+    parsed = model_proto->ParseFromCodedStream(&coded_input);
+  }
+  ORT_RETURN_IF_ERROR(Env::Default().FileClose(fd));
+  if (!parsed) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_PROTOBUF, "Failed to parse the optimized model cache ", cache_path);
+  }
+
+  const auto& metadata = model_proto->metadata_props();
+  const bool key_matches = std::any_of(metadata.cbegin(), metadata.cend(), [&key](const StringStringEntryProto& entry) {
+    return entry.key() == kKeyMetadataName && entry.value() == key;
+  });
+  if (!key_matches) {
+    return Status::OK();
+  }
+
+  return Model::Load(std::move(model_proto), model, local_registries);
+}
+
+// The partition is a line with the types of the execution providers, then a line with the index of the execution
+// provider of each node, or -1 if the node wasn't assigned, followed by a space and the id of the node.
+void OptimizedModelCache::SetPartition(ModelProto& model_proto, const Graph& graph,
+                                       const ExecutionProviders& providers) {
+  auto* metadata = model_proto.mutable_metadata_props();
+  metadata->erase(std::remove_if(metadata->begin(), metadata->end(),
+                                 [](const StringStringEntryProto& entry) {
+                                   return entry.key() == kPartitionMetadataName;
+                                 }),
+                  metadata->end());
+
+  std::unordered_map<std::string, int> provider_indices;
+  for (const auto& provider : providers) {
+    provider_indices.emplace(provider->Type(), static_cast<int>(provider_indices.size()));
+  }
+
+  std::ostringstream partition;
+  partition << GetProviderTypes(providers) << '\n';
+  for (const auto& node : graph.Nodes()) {
+    const std::string* id = GetNodeId(node);
+    if (id == nullptr || node.NodeType() == Node::Type::Fused) {
+      return;
+    }
+
+    const auto& provider_type = node.GetExecutionProviderType();
+    partition << (provider_type.empty() ? -1 : provider_indices.at(provider_type)) << ' ' << *id << '\n';
+  }
+
+  auto* entry = metadata->Add();
+  entry->set_key(kPartitionMetadataName);
+  entry->set_value(partition.str());
+}
+
+bool OptimizedModelCache::ApplyPartition(const Model& model, Graph& graph, const ExecutionProviders& providers) {
+  const auto& metadata = model.MetaData();
+  const auto entry = metadata.find(kPartitionMetadataName);
+  if (entry == metadata.cend()) {
+    return false;
+  }
+
+  std::istringstream partition(entry->second);
+  std::string line;
+  if (!std::getline(partition, line) || line != GetProviderTypes(providers)) {
+    return false;
+  }
+
+  std::vector<std::string> provider_types;
+  for (const auto& provider : providers) {
+    provider_types.push_back(provider->Type());
+  }
+
+  std::unordered_map<std::string, int> assignments;
+  while (std::getline(partition, line)) {
+    std::istringstream assignment(line);
+    int provider_index;
+    if (!(assignment >> provider_index) || assignment.get() != ' ' || provider_index < -1 ||
+        provider_index >= static_cast<int>(provider_types.size())) {
+      return false;
+    }
+    std::string id;
+    std::getline(assignment, id);
+    assignments.emplace(std::move(id), provider_index);
+  }
+
+  // check that every node is in the partition before assigning any
+  if (assignments.size() != static_cast<size_t>(graph.NumberOfNodes())) {
+    return false;
+  }
+  for (const auto& node : graph.Nodes()) {
+    const std::string* id = GetNodeId(node);
+    if (id == nullptr || assignments.count(*id) == 0) {
+      return false;
+    }
+  }
+
+  for (auto& node : graph.Nodes()) {
+    const int provider_index = assignments[*GetNodeId(node)];
+    if (provider_index >= 0) {
+      node.SetExecutionProviderType(provider_types[provider_index]);
+    }
+  }
+  return true;
+}
+
+Status OptimizedModelCache::Save(ModelProto& model_proto, const std::string& cache_path, const std::string& key) {
+  auto* metadata = model_proto.mutable_metadata_props();
+  metadata->erase(std::remove_if(metadata->begin(), metadata->end(),
+                                 [](const StringStringEntryProto& entry) { return entry.key() == kKeyMetadataName; }),
+                  metadata->end());
+  auto* key_entry = model_proto.add_metadata_props();
+  key_entry->set_key(kKeyMetadataName);
+  key_entry->set_value(key);
+
+  // the counter keeps the temporary names of sessions saving concurrently in the same process apart
+  static std::atomic<uint64_t> save_count{0};
+  const std::string temp_path = cache_path + "." + std::to_string(Env::Default().GetSelfPid()) + "." +
+                                std::to_string(save_count++) + ".tmp";
+  int fd;
+  ORT_RETURN_IF_ERROR(Env::Default().FileOpenWr(temp_path, fd));
+  const bool written = model_proto.SerializeToFileDescriptor(fd);
+  Status status = Env::Default().FileClose(fd);
+  if (!written || !status.IsOK()) {
+    std::remove(temp_path.c_str());
+    return written ? status : ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Failed to write ", temp_path);
+  }
+
+#ifdef _WIN32
+  // rename doesn't replace an existing file on Windows, e.g. a cache with another key
+  std::remove(cache_path.c_str());
+#endif
+  if (std::rename(temp_path.c_str(), cache_path.c_str()) != 0) {
+    std::remove(temp_path.c_str());
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Failed to move the optimized model cache to ", cache_path);
+  }
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,70 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "core/common/common.h"
+#include "core/common/status.h"
+#include "core/graph/graph_transformer_mgr.h"
+#include "core/graph/model.h"
+
+namespace onnxruntime {
+class ExecutionProviders;
+
+/**
+@class OptimizedModelCache
+A cache of a model after the graph transformers of a session were applied to its main graph and the main graph was
+partitioned, so that sessions created later for the same model skip Resolve of the original model, the transformers
+and the partitioner. The cache is an ONNX model holding the transformed graph and its initializers, e.g. the ones
+computed by constant folding, with the execution provider assigned to each node stored in its metadata.
+
+The partition is only used by sessions with the same execution providers, in the same order, as the session that
+saved the cache. Other sessions use the transformed graph and partition it. Graphs with nodes fused by an execution
+provider, e.g. a compiled subgraph, are cached without their partition.
+
+The kernels, the execution plan, the memory patterns and the initializers placed by the session state are not
+cached. They hold allocations and objects of the execution providers of the session, so they are created when the
+session is initialized. Subgraphs are transformed and partitioned when the session is initialized too.
+
+A cache is only used if its key matches the one of the session: a hash of the content of the original model file,
+the graph optimization level and steps, and the versions of onnxruntime and of the cache format. Transformers registered
+with InferenceSession::RegisterGraphTransformer and custom op registries are not part of the key, so sessions using
+them don't use the cache.
+*/
+class OptimizedModelCache {
+ public:
+  // metadata_props entry the key is stored in
+  static constexpr const char* kKeyMetadataName = "onnxruntime.optimized_model_cache.key";
+
+  // metadata_props entry the partition of the main graph is stored in
+  static constexpr const char* kPartitionMetadataName = "onnxruntime.optimized_model_cache.partition";
+
+  // Compute the key of the cache for the model file at model_uri, transformed at level for up to steps steps.
+  template <typename T>
+  static common::Status ComputeKey(const T& model_uri, TransformerLevel level, unsigned steps, std::string& key);
+
+  // Load the cache at cache_path if it exists and was saved with key. model is null if there is no such cache.
+  static common::Status Load(const std::string& cache_path, const std::string& key,
+                             const IOnnxRuntimeOpSchemaRegistryList* local_registries,
+                             std::shared_ptr<Model>& model);
+
+  // Record in model_proto, the cache of a model whose main graph is graph, the execution provider each node of graph
+  // was assigned to by partitioning it for providers. Nothing is recorded if partitioning fused nodes.
+  static void SetPartition(ONNX_NAMESPACE::ModelProto& model_proto, const Graph& graph,
+                           const ExecutionProviders& providers);
+
+  // Assign the nodes of graph, the main graph of model loaded from a cache, to the execution providers recorded by
+  // SetPartition. Returns false and leaves graph alone if the cache has no partition, if it was recorded for other
+  // execution providers, or if it doesn't match the nodes of graph, in which case graph has to be partitioned.
+  static bool ApplyPartition(const Model& model, Graph& graph, const ExecutionProviders& providers);
+
+  // Save model_proto, a model whose main graph was transformed, to cache_path. The file is written under a temporary
+  // name and then renamed so that sessions loading the cache concurrently never see it partially written.
+  static common::Status Save(ONNX_NAMESPACE::ModelProto& model_proto, const std::string& cache_path,
+                             const std::string& key);
+};
+
+}  // namespace onnxruntime
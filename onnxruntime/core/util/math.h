@@ -40,6 +40,9 @@ extern "C" {
 #include "core/framework/tensor.h"
 
 namespace onnxruntime {
+namespace concurrency {
+class ThreadPool;
+}
 
 enum StorageOrder {
   UNKNOWN = 0,
@@ -190,6 +193,8 @@ void Gemm(
     const float beta,
     T* C,
     Provider* provider,
+    // Intra-op thread pool used to parallelize the operation. nullptr runs it with the BLAS library's own threading.
+    concurrency::ThreadPool* threadpool = nullptr,
     //Caffe2 use this type to control on GPU, what presicion do we want to do the calculation
     //But not sure is this a good design for us. Keep it here for now.
     MLDataType math_type = FLOAT_TYPE);
@@ -211,7 +216,8 @@ void GemmEx(
     const T beta,
     T* C,
     const int ldc,
-    Provider* provider);
+    Provider* provider,
+    concurrency::ThreadPool* threadpool = nullptr);
 
 // GemmBatched provides a simple abstraction into library routines
 template <typename T, class Provider>
@@ -88,8 +88,10 @@ void Gemm<float, CPUMathUtil>(
     const float beta,
     float* C,
     CPUMathUtil* /*provider*/,
+    concurrency::ThreadPool* threadpool,
     MLDataType /*math_type*/) {
 #if defined(USE_MKLDNN)
+  ORT_UNUSED_PARAMETER(threadpool);
   int lda = (int)((TransA == CblasTrans) ? M : K);
   int ldb = (int)((TransB == CblasTrans) ? K : N);
   int M_ = (int)M;
@@ -108,8 +110,9 @@ void Gemm<float, CPUMathUtil>(
 #elif defined(USE_MLAS)
   int lda = (int)((TransA == CblasNoTrans) ? K : M);
   int ldb = (int)((TransB == CblasNoTrans) ? N : K);
-  MlasSgemm(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, N);
+  MlasSgemm(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, N, threadpool);
 #else
+  ORT_UNUSED_PARAMETER(threadpool);
   auto C_mat = EigenMatrixMap<float>(C, N, M);
   if (beta == 0) {
     C_mat.setZero();
@@ -166,8 +169,10 @@ void GemmEx<float, CPUMathUtil>(
     const float beta,
     float* C,
     const int ldc,
-    CPUMathUtil*) {
+    CPUMathUtil*,
+    concurrency::ThreadPool* threadpool) {
 #if defined(USE_MKLDNN)
+  ORT_UNUSED_PARAMETER(threadpool);
   // mkldnn_sgemm expects col major matrices, so we need to swap the operands A and B
   auto status = mkldnn_sgemm(TransB == CblasNoTrans ? "N" : "T",
                              TransA == CblasNoTrans ? "N" : "T",
@@ -179,8 +184,9 @@ void GemmEx<float, CPUMathUtil>(
     ORT_THROW("mkldnn_sgemm failed with status: ", status);
   }
 #elif defined(USE_MLAS)
-  MlasSgemm(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+  MlasSgemm(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc, threadpool);
 #else
+  ORT_UNUSED_PARAMETER(threadpool);
   using OuterStride = Eigen::OuterStride<Eigen::Dynamic>;
   using StridedMap = Eigen::Map<Eigen::MatrixXf, 0, OuterStride>;
   using ConstStridedMap = Eigen::Map<const Eigen::MatrixXf, 0, OuterStride>;
@@ -332,6 +338,7 @@ void Gemm<float, CPUMathUtil>(
     const float beta,
     float* C,
     CPUMathUtil* /*context*/,
+    concurrency::ThreadPool* /*threadpool*/,
     MLDataType /*math_type*/) {
   int lda = gsl::narrow_cast<int>((TransA == CblasNoTrans) ? K : M);
   int ldb = gsl::narrow_cast<int>((TransB == CblasNoTrans) ? N : K);
@@ -358,7 +365,8 @@ void GemmEx<float, CPUMathUtil>(
     const float beta,
     float* C,
     const int ldc,
-    CPUMathUtil* /*context*/) {
+    CPUMathUtil* /*context*/,
+    concurrency::ThreadPool* /*threadpool*/) {
   cblas_sgemm(CblasRowMajor, TransA, TransB, M, N, K, alpha, A, lda, B, ldb,
               beta, C, ldc);
 }
@@ -230,6 +230,11 @@ void addGlobalMethods(py::module& m) {
 void addObjectMethods(py::module& m) {
   // allow unit tests to redirect std::cout and std::cerr to sys.stdout and sys.stderr
   py::add_ostream_redirect(m, "onnxruntime_ostream_redirect");
+  py::enum_<TransformerLevel>(m, "GraphOptimizationLevel", R"pbdoc(Levels of the built-in graph optimizations.)pbdoc")
+      .value("ORT_DISABLE_ALL", TransformerLevel::None)
+      .value("ORT_ENABLE_BASIC", TransformerLevel::Basic)
+      .value("ORT_ENABLE_EXTENDED", TransformerLevel::Extended);
+
   py::class_<SessionOptions>(m, "SessionOptions", R"pbdoc(Configuration information for a session.)pbdoc")
       .def(py::init())
       .def_readwrite("enable_mem_pattern", &SessionOptions::enable_mem_pattern,
@@ -237,11 +242,33 @@ void addObjectMethods(py::module& m) {
 The idea is if the input shapes are the same, we could trace the internal memory allocation
 and generate a memory pattern for future request. So next time we could just do one allocation
 with a big chunk for all the internal memory allocation. Default is true.)pbdoc")
+      .def_readwrite("mem_pattern_cache_max_entries", &SessionOptions::mem_pattern_cache_max_entries,
+                     R"pbdoc(Maximum number of memory patterns cached by the session. The least recently used pattern is
+dropped when it is exceeded. Default is 64, 0 for no limit.)pbdoc")
+      .def_readwrite("mem_pattern_cache_max_bytes", &SessionOptions::mem_pattern_cache_max_bytes,
+                     R"pbdoc(Maximum approximate memory used by the cached memory patterns, counting the
+buffer each pattern allocates. Default is 0 for no limit.)pbdoc")
+      .def_readwrite("mem_pattern_dim_buckets", &SessionOptions::mem_pattern_dim_buckets,
+                     R"pbdoc(Ascending boundaries the input dimensions are rounded up to before looking up a memory pattern,
+so that inputs with a variable dimension such as the sequence length share patterns.
+Default is empty, the shapes must match exactly.)pbdoc")
       .def_readwrite("enable_cpu_mem_arena", &SessionOptions::enable_cpu_mem_arena,
                      R"pbdoc(Enables the memory arena on CPU. Arena may pre-allocate memory for future usage.
 Set this option to false if you don't want it. Default is True.)pbdoc")
       .def_readwrite("enable_profiling", &SessionOptions::enable_profiling,
                      R"pbdoc(Enable profiling for this session. Default is false.)pbdoc")
+      .def_readwrite("profile_sampling_interval", &SessionOptions::profile_sampling_interval,
+                     R"pbdoc(Record the profile events of one in every *profile_sampling_interval* runs.
+Default is 1 to record every run.)pbdoc")
+      .def_readwrite("profile_max_file_bytes", &SessionOptions::profile_max_file_bytes,
+                     R"pbdoc(Start a new profile file once the current one holds this many bytes.
+Default is 0 for no limit.)pbdoc")
+      .def_readwrite("profile_max_file_seconds", &SessionOptions::profile_max_file_seconds,
+                     R"pbdoc(Start a new profile file once the current one was started this many seconds ago.
+Default is 0 for no limit.)pbdoc")
+      .def_readwrite("enable_node_statistics", &SessionOptions::enable_node_statistics,
+                     R"pbdoc(Keep per node counters of the kernel calls, see *InferenceSession.get_node_statistics*.
+They are cheap enough to be always on. Default is true.)pbdoc")
       .def_readwrite("enable_sequential_execution", &SessionOptions::enable_sequential_execution,
                      R"pbdoc(Enables sequential execution, disables parallel execution. Default is true.)pbdoc")
       .def_readwrite("max_num_graph_transformation_steps", &SessionOptions::max_num_graph_transformation_steps,
@@ -252,7 +279,17 @@ Set this option to false if you don't want it. Default is True.)pbdoc")
                      R"pbdoc(Applies to session load, initialization, etc. Default is 0.)pbdoc")
       .def_readwrite("session_thread_pool_size", &SessionOptions::session_thread_pool_size,
                      R"pbdoc(How many threads in the session thread pool. Default is 0 to let onnxruntime choose.
-This parameter is unused unless *enable_sequential_execution* is false.)pbdoc");
+This parameter is unused unless *enable_sequential_execution* is false.)pbdoc")
+      .def_readwrite("intra_op_num_threads", &SessionOptions::intra_op_num_threads,
+                     R"pbdoc(How many threads the CPU kernels use to parallelize a single operator, including the calling thread.
+The threads are shared by all the kernels of the session. Default is 0 to let onnxruntime choose.)pbdoc")
+      .def_readwrite("graph_optimization_level", &SessionOptions::graph_optimization_level,
+                     R"pbdoc(Level of the built-in graph optimizations applied when the session is initialized.
+*ORT_ENABLE_EXTENDED* adds fusions into operators that only have CPU kernels. Default is *ORT_ENABLE_BASIC*.)pbdoc")
+      .def_readwrite("optimized_model_cache_path", &SessionOptions::optimized_model_cache_path,
+                     R"pbdoc(Path of a file caching the model after the graph optimizations, and the execution provider
+assigned to each node, so that sessions created later for the same model file skip them. The execution plan, kernels
+and initializers are created by every session. Default is empty to disable the cache.)pbdoc");
 
   py::class_<RunOptions>(m, "RunOptions", R"pbdoc(Configuration information for a single Run.)pbdoc")
       .def(py::init())
@@ -274,6 +311,25 @@ facilitate the comparison.)pbdoc")
       .def_readwrite("version", &ModelMetadata::version, "version of the model")
       .def_readwrite("custom_metadata_map", &ModelMetadata::custom_metadata_map, "additional metadata");
 
+  py::class_<NodeStatistics>(m, "NodeStatistics", R"pbdoc(Statistics of the kernel calls of a node.)pbdoc")
+      .def_readonly("node_name", &NodeStatistics::node_name, "node name")
+      .def_readonly("op_type", &NodeStatistics::op_type, "operator type")
+      .def_readonly("call_count", &NodeStatistics::call_count, "number of calls")
+      .def_readonly("total_time_ns", &NodeStatistics::total_time_ns, "total compute time in nanoseconds")
+      .def_readonly("min_time_ns", &NodeStatistics::min_time_ns, "minimum compute time in nanoseconds")
+      .def_readonly("max_time_ns", &NodeStatistics::max_time_ns, "maximum compute time in nanoseconds")
+      .def_readonly("input_bytes", &NodeStatistics::input_bytes, "total size of the input tensors")
+      .def_readonly("output_bytes", &NodeStatistics::output_bytes, "total size of the output tensors");
+
+  py::class_<MemoryPatternCacheStats>(m, "MemoryPatternCacheStats",
+                                      R"pbdoc(Counters of the memory pattern cache of a session.)pbdoc")
+      .def_readonly("hits", &MemoryPatternCacheStats::hits, "runs that found a pattern for their input shapes")
+      .def_readonly("misses", &MemoryPatternCacheStats::misses, "runs that had to trace a pattern")
+      .def_readonly("evictions", &MemoryPatternCacheStats::evictions, "patterns dropped to stay within the limits")
+      .def_readonly("num_entries", &MemoryPatternCacheStats::num_entries, "patterns currently cached")
+      .def_readonly("num_bytes", &MemoryPatternCacheStats::num_bytes,
+                    "approximate host memory used by the cached patterns");
+
   py::class_<onnxruntime::NodeArg>(m, "NodeArg", R"pbdoc(Node argument definition, for both input and output,
 including arg name, arg type (contains both type and shape).)pbdoc")
       .def_property_readonly("name", &onnxruntime::NodeArg::Name, "node name")
@@ -401,6 +457,15 @@ including arg name, arg type (contains both type and shape).)pbdoc")
       .def("end_profiling", [](InferenceSession* sess) -> std::string {
         return sess->EndProfiling();
       })
+      .def("get_node_statistics", [](const InferenceSession* sess) -> std::vector<NodeStatistics> {
+        return sess->GetNodeStatistics();
+      })
+      .def("reset_node_statistics", [](InferenceSession* sess) {
+        sess->ResetNodeStatistics();
+      })
+      .def("get_mem_pattern_cache_stats", [](const InferenceSession* sess) -> MemoryPatternCacheStats {
+        return sess->GetMemoryPatternCacheStats();
+      })
       .def_property_readonly("inputs_meta", [](const InferenceSession* sess) -> const std::vector<const onnxruntime::NodeArg*>& {
         auto res = sess->GetModelInputs();
         if (!res.first.IsOK()) {
@@ -79,3 +79,27 @@ class InferenceSession:
         :meth:`onnxruntime.SessionOptions.enable_profiling`.
         """
         return self._sess.end_profiling()
+
+    def get_node_statistics(self):
+        """
+        Return the statistics of the kernel calls of the nodes that ran since the session
+        was created or :meth:`reset_node_statistics` was called: call count, compute times
+        and bytes read and written. They are kept unless
+        :meth:`onnxruntime.SessionOptions.enable_node_statistics` is false.
+        """
+        return self._sess.get_node_statistics()
+
+    def reset_node_statistics(self):
+        """
+        Zero the statistics returned by :meth:`get_node_statistics`.
+        """
+        self._sess.reset_node_statistics()
+
+    def get_mem_pattern_cache_stats(self):
+        """
+        Return the counters of the memory pattern cache of the session: hits, misses,
+        evictions and the number and approximate size of the cached patterns. The cache
+        is bounded by :meth:`onnxruntime.SessionOptions.mem_pattern_cache_max_entries`
+        and :meth:`onnxruntime.SessionOptions.mem_pattern_cache_max_bytes`.
+        """
+        return self._sess.get_mem_pattern_cache_stats()
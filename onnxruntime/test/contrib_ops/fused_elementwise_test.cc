@@ -0,0 +1,62 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "test/providers/provider_test_utils.h"
+
+namespace onnxruntime {
+namespace test {
+
+TEST(FusedElementwiseTest, BroadcastOperands) {
+  // Relu(1 - X * scale) / X, with a scale per row
+  OpTester test("FusedElementwise", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("ops", std::vector<std::string>{"Mul", "Sub", "Relu", "Div"});
+  test.AddAttribute("operands", std::vector<int64_t>{1, 2, -1, 0});
+  test.AddAttribute("operand_first", std::vector<int64_t>{0, 1, 0, 0});
+
+  test.AddInput<float>("X", {2, 3, 2}, {1.0f, 2.0f, 0.5f, 0.25f, 4.0f, 8.0f,
+                                        -1.0f, -2.0f, 0.1f, 0.2f, 1.0f, 0.5f});
+  test.AddInput<float>("scale", {3, 1}, {0.5f, 2.0f, 0.125f});
+  test.AddInput<float>("one", {1}, {1.0f});
+  test.AddOutput<float>("Y", {2, 3, 2}, {0.5f, 0.0f, 0.0f, 2.0f, 0.125f, 0.0f,
+                                         -1.5f, -1.0f, 8.0f, 3.0f, 0.875f, 1.875f});
+  test.Run();
+}
+
+TEST(FusedElementwiseTest, LargeChain) {
+  // Sigmoid(X * scale + bias) * X, large enough to be split into tiles and across threads
+  const int64_t N = 4, C = 16, H = 33, W = 65;
+  std::vector<float> X(N * C * H * W);
+  for (size_t i = 0; i < X.size(); ++i) {
+    X[i] = static_cast<float>(static_cast<int64_t>(i % 200) - 100) / 25.0f;
+  }
+  std::vector<float> scale(C);
+  for (int64_t c = 0; c < C; ++c) {
+    scale[c] = 0.25f + 0.125f * static_cast<float>(c);
+  }
+  std::vector<float> bias(W);
+  for (int64_t w = 0; w < W; ++w) {
+    bias[w] = static_cast<float>(w - W / 2) / 16.0f;
+  }
+
+  std::vector<float> Y(X.size());
+  for (int64_t n = 0, i = 0; n < N; ++n)
+    for (int64_t c = 0; c < C; ++c)
+      for (int64_t h = 0; h < H; ++h)
+        for (int64_t w = 0; w < W; ++w, ++i)
+          Y[i] = X[i] / (1.0f + std::exp(-(X[i] * scale[c] + bias[w])));
+
+  OpTester test("FusedElementwise", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("ops", std::vector<std::string>{"Mul", "Add", "Sigmoid", "Mul"});
+  test.AddAttribute("operands", std::vector<int64_t>{1, 2, -1, 0});
+  test.AddInput<float>("X", {N, C, H, W}, X);
+  test.AddInput<float>("scale", {C, 1, 1}, scale);
+  test.AddInput<float>("bias", {W}, bias);
+  test.AddOutput<float>("Y", {N, C, H, W}, Y);
+  test.Run();
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -261,5 +261,53 @@ TEST(ExecutionFrameTest, MemPatternTest) {
   EXPECT_EQ(p->GetBlock(3)->offset_, 0);
   EXPECT_EQ(p->GetBlock(4)->offset_, sizeof(float) * 4);
 }
+
+TEST(ExecutionFrameTest, ResetAndClearTest) {
+  onnxruntime::Model model("test");
+  onnxruntime::Graph& graph = model.MainGraph();
+  TypeProto tensor_float;
+  tensor_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  onnxruntime::NodeArg input_def("X", &tensor_float), output_def("Y", &tensor_float);
+
+  graph.AddNode("node1", "Clip", "Clip operator", ArgMap{&input_def}, ArgMap{&output_def});
+  graph.Resolve();
+
+  auto cpu_xp = CreateCPUExecutionProvider();
+  auto xp_typ = cpu_xp->Type();
+  ExecutionProviders execution_providers;
+  execution_providers.Add(xp_typ, std::move(cpu_xp));
+
+  SessionState state{execution_providers};
+  state.SetGraphViewer(std::make_unique<GraphViewer>(graph));
+
+  MLValueNameIdxMap& mlvalue_name_idx_map{state.GetMLValueNameIdxMap()};
+  mlvalue_name_idx_map.Add("X");
+  mlvalue_name_idx_map.Add("Y");
+
+  auto cpu_allocator = execution_providers.Get(xp_typ)->GetAllocator(0, OrtMemTypeDefault);
+
+  int x_idx;
+  ASSERT_TRUE(mlvalue_name_idx_map.GetIdx("X", x_idx).IsOK());
+
+  // the frame is created once and then reused with different feeds
+  ExecutionFrame frame(state);
+  vector<MLValue> outputs;
+
+  for (float feed_value : {1.0f, 2.0f}) {
+    MLValue value;
+    CreateMLValue<float>(cpu_allocator, std::vector<int64_t>{3, 2}, std::vector<float>(6, feed_value), &value);
+
+    frame.Reset(std::vector<int>{x_idx}, std::vector<MLValue>{value}, std::vector<int>{}, outputs);
+
+    const MLValue* p_ml_value = frame.GetNodeInputOrOutputMLValue(0);
+    ASSERT_TRUE(p_ml_value != nullptr && p_ml_value->IsAllocated());
+    EXPECT_EQ(p_ml_value->Get<Tensor>().Data<float>(), value.Get<Tensor>().Data<float>());
+    EXPECT_FALSE(frame.GetNodeInputOrOutputMLValue(1)->IsAllocated());
+
+    // the frame must not keep the feed alive once cleared
+    frame.Clear();
+    EXPECT_FALSE(frame.GetNodeInputOrOutputMLValue(0)->IsAllocated());
+  }
+}
 }  // namespace test
 }  // namespace onnxruntime
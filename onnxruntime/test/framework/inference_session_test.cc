@@ -4,6 +4,7 @@
 #include "core/session/inference_session.h"
 
 #include <algorithm>
+#include <cstdio>
 #include <functional>
 #include <iterator>
 #include <thread>
@@ -12,9 +13,12 @@
 #include "core/common/logging/logging.h"
 #include "core/common/profiler.h"
 #include "core/framework/execution_provider.h"
+#include "core/framework/execution_providers.h"
+#include "core/framework/feeds_fetches_info.h"
 #include "core/framework/kernel_registry.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/session_state.h"
+#include "core/graph/graph_transformer.h"
 #include "core/graph/graph_viewer.h"
 #include "core/framework/compute_capability.h"
 #include "core/graph/model.h"
@@ -23,11 +27,20 @@
 #include "core/providers/cpu/math/element_wise_ops.h"
 #include "core/framework/tensorprotoutils.h"
 #include "core/session/IOBinding.h"
+#include "core/session/optimized_model_cache.h"
 #include "test/capturing_sink.h"
 #include "test/test_environment.h"
 #include "test/providers/provider_test_utils.h"
 #include "test_utils.h"
 #include "gtest/gtest.h"
+#ifdef _WIN32
+#include <direct.h>
+#define mkdir(path, mode) _mkdir(path)
+#define rmdir _rmdir
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 using namespace ONNX_NAMESPACE;
@@ -324,6 +337,245 @@ TEST(InferenceSessionTests, DisableCPUArena) {
   RunModel(session_object, run_options);
 }
 
+TEST(InferenceSessionTests, IntraOpNumThreads) {
+  // 1 runs all the kernels on the calling thread
+  for (int intra_op_num_threads : {1, 4}) {
+    SessionOptions so;
+
+    so.session_logid = "InferenceSessionTests.IntraOpNumThreads";
+    so.intra_op_num_threads = intra_op_num_threads;
+
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+    ASSERT_TRUE(session_object.Initialize().IsOK());
+
+    RunOptions run_options;
+    run_options.run_tag = "one session/one tag";
+    RunModel(session_object, run_options);
+  }
+}
+
+static void ReadOptimizedModelCache(const std::string& cache_path, ModelProto& cached_model) {
+  std::ifstream cache_file(cache_path, ios::in | ios::binary);
+  ASSERT_TRUE(cached_model.ParseFromIstream(&cache_file));
+}
+
+static std::string GetOptimizedModelCacheKey(const ModelProto& cached_model) {
+  for (const auto& entry : cached_model.metadata_props()) {
+    if (entry.key() == "onnxruntime.optimized_model_cache.key") {
+      return entry.value();
+    }
+  }
+  return "";
+}
+
+static bool HasMetadata(const ModelProto& model, const std::string& key) {
+  return std::any_of(model.metadata_props().cbegin(), model.metadata_props().cend(),
+                     [&key](const StringStringEntryProto& entry) { return entry.key() == key; });
+}
+
+TEST(InferenceSessionTests, OptimizedModelCache) {
+  const std::string cache_path = "InferenceSessionTests.OptimizedModelCache.onnx";
+  std::remove(cache_path.c_str());
+
+  // the first session writes the cache
+  {
+    SessionOptions so;
+
+    so.session_logid = "InferenceSessionTests.OptimizedModelCache";
+    so.optimized_model_cache_path = cache_path;
+
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+    ASSERT_TRUE(session_object.Initialize().IsOK());
+    ASSERT_TRUE(std::ifstream(cache_path).good());
+
+    RunOptions run_options;
+    run_options.run_tag = "one session/one tag";
+    RunModel(session_object, run_options);
+  }
+
+  // mark the cached model so that a session that loads it from the cache can be told apart from one that loads
+  // the original model, and a rewrite of the cache can be detected
+  ModelProto cached_model;
+  ReadOptimizedModelCache(cache_path, cached_model);
+  const std::string basic_key = GetOptimizedModelCacheKey(cached_model);
+  ASSERT_NE(basic_key.find("level=1"), std::string::npos);
+  auto* marker = cached_model.add_metadata_props();
+  marker->set_key("test.from_cache");
+  marker->set_value("1");
+  {
+    std::ofstream cache_file(cache_path, ios::out | ios::binary | ios::trunc);
+    ASSERT_TRUE(cached_model.SerializeToOstream(&cache_file));
+  }
+
+  // the second session loads the model from the cache and leaves the cache alone
+  {
+    SessionOptions so;
+    so.optimized_model_cache_path = cache_path;
+
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+    ASSERT_TRUE(session_object.Initialize().IsOK());
+
+    // the key of the cache is not part of the metadata of the model
+    auto metadata = session_object.GetModelMetadata();
+    ASSERT_TRUE(metadata.first.IsOK());
+    ASSERT_EQ(metadata.second->custom_metadata_map.count("onnxruntime.optimized_model_cache.key"), 0u);
+    ASSERT_EQ(metadata.second->custom_metadata_map.count("test.from_cache"), 1u);
+
+    RunOptions run_options;
+    RunModel(session_object, run_options);
+  }
+  ReadOptimizedModelCache(cache_path, cached_model);
+  ASSERT_TRUE(HasMetadata(cached_model, "test.from_cache"));
+
+  // a session with a registered transformer neither loads nor writes the cache
+  {
+    SessionOptions so;
+    so.optimized_model_cache_path = cache_path;
+
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    ASSERT_TRUE(session_object.RegisterGraphTransformer(
+                                  std::make_unique<TopDownRuleBasedTransformer>("EmptyTransformer", "No rules"))
+                    .IsOK());
+    ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+    ASSERT_TRUE(session_object.Initialize().IsOK());
+
+    auto metadata = session_object.GetModelMetadata();
+    ASSERT_TRUE(metadata.first.IsOK());
+    ASSERT_EQ(metadata.second->custom_metadata_map.count("test.from_cache"), 0u);
+
+    RunOptions run_options;
+    RunModel(session_object, run_options);
+  }
+  ReadOptimizedModelCache(cache_path, cached_model);
+  ASSERT_TRUE(HasMetadata(cached_model, "test.from_cache"));
+
+  // a session with another optimization level doesn't match the key and rewrites the cache
+  {
+    SessionOptions so;
+    so.optimized_model_cache_path = cache_path;
+    so.graph_optimization_level = TransformerLevel::None;
+
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+    ASSERT_TRUE(session_object.Initialize().IsOK());
+
+    auto metadata = session_object.GetModelMetadata();
+    ASSERT_TRUE(metadata.first.IsOK());
+    ASSERT_EQ(metadata.second->custom_metadata_map.count("test.from_cache"), 0u);
+
+    RunOptions run_options;
+    RunModel(session_object, run_options);
+  }
+  ReadOptimizedModelCache(cache_path, cached_model);
+  ASSERT_FALSE(HasMetadata(cached_model, "test.from_cache"));
+  const std::string none_key = GetOptimizedModelCacheKey(cached_model);
+  ASSERT_NE(none_key.find("level=0"), std::string::npos);
+  ASSERT_NE(none_key, basic_key);
+
+  // a cache that doesn't hold a model is replaced
+  std::ofstream(cache_path) << "not a model";
+  {
+    SessionOptions so;
+    so.optimized_model_cache_path = cache_path;
+
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+    ASSERT_TRUE(session_object.Initialize().IsOK());
+
+    RunOptions run_options;
+    RunModel(session_object, run_options);
+  }
+  ReadOptimizedModelCache(cache_path, cached_model);
+  ASSERT_EQ(GetOptimizedModelCacheKey(cached_model), basic_key);
+
+  std::remove(cache_path.c_str());
+}
+
+static void SetOptimizedModelCachePartition(ModelProto& cached_model, const std::string& partition) {
+  for (auto& entry : *cached_model.mutable_metadata_props()) {
+    if (entry.key() == OptimizedModelCache::kPartitionMetadataName) {
+      entry.set_value(partition);
+    }
+  }
+}
+
+TEST(InferenceSessionTests, OptimizedModelCachePartition) {
+  const std::string cache_path = "InferenceSessionTests.OptimizedModelCachePartition.onnx";
+  std::remove(cache_path.c_str());
+
+  // the first session saves the partition of the main graph with the transformed graph
+  {
+    SessionOptions so;
+    so.optimized_model_cache_path = cache_path;
+
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+    ASSERT_TRUE(session_object.Initialize().IsOK());
+  }
+
+  // the single Mul node of the model, identified by its output, runs on the CPU execution provider
+  ModelProto cached_model;
+  ReadOptimizedModelCache(cache_path, cached_model);
+  const auto partition = std::find_if(cached_model.metadata_props().cbegin(), cached_model.metadata_props().cend(),
+                                      [](const StringStringEntryProto& entry) {
+                                        return entry.key() == OptimizedModelCache::kPartitionMetadataName;
+                                      });
+  ASSERT_NE(partition, cached_model.metadata_props().cend());
+  ASSERT_EQ(partition->value(), std::string(kCpuExecutionProvider) + "\n0 Y\n");
+
+  ExecutionProviders providers;
+  providers.Add(kCpuExecutionProvider, std::make_unique<CPUExecutionProvider>(CPUExecutionProviderInfo{}));
+
+  // the partition is applied to the graph loaded from the cache without partitioning it
+  {
+    std::shared_ptr<Model> model;
+    ASSERT_TRUE(Model::Load(cache_path, model).IsOK());
+    Graph& graph = model->MainGraph();
+    ASSERT_TRUE(OptimizedModelCache::ApplyPartition(*model, graph, providers));
+    for (const auto& node : graph.Nodes()) {
+      ASSERT_EQ(node.GetExecutionProviderType(), kCpuExecutionProvider);
+    }
+  }
+
+  // a partition made for other execution providers, or for other nodes, is not applied
+  for (const std::string stale_partition : {std::string("OtherExecutionProvider,") + kCpuExecutionProvider + "\n1 Y\n",
+                                            std::string(kCpuExecutionProvider) + "\n0 Z\n"}) {
+    SetOptimizedModelCachePartition(cached_model, stale_partition);
+    {
+      std::ofstream cache_file(cache_path, ios::out | ios::binary | ios::trunc);
+      ASSERT_TRUE(cached_model.SerializeToOstream(&cache_file));
+    }
+
+    std::shared_ptr<Model> model;
+    ASSERT_TRUE(Model::Load(cache_path, model).IsOK());
+    Graph& graph = model->MainGraph();
+    ASSERT_FALSE(OptimizedModelCache::ApplyPartition(*model, graph, providers));
+    for (const auto& node : graph.Nodes()) {
+      ASSERT_TRUE(node.GetExecutionProviderType().empty());
+    }
+
+    // a session using the cache partitions the cached graph
+    SessionOptions so;
+    so.optimized_model_cache_path = cache_path;
+
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+    ASSERT_TRUE(session_object.Initialize().IsOK());
+
+    auto metadata = session_object.GetModelMetadata();
+    ASSERT_TRUE(metadata.first.IsOK());
+    ASSERT_EQ(metadata.second->custom_metadata_map.count(OptimizedModelCache::kPartitionMetadataName), 0u);
+
+    RunOptions run_options;
+    RunModel(session_object, run_options);
+  }
+
+  std::remove(cache_path.c_str());
+}
+
 #ifdef ORT_RUN_EXTERNAL_ONNX_TESTS
 static bool Compare(const InputDefList& f_arg, const InputDefList& s_arg) {
   if (f_arg.size() != s_arg.size()) {
@@ -524,6 +776,83 @@ TEST(InferenceSessionTests, CheckRunProfilerWithStartProfile) {
   }
 }
 
+TEST(InferenceSessionTests, CheckRunProfilerWithSampling) {
+  SessionOptions so;
+
+  so.session_logid = "CheckRunProfilerWithSampling";
+  so.enable_profiling = true;
+  so.profile_file_prefix = "onnxruntime_profile_sampling";
+  so.profile_sampling_interval = 2;
+
+  InferenceSession session_object(so);
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  RunOptions run_options;
+  run_options.run_tag = "RunTag";
+  for (int i = 0; i < 4; ++i) {
+    RunModel(session_object, run_options);
+  }
+  std::string profile_file = session_object.EndProfiling();
+
+  std::ifstream profile(profile_file);
+  ASSERT_TRUE(profile);
+  std::string line;
+  int num_runs = 0;
+  int num_kernels = 0;
+  while (std::getline(profile, line)) {
+    if (line.find("\"model_run\"") != string::npos) {
+      ++num_runs;
+    }
+    if (line.find("mul_1_kernel_time") != string::npos) {
+      ++num_kernels;
+    }
+  }
+
+  // the events of the runs that are not sampled are all dropped
+  EXPECT_EQ(num_runs, 2);
+  EXPECT_EQ(num_kernels, 2);
+}
+
+TEST(InferenceSessionTests, CheckRunProfilerWithFileRotation) {
+  SessionOptions so;
+
+  so.session_logid = "CheckRunProfilerWithFileRotation";
+  so.enable_profiling = true;
+  so.profile_file_prefix = "onnxruntime_profile_rotation";
+  // every file is full after a single event
+  so.profile_max_file_bytes = 1;
+
+  InferenceSession session_object(so);
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  RunOptions run_options;
+  run_options.run_tag = "RunTag";
+  RunModel(session_object, run_options);
+  std::string profile_file = session_object.EndProfiling();
+
+  // the last file is numbered after the first one, e.g. onnxruntime_profile_rotation_<time>.7.json
+  const size_t extension = profile_file.rfind(".json");
+  ASSERT_NE(extension, string::npos);
+  const size_t index = profile_file.rfind('.', extension - 1);
+  ASSERT_NE(index, string::npos);
+  EXPECT_GT(std::stoi(profile_file.substr(index + 1, extension - index - 1)), 0);
+
+  std::ifstream profile(profile_file);
+  ASSERT_TRUE(profile);
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(profile, line)) {
+    lines.push_back(line);
+  }
+
+  ASSERT_EQ(lines.size(), 3u);
+  EXPECT_NE(lines[0].find("["), string::npos);
+  EXPECT_NE(lines[1].find("\"name\""), string::npos);
+  EXPECT_NE(lines[2].find("]"), string::npos);
+}
+
 TEST(InferenceSessionTests, MultipleSessionsNoTimeout) {
   SessionOptions session_options;
 
@@ -563,6 +892,155 @@ TEST(InferenceSessionTests, PreAllocateOutputVector) {
   RunModel(session_object, run_options, is_preallocate_output_vec);
 }
 
+TEST(InferenceSessionTests, StaticMemoryPattern) {
+  SessionOptions so;
+
+  so.session_logid = "InferenceSessionTests.StaticMemoryPattern";
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  // the input of the model has a fixed shape so its memory pattern is planned by Initialize
+  auto stats = session_object.GetMemoryPatternCacheStats();
+  EXPECT_EQ(stats.num_entries, 1u);
+
+  RunOptions run_options;
+  run_options.run_tag = "InferenceSessionTests.StaticMemoryPattern";
+  RunModel(session_object, run_options);
+
+  stats = session_object.GetMemoryPatternCacheStats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 0u);
+  EXPECT_EQ(stats.num_entries, 1u);
+}
+
+TEST(InferenceSessionTests, StaticMemoryPatternSizeOverflow) {
+  // the number of elements of the intermediate value doesn't fit in an int64_t, so no pattern can be planned
+  Model model("SizeOverflow");
+  auto& graph = model.MainGraph();
+
+  TypeProto huge_float;
+  huge_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  huge_float.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(int64_t{1} << 32);
+  huge_float.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(int64_t{1} << 32);
+
+  auto& input_arg = graph.GetOrCreateNodeArg("X", &huge_float);
+  auto& neg_arg = graph.GetOrCreateNodeArg("neg", &huge_float);
+  auto& output_arg = graph.GetOrCreateNodeArg("Y", &huge_float);
+  graph.AddNode("neg1", "Neg", "", {&input_arg}, {&neg_arg});
+  graph.AddNode("neg2", "Neg", "", {&neg_arg}, {&output_arg});
+  ASSERT_TRUE(graph.Resolve().IsOK());
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.StaticMemoryPatternSizeOverflow";
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+
+  std::stringstream model_stream;
+  model.ToProto().SerializeToOstream(&model_stream);
+  ASSERT_TRUE(session_object.Load(model_stream).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  EXPECT_EQ(session_object.GetMemoryPatternCacheStats().num_entries, 0u);
+}
+
+TEST(InferenceSessionTests, NodeStatistics) {
+  SessionOptions so;
+
+  so.session_logid = "InferenceSessionTests.NodeStatistics";
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  RunOptions run_options;
+  run_options.run_tag = "InferenceSessionTests.NodeStatistics";
+  for (int i = 0; i < 3; ++i) {
+    RunModel(session_object, run_options);
+  }
+
+  auto statistics = session_object.GetNodeStatistics();
+  ASSERT_EQ(statistics.size(), 1u);
+  EXPECT_EQ(statistics[0].op_type, "Mul");
+  EXPECT_EQ(statistics[0].call_count, 3u);
+  EXPECT_LE(statistics[0].min_time_ns, statistics[0].max_time_ns);
+  EXPECT_LE(statistics[0].max_time_ns, statistics[0].total_time_ns);
+  EXPECT_GT(statistics[0].input_bytes, 0u);
+  EXPECT_EQ(statistics[0].output_bytes, 3 * 6 * sizeof(float));
+
+  session_object.ResetNodeStatistics();
+  EXPECT_TRUE(session_object.GetNodeStatistics().empty());
+
+  so.enable_node_statistics = false;
+  InferenceSession disabled_session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(disabled_session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(disabled_session_object.Initialize().IsOK());
+  RunModel(disabled_session_object, run_options);
+  EXPECT_TRUE(disabled_session_object.GetNodeStatistics().empty());
+}
+
+TEST(InferenceSessionTests, RunWithPreparedFeedsFetches) {
+  SessionOptions so;
+
+  so.session_logid = "InferenceSessionTests.RunWithPreparedFeedsFetches";
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+
+  std::unique_ptr<FeedsFetchesInfo> info;
+  // the indices are only known once the session is initialized
+  ASSERT_FALSE(session_object.PrepareRun({"X"}, {"Y"}, &info).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  ASSERT_FALSE(session_object.PrepareRun({}, {"Y"}, &info).IsOK());
+  ASSERT_FALSE(session_object.PrepareRun({"X"}, {"Z"}, &info).IsOK());
+  ASSERT_FALSE(session_object.PrepareRun({"X", "X"}, {"Y"}, &info).IsOK());
+  ASSERT_TRUE(session_object.PrepareRun({"X"}, {"Y"}, &info).IsOK());
+  ASSERT_TRUE(info != nullptr);
+
+  std::vector<int64_t> dims_mul_x = {3, 2};
+  std::vector<float> values_mul_x = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  std::vector<MLValue> feeds(1);
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), dims_mul_x, values_mul_x,
+                       &feeds[0]);
+
+  std::vector<int64_t> expected_dims_mul_y = {3, 2};
+  std::vector<float> expected_values_mul_y = {1.0f, 4.0f, 9.0f, 16.0f, 25.0f, 36.0f};
+
+  RunOptions run_options;
+  for (int i = 0; i < 3; ++i) {
+    std::vector<MLValue> fetches;
+    common::Status st = session_object.Run(run_options, *info, feeds, &fetches);
+    ASSERT_TRUE(st.IsOK()) << st.ErrorMessage();
+    VerifyOutputs(fetches, expected_dims_mul_y, expected_values_mul_y);
+  }
+
+  // pre-allocated outputs are written in place
+  std::vector<MLValue> fetches(1);
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), dims_mul_x, values_mul_x,
+                       &fetches[0]);
+  const void* output_buffer = fetches[0].Get<Tensor>().DataRaw();
+  ASSERT_TRUE(session_object.Run(run_options, *info, feeds, &fetches).IsOK());
+  VerifyOutputs(fetches, expected_dims_mul_y, expected_values_mul_y);
+  EXPECT_EQ(output_buffer, fetches[0].Get<Tensor>().DataRaw());
+
+  // wrong number of feeds
+  std::vector<MLValue> no_feeds;
+  ASSERT_FALSE(session_object.Run(run_options, *info, no_feeds, &fetches).IsOK());
+
+  // wrong feed type
+  std::vector<MLValue> int_feeds(1);
+  CreateMLValue<int32_t>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), dims_mul_x,
+                         {1, 2, 3, 4, 5, 6}, &int_feeds[0]);
+  ASSERT_FALSE(session_object.Run(run_options, *info, int_feeds, &fetches).IsOK());
+
+  // info prepared by another session
+  InferenceSession other_session{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(other_session.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(other_session.Initialize().IsOK());
+  ASSERT_FALSE(other_session.Run(run_options, *info, feeds, &fetches).IsOK());
+}
+
 TEST(InferenceSessionTests, ConfigureVerbosityLevel) {
   SessionOptions so;
 
@@ -935,6 +1413,269 @@ TEST(InferenceSessionTests, TestOptionalInputs) {
   EXPECT_THAT(status.ErrorMessage(), testing::HasSubstr("Missing required inputs: required_input"));
 }
 
+// An initializer that is also a graph input can be overridden by a feed, so the nodes that read it must not be
+// folded into constants at Initialize.
+TEST(InferenceSessionTests, OverrideInitializerWithConstantFolding) {
+  Model model("ModelWithOverriddenInitializer");
+  auto& graph = model.MainGraph();
+
+  onnx::TensorProto tensor_proto;
+  tensor_proto.add_dims(1);
+  tensor_proto.set_data_type(TensorProto_DataType_FLOAT);
+  tensor_proto.add_float_data(1.f);
+  tensor_proto.set_name("optional_input");
+  graph.AddInitializedTensor(tensor_proto);
+
+  TypeProto single_float;
+  single_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  single_float.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+  auto& required_input = graph.GetOrCreateNodeArg("required_input", &single_float);
+  auto& optional_input = graph.GetOrCreateNodeArg("optional_input", nullptr);
+  auto& neg_output = graph.GetOrCreateNodeArg("neg_output", &single_float);
+  auto& add_output = graph.GetOrCreateNodeArg("add_output", &single_float);
+  graph.AddNode("neg", "Neg", "Negate the optional input", {&optional_input}, {&neg_output});
+  graph.AddNode("add", "Add", "Add required and negated optional inputs", {&required_input, &neg_output},
+                {&add_output});
+  ASSERT_TRUE(graph.Resolve().IsOK());
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.OverrideInitializerWithConstantFolding";
+  so.graph_optimization_level = TransformerLevel::Basic;
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+
+  std::stringstream s1;
+  model.ToProto().SerializeToOstream(&s1);
+  ASSERT_TRUE(session_object.Load(s1).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  auto run = [&](bool override_optional_input, float expected_value) {
+    std::vector<int64_t> dims = {1};
+    NameMLValMap feeds;
+    MLValue required_input_mlvalue;
+    CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), dims, {5.f},
+                         &required_input_mlvalue);
+    feeds.insert(std::make_pair("required_input", required_input_mlvalue));
+    if (override_optional_input) {
+      MLValue optional_input_mlvalue;
+      CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), dims, {10.f},
+                           &optional_input_mlvalue);
+      feeds.insert(std::make_pair("optional_input", optional_input_mlvalue));
+    }
+
+    RunOptions run_options;
+    std::vector<MLValue> fetches;
+    auto status = session_object.Run(run_options, feeds, {"add_output"}, &fetches);
+    ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+    EXPECT_EQ(*fetches.front().Get<Tensor>().Data<float>(), expected_value);
+  };
+
+  run(false, 4.f);
+  run(true, -5.f);
+}
+
+TEST(InferenceSessionTests, ExternalDataInitializer) {
+  // the model and its data live in a directory other than the current one, so the location of the data has to be
+  // resolved against the directory of the model
+  const std::string model_dir = "inference_session_test_external_data";
+  const std::string model_path = model_dir + "/model.onnx";
+  const std::string data_path = model_dir + "/weights.bin";
+  mkdir(model_dir.c_str(), 0755);
+  const std::vector<float> weights{1.f, 2.f, 3.f, 4.f, 5.f, 6.f};
+  {
+    std::ofstream file(data_path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(weights.data()), weights.size() * sizeof(float));
+  }
+
+  {
+    Model model("ModelWithExternalData");
+    auto& graph = model.MainGraph();
+
+    TensorProto tensor_proto;
+    tensor_proto.set_name("W");
+    tensor_proto.set_data_type(TensorProto_DataType_FLOAT);
+    tensor_proto.add_dims(3);
+    tensor_proto.add_dims(2);
+    tensor_proto.set_data_location(TensorProto_DataLocation_EXTERNAL);
+    auto* location = tensor_proto.add_external_data();
+    location->set_key("location");
+    location->set_value("weights.bin");
+    graph.AddInitializedTensor(tensor_proto);
+
+    TypeProto float_tensor;
+    float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+    float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(3);
+    float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+
+    auto& input_x = graph.GetOrCreateNodeArg("X", &float_tensor);
+    auto& input_w = graph.GetOrCreateNodeArg("W", &float_tensor);
+    auto& output_y = graph.GetOrCreateNodeArg("Y", &float_tensor);
+    graph.AddNode("mul", "Mul", "Multiply X by the external weights", {&input_x, &input_w}, {&output_y});
+    ASSERT_TRUE(graph.Resolve().IsOK());
+    ASSERT_TRUE(Model::Save(model, model_path).IsOK());
+  }
+
+  auto run = [&](InferenceSession& session_object) {
+    MLValue ml_value;
+    CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), {3, 2},
+                         {1.f, 1.f, 2.f, 2.f, 3.f, 3.f}, &ml_value);
+    NameMLValMap feeds;
+    feeds.insert(std::make_pair("X", ml_value));
+
+    RunOptions run_options;
+    std::vector<MLValue> fetches;
+    auto status = session_object.Run(run_options, feeds, {"Y"}, &fetches);
+    ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+    VerifyOutputs(fetches, {3, 2}, {1.f, 2.f, 6.f, 8.f, 15.f, 18.f});
+  };
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.ExternalDataInitializer";
+  {
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    ASSERT_TRUE(session_object.Load(model_path).IsOK());
+    auto status = session_object.Initialize();
+    ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+    // the mapping of the data file is kept for as long as the session uses the initializer
+    run(session_object);
+    run(session_object);
+  }
+
+  // a model loaded from a stream has no directory, so the data is looked up in the current directory and not found
+  {
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    std::ifstream model_file(model_path, std::ios::binary);
+    ASSERT_TRUE(session_object.Load(model_file).IsOK());
+    EXPECT_FALSE(session_object.Initialize().IsOK());
+  }
+
+  std::remove(model_path.c_str());
+  std::remove(data_path.c_str());
+  rmdir(model_dir.c_str());
+}
+
+// X feeds kNumBranches independent Relu -> Add branches that are combined by a single Sum,
+// so Y = kNumBranches * (Relu(X) + X).
+static constexpr int kNumBranches = 16;
+
+static ONNX_NAMESPACE::ModelProto CreateWideModel() {
+  Model model("WideModel");
+  auto& graph = model.MainGraph();
+
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(3);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+
+  auto& input_arg = graph.GetOrCreateNodeArg("X", &float_tensor);
+  std::vector<onnxruntime::NodeArg*> sum_inputs;
+
+  for (int i = 0; i < kNumBranches; ++i) {
+    const std::string suffix = std::to_string(i);
+    auto& relu_output = graph.GetOrCreateNodeArg("relu_" + suffix, &float_tensor);
+    auto& add_output = graph.GetOrCreateNodeArg("add_" + suffix, &float_tensor);
+    graph.AddNode("relu_node_" + suffix, "Relu", "branch relu", {&input_arg}, {&relu_output});
+    graph.AddNode("add_node_" + suffix, "Add", "branch add", {&relu_output, &input_arg}, {&add_output});
+    sum_inputs.push_back(&add_output);
+  }
+
+  auto& output_arg = graph.GetOrCreateNodeArg("Y", &float_tensor);
+  graph.AddNode("sum_node", "Sum", "combine branches", sum_inputs, {&output_arg});
+
+  auto status = graph.Resolve();
+  EXPECT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  return model.ToProto();
+}
+
+static common::Status RunWideModel(InferenceSession& session_object, const RunOptions& run_options) {
+  std::vector<int64_t> dims = {3, 2};
+  std::vector<float> values = {-1.0f, 2.0f, -3.0f, 4.0f, -5.0f, 6.0f};
+  MLValue ml_value;
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), dims, values, &ml_value);
+  NameMLValMap feeds;
+  feeds.insert(std::make_pair("X", ml_value));
+
+  std::vector<std::string> output_names{"Y"};
+  std::vector<MLValue> fetches;
+
+  ORT_RETURN_IF_ERROR(session_object.Run(run_options, feeds, output_names, &fetches));
+
+  std::vector<float> expected_values;
+  for (float value : values) {
+    expected_values.push_back(kNumBranches * (std::max(value, 0.0f) + value));
+  }
+  VerifyOutputs(fetches, dims, expected_values);
+
+  return Status::OK();
+}
+
+TEST(InferenceSessionTests, ParallelExecutionWideGraph) {
+  auto model_proto = CreateWideModel();
+
+  for (int session_thread_pool_size : {1, 4}) {
+    SessionOptions so;
+    so.session_logid = "InferenceSessionTests.ParallelExecutionWideGraph";
+    so.enable_sequential_execution = false;
+    so.session_thread_pool_size = session_thread_pool_size;
+
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    std::stringstream s1;
+    model_proto.SerializeToOstream(&s1);
+    ASSERT_TRUE(session_object.Load(s1).IsOK());
+    ASSERT_TRUE(session_object.Initialize().IsOK());
+
+    // concurrent Run calls share the inter-op pool
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 3; ++t) {
+      threads.emplace_back([&session_object]() {
+        RunOptions run_options;
+        run_options.run_tag = "parallel executor";
+        for (int i = 0; i < 20; ++i) {
+          auto status = RunWideModel(session_object, run_options);
+          ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+        }
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+}
+
+TEST(InferenceSessionTests, ParallelExecutionTerminate) {
+  auto model_proto = CreateWideModel();
+
+  for (bool enable_sequential_execution : {false, true}) {
+    SessionOptions so;
+    so.session_logid = "InferenceSessionTests.ParallelExecutionTerminate";
+    so.enable_sequential_execution = enable_sequential_execution;
+    so.session_thread_pool_size = 2;
+
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    std::stringstream s1;
+    model_proto.SerializeToOstream(&s1);
+    ASSERT_TRUE(session_object.Load(s1).IsOK());
+    ASSERT_TRUE(session_object.Initialize().IsOK());
+
+    // the failure of a node is reported by Run and does not leave the session unusable. the second Run reuses the
+    // executor of the first one, which must check the terminate flag of the new RunOptions.
+    RunOptions run_options;
+    run_options.terminate = true;
+    auto status = RunWideModel(session_object, run_options);
+    ASSERT_FALSE(status.IsOK());
+    EXPECT_THAT(status.ErrorMessage(), testing::HasSubstr("terminate flag"));
+
+    RunOptions next_run_options;
+    for (int i = 0; i < 3; ++i) {
+      status = RunWideModel(session_object, next_run_options);
+      ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+    }
+  }
+}
+
 TEST(ExecutionProviderTest, FunctionTest) {
   onnxruntime::Model model("graph_1");
   auto& graph = model.MainGraph();
@@ -0,0 +1,105 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/mem_pattern_cache.h"
+#include "core/framework/mem_pattern_planner.h"
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+TEST(MemPatternCacheTest, LruEvictionTest) {
+  MemoryPatternCacheOptions options;
+  options.max_entries = 2;
+  MemoryPatternCache cache(options);
+
+  std::vector<TensorShape> shapes_1{TensorShape({1, 3})};
+  std::vector<TensorShape> shapes_2{TensorShape({2, 3})};
+  std::vector<TensorShape> shapes_3{TensorShape({3, 3})};
+
+  EXPECT_EQ(cache.Find(shapes_1), nullptr);
+  cache.Insert(shapes_1, std::make_unique<MemoryPatternGroup>());
+  cache.Insert(shapes_2, std::make_unique<MemoryPatternGroup>());
+
+  // make shapes_2 the least recently used
+  EXPECT_NE(cache.Find(shapes_1), nullptr);
+  cache.Insert(shapes_3, std::make_unique<MemoryPatternGroup>());
+
+  EXPECT_NE(cache.Find(shapes_1), nullptr);
+  EXPECT_EQ(cache.Find(shapes_2), nullptr);
+  EXPECT_NE(cache.Find(shapes_3), nullptr);
+
+  auto stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 3u);
+  EXPECT_EQ(stats.misses, 2u);
+  EXPECT_EQ(stats.evictions, 1u);
+  EXPECT_EQ(stats.num_entries, 2u);
+}
+
+// the byte limit counts the buffer every pattern allocates, not only its bookkeeping
+TEST(MemPatternCacheTest, ByteLimitTest) {
+  auto make_patterns = [](size_t peak_size) {
+    MemPatternPlanner planner;
+    planner.TraceAllocation(0, peak_size);
+    auto group = std::make_unique<MemoryPatternGroup>();
+    group->locations.push_back(OrtAllocatorInfo(CPU, OrtDeviceAllocator));
+    group->patterns.push_back(planner.GenerateMemPattern());
+    return group;
+  };
+
+  MemoryPatternCacheOptions options;
+  options.max_bytes = 3 << 20;
+  MemoryPatternCache cache(options);
+
+  std::vector<TensorShape> shapes_1{TensorShape({1, 3})};
+  std::vector<TensorShape> shapes_2{TensorShape({2, 3})};
+  cache.Insert(shapes_1, make_patterns(2 << 20));
+  cache.Insert(shapes_2, make_patterns(2 << 20));
+
+  EXPECT_EQ(cache.Find(shapes_1), nullptr);
+  EXPECT_NE(cache.Find(shapes_2), nullptr);
+  auto stats = cache.GetStats();
+  EXPECT_EQ(stats.evictions, 1u);
+  EXPECT_EQ(stats.num_entries, 1u);
+  EXPECT_GE(stats.num_bytes, size_t{2 << 20});
+}
+
+TEST(MemPatternCacheTest, DimBucketsTest) {
+  MemoryPatternCacheOptions options;
+  options.dim_buckets = {16, 32, 64};
+  MemoryPatternCache cache(options);
+
+  cache.Insert({TensorShape({1, 20})}, std::make_unique<MemoryPatternGroup>());
+
+  EXPECT_NE(cache.Find({TensorShape({1, 32})}), nullptr);
+  EXPECT_NE(cache.Find({TensorShape({1, 17})}), nullptr);
+  EXPECT_EQ(cache.Find({TensorShape({1, 16})}), nullptr);
+  EXPECT_EQ(cache.Find({TensorShape({1, 1, 20})}), nullptr);
+
+  // beyond the last bucket the dimension must match exactly
+  cache.Insert({TensorShape({1, 100})}, std::make_unique<MemoryPatternGroup>());
+  EXPECT_NE(cache.Find({TensorShape({1, 100})}), nullptr);
+  EXPECT_EQ(cache.Find({TensorShape({1, 99})}), nullptr);
+}
+
+TEST(MemPatternCacheTest, GrowthTest) {
+  MemoryPatternCache cache;
+  std::vector<TensorShape> shapes{TensorShape({4})};
+
+  cache.Insert(shapes, std::make_unique<MemoryPatternGroup>());
+  bool needs_growth = true;
+  EXPECT_NE(cache.Find(shapes, &needs_growth), nullptr);
+  EXPECT_FALSE(needs_growth);
+
+  cache.MarkForGrowth(shapes);
+  EXPECT_NE(cache.Find(shapes, &needs_growth), nullptr);
+  EXPECT_TRUE(needs_growth);
+
+  // a regenerated pattern replaces the entry and clears the flag
+  cache.Insert(shapes, std::make_unique<MemoryPatternGroup>());
+  EXPECT_NE(cache.Find(shapes, &needs_growth), nullptr);
+  EXPECT_FALSE(needs_growth);
+  EXPECT_EQ(cache.GetStats().num_entries, 1u);
+  EXPECT_EQ(cache.GetStats().evictions, 0u);
+}
+}  // namespace test
+}  // namespace onnxruntime
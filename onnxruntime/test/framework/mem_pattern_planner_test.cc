@@ -34,5 +34,32 @@ TEST(MemPatternPlannerTest, TraceAllocaitonTest) {
   EXPECT_EQ(pattern.GetBlock(5)->offset_, 1024 + 256 + 512);
   EXPECT_EQ(pattern.GetBlock(6)->offset_, 1024);
 }
+
+TEST(MemPatternPlannerTest, LifetimeStrategyTest) {
+  // allocated in an order where the greedy strategy leaves a hole that is too small for the last block
+  MemPatternPlanner greedy;
+  MemPatternPlanner lifetime(MemPatternPlanner::Strategy::kLifetime);
+  for (auto* planner : {&greedy, &lifetime}) {
+    planner->TraceAllocation(0, 256);
+    planner->TraceAllocation(1, 512);
+    planner->TraceFree(0);
+    planner->TraceAllocation(2, 512);
+    planner->TraceFree(1);
+    planner->TraceFree(2);
+  }
+
+  auto greedy_pattern = greedy.GenerateMemPattern();
+  auto lifetime_pattern = lifetime.GenerateMemPattern();
+
+  EXPECT_EQ(greedy_pattern.PeakSize(), 256 + 512 + 512);
+  EXPECT_EQ(greedy_pattern.LowerBoundSize(), 512 + 512);
+  EXPECT_EQ(lifetime_pattern.PeakSize(), 512 + 512);
+  EXPECT_EQ(lifetime_pattern.LowerBoundSize(), 512 + 512);
+
+  // blocks with overlapping lifetimes must not overlap in memory
+  EXPECT_EQ(lifetime_pattern.GetBlock(1)->offset_, 0);
+  EXPECT_EQ(lifetime_pattern.GetBlock(2)->offset_, 512);
+  EXPECT_EQ(lifetime_pattern.GetBlock(0)->offset_, 512);
+}
 }  // namespace test
 }  // namespace onnxruntime
@@ -7,6 +7,14 @@
 #include "core/framework/tensorprotoutils.h"
 #include "gtest/gtest.h"
 #include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <cstdio>
+#ifdef _WIN32
+#include <direct.h>
+#define getcwd _getcwd
+#else
+#include <unistd.h>
+#endif
+#include <fstream>
 #include <sstream>
 
 namespace onnxruntime {
@@ -27,5 +35,65 @@ TEST(TensorProtoUtilsTest, test1) {
   ASSERT_TRUE(st.IsOK());
 }
 #endif
+
+TEST(TensorProtoUtilsTest, ExternalData) {
+  // the tensor starts after some other data in the file
+  const std::string filename = "tensorprotoutils_test_external_data.bin";
+  const std::vector<float> data{0.5f, 2.0f, 1.0f, 2.5f, 1.5f, 3.0f};
+  {
+    std::ofstream file(filename, std::ios::binary);
+    const std::vector<char> padding(8, 'x');
+    file.write(padding.data(), padding.size());
+    file.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(float));
+  }
+
+  ONNX_NAMESPACE::TensorProto proto;
+  proto.set_name("W");
+  proto.set_data_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  proto.add_dims(2);
+  proto.add_dims(3);
+  proto.set_data_location(ONNX_NAMESPACE::TensorProto_DataLocation_EXTERNAL);
+  auto* location = proto.add_external_data();
+  location->set_key("location");
+  location->set_value(filename);
+  auto* offset = proto.add_external_data();
+  offset->set_key("offset");
+  offset->set_value("8");
+  auto* length = proto.add_external_data();
+  length->set_key("length");
+  length->set_value(std::to_string(data.size() * sizeof(float)));
+  ASSERT_TRUE(utils::HasExternalData(proto));
+
+  ::onnxruntime::AllocatorPtr cpu_allocator = std::make_shared<::onnxruntime::CPUAllocator>();
+  {
+    std::unique_ptr<Tensor> tensor;
+    auto st = utils::GetTensorFromExternalData(proto, "", cpu_allocator, &tensor);
+    ASSERT_TRUE(st.IsOK()) << st.ErrorMessage();
+    EXPECT_EQ(tensor->Shape(), TensorShape({2, 3}));
+    EXPECT_EQ(std::vector<float>(tensor->Data<float>(), tensor->Data<float>() + data.size()), data);
+  }
+
+  // the length has to match the shape
+  length->set_value("12");
+  std::unique_ptr<Tensor> tensor;
+  EXPECT_FALSE(utils::GetTensorFromExternalData(proto, "", cpu_allocator, &tensor).IsOK());
+  length->set_value(std::to_string(data.size() * sizeof(float)));
+
+  // the data can't be outside of the model directory
+  auto expect_rejected = [&](const std::string& rejected_location) {
+    location->set_value(rejected_location);
+    auto st = utils::GetTensorFromExternalData(proto, ".", cpu_allocator, &tensor);
+    ASSERT_FALSE(st.IsOK()) << rejected_location;
+    EXPECT_EQ(st.Code(), common::INVALID_ARGUMENT) << rejected_location;
+  };
+  char current_dir[4096];
+  ASSERT_NE(getcwd(current_dir, sizeof(current_dir)), nullptr);
+  expect_rejected(std::string(current_dir) + "/" + filename);
+  expect_rejected("../" + filename);
+  expect_rejected("data/../../" + filename);
+  expect_rejected("data/..");
+
+  std::remove(filename.c_str());
+}
 }  // namespace test
 }  // namespace onnxruntime
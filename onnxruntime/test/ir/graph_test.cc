@@ -607,6 +607,45 @@ TEST(ResolvingGraphTest, UnusedInitializerIsIgnored) {
   ASSERT_TRUE(graph.GetAllInitializedTensors().empty());
 }
 
+TEST(ResolvingGraphTest, ReleaseGraphProtoNodes) {
+  ASSERT_TRUE(kSchemasRegistered);
+
+  Model model("ReleaseGraphProtoNodes");
+  auto& graph = model.MainGraph();
+
+  TypeProto tensor_int32;
+  tensor_int32.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT32);
+  tensor_int32.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+  auto& input_arg = graph.GetOrCreateNodeArg("node_a_in_1", &tensor_int32);
+  auto& middle_arg = graph.GetOrCreateNodeArg("node_a_out_1", &tensor_int32);
+  auto& output_arg = graph.GetOrCreateNodeArg("node_b_out_1", &tensor_int32);
+  graph.AddNode("a", "Identity_Fake", "a", {&input_arg}, {&middle_arg});
+  graph.AddNode("b", "Identity_Fake", "b", {&middle_arg}, {&output_arg});
+  auto status = graph.Resolve();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  // load from a proto so that the graph is backed by the NodeProtos of the model
+  std::shared_ptr<onnxruntime::Model> p_model;
+  status = onnxruntime::Model::Load(model.ToProto(), p_model, nullptr);
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  auto& loaded_graph = p_model->MainGraph();
+  status = loaded_graph.Resolve();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  ASSERT_EQ(loaded_graph.ToGraphProto().node_size(), 2);
+
+  loaded_graph.ReleaseGraphProtoNodes();
+  EXPECT_EQ(loaded_graph.NumberOfNodes(), 2);
+
+  // the proto is recreated from the nodes when it is needed again
+  const auto& graph_proto = loaded_graph.ToGraphProto();
+  ASSERT_EQ(graph_proto.node_size(), 2);
+  EXPECT_EQ(graph_proto.node(0).name(), "a");
+  EXPECT_EQ(graph_proto.node(1).name(), "b");
+  ASSERT_EQ(graph_proto.output_size(), 1);
+  EXPECT_EQ(graph_proto.output(0).name(), "node_b_out_1");
+}
+
 TEST(ResolvingGraphTest, GraphConstruction_CheckIsNotAcyclic) {
   // A cyclic graph
   //                 SouceNode
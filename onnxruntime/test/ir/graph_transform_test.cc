@@ -2,6 +2,12 @@
 // Licensed under the MIT License.
 
 #include "core/session/inference_session.h"
+
+#include <cmath>
+#include <map>
+#include <sstream>
+#include <unordered_set>
+
 #include "core/graph/graph_viewer.h"
 #include "core/graph/model.h"
 #include "core/graph/graph_transformer.h"
@@ -11,9 +17,16 @@
 #include "core/graph/conv_mul_fusion.h"
 #include "core/graph/conv_add_fusion.h"
 #include "core/graph/conv_activation_fusion.h"
+#include "core/graph/elementwise_fusion.h"
+#include "core/framework/constant_folding.h"
+#include "core/framework/execution_providers.h"
+#include "core/framework/kernel_registry_manager.h"
+#include "core/framework/tensorprotoutils.h"
 #include "core/platform/env.h"
+#include "core/providers/cpu/cpu_execution_provider.h"
 
 #include "test/capturing_sink.h"
+#include "test/framework/test_utils.h"
 #include "test/test_environment.h"
 #include "gtest/gtest.h"
 
@@ -92,6 +105,309 @@ TEST(GraphTransformationTests, FuseConvActivation) {
   }
 }
 
+// Conv -> Relu -> Add X -> Sigmoid, which only the Extended level fuses
+static ModelProto BuildConvReluAddSigmoidModel() {
+  Model model("conv_relu_add_sigmoid");
+  Graph& graph = model.MainGraph();
+
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  TypeProto x_type(float_tensor);
+  for (int64_t dim : {1, 1, 5, 5}) {
+    x_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(dim);
+  }
+
+  TensorProto w;
+  w.set_name("W");
+  w.set_data_type(TensorProto_DataType_FLOAT);
+  for (int64_t dim : {1, 1, 3, 3}) {
+    w.add_dims(dim);
+  }
+  for (int i = 0; i < 9; ++i) {
+    w.add_float_data(0.25f * (i % 4) - 0.5f);
+  }
+  graph.AddInitializedTensor(w);
+
+  NodeArg* x = &graph.GetOrCreateNodeArg("X", &x_type);
+  NodeArg* conv_out = &graph.GetOrCreateNodeArg("conv_out", &float_tensor);
+  NodeArg* relu_out = &graph.GetOrCreateNodeArg("relu_out", &float_tensor);
+  NodeArg* add_out = &graph.GetOrCreateNodeArg("add_out", &float_tensor);
+  Node& conv = graph.AddNode("conv", "Conv", "", {x, graph.GetNodeArg("W")}, {conv_out});
+  conv.AddAttribute("pads", std::vector<int64_t>{1, 1, 1, 1});
+  graph.AddNode("relu", "Relu", "", {conv_out}, {relu_out});
+  graph.AddNode("add", "Add", "", {relu_out, x}, {add_out});
+  graph.AddNode("sigmoid", "Sigmoid", "", {add_out}, {&graph.GetOrCreateNodeArg("Z", &float_tensor)});
+  EXPECT_TRUE(graph.Resolve().IsOK());
+
+  return model.ToProto();
+}
+
+// Remove the initializers from the graph inputs of model_proto, so that they are constants that no feed can override.
+static void RemoveInitializersFromInputs(ModelProto& model_proto) {
+  std::unordered_set<std::string> initializer_names;
+  for (const auto& initializer : model_proto.graph().initializer()) {
+    initializer_names.insert(initializer.name());
+  }
+  auto* graph_inputs = model_proto.mutable_graph()->mutable_input();
+  for (int i = graph_inputs->size(); i-- > 0;) {
+    if (initializer_names.count(graph_inputs->Get(i).name()) != 0) {
+      graph_inputs->DeleteSubrange(i, 1);
+    }
+  }
+}
+
+// Run model_proto at level with deterministic values for its inputs and return the outputs.
+static void RunAtLevel(const ModelProto& model_proto, TransformerLevel level, std::vector<MLValue>& fetches) {
+  SessionOptions so;
+  so.session_logid = "GraphTransformationTests.GraphOptimizationLevels";
+  so.graph_optimization_level = level;
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+
+  std::stringstream model_stream;
+  ASSERT_TRUE(model_proto.SerializeToOstream(&model_stream));
+  ASSERT_TRUE(session_object.Load(model_stream).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  CPUExecutionProvider cpu_provider{CPUExecutionProviderInfo()};
+  AllocatorPtr allocator = cpu_provider.GetAllocator(0, OrtMemTypeDefault);
+
+  NameMLValMap feeds;
+  auto inputs = session_object.GetModelInputs();
+  ASSERT_TRUE(inputs.first.IsOK());
+  for (const NodeArg* input : *inputs.second) {
+    ASSERT_NE(input->Shape(), nullptr);
+    TensorShape shape(utils::GetTensorShapeFromTensorShapeProto(*input->Shape()));
+    void* buffer = allocator->Alloc(sizeof(float) * shape.Size());
+    auto tensor = std::make_unique<Tensor>(DataTypeImpl::GetType<float>(), shape, buffer, allocator->Info(),
+                                           allocator);
+    float* values = tensor->MutableData<float>();
+    for (int64_t i = 0; i < shape.Size(); ++i) {
+      values[i] = static_cast<float>(i % 13) * 0.125f - 0.75f;
+    }
+    MLValue value;
+    value.Init(tensor.release(), DataTypeImpl::GetType<Tensor>(), DataTypeImpl::GetType<Tensor>()->GetDeleteFunc());
+    feeds.insert(std::make_pair(input->Name(), value));
+  }
+
+  std::vector<std::string> output_names;
+  auto outputs = session_object.GetModelOutputs();
+  ASSERT_TRUE(outputs.first.IsOK());
+  for (const NodeArg* output : *outputs.second) {
+    output_names.push_back(output->Name());
+  }
+
+  RunOptions run_options;
+  ASSERT_TRUE(session_object.Run(run_options, feeds, output_names, &fetches).IsOK());
+}
+
+TEST(GraphTransformationTests, GraphOptimizationLevels) {
+  // the built-in transformers of each level run without any being registered. the op counts are the ones after
+  // the None, Basic and Extended levels.
+  // the initializers of these IR 3 models are graph inputs too. unless they are removed from the inputs, a feed can
+  // override them and nothing that reads them is fused.
+  struct LevelExpectations {
+    std::string model;
+    bool initializers_are_inputs;
+    std::map<std::string, int> op_counts[3];
+  };
+  const LevelExpectations expectations[] = {
+      {"fusion/fuse-conv-bn-mul-add-unsqueeze.onnx", false,
+       {{{"Sub", 1}, {"Conv", 1}, {"BatchNormalization", 1}, {"Unsqueeze", 2}, {"Mul", 1}, {"Add", 1}, {"Flatten", 1}},
+        {{"Sub", 1}, {"Conv", 1}, {"Flatten", 1}},
+        {{"Sub", 1}, {"Conv", 1}, {"Flatten", 1}}}},
+      {"fusion/fuse-conv-bn-mul-add-unsqueeze.onnx", true,
+       {{{"Sub", 1}, {"Conv", 1}, {"BatchNormalization", 1}, {"Unsqueeze", 2}, {"Mul", 1}, {"Add", 1}, {"Flatten", 1}},
+        {{"Sub", 1}, {"Conv", 1}, {"BatchNormalization", 1}, {"Unsqueeze", 2}, {"Mul", 1}, {"Add", 1}, {"Flatten", 1}},
+        {{"Sub", 1}, {"Conv", 1}, {"BatchNormalization", 1}, {"Unsqueeze", 2}, {"Mul", 1}, {"Add", 1}, {"Flatten", 1}}}},
+      {"fusion/fuse-conv-bn-no-bias.onnx", false,
+       {{{"Conv", 1}, {"BatchNormalization", 1}, {"Flatten", 1}},
+        {{"Conv", 1}, {"Flatten", 1}},
+        {{"Conv", 1}, {"Flatten", 1}}}},
+      {"fusion/fuse-conv-bn-no-bias.onnx", true,
+       {{{"Conv", 1}, {"BatchNormalization", 1}, {"Flatten", 1}},
+        {{"Conv", 1}, {"BatchNormalization", 1}, {"Flatten", 1}},
+        {{"Conv", 1}, {"BatchNormalization", 1}, {"Flatten", 1}}}},
+      // the activations produce graph outputs, so they stay apart from the Conv
+      {"fusion/conv_relu.onnx", true,
+       {{{"Conv", 1}, {"Relu", 1}}, {{"Conv", 1}, {"Relu", 1}}, {{"Conv", 1}, {"Relu", 1}}}},
+      {"fusion/conv_leakyrelu.onnx", true,
+       {{{"Conv", 1}, {"LeakyRelu", 1}}, {{"Conv", 1}, {"LeakyRelu", 1}}, {{"Conv", 1}, {"LeakyRelu", 1}}}},
+      {"abs-id-max.onnx", true,
+       {{{"Abs", 1}, {"Identity", 1}, {"Max", 1}}, {{"Abs", 1}, {"Max", 1}}, {{"Abs", 1}, {"Max", 1}}}},
+      {"", true,
+       {{{"Conv", 1}, {"Relu", 1}, {"Add", 1}, {"Sigmoid", 1}},
+        {{"Conv", 1}, {"Relu", 1}, {"Add", 1}, {"Sigmoid", 1}},
+        {{"FusedConv", 1}, {"FusedElementwise", 1}}}},
+  };
+  const TransformerLevel levels[] = {TransformerLevel::None, TransformerLevel::Basic, TransformerLevel::Extended};
+
+  for (const auto& expected : expectations) {
+    ModelProto model_proto;
+    if (expected.model.empty()) {
+      model_proto = BuildConvReluAddSigmoidModel();
+    } else {
+      std::shared_ptr<Model> p_model;
+      ASSERT_TRUE(Model::Load(MODEL_FOLDER + expected.model, p_model).IsOK());
+      model_proto = p_model->ToProto();
+    }
+    if (!expected.initializers_are_inputs) {
+      RemoveInitializersFromInputs(model_proto);
+    }
+
+    std::vector<MLValue> unoptimized_fetches;
+    RunAtLevel(model_proto, TransformerLevel::None, unoptimized_fetches);
+
+    for (int level = 0; level < 3; ++level) {
+      SCOPED_TRACE(expected.model + (expected.initializers_are_inputs ? " with" : " without") +
+                   " initializer inputs at level " + std::to_string(level));
+
+      std::shared_ptr<Model> p_model;
+      ASSERT_TRUE(Model::Load(model_proto, p_model).IsOK());
+      Graph& graph = p_model->MainGraph();
+      GraphTransformerManager graph_transformation_mgr{SessionOptions().max_num_graph_transformation_steps,
+                                                       levels[level]};
+      ASSERT_TRUE(graph_transformation_mgr.ApplyAll(graph).IsOK());
+
+      std::map<std::string, int> op_counts;
+      for (auto& node : graph.Nodes()) {
+        op_counts[node.OpType()]++;
+      }
+      EXPECT_EQ(op_counts, expected.op_counts[level]);
+
+      // the session of the level computes the same outputs as the unoptimized one
+      std::vector<MLValue> fetches;
+      RunAtLevel(model_proto, levels[level], fetches);
+      ASSERT_EQ(fetches.size(), unoptimized_fetches.size());
+      for (size_t i = 0; i < fetches.size(); ++i) {
+        const Tensor& actual = fetches[i].Get<Tensor>();
+        const Tensor& reference = unoptimized_fetches[i].Get<Tensor>();
+        ASSERT_EQ(actual.Shape(), reference.Shape());
+        const float* actual_values = actual.Data<float>();
+        const float* reference_values = reference.Data<float>();
+        for (int64_t j = 0; j < actual.Shape().Size(); ++j) {
+          EXPECT_NEAR(actual_values[j], reference_values[j], 1e-3f + 1e-4f * std::abs(reference_values[j]));
+        }
+      }
+    }
+  }
+}
+
+TEST(GraphTransformationTests, FuseConvBNOverriddenInitializer) {
+  // Conv -> BatchNormalization. the initializers of a graph built from scratch are graph inputs too, so a feed can
+  // override the Conv weights and the BatchNormalization parameters. opset 7 has the versions ConvBNFusion handles.
+  Model model("conv_bn", false, ModelMetaData(), IOnnxRuntimeOpSchemaRegistryList(), {{kOnnxDomain, 7}});
+  Graph& graph = model.MainGraph();
+
+  auto add_initializer = [&](const std::string& name, const std::vector<int64_t>& dims,
+                             const std::vector<float>& values) {
+    TensorProto tensor;
+    tensor.set_name(name);
+    tensor.set_data_type(TensorProto_DataType_FLOAT);
+    for (auto dim : dims) {
+      tensor.add_dims(dim);
+    }
+    for (auto value : values) {
+      tensor.add_float_data(value);
+    }
+    graph.AddInitializedTensor(tensor);
+    return graph.GetNodeArg(name);
+  };
+
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  TypeProto x_type(float_tensor);
+  for (int64_t dim : {1, 1, 3, 3}) {
+    x_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(dim);
+  }
+
+  const std::vector<float> x_values{1.0f, -2.0f, 3.0f, 0.5f, 1.5f, -1.0f, 2.0f, 0.0f, -0.5f};
+  const std::vector<float> w_values{0.5f, -1.0f, 0.25f, 1.0f, 0.0f, 2.0f, -0.5f, 1.0f, 0.75f,
+                                    -0.25f, 0.5f, 1.0f, 0.0f, 1.5f, -1.0f, 0.5f, 0.25f, -0.75f};
+  const std::vector<float> scale_values{2.0f, 0.5f};
+  const std::vector<float> bias_values{0.5f, -1.0f};
+  const std::vector<float> mean_values{1.0f, -2.0f};
+  const std::vector<float> var_values{3.0f, 0.25f};
+
+  NodeArg* conv_out = &graph.GetOrCreateNodeArg("conv_out", &float_tensor);
+  graph.AddNode("conv", "Conv", "",
+                {&graph.GetOrCreateNodeArg("X", &x_type), add_initializer("W", {2, 1, 3, 3}, w_values)}, {conv_out});
+  graph.AddNode("bn", "BatchNormalization", "",
+                {conv_out, add_initializer("scale", {2}, scale_values), add_initializer("B", {2}, bias_values),
+                 add_initializer("mean", {2}, mean_values), add_initializer("var", {2}, var_values)},
+                {&graph.GetOrCreateNodeArg("Y", &float_tensor)});
+  ASSERT_TRUE(graph.Resolve().IsOK());
+  ModelProto model_proto = model.ToProto();
+
+  // the Basic level leaves the BatchNormalization in place, and fuses it once the initializers are constants
+  GraphTransformerManager graph_transformation_mgr{SessionOptions().max_num_graph_transformation_steps,
+                                                   TransformerLevel::Basic};
+  std::shared_ptr<Model> p_model;
+  ASSERT_TRUE(Model::Load(model_proto, p_model).IsOK());
+  ASSERT_TRUE(graph_transformation_mgr.ApplyAll(p_model->MainGraph()).IsOK());
+  EXPECT_EQ(p_model->MainGraph().NumberOfNodes(), 2);
+
+  ModelProto constant_model_proto(model_proto);
+  RemoveInitializersFromInputs(constant_model_proto);
+  std::shared_ptr<Model> constant_model;
+  ASSERT_TRUE(Model::Load(constant_model_proto, constant_model).IsOK());
+  ASSERT_TRUE(graph_transformation_mgr.ApplyAll(constant_model->MainGraph()).IsOK());
+  EXPECT_EQ(constant_model->MainGraph().NumberOfNodes(), 1);
+
+  // the single output of each channel: the 3x3 Conv covers all of X, then the BatchNormalization
+  auto conv_bn = [&](const std::vector<float>& w, const std::vector<float>& mean) {
+    std::vector<float> y(2);
+    for (size_t c = 0; c < y.size(); ++c) {
+      float conv = 0.0f;
+      for (size_t i = 0; i < x_values.size(); ++i) {
+        conv += x_values[i] * w[c * x_values.size() + i];
+      }
+      y[c] = scale_values[c] * (conv - mean[c]) / std::sqrt(var_values[c] + 1e-5f) + bias_values[c];
+    }
+    return y;
+  };
+
+  SessionOptions so;
+  so.session_logid = "GraphTransformationTests.FuseConvBNOverriddenInitializer";
+  ASSERT_EQ(so.graph_optimization_level, TransformerLevel::Basic);
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  std::stringstream model_stream;
+  ASSERT_TRUE(model_proto.SerializeToOstream(&model_stream));
+  ASSERT_TRUE(session_object.Load(model_stream).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  AllocatorPtr allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+  auto run = [&](NameMLValMap& feeds, const std::vector<float>& expected) {
+    MLValue x;
+    CreateMLValue<float>(allocator, {1, 1, 3, 3}, x_values, &x);
+    feeds.insert(std::make_pair("X", x));
+
+    std::vector<MLValue> fetches;
+    RunOptions run_options;
+    ASSERT_TRUE(session_object.Run(run_options, feeds, {"Y"}, &fetches).IsOK());
+    ASSERT_EQ(fetches.size(), 1u);
+    const Tensor& y = fetches[0].Get<Tensor>();
+    ASSERT_EQ(y.Shape(), TensorShape(std::vector<int64_t>{1, 2, 1, 1}));
+    for (size_t c = 0; c < expected.size(); ++c) {
+      EXPECT_NEAR(y.Data<float>()[c], expected[c], 1e-4f);
+    }
+  };
+
+  // without overrides the initializers are used
+  NameMLValMap default_feeds;
+  run(default_feeds, conv_bn(w_values, mean_values));
+
+  // the fed weights and mean replace the initializers
+  std::vector<float> fed_w_values(w_values.rbegin(), w_values.rend());
+  const std::vector<float> fed_mean_values{-3.0f, 4.0f};
+  NameMLValMap override_feeds;
+  MLValue fed_w, fed_mean;
+  CreateMLValue<float>(allocator, {2, 1, 3, 3}, fed_w_values, &fed_w);
+  CreateMLValue<float>(allocator, {2}, fed_mean_values, &fed_mean);
+  override_feeds.insert(std::make_pair("W", fed_w));
+  override_feeds.insert(std::make_pair("mean", fed_mean));
+  run(override_feeds, conv_bn(fed_w_values, fed_mean_values));
+}
+
 TEST(GraphTransformationTests, FuseConvBNNoBias) {
   string model_uri = MODEL_FOLDER + "fusion/fuse-conv-bn-no-bias.onnx";
 
@@ -194,5 +510,134 @@ TEST(GraphTransformationTests, FuseConvAddMul3D) {
   ASSERT_TRUE(session_object.Initialize().IsOK());
 }
 
+TEST(GraphTransformationTests, FuseElementwiseChain) {
+  // X * scale + bias -> Sigmoid -> * X, with an Exp also reading X * scale + bias when branch is set
+  for (bool branch : {false, true}) {
+    Model model("elementwise_chain");
+    Graph& graph = model.MainGraph();
+
+    TypeProto float_tensor;
+    float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+    auto make_input = [&](const std::string& name, const std::vector<int64_t>& dims) {
+      TypeProto type(float_tensor);
+      for (auto dim : dims) {
+        type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(dim);
+      }
+      return &graph.GetOrCreateNodeArg(name, &type);
+    };
+    auto make_output = [&](const std::string& name) { return &graph.GetOrCreateNodeArg(name, &float_tensor); };
+
+    NodeArg* x = make_input("X", {2, 3, 4, 5});
+    NodeArg* scale = make_input("scale", {3, 1, 1});
+    NodeArg* bias = make_input("bias", {5});
+    NodeArg* scaled = make_output("scaled");
+    NodeArg* biased = make_output("biased");
+    NodeArg* sigmoid = make_output("sigmoid");
+    graph.AddNode("mul_scale", "Mul", "", {x, scale}, {scaled});
+    graph.AddNode("add_bias", "Add", "", {scaled, bias}, {biased});
+    graph.AddNode("sigmoid", "Sigmoid", "", {biased}, {sigmoid});
+    graph.AddNode("mul_x", "Mul", "", {sigmoid, x}, {make_output("Y")});
+    if (branch) {
+      graph.AddNode("exp", "Exp", "", {biased}, {make_output("Z")});
+    }
+    ASSERT_TRUE(graph.Resolve().IsOK());
+
+    ElementwiseFusion fusion;
+    bool modified = false;
+    ASSERT_TRUE(fusion.Apply(graph, modified).IsOK());
+    EXPECT_TRUE(modified);
+
+    std::map<std::string, int> op_counts;
+    for (auto& node : graph.Nodes()) {
+      op_counts[node.OpType()]++;
+    }
+    if (branch) {
+      // the chain splits after the Add, which has two consumers
+      EXPECT_EQ(graph.NumberOfNodes(), 3);
+      EXPECT_EQ(op_counts["FusedElementwise"], 2);
+      EXPECT_EQ(op_counts["Exp"], 1);
+    } else {
+      EXPECT_EQ(graph.NumberOfNodes(), 1);
+      EXPECT_EQ(op_counts["FusedElementwise"], 1);
+    }
+  }
+}
+
+TEST(GraphTransformationTests, ConstantFolding) {
+  // Transpose(W) * scale + X, where W and scale are initializers
+  Model model("constant_folding");
+  Graph& graph = model.MainGraph();
+
+  auto add_initializer = [&](const std::string& name, const std::vector<int64_t>& dims,
+                             const std::vector<float>& values) {
+    TensorProto tensor;
+    tensor.set_name(name);
+    tensor.set_data_type(TensorProto_DataType_FLOAT);
+    for (auto dim : dims) {
+      tensor.add_dims(dim);
+    }
+    for (auto value : values) {
+      tensor.add_float_data(value);
+    }
+    graph.AddInitializedTensor(tensor);
+    return graph.GetNodeArg(name);
+  };
+
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  TypeProto x_type(float_tensor);
+  x_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(3);
+  x_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+
+  NodeArg* w = add_initializer("W", {2, 3}, {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f});
+  NodeArg* scale = add_initializer("scale", {1}, {0.5f});
+  NodeArg* transposed = &graph.GetOrCreateNodeArg("transposed", &float_tensor);
+  NodeArg* scaled = &graph.GetOrCreateNodeArg("scaled", &float_tensor);
+  graph.AddNode("transpose", "Transpose", "", {w}, {transposed});
+  graph.AddNode("mul", "Mul", "", {transposed, scale}, {scaled});
+  graph.AddNode("add", "Add", "", {&graph.GetOrCreateNodeArg("X", &x_type), scaled},
+                {&graph.GetOrCreateNodeArg("Y", &float_tensor)});
+  ASSERT_TRUE(graph.Resolve().IsOK());
+
+  ExecutionProviders execution_providers;
+  execution_providers.Add(kCpuExecutionProvider, std::make_unique<CPUExecutionProvider>(CPUExecutionProviderInfo()));
+  KernelRegistryManager kernel_registry_manager;
+  kernel_registry_manager.RegisterKernels(execution_providers);
+
+  ConstantFolding constant_folding(execution_providers, kernel_registry_manager,
+                                   logging::LoggingManager::DefaultLogger());
+
+  // the initializers of a graph built from scratch are all graph inputs too, so a feed can override them and
+  // nothing is folded
+  bool modified = false;
+  ASSERT_TRUE(constant_folding.Apply(graph, modified).IsOK());
+  EXPECT_FALSE(modified);
+  EXPECT_EQ(graph.NumberOfNodes(), 3);
+
+  // once X is the only graph input, W and scale are constants
+  ModelProto model_proto = model.ToProto();
+  RemoveInitializersFromInputs(model_proto);
+  std::shared_ptr<Model> constant_model;
+  ASSERT_TRUE(Model::Load(model_proto, constant_model).IsOK());
+  Graph& constant_graph = constant_model->MainGraph();
+
+  ASSERT_TRUE(constant_folding.Apply(constant_graph, modified).IsOK());
+  EXPECT_TRUE(modified);
+
+  // only the Add is left, reading the folded value that replaced W and scale
+  ASSERT_EQ(constant_graph.NumberOfNodes(), 1);
+  EXPECT_EQ(constant_graph.Nodes().begin()->OpType(), "Add");
+  const TensorProto* folded = nullptr;
+  EXPECT_FALSE(constant_graph.GetInitializedTensor("W", folded));
+  ASSERT_TRUE(constant_graph.GetInitializedTensor("scaled", folded));
+  EXPECT_EQ(std::vector<int64_t>(folded->dims().begin(), folded->dims().end()), std::vector<int64_t>({3, 2}));
+
+  std::vector<float> values(6);
+  ASSERT_EQ(folded->raw_data().size(), values.size() * sizeof(float));
+  memcpy(values.data(), folded->raw_data().data(), folded->raw_data().size());
+  const std::vector<float> expected{0.5f, 2.0f, 1.0f, 2.5f, 1.5f, 3.0f};
+  EXPECT_EQ(values, expected);
+}
+
 }  // namespace test
 }  // namespace onnxruntime
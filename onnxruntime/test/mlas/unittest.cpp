@@ -18,7 +18,10 @@ Abstract:
 #include <memory.h>
 #include <algorithm>
 #include <limits>
+#include <thread>
+#include <vector>
 #include <mlas.h>
+#include "core/platform/threadpool.h"
 
 #if defined(_WIN32)
 #include <windows.h>
@@ -232,7 +235,8 @@ TrialSgemm(
     float beta,
     float* C,
     float* CReference,
-    size_t ldc
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
     )
 {
     for (size_t f = 0; f < M * N; f++) {
@@ -240,7 +244,7 @@ TrialSgemm(
         CReference[f] = -0.5f;
     }
 
-    MlasSgemm(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+    MlasSgemm(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc, ThreadPool);
     ReferenceSgemm(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, CReference, ldc);
 
     for (size_t f = 0; f < M * N; f++) {
@@ -249,6 +253,27 @@ TrialSgemm(
             printf("mismatch TransA=%d, TransB=%d, M=%zd, N=%zd, K=%zd, alpha=%f, beta=%f!\n", TransA, TransB, M, N, K, alpha, beta);
         }
     }
+
+    //
+    // Repeat the operation with matrix B packed ahead of time.
+    //
+
+    std::vector<float> PackedBuffer(MlasSgemmPackBSize(N, K) / sizeof(float) + 16);
+    void* PackedB = (void*)(((uintptr_t)PackedBuffer.data() + 63) & ~uintptr_t(63));
+
+    MlasSgemmPackB(TransB, N, K, B, ldb, PackedB);
+
+    for (size_t f = 0; f < M * N; f++) {
+        C[f] = -0.5f;
+    }
+
+    MlasSgemm(TransA, M, N, K, alpha, A, lda, PackedB, beta, C, ldc, ThreadPool);
+
+    for (size_t f = 0; f < M * N; f++) {
+        if (C[f] != CReference[f]) {
+            printf("mismatch packed TransA=%d, TransB=%d, M=%zd, N=%zd, K=%zd, alpha=%f, beta=%f!\n", TransA, TransB, M, N, K, alpha, beta);
+        }
+    }
 }
 
 void
@@ -261,7 +286,8 @@ TrialSgemm(
     MatrixGuardBuffer& BufferB,
     float beta,
     MatrixGuardBuffer& BufferC,
-    MatrixGuardBuffer& BufferCReference
+    MatrixGuardBuffer& BufferCReference,
+    MLAS_THREADPOOL* ThreadPool = nullptr
     )
 {
     const float* A = BufferA.GetBuffer(K * M);
@@ -269,10 +295,73 @@ TrialSgemm(
     float* C = BufferC.GetBuffer(N * M);
     float* CReference = BufferCReference.GetBuffer(N * M);
 
-    TrialSgemm(CblasNoTrans, CblasNoTrans, M, N, K, alpha, A, K, B, N, beta, C, CReference, N);
-    TrialSgemm(CblasNoTrans, CblasTrans, M, N, K, alpha, A, K, B, K, beta, C, CReference, N);
-    TrialSgemm(CblasTrans, CblasNoTrans, M, N, K, alpha, A, M, B, N, beta, C, CReference, N);
-    TrialSgemm(CblasTrans, CblasTrans, M, N, K, alpha, A, M, B, K, beta, C, CReference, N);
+    TrialSgemm(CblasNoTrans, CblasNoTrans, M, N, K, alpha, A, K, B, N, beta, C, CReference, N, ThreadPool);
+    TrialSgemm(CblasNoTrans, CblasTrans, M, N, K, alpha, A, K, B, K, beta, C, CReference, N, ThreadPool);
+    TrialSgemm(CblasTrans, CblasNoTrans, M, N, K, alpha, A, M, B, N, beta, C, CReference, N, ThreadPool);
+    TrialSgemm(CblasTrans, CblasTrans, M, N, K, alpha, A, M, B, K, beta, C, CReference, N, ThreadPool);
+}
+
+void
+TrialSgemmBatch(
+    size_t BatchCount,
+    size_t M,
+    size_t N,
+    size_t K,
+    MLAS_THREADPOOL* ThreadPool
+    )
+{
+    std::vector<float> A(BatchCount * M * K);
+    std::vector<float> B(BatchCount * K * N);
+    std::vector<float> C(BatchCount * M * N, -0.5f);
+    std::vector<float> CReference(BatchCount * M * N, -0.5f);
+
+    for (size_t f = 0; f < A.size(); f++) {
+        A[f] = float(int(f % 23) - 11);
+    }
+
+    for (size_t f = 0; f < B.size(); f++) {
+        B[f] = float(int(f % 19) - 9);
+    }
+
+    std::vector<const float*> BatchA(BatchCount);
+    std::vector<const float*> BatchB(BatchCount);
+    std::vector<float*> BatchC(BatchCount);
+
+    for (size_t b = 0; b < BatchCount; b++) {
+        BatchA[b] = A.data() + b * M * K;
+        BatchB[b] = B.data() + b * K * N;
+        BatchC[b] = C.data() + b * M * N;
+    }
+
+    MlasSgemmBatch(CblasNoTrans, CblasNoTrans, M, N, K, 1.0f, BatchA.data(), K, BatchB.data(), N, 0.0f, BatchC.data(), N, BatchCount, ThreadPool);
+
+    for (size_t b = 0; b < BatchCount; b++) {
+        ReferenceSgemm(CblasNoTrans, CblasNoTrans, M, N, K, 1.0f, BatchA[b], K, BatchB[b], N, 0.0f, CReference.data() + b * M * N, N);
+    }
+
+    for (size_t f = 0; f < C.size(); f++) {
+        if (C[f] != CReference[f]) {
+            printf("mismatch batch BatchCount=%zd, M=%zd, N=%zd, K=%zd!\n", BatchCount, M, N, K);
+            break;
+        }
+    }
+}
+
+void
+ExecuteSgemmBatchTests(
+    MLAS_THREADPOOL* ThreadPool
+    )
+{
+    static const size_t bs[] = { 1, 2, 3, 7, 16, 33 };
+    static const size_t ds[] = { 1, 3, 16, 17, 64, 129 };
+
+    for (size_t b = 0; b < _countof(bs); b++) {
+        for (size_t m = 0; m < _countof(ds); m++) {
+            for (size_t n = 0; n < _countof(ds); n++) {
+                TrialSgemmBatch(bs[b], ds[m], ds[n], 31, ThreadPool);
+            }
+        }
+    }
 }
 
 void
@@ -367,6 +456,106 @@ ExecuteSgemmTests(
     }
 }
 
+void
+ExecuteThreadingTests(
+    void
+    )
+{
+    constexpr size_t MaximumDimension = 320;
+
+    MatrixGuardBuffer BufferA(MaximumDimension * MaximumDimension, true);
+    MatrixGuardBuffer BufferB(MaximumDimension * MaximumDimension, true);
+    MatrixGuardBuffer BufferC(MaximumDimension * MaximumDimension, false);
+    MatrixGuardBuffer BufferCReference(MaximumDimension * MaximumDimension, false);
+
+    //
+    // Run operations large enough to be segmented across threads using a range
+    // of maximum thread counts, independent of the number of processors.
+    //
+
+    static const int32_t ThreadCounts[] = { 1, 2, 3, 4, 8, 16 };
+
+    for (size_t t = 0; t < _countof(ThreadCounts); t++) {
+
+        MlasSetMaximumThreadCount(ThreadCounts[t]);
+
+        for (size_t M = 64; M < MaximumDimension; M += 64) {
+            for (size_t N = 64; N < MaximumDimension; N += 64) {
+                TrialSgemm(M, N, 128, 1.0f, BufferA, BufferB, 0.0f, BufferC, BufferCReference);
+                TrialSgemm(M + 7, N + 3, 96, 0.5f, BufferA, BufferB, -1.0f, BufferC, BufferCReference);
+            }
+        }
+
+        printf("threads %d\n", ThreadCounts[t]);
+    }
+
+    //
+    // Run operations concurrently from multiple threads. Requests that find the
+    // thread pool busy execute on the calling thread.
+    //
+
+    MlasSetMaximumThreadCount(4);
+
+    std::vector<std::thread> Threads;
+
+    for (size_t t = 0; t < 4; t++) {
+        Threads.emplace_back([]() {
+            MatrixGuardBuffer ThreadBufferC(MaximumDimension * MaximumDimension, false);
+            MatrixGuardBuffer ThreadBufferCReference(MaximumDimension * MaximumDimension, false);
+            MatrixGuardBuffer ThreadBufferA(MaximumDimension * MaximumDimension, true);
+            MatrixGuardBuffer ThreadBufferB(MaximumDimension * MaximumDimension, true);
+            for (size_t i = 0; i < 8; i++) {
+                TrialSgemm(256, 192, 128, 1.0f, ThreadBufferA, ThreadBufferB, 0.0f, ThreadBufferC, ThreadBufferCReference);
+            }
+        });
+    }
+
+    for (auto& Thread : Threads) {
+        Thread.join();
+    }
+
+    //
+    // Run operations using caller supplied thread pools, including from
+    // multiple threads sharing the same thread pool.
+    //
+
+    for (size_t t = 0; t < _countof(ThreadCounts); t++) {
+
+        onnxruntime::concurrency::ThreadPool ThreadPool("mlas_test", ThreadCounts[t] - 1);
+
+        for (size_t M = 64; M < MaximumDimension; M += 64) {
+            for (size_t N = 64; N < MaximumDimension; N += 64) {
+                TrialSgemm(M, N, 128, 1.0f, BufferA, BufferB, 0.0f, BufferC, BufferCReference, &ThreadPool);
+                TrialSgemm(M + 7, N + 3, 96, 0.5f, BufferA, BufferB, -1.0f, BufferC, BufferCReference, &ThreadPool);
+            }
+        }
+
+        ExecuteSgemmBatchTests(&ThreadPool);
+
+        printf("thread pool threads %d\n", ThreadCounts[t]);
+    }
+
+    onnxruntime::concurrency::ThreadPool SharedThreadPool("mlas_test", 3);
+
+    Threads.clear();
+
+    for (size_t t = 0; t < 4; t++) {
+        Threads.emplace_back([&SharedThreadPool]() {
+            MatrixGuardBuffer ThreadBufferC(MaximumDimension * MaximumDimension, false);
+            MatrixGuardBuffer ThreadBufferCReference(MaximumDimension * MaximumDimension, false);
+            MatrixGuardBuffer ThreadBufferA(MaximumDimension * MaximumDimension, true);
+            MatrixGuardBuffer ThreadBufferB(MaximumDimension * MaximumDimension, true);
+            for (size_t i = 0; i < 8; i++) {
+                TrialSgemm(256, 192, 128, 1.0f, ThreadBufferA, ThreadBufferB, 0.0f, ThreadBufferC, ThreadBufferCReference, &SharedThreadPool);
+            }
+        });
+    }
+
+    for (auto& Thread : Threads) {
+        Thread.join();
+    }
+}
+
 void
 ReferenceConv2D(
     size_t BatchCount,
@@ -439,7 +628,7 @@ ReferenceConv2D(
             }
 
             MlasSgemm(CblasNoTrans, CblasNoTrans, FilterCount, OutputSize, K, 1.0f,
-                filter, K, Im2Col, OutputSize, 0.0f, Output, OutputSize);
+                filter, K, Im2Col, OutputSize, 0.0f, Output, OutputSize, nullptr);
 
             //
             // Apply the bias.
@@ -512,7 +701,8 @@ TrialConv2D(
                     StrideShape,
                     OutputShape,
                     FilterCount,
-                    &WorkingBufferSize);
+                    &WorkingBufferSize,
+                    nullptr);
 
     size_t OutputHeight = size_t(OutputHeight64);
     size_t OutputWidth = size_t(OutputWidth64);
@@ -545,7 +735,8 @@ TrialConv2D(
              Filter,
              Bias,
              BufferWorking.GetBuffer(WorkingBufferSize),
-             Output);
+             Output,
+             nullptr);
 
     ReferenceConv2D(BatchCount,
                     GroupCount,
@@ -1186,7 +1377,7 @@ EvaluateThreadingPerformance(
                 DWORD start = GetTickCount();
                 DWORD stop;
                 do {
-                    MlasSgemm(CblasNoTrans, CblasNoTrans, M, N, K, 1.0f, A, K, B, N, 0.0f, C, N);
+                    MlasSgemm(CblasNoTrans, CblasNoTrans, M, N, K, 1.0f, A, K, B, N, 0.0f, C, N, nullptr);
                     stop = GetTickCount();
                     NumberIterations++;
                 } while ((stop - start) <= 5000);
@@ -1206,7 +1397,7 @@ EvaluateThreadingPerformance(
 
                     start = GetTickCount();
                     for (size_t iters = 0; iters < NumberIterations; iters++) {
-                        MlasSgemm(CblasNoTrans, CblasNoTrans, M, N, K, 1.0f, A, K, B, N, 0.0f, C, N);
+                        MlasSgemm(CblasNoTrans, CblasNoTrans, M, N, K, 1.0f, A, K, B, N, 0.0f, C, N, nullptr);
                         stop = GetTickCount();
                         if ((stop - start) > 20000) {
                             break;
@@ -1235,6 +1426,7 @@ main(
     )
 {
 //    ExecuteSgemmTests();
+    ExecuteThreadingTests();
     ExecuteConvTests();
 //    ExecutePool2DTests();
 //    ExecutePool3DTests();
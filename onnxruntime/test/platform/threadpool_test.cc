@@ -0,0 +1,153 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/platform/threadpool.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+
+namespace {
+
+void ValidateParallelFor(concurrency::ThreadPool& tp, int32_t total) {
+  std::vector<std::atomic<int>> counts(total);
+  for (auto& count : counts) {
+    count = 0;
+  }
+
+  tp.ParallelFor(total, [&counts](int32_t i) { counts[i]++; });
+
+  for (int32_t i = 0; i < total; i++) {
+    ASSERT_EQ(counts[i], 1) << "iteration " << i;
+  }
+}
+
+}  // namespace
+
+TEST(ThreadPoolTest, ParallelForRunsEachIterationOnce) {
+  for (int num_threads : {0, 1, 3, 8}) {
+    concurrency::ThreadPool tp("test", num_threads);
+    EXPECT_EQ(tp.NumThreads(), num_threads);
+
+    for (int32_t total : {0, 1, 2, 7, 100, 1000}) {
+      ValidateParallelFor(tp, total);
+    }
+  }
+}
+
+TEST(ThreadPoolTest, ParallelForIsReentrant) {
+  concurrency::ThreadPool tp("test", 2);
+  std::atomic<int> count{0};
+
+  // nested use from within the pool must not deadlock even when all workers are busy
+  tp.ParallelFor(8, [&tp, &count](int32_t) {
+    tp.ParallelFor(8, [&count](int32_t) { count++; });
+  });
+
+  EXPECT_EQ(count, 64);
+}
+
+TEST(ThreadPoolTest, ParallelForFromMultipleThreads) {
+  concurrency::ThreadPool tp("test", 3);
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&tp]() {
+      for (int i = 0; i < 50; i++) {
+        ValidateParallelFor(tp, 64);
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST(ThreadPoolTest, ParallelForPropagatesException) {
+  for (int num_threads : {0, 4}) {
+    concurrency::ThreadPool tp("test", num_threads);
+
+    EXPECT_THROW(tp.ParallelFor(100, [](int32_t i) {
+      if (i == 42) {
+        throw std::runtime_error("failed");
+      }
+    }),
+                 std::runtime_error);
+
+    // the pool remains usable
+    ValidateParallelFor(tp, 100);
+  }
+}
+
+TEST(ThreadPoolTest, TryParallelForCoversRangeInAlignedBlocks) {
+  concurrency::ThreadPool tp("test", 3);
+
+  for (int64_t total : {0, 1, 15, 16, 1000, 100000}) {
+    for (int64_t alignment : {1, 16}) {
+      std::vector<std::atomic<int>> counts(static_cast<size_t>(total));
+      for (auto& count : counts) {
+        count = 0;
+      }
+      std::atomic<int> num_blocks{0};
+
+      concurrency::ThreadPool::TryParallelFor(&tp, total, 10, [&](int64_t first, int64_t last) {
+        EXPECT_LT(first, last);
+        EXPECT_EQ(first % alignment, 0);
+        // every block but the last one processes at least the minimum cost
+        if (last != total) {
+          EXPECT_GE((last - first) * 10, concurrency::ThreadPool::kMinBlockCost);
+        }
+        for (int64_t i = first; i < last; i++) {
+          counts[static_cast<size_t>(i)]++;
+        }
+        num_blocks++;
+      },
+                                              alignment);
+
+      for (int64_t i = 0; i < total; i++) {
+        ASSERT_EQ(counts[static_cast<size_t>(i)], 1) << "unit " << i;
+      }
+      if (total * 10 > 2 * concurrency::ThreadPool::kMinBlockCost) {
+        EXPECT_GT(num_blocks, 1);
+      }
+    }
+  }
+
+  // without a pool the whole range is a single block on the calling thread
+  int calls = 0;
+  concurrency::ThreadPool::TryParallelFor(nullptr, 100000, 10, [&calls](int64_t first, int64_t last) {
+    EXPECT_EQ(first, 0);
+    EXPECT_EQ(last, 100000);
+    calls++;
+  });
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(ThreadPoolTest, Schedule) {
+  concurrency::ThreadPool tp("test", 2);
+  std::atomic<int> count{0};
+
+  for (int i = 0; i < 10; i++) {
+    tp.Schedule([&count]() { count++; });
+  }
+
+  while (count != 10) {
+    std::this_thread::yield();
+  }
+
+  // without worker threads the function is run inline
+  concurrency::ThreadPool inline_tp("test", 0);
+  bool ran = false;
+  inline_tp.Schedule([&ran]() { ran = true; });
+  EXPECT_TRUE(ran);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
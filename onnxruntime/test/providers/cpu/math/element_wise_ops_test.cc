@@ -154,6 +154,40 @@ TEST(MathOpTest, Add_Broadcast_2x1x1_3x4) {
   test.Run();
 }
 
+// large enough to be split across threads, with the splits falling part way through the broadcast spans
+TEST(MathOpTest, Add_Broadcast_Large) {
+  const int64_t N = 4, C = 16, H = 33, W = 65;
+  std::vector<float> A(N * C * H * W);
+  for (size_t i = 0; i < A.size(); ++i) {
+    A[i] = static_cast<float>(i % 1000);
+  }
+
+  auto run = [&](const std::vector<int64_t>& b_dims, const std::function<size_t(int64_t, int64_t, int64_t)>& b_index) {
+    std::vector<float> B(TensorShape(b_dims).Size());
+    for (size_t i = 0; i < B.size(); ++i) {
+      B[i] = 10000.0f * static_cast<float>(i + 1);
+    }
+
+    std::vector<float> Y(A.size());
+    for (int64_t n = 0, i = 0; n < N; ++n)
+      for (int64_t c = 0; c < C; ++c)
+        for (int64_t h = 0; h < H; ++h)
+          for (int64_t w = 0; w < W; ++w, ++i)
+            Y[i] = A[i] + B[b_index(c, h, w)];
+
+    OpTester test("Add");
+    test.AddInput<float>("A", {N, C, H, W}, A);
+    test.AddInput<float>("B", b_dims, B);
+    test.AddOutput<float>("C", {N, C, H, W}, Y);
+    test.Run();
+  };
+
+  // one value per channel
+  run({1, C, 1, 1}, [](int64_t c, int64_t, int64_t) { return static_cast<size_t>(c); });
+  // a row per channel, repeated down each column
+  run({C, 1, W}, [](int64_t c, int64_t, int64_t w) { return static_cast<size_t>(c * W + w); });
+}
+
 TEST(MathOpTest, Sub_int32) {
   OpTester test("Sub");
   test.AddInput<int32_t>("A", {3}, {1, 4, 3});
@@ -66,6 +66,28 @@ TEST(MathOpTest, GemmTrans) {
   test.Run();
 }
 
+TEST(MathOpTest, GemmTransConstantB) {
+  OpTester test("Gemm");
+
+  test.AddAttribute("transA", (int64_t)0);
+  test.AddAttribute("transB", (int64_t)1);
+  test.AddAttribute("alpha", 0.5f);
+  test.AddAttribute("beta", 1.0f);
+
+  // K spans more than one panel of the packed B
+  std::vector<float> A(2 * 130);
+  std::fill(A.begin(), A.begin() + 130, 1.0f);
+  std::fill(A.begin() + 130, A.end(), -1.0f);
+  test.AddInput<float>("A", {2, 130}, A);
+  test.AddInput<float>("B", {20, 130}, std::vector<float>(20 * 130, 2.0f), true);
+  test.AddInput<float>("C", {1}, std::vector<float>{0.5f});
+  std::vector<float> Y(2 * 20);
+  std::fill(Y.begin(), Y.begin() + 20, 130.5f);
+  std::fill(Y.begin() + 20, Y.end(), -129.5f);
+  test.AddOutput<float>("Y", {2, 20}, Y);
+  test.Run();
+}
+
 TEST(MathOpTest, GemmAlphaBeta) {
   OpTester test("Gemm");
 
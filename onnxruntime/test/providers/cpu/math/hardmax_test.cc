@@ -2,6 +2,9 @@
 // Licensed under the MIT License.
 
 #include "core/providers/cpu/math/softmax_shared.h"
+
+#include <algorithm>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
@@ -135,6 +138,25 @@ TEST(HardmaxOperator, ThreeDimsAxis2) {
   RunTest(x_vals_3dims, expected_vals, three_dimensions, /*axis*/ 2);
 }
 
+TEST(HardmaxOperator, ManyRows) {
+  // enough rows to be split across the thread pool. the maximum of a row appears several times and only the
+  // first one is set.
+  const int64_t N = 97;
+  const int64_t D = 523;
+  std::vector<float> x_vals(N * D);
+  std::vector<float> expected_vals(N * D, 0.0f);
+  for (int64_t i = 0; i < N; ++i) {
+    for (int64_t j = 0; j < D; ++j) {
+      x_vals[i * D + j] = static_cast<float>((i * 31 + j * 17) % 101) / 10.f - 5.f;
+    }
+
+    const float* x = x_vals.data() + i * D;
+    expected_vals[i * D + (std::max_element(x, x + D) - x)] = 1.0f;
+  }
+
+  RunTest(x_vals, expected_vals, {N, D});
+}
+
 TEST(HardmaxOperator, InvalidAxis) {
   std::vector<float> x_vals = {-1.0f, 0.0f, 1.0f};
   std::vector<float> expected_vals = {0.0f, 0.0f, 0.0f};
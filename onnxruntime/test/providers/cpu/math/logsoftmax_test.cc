@@ -2,6 +2,10 @@
 // Licensed under the MIT License.
 
 #include "core/providers/cpu/math/logsoftmax.h"
+
+#include <algorithm>
+#include <cmath>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
@@ -178,6 +182,31 @@ TEST(LogSoftmaxOperator, ThreeDimsNegativeAxis) {
   RunTest(x_vals_3dims, expected_vals, three_dimensions, /*axis*/ -1);
 }
 
+TEST(LogSoftmaxOperator, ManyRows) {
+  // enough rows to be split across the thread pool, with rows that aren't a multiple of the vector width
+  const int64_t N = 97;
+  const int64_t D = 523;
+  std::vector<float> x_vals(N * D);
+  std::vector<float> expected_vals(N * D);
+  for (int64_t i = 0; i < N; ++i) {
+    for (int64_t j = 0; j < D; ++j) {
+      x_vals[i * D + j] = static_cast<float>((i * 31 + j * 17) % 101) / 10.f - 5.f;
+    }
+
+    const float* x = x_vals.data() + i * D;
+    const float max = *std::max_element(x, x + D);
+    double sum = 0;
+    for (int64_t j = 0; j < D; ++j) {
+      sum += std::exp(x[j] - max);
+    }
+    for (int64_t j = 0; j < D; ++j) {
+      expected_vals[i * D + j] = static_cast<float>(x[j] - max - std::log(sum));
+    }
+  }
+
+  RunTest(x_vals, expected_vals, {N, D});
+}
+
 TEST(LogSoftmaxOperator, InvalidAxis) {
   std::vector<float> x_vals = {-1.0f, 0.0f, 1.0f};
   std::vector<float> expected_vals = {0.0f, 0.0f, 0.0f};
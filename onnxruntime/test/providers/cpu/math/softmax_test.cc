@@ -2,6 +2,10 @@
 // Licensed under the MIT License.
 
 #include "core/providers/cpu/math/softmax_shared.h"
+
+#include <algorithm>
+#include <cmath>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
@@ -174,6 +178,31 @@ TEST(SoftmaxOperator, ThreeDimsNegativeAxis) {
   RunTest(x_vals_3dims, expected_vals, three_dimensions, /*axis*/ -1);
 }
 
+TEST(SoftmaxOperator, ManyRows) {
+  // enough rows to be split across the thread pool, with rows that aren't a multiple of the vector width
+  const int64_t N = 97;
+  const int64_t D = 523;
+  std::vector<float> x_vals(N * D);
+  std::vector<float> expected_vals(N * D);
+  for (int64_t i = 0; i < N; ++i) {
+    for (int64_t j = 0; j < D; ++j) {
+      x_vals[i * D + j] = static_cast<float>((i * 31 + j * 17) % 101) / 10.f - 5.f;
+    }
+
+    const float* x = x_vals.data() + i * D;
+    const float max = *std::max_element(x, x + D);
+    double sum = 0;
+    for (int64_t j = 0; j < D; ++j) {
+      sum += std::exp(x[j] - max);
+    }
+    for (int64_t j = 0; j < D; ++j) {
+      expected_vals[i * D + j] = static_cast<float>(std::exp(x[j] - max) / sum);
+    }
+  }
+
+  RunTest(x_vals, expected_vals, {N, D});
+}
+
 TEST(SoftmaxOperator, InvalidAxis) {
   std::vector<float> x_vals = {-1.0f, 0.0f, 1.0f};
   std::vector<float> expected_vals = {0.0f, 0.0f, 0.0f};
@@ -193,19 +222,19 @@ TEST(SoftmaxOperator, TestInputTooLarge) {
   // N > INT32_MAX
   int64_t N = int64_t(INT32_MAX) + 1;
   int64_t D = 1;
-  auto status = SoftmaxCPU(N, D, ignored, ignored, ignored, ignored, true, ignored);
+  auto status = SoftmaxCPU(N, D, ignored, ignored, true, nullptr);
   EXPECT_EQ(status.Code(), common::INVALID_ARGUMENT);
 
   // D > INT32_MAX
   N = 1;
   D = int64_t(INT32_MAX) + 1;
-  status = SoftmaxCPU(N, D, ignored, ignored, ignored, ignored, true, ignored);
+  status = SoftmaxCPU(N, D, ignored, ignored, true, nullptr);
   EXPECT_EQ(status.Code(), common::INVALID_ARGUMENT);
 
   // N * D > INT32_MAX
   N = int64_t(INT32_MAX) / 2;
   D = 3;
-  status = SoftmaxCPU(N, D, ignored, ignored, ignored, ignored, true, ignored);
+  status = SoftmaxCPU(N, D, ignored, ignored, true, nullptr);
   EXPECT_EQ(status.Code(), common::INVALID_ARGUMENT);
 
   /*
@@ -213,12 +242,10 @@ TEST(SoftmaxOperator, TestInputTooLarge) {
                               const int64_t D,
                               const float* Xdata,
                               float* Ydata,
-                              float* scale,
-                              const float* sum_multiplier,
                               bool logarithmic,
-                              float* rowmax)
+                              concurrency::ThreadPool* tp)
     {
-        // the Math functions SoftmaxCPU uses only support int32_t as input, so enforce that
+        // the rows are split across the thread pool with int32_t task indices
         if (N * D > INT32_MAX || N > INT32_MAX || D > INT32_MAX)
         {
             std::ostringstream ss;
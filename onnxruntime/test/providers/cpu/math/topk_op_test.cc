@@ -82,5 +82,50 @@ TEST(TopKOperator, InvalidK) {
           "Invalid value for attribute k");
 }
 
+TEST(TopKOperator, FirstAxis) {
+  std::vector<float> input_vals = {0.1f, 0.3f, 0.2f, 0.4f, 0.1f, 0.3f, 0.4f, 0.2f, 0.5f, 0.3f, 0.1f, 0.2f};
+  std::vector<int64_t> input_dimensions = {3, 4};
+  std::vector<float> expected_vals = {0.5f, 0.3f, 0.4f, 0.4f, 0.1f, 0.3f, 0.2f, 0.2f};
+  std::vector<int64_t> expected_indices = {2, 0, 1, 0, 0, 1, 0, 1};
+  std::vector<int64_t> expected_dimensions = {2, 4};
+  RunTest(2, input_vals, input_dimensions, expected_vals, expected_indices, expected_dimensions, 0);
+}
+
+TEST(TopKOperator, MiddleAxisDouble) {
+  OpTester test("TopK");
+  test.AddAttribute("k", (int64_t)2);
+  test.AddAttribute("axis", (int64_t)1);
+  test.AddInput<double>("X", {2, 3, 2}, {0.1, 0.6, 0.5, 0.2, 0.3, 0.6, 0.9, 0.4, 0.7, 0.8, 0.8, 0.4});
+  test.AddOutput<double>("Values", {2, 2, 2}, {0.5, 0.6, 0.3, 0.6, 0.9, 0.8, 0.8, 0.4});
+  test.AddOutput<int64_t>("Indices", {2, 2, 2}, {1, 0, 2, 2, 0, 1, 2, 0});
+  test.Run();
+}
+
+// A few rows much longer than k, which are searched in chunks by several threads
+TEST(TopKOperator, LongRows) {
+  const int64_t rows = 2, n = 100000, k = 10;
+  std::vector<float> input_vals(rows * n);
+  for (int64_t i = 0; i < rows * n; ++i) {
+    input_vals[i] = static_cast<float>((i * 7919) % 100003);
+  }
+
+  std::vector<float> expected_vals;
+  std::vector<int64_t> expected_indices;
+  for (int64_t row = 0; row < rows; ++row) {
+    std::vector<int64_t> order(n);
+    for (int64_t j = 0; j < n; ++j) {
+      order[j] = j;
+    }
+    const float* row_vals = input_vals.data() + row * n;
+    std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) { return row_vals[a] > row_vals[b]; });
+    for (int64_t j = 0; j < k; ++j) {
+      expected_vals.push_back(row_vals[order[j]]);
+      expected_indices.push_back(order[j]);
+    }
+  }
+
+  RunTest(k, input_vals, {rows, n}, expected_vals, expected_indices, {rows, k});
+}
+
 }  // namespace test
 }  // namespace onnxruntime
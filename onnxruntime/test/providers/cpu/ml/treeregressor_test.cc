@@ -1,6 +1,8 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
+
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 
@@ -50,5 +52,151 @@ TEST(MLOpTest, TreeRegressorMultiTarget) {
   test.Run();
 }
 
+TEST(MLOpTest, TreeRegressorManyTreesAndSamples) {
+  //the trees of TreeRegressorMultiTarget repeated, so that the average is unchanged
+  std::vector<int64_t> lefts = {1, 2, -1, -1, -1, 1, -1, 3, -1, -1, 1, -1, -1};
+  std::vector<int64_t> rights = {4, 3, -1, -1, -1, 2, -1, 4, -1, -1, 2, -1, -1};
+  std::vector<int64_t> treeids = {0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 2, 2, 2};
+  std::vector<int64_t> nodeids = {0, 1, 2, 3, 4, 0, 1, 2, 3, 4, 0, 1, 2};
+  std::vector<int64_t> featureids = {2, 1, -2, -2, -2, 0, -2, 2, -2, -2, 1, -2, -2};
+  std::vector<float> thresholds = {10.5f, 13.10000038f, -2.f, -2.f, -2.f, 1.5f, -2.f, -213.f, -2.f, -2.f, 13.10000038f, -2.f, -2.f};
+  std::vector<std::string> modes = {"BRANCH_LEQ", "BRANCH_LEQ", "LEAF", "LEAF", "LEAF", "BRANCH_LEQ", "LEAF", "BRANCH_LEQ", "LEAF", "LEAF", "BRANCH_LEQ", "LEAF", "LEAF"};
+
+  std::vector<int64_t> target_treeids = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2};
+  std::vector<int64_t> target_nodeids = {0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 0, 0, 1, 1, 2, 2};
+  std::vector<int64_t> target_classids = {0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1};
+  std::vector<float> target_weights = {1.5f, 27.5f, 2.25f, 20.75f, 2.f, 23.f, 3.f, 14.f, 0.f, 41.f, 1.83333333f, 24.5f, 0.f, 41.f, 2.75f, 16.25f, 2.f, 23.f, 3.f, 14.f, 2.66666667f, 17.f, 2.f, 23.f, 3.f, 14.f};
+
+  const int64_t copies = 400;
+  std::vector<int64_t> all_lefts, all_rights, all_treeids, all_nodeids, all_featureids;
+  std::vector<float> all_thresholds;
+  std::vector<std::string> all_modes;
+  std::vector<int64_t> all_target_treeids, all_target_nodeids, all_target_classids;
+  std::vector<float> all_target_weights;
+  for (int64_t c = 0; c < copies; ++c) {
+    all_lefts.insert(all_lefts.end(), lefts.begin(), lefts.end());
+    all_rights.insert(all_rights.end(), rights.begin(), rights.end());
+    for (auto id : treeids) all_treeids.push_back(id + 3 * c);
+    all_nodeids.insert(all_nodeids.end(), nodeids.begin(), nodeids.end());
+    all_featureids.insert(all_featureids.end(), featureids.begin(), featureids.end());
+    all_thresholds.insert(all_thresholds.end(), thresholds.begin(), thresholds.end());
+    all_modes.insert(all_modes.end(), modes.begin(), modes.end());
+    for (auto id : target_treeids) all_target_treeids.push_back(id + 3 * c);
+    all_target_nodeids.insert(all_target_nodeids.end(), target_nodeids.begin(), target_nodeids.end());
+    all_target_classids.insert(all_target_classids.end(), target_classids.begin(), target_classids.end());
+    all_target_weights.insert(all_target_weights.end(), target_weights.begin(), target_weights.end());
+  }
+
+  std::vector<float> X = {1.f, 0.0f, 0.4f, 3.0f, 44.0f, -3.f, 12.0f, 12.9f, -312.f, 23.0f, 11.3f, -222.f, 23.0f, 11.3f, -222.f, 23.0f, 3311.3f, -222.f, 23.0f, 11.3f, -222.f, 43.0f, 413.3f, -114.f};
+  std::vector<float> results = {1.33333333f, 29.f, 3.f, 14.f, 2.f, 23.f, 2.f, 23.f, 2.f, 23.f, 2.66666667f, 17.f, 2.f, 23.f, 3.f, 14.f};
+
+  //a single sample is split across the trees, a large batch across the samples
+  for (int64_t batches : {int64_t{0}, int64_t{64}}) {
+    OpTester test("TreeEnsembleRegressor", 1, onnxruntime::kMLDomain);
+    test.AddAttribute("nodes_truenodeids", all_lefts);
+    test.AddAttribute("nodes_falsenodeids", all_rights);
+    test.AddAttribute("nodes_treeids", all_treeids);
+    test.AddAttribute("nodes_nodeids", all_nodeids);
+    test.AddAttribute("nodes_featureids", all_featureids);
+    test.AddAttribute("nodes_values", all_thresholds);
+    test.AddAttribute("nodes_modes", all_modes);
+    test.AddAttribute("target_treeids", all_target_treeids);
+    test.AddAttribute("target_nodeids", all_target_nodeids);
+    test.AddAttribute("target_ids", all_target_classids);
+    test.AddAttribute("target_weights", all_target_weights);
+    test.AddAttribute("n_targets", (int64_t)2);
+    test.AddAttribute("aggregate_function", "AVERAGE");
+
+    if (batches == 0) {
+      test.AddInput<float>("X", {1, 3}, {X.begin(), X.begin() + 3});
+      test.AddOutput<float>("Y", {1, 2}, {results.begin(), results.begin() + 2});
+    } else {
+      std::vector<float> all_X, all_results;
+      for (int64_t b = 0; b < batches; ++b) {
+        all_X.insert(all_X.end(), X.begin(), X.end());
+        all_results.insert(all_results.end(), results.begin(), results.end());
+      }
+      test.AddInput<float>("X", {8 * batches, 3}, all_X);
+      test.AddOutput<float>("Y", {8 * batches, 2}, all_results);
+    }
+    test.Run();
+  }
+}
+
+TEST(MLOpTest, TreeRegressorNonContiguousNodeIds) {
+  //the trees of TreeRegressorMultiTarget with node ids that have gaps and nodes listed from the last one
+  std::vector<int64_t> lefts = {1, 2, -1, -1, -1, 1, -1, 3, -1, -1, 1, -1, -1};
+  std::vector<int64_t> rights = {4, 3, -1, -1, -1, 2, -1, 4, -1, -1, 2, -1, -1};
+  std::vector<int64_t> treeids = {0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 2, 2, 2};
+  std::vector<int64_t> nodeids = {0, 1, 2, 3, 4, 0, 1, 2, 3, 4, 0, 1, 2};
+  std::vector<int64_t> featureids = {2, 1, -2, -2, -2, 0, -2, 2, -2, -2, 1, -2, -2};
+  std::vector<float> thresholds = {10.5f, 13.10000038f, -2.f, -2.f, -2.f, 1.5f, -2.f, -213.f, -2.f, -2.f, 13.10000038f, -2.f, -2.f};
+  std::vector<std::string> modes = {"BRANCH_LEQ", "BRANCH_LEQ", "LEAF", "LEAF", "LEAF", "BRANCH_LEQ", "LEAF", "BRANCH_LEQ", "LEAF", "LEAF", "BRANCH_LEQ", "LEAF", "LEAF"};
+
+  std::vector<int64_t> target_treeids = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2};
+  std::vector<int64_t> target_nodeids = {0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 0, 0, 1, 1, 2, 2};
+  std::vector<int64_t> target_classids = {0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1};
+  std::vector<float> target_weights = {1.5f, 27.5f, 2.25f, 20.75f, 2.f, 23.f, 3.f, 14.f, 0.f, 41.f, 1.83333333f, 24.5f, 0.f, 41.f, 2.75f, 16.25f, 2.f, 23.f, 3.f, 14.f, 2.66666667f, 17.f, 2.f, 23.f, 3.f, 14.f};
+
+  auto remap = [](int64_t id) { return id < 0 ? id : 100 - 7 * id; };
+  for (auto* ids : {&lefts, &rights, &nodeids, &target_nodeids}) {
+    std::transform(ids->begin(), ids->end(), ids->begin(), remap);
+  }
+  std::reverse(lefts.begin(), lefts.end());
+  std::reverse(rights.begin(), rights.end());
+  std::reverse(treeids.begin(), treeids.end());
+  std::reverse(nodeids.begin(), nodeids.end());
+  std::reverse(featureids.begin(), featureids.end());
+  std::reverse(thresholds.begin(), thresholds.end());
+  std::reverse(modes.begin(), modes.end());
+
+  std::vector<float> X = {1.f, 0.0f, 0.4f, 3.0f, 44.0f, -3.f, 12.0f, 12.9f, -312.f, 23.0f, 11.3f, -222.f, 23.0f, 11.3f, -222.f, 23.0f, 3311.3f, -222.f, 23.0f, 11.3f, -222.f, 43.0f, 413.3f, -114.f};
+  std::vector<float> results = {1.33333333f, 29.f, 3.f, 14.f, 2.f, 23.f, 2.f, 23.f, 2.f, 23.f, 2.66666667f, 17.f, 2.f, 23.f, 3.f, 14.f};
+
+  OpTester test("TreeEnsembleRegressor", 1, onnxruntime::kMLDomain);
+  test.AddAttribute("nodes_truenodeids", lefts);
+  test.AddAttribute("nodes_falsenodeids", rights);
+  test.AddAttribute("nodes_treeids", treeids);
+  test.AddAttribute("nodes_nodeids", nodeids);
+  test.AddAttribute("nodes_featureids", featureids);
+  test.AddAttribute("nodes_values", thresholds);
+  test.AddAttribute("nodes_modes", modes);
+  test.AddAttribute("target_treeids", target_treeids);
+  test.AddAttribute("target_nodeids", target_nodeids);
+  test.AddAttribute("target_ids", target_classids);
+  test.AddAttribute("target_weights", target_weights);
+  test.AddAttribute("n_targets", (int64_t)2);
+  test.AddAttribute("aggregate_function", "AVERAGE");
+  test.AddInput<float>("X", {8, 3}, X);
+  test.AddOutput<float>("Y", {8, 2}, results);
+  test.Run();
+}
+
+TEST(MLOpTest, TreeRegressorFeatureIdOutOfRange) {
+  //a single branch on the feature at featureid, with a leaf on each side
+  auto run = [](int64_t featureid, const std::string& expected_failure) {
+    OpTester test("TreeEnsembleRegressor", 1, onnxruntime::kMLDomain);
+    test.AddAttribute("nodes_truenodeids", std::vector<int64_t>{1, -1, -1});
+    test.AddAttribute("nodes_falsenodeids", std::vector<int64_t>{2, -1, -1});
+    test.AddAttribute("nodes_treeids", std::vector<int64_t>{0, 0, 0});
+    test.AddAttribute("nodes_nodeids", std::vector<int64_t>{0, 1, 2});
+    test.AddAttribute("nodes_featureids", std::vector<int64_t>{featureid, 0, 0});
+    test.AddAttribute("nodes_values", std::vector<float>{0.5f, 0.f, 0.f});
+    test.AddAttribute("nodes_modes", std::vector<std::string>{"BRANCH_LEQ", "LEAF", "LEAF"});
+    test.AddAttribute("target_treeids", std::vector<int64_t>{0, 0});
+    test.AddAttribute("target_nodeids", std::vector<int64_t>{1, 2});
+    test.AddAttribute("target_ids", std::vector<int64_t>{0, 0});
+    test.AddAttribute("target_weights", std::vector<float>{1.f, 2.f});
+    test.AddAttribute("n_targets", (int64_t)1);
+    test.AddInput<float>("X", {2, 3}, {0.f, 1.f, 2.f, 3.f, 4.f, 5.f});
+    test.AddOutput<float>("Y", {2, 1}, {1.f, 2.f});
+    test.Run(OpTester::ExpectResult::kExpectFailure, expected_failure);
+  };
+
+  //X has 3 features
+  run(3, "X has fewer features than the trees use.");
+  run(-1, "Invalid feature id -1");
+}
+
 }  // namespace test
 }  // namespace onnxruntime
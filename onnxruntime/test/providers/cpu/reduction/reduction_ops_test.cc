@@ -1103,5 +1103,77 @@ TEST(ReductionOpTest, ArgMin_int32) {
   test.Run();
 }
 
+// Reduce over the middle axis of a tensor large enough to be split across threads
+TEST(ReductionOpTest, ReduceMean_middle_axis_large) {
+  const int64_t N = 2, C = 64, HW = 300;
+  std::vector<float> input(N * C * HW);
+  for (size_t i = 0; i < input.size(); ++i) {
+    input[i] = static_cast<float>(i % 7);
+  }
+
+  std::vector<float> expected(N * HW, 0.0f);
+  for (int64_t n = 0; n < N; ++n) {
+    for (int64_t c = 0; c < C; ++c) {
+      for (int64_t i = 0; i < HW; ++i) {
+        expected[n * HW + i] += input[(n * C + c) * HW + i] / C;
+      }
+    }
+  }
+
+  OpTester test("ReduceMean");
+  test.AddAttribute("axes", std::vector<int64_t>{1});
+  test.AddAttribute("keepdims", (int64_t)1);
+  test.AddInput<float>("data", {N, C, HW}, input);
+  test.AddOutput<float>("reduced", {N, 1, HW}, expected);
+  test.Run();
+}
+
+// Reduce over axes that are not next to each other, with kept axes between them and after them
+TEST(ReductionOpTest, ReduceMax_interleaved_axes) {
+  const std::vector<int64_t> dims{3, 4, 2, 5};
+  std::vector<int32_t> input(3 * 4 * 2 * 5);
+  for (size_t i = 0; i < input.size(); ++i) {
+    input[i] = static_cast<int32_t>((i * 37) % 101);
+  }
+
+  std::vector<int32_t> expected(4 * 5, std::numeric_limits<int32_t>::lowest());
+  for (int64_t a = 0; a < 3; ++a) {
+    for (int64_t b = 0; b < 4; ++b) {
+      for (int64_t c = 0; c < 2; ++c) {
+        for (int64_t d = 0; d < 5; ++d) {
+          int32_t& e = expected[b * 5 + d];
+          e = std::max(e, input[((a * 4 + b) * 2 + c) * 5 + d]);
+        }
+      }
+    }
+  }
+
+  OpTester test("ReduceMax");
+  test.AddAttribute("axes", std::vector<int64_t>{0, 2});
+  test.AddAttribute("keepdims", (int64_t)0);
+  test.AddInput<int32_t>("data", dims, input);
+  test.AddOutput<int32_t>("reduced", {4, 5}, expected);
+  test.Run();
+}
+
+// ArgMax over the middle axis, where the outputs reduce columns of the input
+TEST(ReductionOpTest, ArgMax_middle_axis) {
+  OpTester test("ArgMax");
+  test.AddAttribute("axis", (int64_t)1);
+  test.AddAttribute("keepdims", (int64_t)0);
+  test.AddInput<float>("data", {2, 3, 2},
+                       {1.0f, 6.0f,
+                        5.0f, 2.0f,
+                        5.0f, 4.0f,
+
+                        7.0f, 8.0f,
+                        9.0f, 8.0f,
+                        3.0f, 9.0f});
+  test.AddOutput<int64_t>("reduced", {2, 2},
+                          {1, 0,
+                           1, 2});
+  test.Run();
+}
+
 }  // namespace test
 }  // namespace onnxruntime
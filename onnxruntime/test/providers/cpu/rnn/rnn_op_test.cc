@@ -71,7 +71,8 @@ TEST(RNNTest, RNN_bidirectional_bias_initial_zigged_batch) {
   std::vector<int64_t> W_dims = {num_directions, hidden_size, input_size};
   std::vector<float> W_data({0.4317745F, 0.37378395F, -1.0386457F, -0.22681296F, 0.4418987F, 0.49973935F,
                              0.47248289F, -0.63369429F, 0.89542073F, 0.69698066F, 0.65118814F, 1.0828459F});
-  test.AddInput<float>("W", W_dims, W_data);
+  // constant W and R are packed once by the kernel
+  test.AddInput<float>("W", W_dims, W_data, true);
 
   std::vector<int64_t> R_dims = {num_directions, hidden_size, hidden_size};
   std::vector<float> R_data({-0.24072374F, -0.29326528F, -0.91741192F,
@@ -81,7 +82,7 @@ TEST(RNNTest, RNN_bidirectional_bias_initial_zigged_batch) {
                              -0.4292987F, -0.14766316F, -0.91084105F,
                              0.23699039F, 0.064034894F, 0.089069292F,
                              -0.12803128F, -0.081178986F, 0.967533F});
-  test.AddInput<float>("R", R_dims, R_data);
+  test.AddInput<float>("R", R_dims, R_data, true);
 
   std::vector<int64_t> B_dims = {num_directions, 2 * hidden_size};
   std::vector<float> B_data({-0.44529742F, 0.80094892F, -1.0028138F, 0.0F, 0.0F, 0.0F,
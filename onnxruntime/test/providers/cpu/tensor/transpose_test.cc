@@ -105,5 +105,89 @@ TEST(TransposeOpTest, ThreeDim) {
   TransposeTest(input_shape, input_vals, &perm, expected_shape, expected_vals);
 }
 
+// Transposes a tensor filled with increasing values and checks it against a reference computed element by element.
+template <typename T>
+void TransposeReferenceTest(const std::vector<int64_t>& input_shape, const std::vector<int64_t>& perm,
+                            std::function<T(int64_t)> make_value) {
+  const size_t rank = input_shape.size();
+  int64_t size = 1;
+  std::vector<int64_t> input_strides(rank);
+  for (size_t i = rank; i-- > 0;) {
+    input_strides[i] = size;
+    size *= input_shape[i];
+  }
+
+  std::vector<T> input_vals;
+  input_vals.reserve(size);
+  for (int64_t i = 0; i < size; ++i) {
+    input_vals.push_back(make_value(i));
+  }
+
+  std::vector<int64_t> expected_shape(rank);
+  for (size_t i = 0; i < rank; ++i) {
+    expected_shape[i] = input_shape[perm[i]];
+  }
+
+  std::vector<T> expected_vals;
+  expected_vals.reserve(size);
+  std::vector<int64_t> index(rank, 0);
+  for (int64_t i = 0; i < size; ++i) {
+    int64_t input_offset = 0;
+    for (size_t j = 0; j < rank; ++j) {
+      input_offset += index[j] * input_strides[perm[j]];
+    }
+    expected_vals.push_back(input_vals[input_offset]);
+
+    for (size_t j = rank; j-- > 0;) {
+      if (++index[j] < expected_shape[j])
+        break;
+      index[j] = 0;
+    }
+  }
+
+  OpTester test("Transpose");
+  test.AddAttribute("perm", perm);
+  test.AddInput<T>("X", input_shape, input_vals);
+  test.AddOutput<T>("Y", expected_shape, expected_vals);
+  test.Run();
+}
+
+// Test the element sizes of the other types
+TEST(TransposeOpTest, OtherTypes) {
+  std::vector<int64_t> input_shape({3, 5, 7});
+  std::vector<int64_t> perm = {2, 0, 1};
+  TransposeReferenceTest<int8_t>(input_shape, perm, [](int64_t i) { return static_cast<int8_t>(i); });
+  TransposeReferenceTest<uint16_t>(input_shape, perm, [](int64_t i) { return static_cast<uint16_t>(i); });
+  // a 2D transpose with full 8x8 tiles of 16-bit elements and partial tiles on both edges
+  TransposeReferenceTest<uint16_t>({19, 13}, {1, 0}, [](int64_t i) { return static_cast<uint16_t>(i); });
+  TransposeReferenceTest<int32_t>(input_shape, perm, [](int64_t i) { return static_cast<int32_t>(i); });
+  TransposeReferenceTest<int64_t>(input_shape, perm, [](int64_t i) { return i; });
+  TransposeReferenceTest<double>(input_shape, perm, [](int64_t i) { return static_cast<double>(i); });
+}
+
+TEST(TransposeOpTest, String) {
+  TransposeReferenceTest<std::string>({3, 5, 7}, {1, 2, 0}, [](int64_t i) { return std::to_string(i); });
+}
+
+// Test the layouts of images, with dimensions that do not fill the tiles of the blocked transpose
+TEST(TransposeOpTest, NCHWToNHWC) {
+  TransposeReferenceTest<float>({2, 3, 17, 19}, {0, 2, 3, 1}, [](int64_t i) { return static_cast<float>(i); });
+  TransposeReferenceTest<uint8_t>({2, 19, 17, 3}, {0, 3, 1, 2}, [](int64_t i) { return static_cast<uint8_t>(i); });
+}
+
+// Test axes of size 1 and axes that stay next to each other, which are merged before the transpose
+TEST(TransposeOpTest, MergedAxes) {
+  TransposeReferenceTest<float>({2, 1, 3, 4, 1, 5}, {4, 3, 5, 0, 1, 2},
+                                [](int64_t i) { return static_cast<float>(i); });
+  TransposeReferenceTest<float>({2, 3, 4, 5}, {2, 3, 0, 1}, [](int64_t i) { return static_cast<float>(i); });
+  TransposeReferenceTest<float>({2, 3, 4, 5}, {1, 0, 2, 3}, [](int64_t i) { return static_cast<float>(i); });
+}
+
+// Test transposes that are large enough to be split across threads
+TEST(TransposeOpTest, Large) {
+  TransposeReferenceTest<float>({1, 64, 96, 96}, {0, 2, 3, 1}, [](int64_t i) { return static_cast<float>(i); });
+  TransposeReferenceTest<uint8_t>({300, 500}, {1, 0}, [](int64_t i) { return static_cast<uint8_t>(i); });
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -355,6 +355,21 @@ class TestInferenceSession(unittest.TestCase):
                     self.assertTrue(tag in lines[i])
             self.assertTrue(']' in lines[8])
 
+    def testMemPatternCacheStats(self):
+        so = onnxrt.SessionOptions()
+        so.mem_pattern_cache_max_entries = 8
+        so.mem_pattern_dim_buckets = [4, 16]
+        sess = onnxrt.InferenceSession(self.get_name("mul_1.pb"), sess_options=so)
+        x = np.array([[1.0, 2.0], [3.0, 4.0], [5.0, 6.0]], dtype=np.float32)
+        sess.run([], {'X': x})
+
+        # the input of the model has a fixed shape, so its pattern is planned when the session is created
+        stats = sess.get_mem_pattern_cache_stats()
+        self.assertEqual(stats.hits, 1)
+        self.assertEqual(stats.misses, 0)
+        self.assertEqual(stats.evictions, 0)
+        self.assertEqual(stats.num_entries, 1)
+
     def testDictVectorizer(self):
         sess = onnxrt.InferenceSession(self.get_name("pipeline_vectorize.onnx"))
         input_name = sess.get_inputs()[0].name
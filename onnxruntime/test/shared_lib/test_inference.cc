@@ -199,6 +199,40 @@ TEST_F(CApiTest, create_tensor_with_data) {
   OrtReleaseObject(type_info);
 }
 
+TEST_F(CApiTest, run_prepared) {
+  SessionOptionsWrapper sf(env);
+  std::unique_ptr<OrtSession, decltype(&OrtReleaseSession)> inference_session(sf.OrtCreateInferenceSession(MODEL_URI), OrtReleaseSession);
+  std::unique_ptr<OrtPreparedRun, decltype(&OrtReleasePreparedRun)> prepared(
+      OrtCreatePreparedRun(inference_session.get(), {"X"}, {"Y"}), OrtReleasePreparedRun);
+  ASSERT_THROW(OrtCreatePreparedRun(inference_session.get(), {"X"}, {"not_an_output"}), std::runtime_error);
+
+  std::unique_ptr<OrtAllocator> default_allocator(MockedOrtAllocator::Create());
+  std::vector<float> values_x = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  std::vector<float> expected_values_y = {1.0f, 4.0f, 9.0f, 16.0f, 25.0f, 36.0f};
+  std::unique_ptr<OrtValue, decltype(&OrtReleaseValue)> value_x(
+      OrtCreateTensorAsOrtValue(default_allocator.get(), {3, 2}, ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT), OrtReleaseValue);
+  void* raw_data;
+  ORT_THROW_ON_ERROR(OrtGetTensorMutableData(value_x.get(), &raw_data));
+  memcpy(raw_data, values_x.data(), values_x.size() * sizeof(values_x[0]));
+  std::vector<OrtValue*> inputs{value_x.get()};
+
+  // the prepared run is reused, as it would be by a serving loop
+  for (int run = 0; run != 2; ++run) {
+    std::vector<OrtValue*> outputs(1);
+    OrtRunPrepared(inference_session.get(), nullptr, prepared.get(), inputs, outputs);
+    ASSERT_NE(outputs[0], nullptr);
+    std::unique_ptr<OrtValue, decltype(&OrtReleaseValue)> value_y(outputs[0], OrtReleaseValue);
+    float* f;
+    ORT_THROW_ON_ERROR(OrtGetTensorMutableData(value_y.get(), (void**)&f));
+    for (size_t i = 0; i != expected_values_y.size(); ++i) {
+      ASSERT_EQ(expected_values_y[i], f[i]);
+    }
+  }
+
+  std::vector<OrtValue*> too_many_outputs(2);
+  ASSERT_THROW(OrtRunPrepared(inference_session.get(), nullptr, prepared.get(), inputs, too_many_outputs), std::runtime_error);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -10,3 +10,25 @@ TEST_F(CApiTest, session_options) {
   std::unique_ptr<OrtSessionOptions> options(OrtCreateSessionOptions());
   ASSERT_NE(options, nullptr);
 }
+
+TEST_F(CApiTest, mem_pattern_cache_options) {
+  SessionOptionsWrapper sf(env);
+  sf.SetMemPatternCacheLimits(8, 1 << 20);
+
+  std::unique_ptr<OrtSessionOptions> options(OrtCreateSessionOptions());
+  const int64_t ascending[] = {4, 16, 64};
+  const int64_t descending[] = {64, 16};
+  ASSERT_EQ(OrtSetMemPatternDimBuckets(options.get(), ascending, 3), 0);
+  ASSERT_EQ(OrtSetMemPatternDimBuckets(options.get(), descending, 2), -1);
+  ASSERT_EQ(OrtSetMemPatternDimBuckets(options.get(), nullptr, 0), 0);
+  ASSERT_THROW(sf.SetMemPatternDimBuckets(descending, 2), std::runtime_error);
+
+  // the input of the model has a fixed shape, so its pattern is planned when the session is created
+  std::unique_ptr<OrtSession, decltype(&OrtReleaseSession)> session(
+      sf.OrtCreateInferenceSession(TSTR("testdata/mul_1.pb")), OrtReleaseSession);
+  OrtMemPatternCacheStats stats;
+  ORT_THROW_ON_ERROR(OrtInferenceSessionGetMemPatternCacheStats(session.get(), &stats));
+  ASSERT_EQ(stats.num_entries, 1u);
+  ASSERT_EQ(stats.hits, 0u);
+  ASSERT_EQ(stats.evictions, 0u);
+}